@@ -36,6 +36,7 @@
 #include "common/command_line.h"
 #include "crypto/hash.h"
 #include "cryptonote_basic/blobdatatype.h"
+#include "cryptonote_basic/circ_supply.h"
 #include "cryptonote_basic/cryptonote_basic.h"
 #include "cryptonote_basic/difficulty.h"
 #include "cryptonote_basic/hardfork.h"
@@ -150,6 +151,20 @@ struct alt_block_data_t
   uint64_t already_generated_coins;
 };
 
+/**
+ * @brief whether a pool conversion tx can go into the next block
+ *
+ * Kept up to date by the tx pool as blocks are added and removed.
+ */
+enum class conversion_status : uint8_t
+{
+  eligible = 0,
+  pr_too_old, //!< its pricing record is more than PRICING_RECORD_VALID_BLOCKS old
+  pr_too_new, //!< its pricing record is not below the chain height, after a reorg
+  no_pricing_record, //!< the chain has no acceptable pricing record
+  reserve_ratio //!< on its own it would break the reserve ratio
+};
+
 /**
  * @brief a struct containing txpool per transaction metadata
  */
@@ -174,8 +189,10 @@ struct txpool_tx_meta_t
   uint8_t is_forwarding: 1;
   uint8_t bf_padding: 3;
   char fee_asset_type[8];
+  uint8_t tx_type; //!< transaction_type, UNSET in entries from older versions
+  uint8_t conversion_status; //!< see conversion_status, only set for conversions
 
-  uint8_t padding[68]; // till 192 bytes
+  uint8_t padding[66]; // till 192 bytes
 
   void set_relay_method(relay_method method) noexcept;
   relay_method get_relay_method() const noexcept;
@@ -986,6 +1003,22 @@ public:
    */
   virtual std::pair<std::vector<uint64_t>, uint64_t> get_block_cumulative_rct_outputs(const std::vector<uint64_t> &heights, const std::string asset_type) const = 0;
 
+  /**
+   * @brief fetch the pricing records of a range of blocks
+   *
+   * The subclass should return the pricing records stored with count
+   * consecutive blocks starting at start_height, stopping early at the
+   * top of the chain.  The blocks themselves are not deserialized.
+   *
+   * If start_height is not in the blockchain, the subclass should throw
+   *
+   * @param start_height the height of the first block
+   * @param count the maximum number of records to fetch
+   *
+   * @return the pricing records, in height order
+   */
+  virtual std::vector<oracle::pricing_record> get_block_pricing_records(uint64_t start_height, size_t count) const = 0;
+
   /**
    * @brief fetch the top block's timestamp
    *
@@ -1174,9 +1207,26 @@ public:
   /**
    * @brief fetch the circulating supply tally values from the blockchain
    *
+   * The snapshot is read in a single transaction and is tagged with the
+   * height and top block hash it corresponds to.
+   *
    * @return the current circulating supply tally values
    */
-  virtual std::vector<std::pair<std::string, std::string>> get_circulating_supply() const = 0;
+  virtual circ_supply_snapshot get_circulating_supply() const = 0;
+
+  /**
+   * @brief fetch the per-block reserve history
+   *
+   * Returns one entry for every stride-th block in [start_height, end_height],
+   * always starting at start_height.  end_height is clamped to the top block.
+   *
+   * @param start_height the first height to fetch
+   * @param end_height the last height to fetch
+   * @param stride the distance between consecutive entries, must be non zero
+   *
+   * @return the reserve state after each selected block
+   */
+  virtual std::vector<reserve_history_entry> get_reserve_history(uint64_t start_height, uint64_t end_height, uint64_t stride) const = 0;
 
   /**
    * <!--
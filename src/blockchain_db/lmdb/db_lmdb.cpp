@@ -59,7 +59,7 @@ using epee::string_tools::pod_to_hex;
 using namespace crypto;
 
 // Increase when the DB structure changes
-#define VERSION 2
+#define VERSION 5
 
 namespace
 {
@@ -202,7 +202,7 @@ namespace
  *
  * output_txs       output ID    {txn hash, local index}
  * output_amounts   amount       [{amount output index, metadata}...]
- * output_types     asset_type   [{asset type output index, output id}]
+ * output_type_ids  asset ID     [{asset type output index, output id}]
  *
  * spent_keys       input hash   -
  *
@@ -211,6 +211,11 @@ namespace
  *
  * alt_blocks       block hash   {block data, block blob}
  *
+ * circ_supply      txn ID       {conversion metadata}
+ * circ_supply_tally asset index {supply tally}
+ * reserve_history  block ID     {supply tallies, spot and moving average prices}
+ * block_cum_rct    column ID    [{block ID, cumulative rct outputs}]
+ *
  * Note: where the data items are of uniform size, DUPFIXED tables have
  * been used to save space. In most of these cases, a dummy "zerokval"
  * key is used when accessing the table; the Key listed above will be
@@ -218,6 +223,10 @@ namespace
  * (DUPFIXED saves 8 bytes per record.)
  *
  * The output_amounts table doesn't use a dummy key, but uses DUPSORT.
+ *
+ * The block_cum_rct table holds one column per asset id, plus one for the
+ * total over all assets, so that rct output distributions are read without
+ * going through the much larger block_info records.
  */
 const char* const LMDB_BLOCKS = "blocks";
 const char* const LMDB_BLOCK_HEIGHTS = "block_heights";
@@ -233,7 +242,7 @@ const char* const LMDB_TX_OUTPUTS = "tx_outputs";
 
 const char* const LMDB_OUTPUT_TXS = "output_txs";
 const char* const LMDB_OUTPUT_AMOUNTS = "output_amounts";
-const char* const LMDB_OUTPUT_TYPES = "output_types";
+const char* const LMDB_OUTPUT_TYPES = "output_type_ids";
 const char* const LMDB_SPENT_KEYS = "spent_keys";
 
 const char* const LMDB_TXPOOL_META = "txpool_meta";
@@ -248,6 +257,11 @@ const char* const LMDB_PROPERTIES = "properties";
 
 const char* const LMDB_CIRC_SUPPLY = "circ_supply";
 const char* const LMDB_CIRC_SUPPLY_TALLY = "circ_supply_tally";
+const char* const LMDB_RESERVE_HISTORY = "reserve_history";
+const char* const LMDB_BLOCK_CUM_RCT = "block_cum_rct";
+
+// block_cum_rct column holding the cumulative rct outputs over all assets
+const uint64_t CUM_RCT_TOTAL_COLUMN = oracle::NUM_ASSET_TYPES;
 
 const char zerokey[8] = {0};
 const MDB_val zerokval = { sizeof(zerokey), (void *)zerokey };
@@ -264,6 +278,14 @@ inline void lmdb_db_open(MDB_txn* txn, const char* name, int flags, MDB_dbi& dbi
     throw0(cryptonote::DB_OPEN_FAILURE((lmdb_error(error_string + " : ", res) + std::string(" - you may want to start with --db-salvage")).c_str()));
 }
 
+inline uint64_t get_output_type_key(const std::string& asset_type)
+{
+  const oracle::asset_id id = oracle::get_asset_id(asset_type);
+  if (!oracle::is_valid_asset_id(id))
+    throw0(cryptonote::DB_ERROR(("Unknown output asset type: " + asset_type).c_str()));
+  return static_cast<uint64_t>(id);
+}
+
 
 }  // anonymous namespace
 
@@ -366,6 +388,23 @@ typedef struct circ_supply_tally {
   uint64_t amount_lo;
 } circ_supply_tally;
 
+typedef struct mdb_reserve_history {
+  uint64_t rh_height;
+  uint64_t rh_zeph_reserve_hi;
+  uint64_t rh_zeph_reserve_lo;
+  uint64_t rh_num_stables_hi;
+  uint64_t rh_num_stables_lo;
+  uint64_t rh_num_reserves_hi;
+  uint64_t rh_num_reserves_lo;
+  uint64_t rh_spot;
+  uint64_t rh_moving_average;
+} mdb_reserve_history;
+
+typedef struct mdb_cum_rct {
+  uint64_t cr_height;
+  uint64_t cr_cum_rct;
+} mdb_cum_rct;
+
 std::atomic<uint64_t> mdb_txn_safe::num_active_txns{0};
 std::atomic_flag mdb_txn_safe::creation_gate = ATOMIC_FLAG_INIT;
 
@@ -851,6 +890,77 @@ void write_circulating_supply_data(MDB_cursor *cur_circ_supply_tally, MDB_val id
     throw0(DB_ERROR(lmdb_error("Failed to update tally for source circulating supply: ", result).c_str()));
 }
 
+// reads all the tallies into a snapshot; its height and top hash are left to the caller
+void read_circulating_supply_tallies(MDB_cursor *cur_circ_supply_tally, circ_supply_snapshot& supply)
+{
+  MDB_val k;
+  MDB_val v;
+
+  MDB_cursor_op op = MDB_FIRST;
+  while (1)
+  {
+    int result = mdb_cursor_get(cur_circ_supply_tally, &k, &v, op);
+    op = MDB_NEXT;
+    if (result == MDB_NOTFOUND)
+      break;
+    if (result)
+      throw0(DB_ERROR(lmdb_error("Failed to get circulating supply: ", result).c_str()));
+
+    const uint64_t currency_type = *(const uint64_t*)k.mv_data;
+    if (currency_type >= circ_supply_snapshot::NUM_ASSETS)
+      throw0(DB_ERROR("Unknown currency type in circulating supply tally"));
+    circ_supply_tally *cst = (circ_supply_tally*)v.mv_data;
+    const boost::multiprecision::int128_t amount = import_tally_from_cst(cst);
+
+    // supply tallies are clamped at zero when written
+    supply.tally[currency_type] = amount < 0 ? 0 : boost::multiprecision::uint128_t(amount);
+  }
+}
+
+mdb_reserve_history make_reserve_history(uint64_t height, const circ_supply_snapshot& supply, const oracle::pricing_record& pr)
+{
+  mdb_reserve_history rh;
+  rh.rh_height = height;
+  rh.rh_zeph_reserve_hi = ((supply.zeph_reserve() >> 64) & 0xffffffffffffffff).convert_to<uint64_t>();
+  rh.rh_zeph_reserve_lo = (supply.zeph_reserve() & 0xffffffffffffffff).convert_to<uint64_t>();
+  rh.rh_num_stables_hi = ((supply.num_stables() >> 64) & 0xffffffffffffffff).convert_to<uint64_t>();
+  rh.rh_num_stables_lo = (supply.num_stables() & 0xffffffffffffffff).convert_to<uint64_t>();
+  rh.rh_num_reserves_hi = ((supply.num_reserves() >> 64) & 0xffffffffffffffff).convert_to<uint64_t>();
+  rh.rh_num_reserves_lo = (supply.num_reserves() & 0xffffffffffffffff).convert_to<uint64_t>();
+  rh.rh_spot = pr.spot;
+  rh.rh_moving_average = pr.moving_average;
+  return rh;
+}
+
+reserve_history_entry import_reserve_history(const mdb_reserve_history *rh)
+{
+  reserve_history_entry e;
+  e.height = rh->rh_height;
+  e.zeph_reserve = rh->rh_zeph_reserve_hi;
+  e.zeph_reserve = (e.zeph_reserve << 64) | rh->rh_zeph_reserve_lo;
+  e.num_stables = rh->rh_num_stables_hi;
+  e.num_stables = (e.num_stables << 64) | rh->rh_num_stables_lo;
+  e.num_reserves = rh->rh_num_reserves_hi;
+  e.num_reserves = (e.num_reserves << 64) | rh->rh_num_reserves_lo;
+  e.spot = rh->rh_spot;
+  e.moving_average = rh->rh_moving_average;
+  return e;
+}
+
+void add_block_cum_rct(MDB_cursor *cur_block_cum_rct, uint64_t height, uint64_t cum_rct, const oracle::asset_type_counts& cum_rct_by_asset_type)
+{
+  for (uint64_t column = 0; column <= CUM_RCT_TOTAL_COLUMN; ++column)
+  {
+    mdb_cum_rct cr;
+    cr.cr_height = height;
+    cr.cr_cum_rct = column == CUM_RCT_TOTAL_COLUMN ? cum_rct : cum_rct_by_asset_type[static_cast<oracle::asset_id>(column)];
+    MDB_val_set(kc, column);
+    MDB_val_set(vc, cr);
+    if (int result = mdb_cursor_put(cur_block_cum_rct, &kc, &vc, MDB_APPENDDUP))
+      throw0(DB_ERROR(lmdb_error("Failed to add cumulative rct outputs to db transaction: ", result).c_str()));
+  }
+}
+
 void BlockchainLMDB::add_block(const block& blk, size_t block_weight, uint64_t long_term_block_weight, const difficulty_type& cumulative_difficulty, const uint64_t& coins_generated,
     const uint64_t& reserve_reward, uint64_t num_rct_outs, oracle::asset_type_counts& cum_rct_by_asset_type, const crypto::hash& blk_hash)
 {
@@ -887,6 +997,8 @@ void BlockchainLMDB::add_block(const block& blk, size_t block_weight, uint64_t l
   CURSOR(blocks)
   CURSOR(block_info)
   CURSOR(circ_supply_tally)
+  CURSOR(reserve_history)
+  CURSOR(block_cum_rct)
 
   // this call to mdb_cursor_put will change height()
   cryptonote::blobdata block_blob(block_to_blob(blk));
@@ -913,8 +1025,11 @@ void BlockchainLMDB::add_block(const block& blk, size_t block_weight, uint64_t l
         throw1(BLOCK_DNE(lmdb_error("Failed to get block info: ", result).c_str()));
     const mdb_block_info *bi_prev = (const mdb_block_info*)h.mv_data;
     bi.bi_cum_rct += bi_prev->bi_cum_rct;
-    for (auto const& asset_type : oracle::ASSET_TYPES)
-      cum_rct_by_asset_type.add(asset_type, bi_prev->bi_cum_rct_by_asset_type[asset_type]);
+    for (size_t a = 0; a < oracle::NUM_ASSET_TYPES; ++a)
+    {
+      const oracle::asset_id asset = static_cast<oracle::asset_id>(a);
+      cum_rct_by_asset_type.add(asset, bi_prev->bi_cum_rct_by_asset_type[asset]);
+    }
   }
   bi.bi_long_term_block_weight = long_term_block_weight;
   bi.bi_cum_rct_by_asset_type = cum_rct_by_asset_type;
@@ -928,18 +1043,29 @@ void BlockchainLMDB::add_block(const block& blk, size_t block_weight, uint64_t l
   if (result)
     throw0(DB_ERROR(lmdb_error("Failed to add block height by hash to db transaction: ", result).c_str()));
 
+  add_block_cum_rct(m_cur_block_cum_rct, m_height, bi.bi_cum_rct, bi.bi_cum_rct_by_asset_type);
+
   // we use weight as a proxy for size, since we don't have size but weight is >= size
   // and often actually equal
   m_cum_size += block_weight;
   m_cum_count++;
 
-  uint64_t source_currency_type = std::find(oracle::ASSET_TYPES.begin(), oracle::ASSET_TYPES.end(), "ZEPH") - oracle::ASSET_TYPES.begin();
+  uint64_t source_currency_type = static_cast<uint64_t>(oracle::asset_id::ZEPH);
   MDB_val_copy<uint64_t> source_idx(source_currency_type);
   boost::multiprecision::int128_t source_tally = read_circulating_supply_data(m_cur_circ_supply_tally, source_idx);
 
   boost::multiprecision::int128_t final_source_tally;
   final_source_tally = source_tally + reserve_reward; // Add reserve reward ZEPH to reserve
   write_circulating_supply_data(m_cur_circ_supply_tally, source_idx, final_source_tally);
+
+  // the block's txs were added before us, so the tallies now reflect the state after this block
+  circ_supply_snapshot supply;
+  read_circulating_supply_tallies(m_cur_circ_supply_tally, supply);
+  mdb_reserve_history rh = make_reserve_history(m_height, supply, blk.pricing_record);
+  MDB_val_set(val_rh, rh);
+  result = mdb_cursor_put(m_cur_reserve_history, (MDB_val *)&zerokval, &val_rh, MDB_APPENDDUP);
+  if (result)
+    throw0(DB_ERROR(lmdb_error("Failed to add reserve history to db transaction: ", result).c_str()));
 }
 
 void BlockchainLMDB::remove_block(const uint64_t& reserve_reward)
@@ -958,6 +1084,8 @@ void BlockchainLMDB::remove_block(const uint64_t& reserve_reward)
   CURSOR(block_heights)
   CURSOR(blocks)
   CURSOR(circ_supply_tally)
+  CURSOR(reserve_history)
+  CURSOR(block_cum_rct)
   MDB_val_copy<uint64_t> k(m_height - 1);
   MDB_val h = k;
   if ((result = mdb_cursor_get(m_cur_block_info, (MDB_val *)&zerokval, &h, MDB_GET_BOTH)))
@@ -979,8 +1107,24 @@ void BlockchainLMDB::remove_block(const uint64_t& reserve_reward)
   if ((result = mdb_cursor_del(m_cur_block_info, 0)))
       throw1(DB_ERROR(lmdb_error("Failed to add removal of block info to db transaction: ", result).c_str()));
 
+  h = k;
+  if ((result = mdb_cursor_get(m_cur_reserve_history, (MDB_val *)&zerokval, &h, MDB_GET_BOTH)))
+      throw1(DB_ERROR(lmdb_error("Failed to locate reserve history for removal: ", result).c_str()));
+  if ((result = mdb_cursor_del(m_cur_reserve_history, 0)))
+      throw1(DB_ERROR(lmdb_error("Failed to add removal of reserve history to db transaction: ", result).c_str()));
+
+  for (uint64_t column = 0; column <= CUM_RCT_TOTAL_COLUMN; ++column)
+  {
+    MDB_val_set(kc, column);
+    h = k;
+    if ((result = mdb_cursor_get(m_cur_block_cum_rct, &kc, &h, MDB_GET_BOTH)))
+        throw1(DB_ERROR(lmdb_error("Failed to locate cumulative rct outputs for removal: ", result).c_str()));
+    if ((result = mdb_cursor_del(m_cur_block_cum_rct, 0)))
+        throw1(DB_ERROR(lmdb_error("Failed to add removal of cumulative rct outputs to db transaction: ", result).c_str()));
+  }
+
 
-  uint64_t source_currency_type = std::find(oracle::ASSET_TYPES.begin(), oracle::ASSET_TYPES.end(), "ZEPH") - oracle::ASSET_TYPES.begin();
+  uint64_t source_currency_type = static_cast<uint64_t>(oracle::asset_id::ZEPH);
   MDB_val_copy<uint64_t> source_idx(source_currency_type);
   boost::multiprecision::int128_t source_tally = read_circulating_supply_data(m_cur_circ_supply_tally, source_idx);
   boost::multiprecision::int128_t final_source_tally;
@@ -1088,8 +1232,8 @@ uint64_t BlockchainLMDB::add_transaction_data(const crypto::hash& blk_hash, cons
     circ_supply cs;
     cs.tx_hash = tx_hash;
     cs.pricing_record_height = tx.pricing_record_height;
-    cs.source_currency_type = std::find(oracle::ASSET_TYPES.begin(), oracle::ASSET_TYPES.end(), strSource) - oracle::ASSET_TYPES.begin();
-    cs.dest_currency_type = std::find(oracle::ASSET_TYPES.begin(), oracle::ASSET_TYPES.end(), strDest) - oracle::ASSET_TYPES.begin();
+    cs.source_currency_type = static_cast<uint64_t>(oracle::get_asset_id(strSource));
+    cs.dest_currency_type = static_cast<uint64_t>(oracle::get_asset_id(strDest));
     cs.amount_burnt = tx.amount_burnt;
     cs.amount_minted = tx.amount_minted;
 
@@ -1217,8 +1361,8 @@ void BlockchainLMDB::remove_transaction_data(const crypto::hash& tx_hash, const
     cs.pricing_record_height = tx.pricing_record_height;
     cs.amount_burnt = tx.amount_burnt;
     cs.amount_minted = tx.amount_minted;
-    cs.source_currency_type = std::find(oracle::ASSET_TYPES.begin(), oracle::ASSET_TYPES.end(), strSource) - oracle::ASSET_TYPES.begin();
-    cs.dest_currency_type = std::find(oracle::ASSET_TYPES.begin(), oracle::ASSET_TYPES.end(), strDest) - oracle::ASSET_TYPES.begin();
+    cs.source_currency_type = static_cast<uint64_t>(oracle::get_asset_id(strSource));
+    cs.dest_currency_type = static_cast<uint64_t>(oracle::get_asset_id(strDest));
 
     // Update the tally by increasing the amount by how much we've burnt
     MDB_val_copy<uint64_t> source_idx(cs.source_currency_type);
@@ -1359,7 +1503,8 @@ std::pair<uint64_t, uint64_t> BlockchainLMDB::add_output(const crypto::hash& tx_
       throw0(DB_ERROR(lmdb_error("Failed to add output pubkey to db transaction: ", result).c_str()));
 
   
-  MDB_val_copy<const char *> k(output_asset_type.c_str());
+  const uint64_t asset_key = get_output_type_key(output_asset_type);
+  MDB_val_set(k, asset_key);
   MDB_val v;
   
   mdb_size_t num_outputs_of_asset_type = 0;
@@ -1378,7 +1523,7 @@ std::pair<uint64_t, uint64_t> BlockchainLMDB::add_output(const crypto::hash& tx_
   oat.output_id = ok.output_id;
   MDB_val_set(voat, oat);
 
-  MDB_val_copy<const char *> koat(output_asset_type.c_str());
+  MDB_val_set(koat, asset_key);
   if ((result = mdb_cursor_put(m_cur_output_types, &koat, &voat, MDB_APPENDDUP)))
     throw0(DB_ERROR(lmdb_error("Failed to add output type to db transaction: ", result).c_str()));
 
@@ -1465,7 +1610,8 @@ void BlockchainLMDB::remove_output(const uint64_t amount, const uint64_t& out_in
   }
 
 
-  MDB_val_copy<const char *> koat(output_asset_type.c_str());
+  const uint64_t asset_key = get_output_type_key(output_asset_type);
+  MDB_val_set(koat, asset_key);
   MDB_val_set(voat, asset_type_output_id);
   
   result = mdb_cursor_get(m_cur_output_types, &koat, &voat, MDB_GET_BOTH);
@@ -1737,7 +1883,7 @@ void BlockchainLMDB::open(const std::string& filename, const int db_flags)
 
   lmdb_db_open(txn, LMDB_OUTPUT_TXS, MDB_INTEGERKEY | MDB_CREATE | MDB_DUPSORT | MDB_DUPFIXED, m_output_txs, "Failed to open db handle for m_output_txs");
   lmdb_db_open(txn, LMDB_OUTPUT_AMOUNTS, MDB_INTEGERKEY | MDB_DUPSORT | MDB_DUPFIXED | MDB_CREATE, m_output_amounts, "Failed to open db handle for m_output_amounts");
-  lmdb_db_open(txn, LMDB_OUTPUT_TYPES, MDB_DUPSORT | MDB_DUPFIXED | MDB_CREATE, m_output_types, "Failed to open db handle for m_output_types");
+  lmdb_db_open(txn, LMDB_OUTPUT_TYPES, MDB_INTEGERKEY | MDB_DUPSORT | MDB_DUPFIXED | MDB_CREATE, m_output_types, "Failed to open db handle for m_output_types");
 
   lmdb_db_open(txn, LMDB_SPENT_KEYS, MDB_INTEGERKEY | MDB_CREATE | MDB_DUPSORT | MDB_DUPFIXED, m_spent_keys, "Failed to open db handle for m_spent_keys");
 
@@ -1758,6 +1904,8 @@ void BlockchainLMDB::open(const std::string& filename, const int db_flags)
 
   lmdb_db_open(txn, LMDB_CIRC_SUPPLY, MDB_INTEGERKEY | MDB_CREATE, m_circ_supply, "Failed to open db handle for m_circ_supply");
   lmdb_db_open(txn, LMDB_CIRC_SUPPLY_TALLY, MDB_CREATE, m_circ_supply_tally, "Failed to open db handle for m_circ_supply_tally");
+  lmdb_db_open(txn, LMDB_RESERVE_HISTORY, MDB_INTEGERKEY | MDB_CREATE | MDB_DUPSORT | MDB_DUPFIXED, m_reserve_history, "Failed to open db handle for m_reserve_history");
+  lmdb_db_open(txn, LMDB_BLOCK_CUM_RCT, MDB_INTEGERKEY | MDB_CREATE | MDB_DUPSORT | MDB_DUPFIXED, m_block_cum_rct, "Failed to open db handle for m_block_cum_rct");
 
 
   mdb_set_dupsort(txn, m_spent_keys, compare_hash32);
@@ -1765,8 +1913,6 @@ void BlockchainLMDB::open(const std::string& filename, const int db_flags)
   mdb_set_dupsort(txn, m_tx_indices, compare_hash32);
   mdb_set_dupsort(txn, m_output_amounts, compare_uint64);
   mdb_set_dupsort(txn, m_output_txs, compare_uint64);
-  
-  mdb_set_compare(txn, m_output_types, compare_string);
   mdb_set_dupsort(txn, m_output_types, compare_uint64);
 
   mdb_set_dupsort(txn, m_block_info, compare_uint64);
@@ -1782,6 +1928,8 @@ void BlockchainLMDB::open(const std::string& filename, const int db_flags)
 
   mdb_set_compare(txn, m_circ_supply, compare_uint64);
   mdb_set_compare(txn, m_circ_supply_tally, compare_uint64);
+  mdb_set_dupsort(txn, m_reserve_history, compare_uint64);
+  mdb_set_dupsort(txn, m_block_cum_rct, compare_uint64);
 
   if (!(mdb_flags & MDB_RDONLY))
   {
@@ -1950,6 +2098,10 @@ void BlockchainLMDB::reset()
     throw0(DB_ERROR(lmdb_error("Failed to drop m_output_types: ", result).c_str()));
   if (auto result = mdb_drop(txn, m_spent_keys, 0))
     throw0(DB_ERROR(lmdb_error("Failed to drop m_spent_keys: ", result).c_str()));
+  if (auto result = mdb_drop(txn, m_reserve_history, 0))
+    throw0(DB_ERROR(lmdb_error("Failed to drop m_reserve_history: ", result).c_str()));
+  if (auto result = mdb_drop(txn, m_block_cum_rct, 0))
+    throw0(DB_ERROR(lmdb_error("Failed to drop m_block_cum_rct: ", result).c_str()));
   (void)mdb_drop(txn, m_hf_starting_heights, 0); // this one is dropped in new code
   if (auto result = mdb_drop(txn, m_hf_versions, 0))
     throw0(DB_ERROR(lmdb_error("Failed to drop m_hf_versions: ", result).c_str()));
@@ -2820,7 +2972,7 @@ std::pair<std::vector<uint64_t>, uint64_t> BlockchainLMDB::get_block_cumulative_
   res.reserve(heights.size());
 
   TXN_PREFIX_RDONLY();
-  RCURSOR(block_info);
+  RCURSOR(block_cum_rct);
 
   MDB_stat db_stats;
   if ((result = mdb_stat(m_txn, m_blocks, &db_stats)))
@@ -2831,43 +2983,62 @@ std::pair<std::vector<uint64_t>, uint64_t> BlockchainLMDB::get_block_cumulative_
 
   MDB_val v;
 
-  uint64_t prev_height = heights[0];
-  uint64_t range_begin = 0, range_end = 0;
-  for (uint64_t height: heights)
+  const oracle::asset_id asset = oracle::get_asset_id(asset_type);
+  if (!oracle::is_valid_asset_id(asset))
   {
-    if (height >= range_begin && height < range_end)
-    {
-      // nohting to do
-    }
-    else
+    // unknown assets have no outputs
+    res.resize(heights.size(), 0);
+  }
+  else
+  {
+    uint64_t column = static_cast<uint64_t>(asset);
+    MDB_val_set(k, column);
+    uint64_t prev_height = heights[0];
+    uint64_t range_begin = 0, range_end = 0;
+    for (uint64_t height: heights)
     {
-      if (height == prev_height + 1)
+      if (height >= range_begin && height < range_end)
       {
-        MDB_val k2;
-        result = mdb_cursor_get(m_cur_block_info, &k2, &v, MDB_NEXT_MULTIPLE);
-        range_begin = ((const mdb_block_info*)v.mv_data)->bi_height;
-        range_end = range_begin + v.mv_size / sizeof(mdb_block_info); // whole records please
-        if (height < range_begin || height >= range_end)
-          throw0(DB_ERROR(("Height " + std::to_string(height) + " not included in multuple record range: " + std::to_string(range_begin) + "-" + std::to_string(range_end)).c_str()));
+        // nohting to do
       }
       else
       {
-        v.mv_size = sizeof(uint64_t);
-        v.mv_data = (void*)&height;
-        result = mdb_cursor_get(m_cur_block_info, (MDB_val *)&zerokval, &v, MDB_GET_BOTH);
-        range_begin = height;
-        range_end = range_begin + 1;
+        if (height == prev_height + 1)
+        {
+          MDB_val k2;
+          result = mdb_cursor_get(m_cur_block_cum_rct, &k2, &v, MDB_NEXT_MULTIPLE);
+          range_begin = ((const mdb_cum_rct*)v.mv_data)->cr_height;
+          range_end = range_begin + v.mv_size / sizeof(mdb_cum_rct); // whole records please
+          if (height < range_begin || height >= range_end)
+            throw0(DB_ERROR(("Height " + std::to_string(height) + " not included in multuple record range: " + std::to_string(range_begin) + "-" + std::to_string(range_end)).c_str()));
+        }
+        else
+        {
+          v.mv_size = sizeof(uint64_t);
+          v.mv_data = (void*)&height;
+          result = mdb_cursor_get(m_cur_block_cum_rct, &k, &v, MDB_GET_BOTH);
+          range_begin = height;
+          range_end = range_begin + 1;
+        }
+        if (result)
+          throw0(DB_ERROR(lmdb_error("Error attempting to retrieve rct distribution from the db: ", result).c_str()));
       }
-      if (result)
-        throw0(DB_ERROR(lmdb_error("Error attempting to retrieve rct distribution from the db: ", result).c_str()));
-    }
-    const mdb_block_info *bi = ((const mdb_block_info *)v.mv_data) + (height - range_begin);
+      const mdb_cum_rct *cr = ((const mdb_cum_rct *)v.mv_data) + (height - range_begin);
+      res.push_back(cr->cr_cum_rct);
 
-    res.push_back(bi->bi_cum_rct_by_asset_type[asset_type]);
-    if (height == heights[heights.size() - CRYPTONOTE_DEFAULT_TX_SPENDABLE_AGE])
-      num_spendable_global_outs = bi->bi_cum_rct;
+      prev_height = height;
+    }
+  }
 
-    prev_height = height;
+  if (heights.size() >= CRYPTONOTE_DEFAULT_TX_SPENDABLE_AGE)
+  {
+    uint64_t column = CUM_RCT_TOTAL_COLUMN;
+    uint64_t height = heights[heights.size() - CRYPTONOTE_DEFAULT_TX_SPENDABLE_AGE];
+    MDB_val_set(k, column);
+    MDB_val_set(vs, height);
+    if ((result = mdb_cursor_get(m_cur_block_cum_rct, &k, &vs, MDB_GET_BOTH)))
+      throw0(DB_ERROR(lmdb_error("Error attempting to retrieve the number of spendable outputs from the db: ", result).c_str()));
+    num_spendable_global_outs = ((const mdb_cum_rct *)vs.mv_data)->cr_cum_rct;
   }
 
   TXN_POSTFIX_RDONLY();
@@ -2966,6 +3137,60 @@ std::vector<uint64_t> BlockchainLMDB::get_block_info_64bit_fields(uint64_t start
   return ret;
 }
 
+std::vector<oracle::pricing_record> BlockchainLMDB::get_block_pricing_records(uint64_t start_height, size_t count) const
+{
+  LOG_PRINT_L3("BlockchainLMDB::" << __func__);
+  check_open();
+
+  TXN_PREFIX_RDONLY();
+  RCURSOR(block_info);
+
+  const uint64_t h = height();
+  if (start_height >= h)
+    throw0(DB_ERROR(("Height " + std::to_string(start_height) + " not in blockchain").c_str()));
+
+  std::vector<oracle::pricing_record> ret;
+  ret.reserve(std::min<uint64_t>(count, h - start_height));
+
+  MDB_val v;
+  uint64_t range_begin = 0, range_end = 0;
+  for (uint64_t height = start_height; height < h && count--; ++height)
+  {
+    if (height >= range_begin && height < range_end)
+    {
+      // nothing to do
+    }
+    else
+    {
+      int result = 0;
+      if (range_end > 0)
+      {
+        MDB_val k2;
+        result = mdb_cursor_get(m_cur_block_info, &k2, &v, MDB_NEXT_MULTIPLE);
+        range_begin = ((const mdb_block_info*)v.mv_data)->bi_height;
+        range_end = range_begin + v.mv_size / sizeof(mdb_block_info); // whole records please
+        if (height < range_begin || height >= range_end)
+          throw0(DB_ERROR(("Height " + std::to_string(height) + " not included in multiple record range: " + std::to_string(range_begin) + "-" + std::to_string(range_end)).c_str()));
+      }
+      else
+      {
+        v.mv_size = sizeof(uint64_t);
+        v.mv_data = (void*)&height;
+        result = mdb_cursor_get(m_cur_block_info, (MDB_val *)&zerokval, &v, MDB_GET_BOTH);
+        range_begin = height;
+        range_end = range_begin + 1;
+      }
+      if (result)
+        throw0(DB_ERROR(lmdb_error("Error attempting to retrieve block_info from the db: ", result).c_str()));
+    }
+    const mdb_block_info *bi = ((const mdb_block_info *)v.mv_data) + (height - range_begin);
+    ret.push_back(bi->bi_pricing_record);
+  }
+
+  TXN_POSTFIX_RDONLY();
+  return ret;
+}
+
 uint64_t BlockchainLMDB::get_max_block_size()
 {
   LOG_PRINT_L3("BlockchainLMDB::" << __func__);
@@ -3249,52 +3474,73 @@ uint64_t BlockchainLMDB::height() const
   return db_stats.ms_entries;
 }
 
-std::vector<std::pair<std::string, std::string>> BlockchainLMDB::get_circulating_supply() const
+circ_supply_snapshot BlockchainLMDB::get_circulating_supply() const
 {
   LOG_PRINT_L3("BlockchainLMDB::" << __func__);
-  std::vector<std::pair<std::string, std::string>> circulating_supply;
-  uint64_t m_height = height();
-  if (m_height == 0) {
+  check_open();
+
+  TXN_PREFIX_RDONLY();
+  RCURSOR(circ_supply_tally);
+
+  circ_supply_snapshot circulating_supply;
+  circulating_supply.height = height();
+  if (circulating_supply.height == 0)
     return circulating_supply;
-  }
+  circulating_supply.top_hash = get_block_hash_from_height(circulating_supply.height - 1);
 
-  uint64_t m_coinbase = get_block_already_generated_coins(m_height-1);
-  LOG_PRINT_L3("BlockchainLMDB::" << __func__ << " - mined supply for ZEPH = " << m_coinbase);
+  read_circulating_supply_tallies(m_cur_circ_supply_tally, circulating_supply);
+
+  TXN_POSTFIX_RDONLY();
+
+  return circulating_supply;
+}
+
+std::vector<reserve_history_entry> BlockchainLMDB::get_reserve_history(uint64_t start_height, uint64_t end_height, uint64_t stride) const
+{
+  LOG_PRINT_L3("BlockchainLMDB::" << __func__);
   check_open();
-  
+
+  if (stride == 0)
+    throw0(DB_ERROR("Reserve history stride must be non zero"));
+
   TXN_PREFIX_RDONLY();
-  RCURSOR(circ_supply_tally);
+  RCURSOR(reserve_history);
 
-  MDB_val k;
-  MDB_val v;
-  int result = 0;
+  std::vector<reserve_history_entry> ret;
+  const uint64_t h = height();
+  if (start_height >= h || end_height < start_height)
+    return ret;
+  end_height = std::min(end_height, h - 1);
+  ret.reserve((end_height - start_height) / stride + 1);
 
-  MDB_cursor_op op = MDB_FIRST;
-  while (1)
+  MDB_val v;
+  for (uint64_t height = start_height; height <= end_height; height += stride)
   {
-    int result = mdb_cursor_get(m_cur_circ_supply_tally, &k, &v, op);
-    op = MDB_NEXT;
-    if (result == MDB_NOTFOUND)
-      break;
+    int result;
+    if (stride == 1 && height > start_height)
+    {
+      MDB_val k;
+      result = mdb_cursor_get(m_cur_reserve_history, &k, &v, MDB_NEXT_DUP);
+    }
+    else
+    {
+      v.mv_size = sizeof(uint64_t);
+      v.mv_data = (void*)&height;
+      result = mdb_cursor_get(m_cur_reserve_history, (MDB_val *)&zerokval, &v, MDB_GET_BOTH);
+    }
     if (result)
-      throw0(DB_ERROR(lmdb_error("Failed to get circulating supply: ", result).c_str()));
-
-    // Push the data into the circulating supply return struct
-    const uint64_t currency_type = *(const uint64_t*)k.mv_data;
-    circ_supply_tally *cst = (circ_supply_tally*)v.mv_data;
-    const std::string currency_label = oracle::ASSET_TYPES.at(currency_type);
-    boost::multiprecision::int128_t amount = import_tally_from_cst(cst);
-
-    circulating_supply.emplace_back(std::pair<std::string, std::string>{currency_label, amount.str()});
+      throw0(DB_ERROR(lmdb_error("Error attempting to retrieve reserve history from the db: ", result).c_str()));
+    const mdb_reserve_history *rh = (const mdb_reserve_history*)v.mv_data;
+    if (rh->rh_height != height)
+      throw0(DB_ERROR(("Unexpected reserve history height " + std::to_string(rh->rh_height) + ", expected " + std::to_string(height)).c_str()));
+    ret.push_back(import_reserve_history(rh));
+    if (end_height - height < stride)
+      break;
   }
 
   TXN_POSTFIX_RDONLY();
 
-  // NEAC: check for empty supply tally - only happens prior to first conversion on chain
-  if (circulating_supply.empty()) {
-    circulating_supply.emplace_back(std::pair<std::string, std::string>{"ZEPH",  std::to_string(0)});
-  }
-  return circulating_supply;
+  return ret;
 }
 
 uint64_t BlockchainLMDB::num_outputs() const
@@ -3762,7 +4008,8 @@ uint64_t BlockchainLMDB::get_num_outputs_of_asset_type(const std::string asset_t
   TXN_PREFIX_RDONLY();
   RCURSOR(output_types);
 
-  MDB_val_copy<const char *> k(asset_type.c_str());
+  const uint64_t asset_key = get_output_type_key(asset_type);
+  MDB_val_set(k, asset_key);
   MDB_val v;
   mdb_size_t num_outputs_of_asset_type = 0;
   auto result = mdb_cursor_get(m_cur_output_types, &k, &v, MDB_SET);
@@ -3825,7 +4072,8 @@ void BlockchainLMDB::get_output_id_from_asset_type_output_index(const std::strin
 
   RCURSOR(output_types);
 
-  MDB_val_copy<const char *> k_type(asset_type.c_str());
+  const uint64_t asset_key = get_output_type_key(asset_type);
+  MDB_val_set(k_type, asset_key);
 
   for (size_t i = 0; i < asset_type_output_indices.size(); ++i)
   {
@@ -3854,7 +4102,8 @@ uint64_t BlockchainLMDB::get_output_id_from_asset_type_output_index(const std::s
   TXN_PREFIX_RDONLY();
   RCURSOR(output_types);
 
-  MDB_val_copy<const char *> k_type(asset_type.c_str());
+  const uint64_t asset_key = get_output_type_key(asset_type);
+  MDB_val_set(k_type, asset_key);
   MDB_val_set(v, asset_type_output_index);
 
   auto get_result = mdb_cursor_get(m_cur_output_types, &k_type, &v, MDB_GET_BOTH);
@@ -5114,10 +5363,414 @@ void BlockchainLMDB::migrate_1_2()
   txn.commit();
 }
 
+void BlockchainLMDB::migrate_2_3()
+{
+  LOG_PRINT_L3("BlockchainLMDB::" << __func__);
+  uint64_t i;
+  int result;
+  mdb_txn_safe txn(false);
+  MDB_val k, v;
+
+  MGINFO_YELLOW("Migrating blockchain from DB version 2 to 3 - this may take a while:");
+
+  do {
+    LOG_PRINT_L1("populating reserve history and block_info pricing records:");
+
+    result = mdb_txn_begin(m_env, NULL, 0, txn);
+    if (result)
+      throw0(DB_ERROR(lmdb_error("Failed to create a transaction for the db: ", result).c_str()));
+
+    MDB_stat db_stats;
+    if ((result = mdb_stat(txn, m_blocks, &db_stats)))
+      throw0(DB_ERROR(lmdb_error("Failed to query m_blocks: ", result).c_str()));
+    const uint64_t blockchain_height = db_stats.ms_entries;
+
+    // the tallies are replayed from the circ_supply records, the same way
+    // add_transaction_data and add_block build them up
+    std::array<boost::multiprecision::int128_t, circ_supply_snapshot::NUM_ASSETS> tally;
+    tally.fill(0);
+
+    MDB_cursor *c_blocks, *c_block_info, *c_tx_indices, *c_circ_supply, *c_reserve_history;
+    uint64_t next_tx_id = 0;
+    bool have_pending = false;
+    circ_supply pending_cs;
+    uint64_t pending_tx_id = 0, pending_block_id = 0;
+    i = 0;
+    while(1) {
+      if (!(i % 1000)) {
+        if (i) {
+          LOGIF(el::Level::Info) {
+            std::cout << i << " / " << blockchain_height << "  \r" << std::flush;
+          }
+          txn.commit();
+          result = mdb_txn_begin(m_env, NULL, 0, txn);
+          if (result)
+            throw0(DB_ERROR(lmdb_error("Failed to create a transaction for the db: ", result).c_str()));
+        }
+        result = mdb_cursor_open(txn, m_blocks, &c_blocks);
+        if (result)
+          throw0(DB_ERROR(lmdb_error("Failed to open a cursor for blocks: ", result).c_str()));
+        result = mdb_cursor_open(txn, m_block_info, &c_block_info);
+        if (result)
+          throw0(DB_ERROR(lmdb_error("Failed to open a cursor for block_info: ", result).c_str()));
+        result = mdb_cursor_open(txn, m_tx_indices, &c_tx_indices);
+        if (result)
+          throw0(DB_ERROR(lmdb_error("Failed to open a cursor for tx_indices: ", result).c_str()));
+        result = mdb_cursor_open(txn, m_circ_supply, &c_circ_supply);
+        if (result)
+          throw0(DB_ERROR(lmdb_error("Failed to open a cursor for circ_supply: ", result).c_str()));
+        result = mdb_cursor_open(txn, m_reserve_history, &c_reserve_history);
+        if (result)
+          throw0(DB_ERROR(lmdb_error("Failed to open a cursor for reserve_history: ", result).c_str()));
+        if (!i) {
+          // resume an interrupted migration from the last entry written
+          result = mdb_cursor_get(c_reserve_history, &k, &v, MDB_LAST);
+          if (result == 0) {
+            const reserve_history_entry last = import_reserve_history((const mdb_reserve_history*)v.mv_data);
+            tally[circ_supply_snapshot::ZEPH] = last.zeph_reserve;
+            tally[circ_supply_snapshot::ZEPHUSD] = last.num_stables;
+            tally[circ_supply_snapshot::ZEPHRSV] = last.num_reserves;
+            i = last.height + 1;
+          }
+          else if (result != MDB_NOTFOUND)
+            throw0(DB_ERROR(lmdb_error("Failed to get a record from reserve_history: ", result).c_str()));
+        }
+      }
+      if (i >= blockchain_height) {
+        // the replay has to end at the running tallies, a history which
+        // does not is dropped rather than kept
+        MDB_cursor *c_circ_supply_tally;
+        result = mdb_cursor_open(txn, m_circ_supply_tally, &c_circ_supply_tally);
+        if (result)
+          throw0(DB_ERROR(lmdb_error("Failed to open a cursor for circ_supply_tally: ", result).c_str()));
+        circ_supply_snapshot current;
+        read_circulating_supply_tallies(c_circ_supply_tally, current);
+        for (size_t a = 0; a < current.tally.size(); ++a) {
+          if (boost::multiprecision::int128_t(current.tally[a]) != tally[a]) {
+            MERROR("Reserve history for " << oracle::ASSET_TYPES[a] << " ends at " << tally[a].str() << ", but the supply tally is " << current.tally[a].str());
+            txn.abort();
+            result = mdb_txn_begin(m_env, NULL, 0, txn);
+            if (result)
+              throw0(DB_ERROR(lmdb_error("Failed to create a transaction for the db: ", result).c_str()));
+            result = mdb_drop(txn, m_reserve_history, 0);
+            if (result)
+              throw0(DB_ERROR(lmdb_error("Failed to drop m_reserve_history: ", result).c_str()));
+            txn.commit();
+            throw0(DB_ERROR("Reserve history does not match the circulating supply tallies"));
+          }
+        }
+        txn.commit();
+        break;
+      }
+
+      MDB_val_set(kh, i);
+      result = mdb_cursor_get(c_blocks, &kh, &v, MDB_SET);
+      if (result)
+        throw0(DB_ERROR(lmdb_error("Failed to get a record from blocks: ", result).c_str()));
+      block b;
+      if (!parse_and_validate_block_from_blob(cryptonote::blobdata((const char*)v.mv_data, v.mv_size), b))
+        throw0(DB_ERROR("Failed to parse block from blob retrieved from the db"));
+
+      // block_info records converted by migrate_1_2 carry an empty pricing record,
+      // restore it so pricing records can be read without parsing blocks
+      MDB_val_copy<uint64_t> kbi(i);
+      MDB_val vbi = kbi;
+      result = mdb_cursor_get(c_block_info, (MDB_val *)&zerokval, &vbi, MDB_GET_BOTH);
+      if (result)
+        throw0(DB_ERROR(lmdb_error("Failed to get a record from block_info: ", result).c_str()));
+      const uint64_t coins = ((const mdb_block_info*)vbi.mv_data)->bi_coins;
+      if (((const mdb_block_info*)vbi.mv_data)->bi_pricing_record != b.pricing_record) {
+        mdb_block_info bi = *(const mdb_block_info*)vbi.mv_data;
+        bi.bi_pricing_record = b.pricing_record;
+        MDB_val_set(nbi, bi);
+        result = mdb_cursor_put(c_block_info, (MDB_val *)&zerokval, &nbi, MDB_CURRENT);
+        if (result)
+          throw0(DB_ERROR(lmdb_error("Failed to update a record in block_info: ", result).c_str()));
+      }
+
+      // apply this block's conversions
+      while (1) {
+        if (!have_pending) {
+          MDB_val_set(ktx, next_tx_id);
+          result = mdb_cursor_get(c_circ_supply, &ktx, &v, MDB_SET_RANGE);
+          if (result == MDB_NOTFOUND)
+            break;
+          if (result)
+            throw0(DB_ERROR(lmdb_error("Failed to get a record from circ_supply: ", result).c_str()));
+          pending_tx_id = *(const uint64_t*)ktx.mv_data;
+          pending_cs = *(const circ_supply*)v.mv_data;
+          MDB_val_set(vti, pending_cs.tx_hash);
+          result = mdb_cursor_get(c_tx_indices, (MDB_val *)&zerokval, &vti, MDB_GET_BOTH);
+          if (result)
+            throw0(DB_ERROR(lmdb_error("Failed to get tx index for circ_supply record: ", result).c_str()));
+          pending_block_id = ((const txindex*)vti.mv_data)->data.block_id;
+          have_pending = true;
+        }
+        if (pending_block_id > i)
+          break;
+        have_pending = false;
+        next_tx_id = pending_tx_id + 1;
+        if (pending_block_id < i)
+          continue; // already accounted for when resuming
+
+        if (pending_cs.source_currency_type >= circ_supply_snapshot::NUM_ASSETS || pending_cs.dest_currency_type >= circ_supply_snapshot::NUM_ASSETS)
+          throw0(DB_ERROR("Unknown currency type in circ_supply record"));
+        boost::multiprecision::int128_t &source_tally = tally[pending_cs.source_currency_type];
+        if (pending_cs.source_currency_type == circ_supply_snapshot::ZEPH)
+          source_tally += pending_cs.amount_burnt;
+        else if ((source_tally -= pending_cs.amount_burnt) < 0)
+          source_tally = 0;
+        boost::multiprecision::int128_t &dest_tally = tally[pending_cs.dest_currency_type];
+        if (pending_cs.dest_currency_type == circ_supply_snapshot::ZEPH) {
+          if ((dest_tally -= pending_cs.amount_minted) < 0)
+            dest_tally = 0;
+        }
+        else
+          dest_tally += pending_cs.amount_minted;
+      }
+
+      // the reward actually emitted, after any block weight penalty, is
+      // what the generated coins grew by
+      if (b.major_version >= HF_VERSION_DJED) {
+        uint64_t prev_coins = 0;
+        if (i > 0) {
+          MDB_val_copy<uint64_t> kprev(i - 1);
+          MDB_val vprev = kprev;
+          result = mdb_cursor_get(c_block_info, (MDB_val *)&zerokval, &vprev, MDB_GET_BOTH);
+          if (result)
+            throw0(DB_ERROR(lmdb_error("Failed to get a record from block_info: ", result).c_str()));
+          prev_coins = ((const mdb_block_info*)vprev.mv_data)->bi_coins;
+        }
+        if (coins < prev_coins)
+          throw0(DB_ERROR("Generated coins decrease in block_info"));
+        tally[circ_supply_snapshot::ZEPH] += get_reserve_reward(coins - prev_coins);
+      }
+
+      circ_supply_snapshot supply;
+      for (size_t a = 0; a < supply.tally.size(); ++a)
+        supply.tally[a] = boost::multiprecision::uint128_t(tally[a]);
+      mdb_reserve_history rh = make_reserve_history(i, supply, b.pricing_record);
+      MDB_val_set(nv, rh);
+      result = mdb_cursor_put(c_reserve_history, (MDB_val *)&zerokval, &nv, MDB_APPENDDUP);
+      if (result)
+        throw0(DB_ERROR(lmdb_error("Failed to put a record into reserve_history: ", result).c_str()));
+      i++;
+    }
+  } while(0);
+
+  uint32_t version = 3;
+  v.mv_data = (void *)&version;
+  v.mv_size = sizeof(version);
+  MDB_val_str(vk, "version");
+  result = mdb_txn_begin(m_env, NULL, 0, txn);
+  if (result)
+    throw0(DB_ERROR(lmdb_error("Failed to create a transaction for the db: ", result).c_str()));
+  result = mdb_put(txn, m_properties, &vk, &v, 0);
+  if (result)
+    throw0(DB_ERROR(lmdb_error("Failed to update version for the db: ", result).c_str()));
+  txn.commit();
+}
+
+void BlockchainLMDB::migrate_3_4()
+{
+  LOG_PRINT_L3("BlockchainLMDB::" << __func__);
+  uint64_t i;
+  int result;
+  mdb_txn_safe txn(false);
+  MDB_val k, v;
+
+  MGINFO_YELLOW("Migrating blockchain from DB version 3 to 4 - this may take a while:");
+
+  do {
+    LOG_PRINT_L1("migrating output types:");
+
+    result = mdb_txn_begin(m_env, NULL, 0, txn);
+    if (result)
+      throw0(DB_ERROR(lmdb_error("Failed to create a transaction for the db: ", result).c_str()));
+
+    /* the old table is keyed by the asset type string, the new one by the
+     * numeric asset id. They use different key comparators, so the old table
+     * keeps its own name and is dropped once all records have been moved.
+     */
+    MDB_dbi o_output_types;
+    lmdb_db_open(txn, "output_types", MDB_DUPSORT | MDB_DUPFIXED | MDB_CREATE, o_output_types, "Failed to open db handle for output_types");
+    mdb_set_compare(txn, o_output_types, compare_string);
+    mdb_set_dupsort(txn, o_output_types, compare_uint64);
+
+    MDB_stat db_stats;
+    if ((result = mdb_stat(txn, o_output_types, &db_stats)))
+      throw0(DB_ERROR(lmdb_error("Failed to query output_types: ", result).c_str()));
+    const uint64_t num_outputs = db_stats.ms_entries;
+
+    MDB_cursor *c_old, *c_cur;
+    i = 0;
+    while(1) {
+      if (!(i % 1000)) {
+        if (i) {
+          LOGIF(el::Level::Info) {
+            std::cout << i << " / " << num_outputs << "  \r" << std::flush;
+          }
+          txn.commit();
+          result = mdb_txn_begin(m_env, NULL, 0, txn);
+          if (result)
+            throw0(DB_ERROR(lmdb_error("Failed to create a transaction for the db: ", result).c_str()));
+        }
+        result = mdb_cursor_open(txn, m_output_types, &c_cur);
+        if (result)
+          throw0(DB_ERROR(lmdb_error("Failed to open a cursor for output_type_ids: ", result).c_str()));
+        result = mdb_cursor_open(txn, o_output_types, &c_old);
+        if (result)
+          throw0(DB_ERROR(lmdb_error("Failed to open a cursor for output_types: ", result).c_str()));
+      }
+      result = mdb_cursor_get(c_old, &k, &v, MDB_NEXT);
+      if (result == MDB_NOTFOUND) {
+        txn.commit();
+        break;
+      }
+      else if (result)
+        throw0(DB_ERROR(lmdb_error("Failed to get a record from output_types: ", result).c_str()));
+
+      const std::string asset_type((const char*)k.mv_data, strnlen((const char*)k.mv_data, k.mv_size));
+      const uint64_t asset_key = get_output_type_key(asset_type);
+      MDB_val_set(nk, asset_key);
+      result = mdb_cursor_put(c_cur, &nk, &v, 0);
+      if (result)
+        throw0(DB_ERROR(lmdb_error("Failed to put a record into output_type_ids: ", result).c_str()));
+      /* we delete the old records immediately, so the overall DB and mapsize should not grow. */
+      result = mdb_cursor_del(c_old, 0);
+      if (result)
+        throw0(DB_ERROR(lmdb_error("Failed to delete a record from output_types: ", result).c_str()));
+      i++;
+    }
+
+    result = mdb_txn_begin(m_env, NULL, 0, txn);
+    if (result)
+      throw0(DB_ERROR(lmdb_error("Failed to create a transaction for the db: ", result).c_str()));
+    /* Delete the old table */
+    result = mdb_drop(txn, o_output_types, 1);
+    if (result)
+      throw0(DB_ERROR(lmdb_error("Failed to delete old output_types table: ", result).c_str()));
+    txn.commit();
+  } while(0);
+
+  uint32_t version = 4;
+  v.mv_data = (void *)&version;
+  v.mv_size = sizeof(version);
+  MDB_val_str(vk, "version");
+  result = mdb_txn_begin(m_env, NULL, 0, txn);
+  if (result)
+    throw0(DB_ERROR(lmdb_error("Failed to create a transaction for the db: ", result).c_str()));
+  result = mdb_put(txn, m_properties, &vk, &v, 0);
+  if (result)
+    throw0(DB_ERROR(lmdb_error("Failed to update version for the db: ", result).c_str()));
+  txn.commit();
+}
+
+void BlockchainLMDB::migrate_4_5()
+{
+  LOG_PRINT_L3("BlockchainLMDB::" << __func__);
+  uint64_t i;
+  int result;
+  mdb_txn_safe txn(false);
+  MDB_val k, v;
+
+  MGINFO_YELLOW("Migrating blockchain from DB version 4 to 5 - this may take a while:");
+
+  do {
+    LOG_PRINT_L1("building cumulative rct output columns:");
+
+    result = mdb_txn_begin(m_env, NULL, 0, txn);
+    if (result)
+      throw0(DB_ERROR(lmdb_error("Failed to create a transaction for the db: ", result).c_str()));
+
+    MDB_stat db_stats;
+    if ((result = mdb_stat(txn, m_blocks, &db_stats)))
+      throw0(DB_ERROR(lmdb_error("Failed to query m_blocks: ", result).c_str()));
+    const uint64_t blockchain_height = db_stats.ms_entries;
+
+    MDB_cursor *c_block_info, *c_cum_rct;
+    i = 0;
+    while(1) {
+      if (!(i % 1000)) {
+        if (i) {
+          LOGIF(el::Level::Info) {
+            std::cout << i << " / " << blockchain_height << "  \r" << std::flush;
+          }
+          txn.commit();
+          result = mdb_txn_begin(m_env, NULL, 0, txn);
+          if (result)
+            throw0(DB_ERROR(lmdb_error("Failed to create a transaction for the db: ", result).c_str()));
+        }
+        result = mdb_cursor_open(txn, m_block_cum_rct, &c_cum_rct);
+        if (result)
+          throw0(DB_ERROR(lmdb_error("Failed to open a cursor for block_cum_rct: ", result).c_str()));
+        result = mdb_cursor_open(txn, m_block_info, &c_block_info);
+        if (result)
+          throw0(DB_ERROR(lmdb_error("Failed to open a cursor for block_info: ", result).c_str()));
+        if (!i) {
+          // resume after the last block of an interrupted migration, the
+          // total column is written last for each block
+          uint64_t column = CUM_RCT_TOTAL_COLUMN;
+          MDB_val_set(kc, column);
+          mdb_size_t done = 0;
+          result = mdb_cursor_get(c_cum_rct, &kc, &v, MDB_SET);
+          if (!result)
+            result = mdb_cursor_count(c_cum_rct, &done);
+          if (result && result != MDB_NOTFOUND)
+            throw0(DB_ERROR(lmdb_error("Failed to query block_cum_rct: ", result).c_str()));
+          i = done;
+        }
+        if (i >= blockchain_height) {
+          txn.commit();
+          break;
+        }
+        MDB_val_set(h, i);
+        result = mdb_cursor_get(c_block_info, (MDB_val *)&zerokval, &h, MDB_GET_BOTH);
+        if (result)
+          throw0(DB_ERROR(lmdb_error("Failed to get a record from block_info: ", result).c_str()));
+      }
+      else {
+        result = mdb_cursor_get(c_block_info, &k, &v, MDB_NEXT_DUP);
+        if (result == MDB_NOTFOUND) {
+          txn.commit();
+          break;
+        }
+        else if (result)
+          throw0(DB_ERROR(lmdb_error("Failed to get a record from block_info: ", result).c_str()));
+      }
+      MDB_val bv;
+      result = mdb_cursor_get(c_block_info, &k, &bv, MDB_GET_CURRENT);
+      if (result)
+        throw0(DB_ERROR(lmdb_error("Failed to get a record from block_info: ", result).c_str()));
+      const mdb_block_info *bi = (const mdb_block_info*)bv.mv_data;
+      add_block_cum_rct(c_cum_rct, bi->bi_height, bi->bi_cum_rct, bi->bi_cum_rct_by_asset_type);
+      i++;
+    }
+  } while(0);
+
+  uint32_t version = 5;
+  v.mv_data = (void *)&version;
+  v.mv_size = sizeof(version);
+  MDB_val_str(vk, "version");
+  result = mdb_txn_begin(m_env, NULL, 0, txn);
+  if (result)
+    throw0(DB_ERROR(lmdb_error("Failed to create a transaction for the db: ", result).c_str()));
+  result = mdb_put(txn, m_properties, &vk, &v, 0);
+  if (result)
+    throw0(DB_ERROR(lmdb_error("Failed to update version for the db: ", result).c_str()));
+  txn.commit();
+}
+
 void BlockchainLMDB::migrate(const uint32_t oldversion)
 {
   if (oldversion < 2)
     migrate_1_2();
+  if (oldversion < 3)
+    migrate_2_3();
+  if (oldversion < 4)
+    migrate_3_4();
+  if (oldversion < 5)
+    migrate_4_5();
 }
 
 }  // namespace cryptonote
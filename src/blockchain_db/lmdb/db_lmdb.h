@@ -77,6 +77,8 @@ typedef struct mdb_txn_cursors
 
   MDB_cursor *m_txc_circ_supply;
   MDB_cursor *m_txc_circ_supply_tally;
+  MDB_cursor *m_txc_reserve_history;
+  MDB_cursor *m_txc_block_cum_rct;
 } mdb_txn_cursors;
 
 #define m_cur_blocks	m_cursors->m_txc_blocks
@@ -101,6 +103,8 @@ typedef struct mdb_txn_cursors
 
 #define m_cur_circ_supply       m_cursors->m_txc_circ_supply
 #define m_cur_circ_supply_tally m_cursors->m_txc_circ_supply_tally
+#define m_cur_reserve_history   m_cursors->m_txc_reserve_history
+#define m_cur_block_cum_rct     m_cursors->m_txc_block_cum_rct
 
 typedef struct mdb_rflags
 {
@@ -126,6 +130,8 @@ typedef struct mdb_rflags
   bool m_rf_properties;
   bool m_rf_circ_supply;
   bool m_rf_circ_supply_tally;
+  bool m_rf_reserve_history;
+  bool m_rf_block_cum_rct;
 } mdb_rflags;
 
 typedef struct mdb_threadinfo
@@ -232,6 +238,8 @@ public:
 
   virtual uint64_t get_block_timestamp(const uint64_t& height) const;
 
+  virtual std::vector<oracle::pricing_record> get_block_pricing_records(uint64_t start_height, size_t count) const;
+
   virtual uint64_t get_top_block_timestamp() const;
 
   virtual size_t get_block_weight(const uint64_t& height) const;
@@ -262,7 +270,9 @@ public:
 
   virtual uint64_t height() const;
 
-  virtual std::vector<std::pair<std::string, std::string>> get_circulating_supply() const;
+  virtual circ_supply_snapshot get_circulating_supply() const;
+
+  virtual std::vector<reserve_history_entry> get_reserve_history(uint64_t start_height, uint64_t end_height, uint64_t stride) const;
 
   virtual bool tx_exists(const crypto::hash& h) const;
   virtual bool tx_exists(const crypto::hash& h, uint64_t& tx_index) const;
@@ -496,6 +506,8 @@ private:
 
   MDB_dbi m_circ_supply;
   MDB_dbi m_circ_supply_tally;
+  MDB_dbi m_reserve_history;
+  MDB_dbi m_block_cum_rct;
 
   mutable uint64_t m_cum_size;	// used in batch size estimation
   mutable unsigned int m_cum_count;
@@ -33,6 +33,8 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <mutex>
+#include <unordered_map>
 
 #include "blockchain_db.h"
 
@@ -77,6 +79,7 @@ public:
   virtual cryptonote::block_header get_block_header(const crypto::hash& h) const override { return cryptonote::block_header(); }
   virtual uint64_t get_block_timestamp(const uint64_t& height) const override { return 0; }
   virtual std::pair<std::vector<uint64_t>, uint64_t> get_block_cumulative_rct_outputs(const std::vector<uint64_t> &heights, const std::string asset_type) const override { return std::pair<std::vector<uint64_t>, uint64_t>(); }
+  virtual std::vector<oracle::pricing_record> get_block_pricing_records(uint64_t start_height, size_t count) const override { return {}; }
   virtual uint64_t get_top_block_timestamp() const override { return 0; }
   virtual size_t get_block_weight(const uint64_t& height) const override { return 128; }
   virtual std::vector<uint64_t> get_block_weights(uint64_t start_height, size_t count) const override { return {}; }
@@ -171,9 +174,121 @@ public:
   virtual void drop_alt_blocks() override {}
   virtual bool for_all_alt_blocks(std::function<bool(const crypto::hash &blkid, const alt_block_data_t &data, const cryptonote::blobdata_ref *blob)> f, bool include_blob = false) const override { return true; }
 
-  virtual std::vector<std::pair<std::string, std::string>> get_circulating_supply() const override { return std::vector<std::pair<std::string, std::string>>(); }
+  virtual cryptonote::circ_supply_snapshot get_circulating_supply() const override { return cryptonote::circ_supply_snapshot(); }
+  virtual std::vector<cryptonote::reserve_history_entry> get_reserve_history(uint64_t start_height, uint64_t end_height, uint64_t stride) const override { return {}; }
   virtual void get_output_id_from_asset_type_output_index(const std::string asset_type, const std::vector<uint64_t> &asset_type_output_indices, std::vector<uint64_t> &output_indices) const override { }
   virtual uint64_t get_output_id_from_asset_type_output_index(const std::string asset_type, const uint64_t &asset_type_output_index) const override { return 0; };
 };
 
+/**
+ * Test DB keeping the txpool, the block pricing records and the circulating
+ * supply in memory, enough for a tx_memory_pool to run against it. The
+ * chain height and pricing records are set by the test.
+ */
+class TxpoolTestDB: public BaseTestDB {
+public:
+  TxpoolTestDB(): m_height(1) { m_open = true; }
+
+  virtual uint64_t height() const override { return m_height; }
+  virtual std::vector<oracle::pricing_record> get_block_pricing_records(uint64_t start_height, size_t count) const override
+  {
+    std::vector<oracle::pricing_record> records;
+    for (uint64_t h = start_height; h < start_height + count; ++h)
+    {
+      const auto i = m_pricing_records.find(h);
+      records.push_back(i == m_pricing_records.end() ? oracle::pricing_record() : i->second);
+    }
+    return records;
+  }
+  virtual cryptonote::circ_supply_snapshot get_circulating_supply() const override { return m_circ_supply; }
+  // distinct non null ids, the pool tells checked txes from failed ones by them
+  virtual crypto::hash get_block_hash_from_height(const uint64_t& height) const override
+  {
+    crypto::hash h;
+    crypto::cn_fast_hash(&height, sizeof(height), h);
+    return h;
+  }
+
+  virtual void add_txpool_tx(const crypto::hash &txid, const cryptonote::blobdata_ref &blob, const cryptonote::txpool_tx_meta_t& details) override
+  {
+    std::lock_guard<std::recursive_mutex> lock(m_txpool_mutex);
+    if (!m_txpool.emplace(txid, std::make_pair(cryptonote::blobdata(blob.data(), blob.size()), details)).second)
+      throw DB_ERROR("Attempting to add txpool tx metadata that's already in the db");
+  }
+  virtual void update_txpool_tx(const crypto::hash &txid, const cryptonote::txpool_tx_meta_t& details) override
+  {
+    std::lock_guard<std::recursive_mutex> lock(m_txpool_mutex);
+    const auto i = m_txpool.find(txid);
+    if (i == m_txpool.end())
+      throw DB_ERROR("Error finding txpool tx meta to update");
+    i->second.second = details;
+  }
+  virtual uint64_t get_txpool_tx_count(relay_category tx_category = relay_category::broadcasted) const override
+  {
+    std::lock_guard<std::recursive_mutex> lock(m_txpool_mutex);
+    uint64_t count = 0;
+    for (const auto &e: m_txpool)
+      if (e.second.second.matches(tx_category))
+        ++count;
+    return count;
+  }
+  virtual bool txpool_has_tx(const crypto::hash &txid, relay_category tx_category) const override
+  {
+    std::lock_guard<std::recursive_mutex> lock(m_txpool_mutex);
+    const auto i = m_txpool.find(txid);
+    return i != m_txpool.end() && i->second.second.matches(tx_category);
+  }
+  virtual void remove_txpool_tx(const crypto::hash& txid) override
+  {
+    std::lock_guard<std::recursive_mutex> lock(m_txpool_mutex);
+    m_txpool.erase(txid);
+  }
+  virtual bool get_txpool_tx_meta(const crypto::hash& txid, cryptonote::txpool_tx_meta_t &meta) const override
+  {
+    std::lock_guard<std::recursive_mutex> lock(m_txpool_mutex);
+    const auto i = m_txpool.find(txid);
+    if (i == m_txpool.end())
+      return false;
+    meta = i->second.second;
+    return true;
+  }
+  virtual bool get_txpool_tx_blob(const crypto::hash& txid, cryptonote::blobdata &bd, relay_category tx_category) const override
+  {
+    std::lock_guard<std::recursive_mutex> lock(m_txpool_mutex);
+    const auto i = m_txpool.find(txid);
+    if (i == m_txpool.end() || !i->second.second.matches(tx_category))
+      return false;
+    bd = i->second.first;
+    return true;
+  }
+  virtual cryptonote::blobdata get_txpool_tx_blob(const crypto::hash& txid, relay_category tx_category) const override
+  {
+    cryptonote::blobdata bd;
+    if (!get_txpool_tx_blob(txid, bd, tx_category))
+      throw DB_ERROR("Tx not found in txpool");
+    return bd;
+  }
+  virtual bool for_all_txpool_txes(std::function<bool(const crypto::hash&, const cryptonote::txpool_tx_meta_t&, const cryptonote::blobdata_ref*)> f, bool include_blob = false, relay_category category = relay_category::broadcasted) const override
+  {
+    std::lock_guard<std::recursive_mutex> lock(m_txpool_mutex);
+    for (const auto &e: m_txpool)
+    {
+      if (!e.second.second.matches(category))
+        continue;
+      const cryptonote::blobdata_ref blob(e.second.first.data(), e.second.first.size());
+      if (!f(e.first, e.second.second, include_blob ? &blob : NULL))
+        return false;
+    }
+    return true;
+  }
+
+  uint64_t m_height;
+  std::map<uint64_t, oracle::pricing_record> m_pricing_records;
+  cryptonote::circ_supply_snapshot m_circ_supply;
+
+private:
+  mutable std::recursive_mutex m_txpool_mutex;
+  std::unordered_map<crypto::hash, std::pair<cryptonote::blobdata, cryptonote::txpool_tx_meta_t>> m_txpool;
+};
+
 }
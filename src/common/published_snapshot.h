@@ -0,0 +1,113 @@
+// Copyright (c) 2023, Zephyr Protocol
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include "syncobj.h"
+
+namespace tools
+{
+  /**
+   * Holds an immutable snapshot of some state guarded by a writer lock,
+   * tagged with the version of that state it was built from. Readers get
+   * the latest snapshot without waiting on writers: when the snapshot is
+   * stale it is rebuilt only if the writer lock is free, otherwise the
+   * previous snapshot is returned and the next reader refreshes it.
+   *
+   * The version is either an atomic counter or a callable returning one,
+   * and must change whenever the state the snapshot is built from does.
+   */
+  template<typename T>
+  class published_snapshot
+  {
+  public:
+    published_snapshot(): m_version(0) {}
+
+    template<typename Version, typename Builder>
+    std::shared_ptr<const T> get(const Version &version, epee::critical_section &writer_lock, Builder build)
+    {
+      std::shared_ptr<const T> snapshot;
+      uint64_t snapshot_version;
+      {
+        std::lock_guard<std::mutex> lock(m);
+        snapshot = m_snapshot;
+        snapshot_version = m_version;
+      }
+      if (snapshot && snapshot_version == read_version(version))
+        return snapshot;
+
+      if (!snapshot)
+        writer_lock.lock();
+      else if (!writer_lock.tryLock())
+        return snapshot;
+
+      try
+      {
+        // the version is read again under the writer lock so the snapshot
+        // is tagged with the state it was actually built from
+        const uint64_t current_version = read_version(version);
+        snapshot = publish(build(), current_version);
+      }
+      catch (...)
+      {
+        writer_lock.unlock();
+        throw;
+      }
+      writer_lock.unlock();
+      return snapshot;
+    }
+
+    std::shared_ptr<const T> publish(std::shared_ptr<const T> snapshot, uint64_t version)
+    {
+      std::lock_guard<std::mutex> lock(m);
+      m_snapshot = std::move(snapshot);
+      m_version = version;
+      return m_snapshot;
+    }
+
+    void reset()
+    {
+      std::lock_guard<std::mutex> lock(m);
+      m_snapshot.reset();
+      m_version = 0;
+    }
+
+  private:
+    static uint64_t read_version(const std::atomic<uint64_t> &version) { return version; }
+    template<typename Version>
+    static uint64_t read_version(const Version &version) { return version(); }
+
+    mutable std::mutex m;
+    std::shared_ptr<const T> m_snapshot;
+    uint64_t m_version;
+  };
+}
@@ -0,0 +1,103 @@
+// Copyright (c) 2023, Zephyr Protocol
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <array>
+#include <string>
+#include <boost/multiprecision/cpp_int.hpp>
+
+#include "crypto/hash.h"
+#include "oracle/asset_types.h"
+#include "oracle/pricing_record.h"
+
+namespace cryptonote
+{
+  /**
+   * @brief circulating supply tallies of the chain as of a given top block
+   *
+   * Tallies are kept as native 128 bit integers and indexed by the position
+   * of the asset in oracle::ASSET_TYPES, which is also the key used by the
+   * circ_supply_tally table. String conversions only happen at the RPC
+   * boundary.
+   */
+  struct circ_supply_snapshot
+  {
+    enum asset_index : size_t
+    {
+      ZEPH = 0,
+      ZEPHUSD = 1,
+      ZEPHRSV = 2,
+      NUM_ASSETS = 3
+    };
+
+    uint64_t height; //!< blockchain height the tallies were read at
+    crypto::hash top_hash; //!< hash of the top block the tallies were read at
+    std::array<boost::multiprecision::uint128_t, NUM_ASSETS> tally;
+
+    circ_supply_snapshot(): height(0), top_hash(crypto::null_hash)
+    {
+      tally.fill(0);
+    }
+
+    const boost::multiprecision::uint128_t& zeph_reserve() const { return tally[ZEPH]; }
+    const boost::multiprecision::uint128_t& num_stables() const { return tally[ZEPHUSD]; }
+    const boost::multiprecision::uint128_t& num_reserves() const { return tally[ZEPHRSV]; }
+
+    static bool asset_index_from_string(const std::string& asset_type, size_t& idx)
+    {
+      for (size_t i = 0; i < NUM_ASSETS; ++i)
+      {
+        if (oracle::ASSET_TYPES[i] == asset_type)
+        {
+          idx = i;
+          return true;
+        }
+      }
+      return false;
+    }
+  };
+
+  /**
+   * @brief reserve state of the chain right after a given block was added
+   *
+   * The prices are those of the block's own pricing record, so they are 0
+   * for blocks without a valid one.
+   */
+  struct reserve_history_entry
+  {
+    uint64_t height;
+    boost::multiprecision::uint128_t zeph_reserve;
+    boost::multiprecision::uint128_t num_stables;
+    boost::multiprecision::uint128_t num_reserves;
+    uint64_t spot;
+    uint64_t moving_average;
+
+    reserve_history_entry(): height(0), zeph_reserve(0), num_stables(0), num_reserves(0), spot(0), moving_average(0) {}
+  };
+}
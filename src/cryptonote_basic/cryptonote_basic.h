@@ -45,6 +45,7 @@
 #include "serialization/crypto.h"
 #include "serialization/keyvalue_serialization.h" // eepe named serialization
 #include "serialization/pricing_record.h"
+#include "serialization/asset_id.h"
 #include "cryptonote_config.h"
 #include "crypto/crypto.h"
 #include "crypto/hash.h"
@@ -79,10 +80,10 @@ namespace cryptonote
 
   struct txout_zephyr_tagged_key
   {
-    txout_zephyr_tagged_key() { }
-    txout_zephyr_tagged_key(const crypto::public_key &_key, const std::string &_asset_type, const crypto::view_tag &_view_tag) : key(_key), asset_type(_asset_type), view_tag(_view_tag) { }
+    txout_zephyr_tagged_key(): asset_type(oracle::asset_id::invalid) { }
+    txout_zephyr_tagged_key(const crypto::public_key &_key, const oracle::asset_id _asset_type, const crypto::view_tag &_view_tag) : key(_key), asset_type(_asset_type), view_tag(_view_tag) { }
     crypto::public_key key;
-    std::string asset_type;
+    oracle::asset_id asset_type; // serialized as the asset type string
     crypto::view_tag view_tag; // optimization to reduce scanning time
 
     BEGIN_SERIALIZE_OBJECT()
@@ -100,11 +100,22 @@ namespace boost
   }
 
 
+  template <class Archive>
+  inline void serialize_asset_id(Archive &a, oracle::asset_id &x)
+  {
+    // stored as the asset type string, like in the binary format
+    std::string asset_type;
+    if (oracle::is_valid_asset_id(x))
+      asset_type = oracle::get_asset_type(x);
+    a & asset_type;
+    x = oracle::get_asset_id(asset_type);
+  }
+
   template <class Archive>
   inline void serialize(Archive &a, cryptonote::txout_zephyr_tagged_key &x, const boost::serialization::version_type ver)
   {
     a & x.key;
-    a & x.asset_type;
+    serialize_asset_id(a, x.asset_type);
     a & x.view_tag;
   }
 
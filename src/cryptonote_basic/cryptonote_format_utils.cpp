@@ -916,10 +916,11 @@ namespace cryptonote
   uint64_t get_outs_money_amount(const transaction& tx, const std::string& asset_type)
   {
     uint64_t outputs_amount = 0;
+    const oracle::asset_id id = oracle::get_asset_id(asset_type);
     for(const auto& o: tx.vout) {
-      std::string output_asset_type;
-      bool ok = cryptonote::get_output_asset_type(o, output_asset_type);
-      if (ok && output_asset_type == asset_type)
+      oracle::asset_id output_asset_id;
+      bool ok = cryptonote::get_output_asset_id(o, output_asset_id);
+      if (ok && output_asset_id == id)
         outputs_amount += o.amount;
     }
     return outputs_amount;
@@ -939,16 +940,25 @@ namespace cryptonote
   }
   //---------------------------------------------------------------
   bool get_output_asset_type(const cryptonote::tx_out& out, std::string& output_asset_type)
+  {
+    oracle::asset_id output_asset_id;
+    if (!get_output_asset_id(out, output_asset_id))
+      return false;
+    output_asset_type = oracle::get_asset_type(output_asset_id);
+    return true;
+  }
+  //---------------------------------------------------------------
+  bool get_output_asset_id(const cryptonote::tx_out& out, oracle::asset_id& output_asset_id)
   {
     if (out.target.type() == typeid(txout_zephyr_tagged_key))
-      output_asset_type = boost::get< txout_zephyr_tagged_key >(out.target).asset_type;
+      output_asset_id = boost::get< txout_zephyr_tagged_key >(out.target).asset_type;
     else
     {
       LOG_ERROR("Unexpected output target type found: " << out.target.type().name());
       return false;
     }
 
-    return true;
+    return oracle::is_valid_asset_id(output_asset_id);
   }
   //---------------------------------------------------------------
   boost::optional<crypto::view_tag> get_output_view_tag(const cryptonote::tx_out& out)
@@ -973,7 +983,7 @@ namespace cryptonote
     txout_zephyr_tagged_key ttk;
     ttk.key = output_public_key;
     ttk.view_tag = view_tag;
-    ttk.asset_type = asset_type;
+    ttk.asset_type = oracle::get_asset_id(asset_type);
     out.target = ttk;
   }
   //---------------------------------------------------------------
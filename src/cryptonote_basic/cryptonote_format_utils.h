@@ -139,6 +139,7 @@ namespace cryptonote
   uint64_t get_pruned_transaction_weight(const transaction &tx);
 
   bool get_output_asset_type(const cryptonote::tx_out& out, std::string& output_asset_type);
+  bool get_output_asset_id(const cryptonote::tx_out& out, oracle::asset_id& output_asset_id);
 
   bool check_money_overflow(const transaction& tx);
   bool check_outs_overflow(const transaction& tx);
@@ -273,25 +273,124 @@ bool Blockchain::scan_outputkeys_for_indexes(size_t tx_version, const txin_zephy
 bool Blockchain::get_latest_acceptable_pr(oracle::pricing_record& pr) const
 {
   LOG_PRINT_L3("Blockchain::" << __func__);
-  uint64_t current_height = get_current_blockchain_height();
-  block latest_bl;
-  for (size_t i = 1; i <= 10; i++) {
-    if (!get_block_by_hash(get_block_id_by_height(current_height - i), latest_bl)) {
-      continue;
+  const uint64_t current_height = get_current_blockchain_height();
+  std::shared_ptr<const recent_pricing_records_t> recent = std::atomic_load(&m_recent_pricing_records);
+  if (!recent || recent->start_height + recent->records.size() != current_height)
+  {
+    // the chain moved under us, or the cache failed to load
+    const uint64_t count = std::min<uint64_t>(current_height, PRICING_RECORD_VALID_BLOCKS);
+    auto records = std::make_shared<recent_pricing_records_t>();
+    records->start_height = current_height - count;
+    try
+    {
+      if (count)
+        records->records = m_db->get_block_pricing_records(records->start_height, count);
     }
-
-    if (!latest_bl.pricing_record.empty() && !latest_bl.pricing_record.has_missing_rates()) {
-      break;
+    catch (const std::exception &e)
+    {
+      MERROR("Failed to get pricing records: " << e.what());
     }
+    recent = records;
   }
-  pr = latest_bl.pricing_record;
 
+  pr = oracle::pricing_record();
+  for (auto it = recent->records.rbegin(); it != recent->records.rend(); ++it) {
+    pr = *it;
+    if (!pr.empty() && !pr.has_missing_rates()) {
+      return true;
+    }
+  }
 
-  if (!pr.empty() && !pr.has_missing_rates()) {
+  return false;
+}
+//------------------------------------------------------------------
+bool Blockchain::get_block_pricing_record(uint64_t height, oracle::pricing_record& pr) const
+{
+  LOG_PRINT_L3("Blockchain::" << __func__);
+  const std::shared_ptr<const recent_pricing_records_t> recent = std::atomic_load(&m_recent_pricing_records);
+  if (recent && height >= recent->start_height && height - recent->start_height < recent->records.size())
+  {
+    pr = recent->records[height - recent->start_height];
     return true;
   }
 
-  return false;
+  try
+  {
+    const std::vector<oracle::pricing_record> records = m_db->get_block_pricing_records(height, 1);
+    if (records.empty())
+      return false;
+    pr = records.front();
+  }
+  catch (const std::exception &e)
+  {
+    MERROR("Failed to get pricing record for height " << height << ": " << e.what());
+    return false;
+  }
+  return true;
+}
+//------------------------------------------------------------------
+void Blockchain::refresh_recent_pricing_records()
+{
+  LOG_PRINT_L3("Blockchain::" << __func__);
+  try
+  {
+    const uint64_t height = m_db->height();
+    const uint64_t count = std::min<uint64_t>(height, PRICING_RECORD_VALID_BLOCKS);
+    auto recent = std::make_shared<recent_pricing_records_t>();
+    recent->start_height = height - count;
+    if (count)
+      recent->records = m_db->get_block_pricing_records(recent->start_height, count);
+    std::atomic_store(&m_recent_pricing_records, std::shared_ptr<const recent_pricing_records_t>(std::move(recent)));
+  }
+  catch (const std::exception &e)
+  {
+    // readers fall back to the db until the next successful refresh
+    MERROR("Failed to refresh recent pricing records: " << e.what());
+    std::atomic_store(&m_recent_pricing_records, std::shared_ptr<const recent_pricing_records_t>());
+  }
+}
+//------------------------------------------------------------------
+void Blockchain::push_recent_pricing_record(uint64_t height, const oracle::pricing_record& pr)
+{
+  LOG_PRINT_L3("Blockchain::" << __func__);
+  const std::shared_ptr<const recent_pricing_records_t> recent = std::atomic_load(&m_recent_pricing_records);
+  if (!recent || recent->start_height + recent->records.size() != height)
+  {
+    refresh_recent_pricing_records();
+    return;
+  }
+
+  auto updated = std::make_shared<recent_pricing_records_t>();
+  const size_t drop = recent->records.size() >= PRICING_RECORD_VALID_BLOCKS ? recent->records.size() - PRICING_RECORD_VALID_BLOCKS + 1 : 0;
+  updated->start_height = recent->start_height + drop;
+  updated->records.reserve(PRICING_RECORD_VALID_BLOCKS);
+  updated->records.assign(recent->records.begin() + drop, recent->records.end());
+  updated->records.push_back(pr);
+  std::atomic_store(&m_recent_pricing_records, std::shared_ptr<const recent_pricing_records_t>(std::move(updated)));
+}
+//------------------------------------------------------------------
+circ_supply_snapshot Blockchain::get_circulating_supply() const
+{
+  LOG_PRINT_L3("Blockchain::" << __func__);
+  const std::shared_ptr<const circ_supply_snapshot> circ_supply = std::atomic_load(&m_circ_supply);
+  if (circ_supply)
+    return *circ_supply;
+  return m_db->get_circulating_supply();
+}
+//------------------------------------------------------------------
+void Blockchain::refresh_circulating_supply()
+{
+  LOG_PRINT_L3("Blockchain::" << __func__);
+  try
+  {
+    std::atomic_store(&m_circ_supply, std::make_shared<const circ_supply_snapshot>(m_db->get_circulating_supply()));
+  }
+  catch (const std::exception &e)
+  {
+    // readers fall back to the db until the next successful refresh
+    MERROR("Failed to refresh circulating supply: " << e.what());
+    std::atomic_store(&m_circ_supply, std::shared_ptr<const circ_supply_snapshot>());
+  }
 }
 //------------------------------------------------------------------
 uint64_t Blockchain::get_current_blockchain_height() const
@@ -331,6 +430,7 @@ bool Blockchain::init(BlockchainDB* db, const network_type nettype, bool offline
 
   m_nettype = test_options != NULL ? FAKECHAIN : nettype;
   m_offline = offline;
+  m_oracle_fetcher.reset(new oracle_fetcher(m_nettype, [this]() { return m_hardfork->get_current_version(); }));
   m_fixed_difficulty = fixed_difficulty;
   if (m_hardfork == nullptr)
   {
@@ -470,6 +570,11 @@ bool Blockchain::init(BlockchainDB* db, const network_type nettype, bool offline
       }
     }
   }
+
+  // the pool's conversion index is rebuilt from these on on_blockchain_dec
+  refresh_circulating_supply();
+  refresh_recent_pricing_records();
+
   if (num_popped_blocks > 0)
   {
     m_timestamps_and_difficulties_height = 0;
@@ -570,8 +675,12 @@ bool Blockchain::deinit()
     LOG_ERROR("There was an issue closing/storing the blockchain, shutting down now to prevent issues!");
   }
 
+  if (m_oracle_fetcher)
+    m_oracle_fetcher->stop();
   delete m_hardfork;
   m_hardfork = NULL;
+  std::atomic_store(&m_recent_pricing_records, std::shared_ptr<const recent_pricing_records_t>());
+  std::atomic_store(&m_circ_supply, std::shared_ptr<const circ_supply_snapshot>());
   delete m_db;
   m_db = NULL;
   return true;
@@ -603,6 +712,8 @@ void Blockchain::pop_blocks(uint64_t nblocks)
     LOG_ERROR("Error when popping blocks after processing " << i << " blocks: " << e.what());
     if (stop_batch)
       m_db->batch_abort();
+    refresh_circulating_supply();
+    refresh_recent_pricing_records();
     return;
   }
 
@@ -649,6 +760,9 @@ block Blockchain::pop_block_from_blockchain()
     throw;
   }
 
+  refresh_circulating_supply();
+  refresh_recent_pricing_records();
+
   // make sure the hard fork object updates its current version
   m_hardfork->on_block_popped(1);
 
@@ -686,6 +800,7 @@ block Blockchain::pop_block_from_blockchain()
     MWARNING(pruned << " pruned txes could not be added back to the txpool");
 
   m_blocks_longhash_table.clear();
+  m_blocks_pr_check_table.clear();
   m_scan_table.clear();
   m_blocks_txs_check.clear();
 
@@ -714,6 +829,8 @@ bool Blockchain::reset_and_set_genesis_block(const block& b)
   m_db->reset();
   m_db->drop_alt_blocks();
   m_hardfork->init();
+  refresh_circulating_supply();
+  refresh_recent_pricing_records();
 
   db_wtxn_guard wtxn_guard(m_db);
   block_verification_context bvc = {};
@@ -1387,7 +1504,12 @@ bool Blockchain::validate_miner_transaction(
   std::map<std::string, uint64_t> money_in_use_map;
   for (auto& o: b.miner_tx.vout) {
     if (o.target.type() == typeid(txout_zephyr_tagged_key)) {
-      money_in_use_map[boost::get<cryptonote::txout_zephyr_tagged_key>(o.target).asset_type] += o.amount;
+      const oracle::asset_id id = boost::get<cryptonote::txout_zephyr_tagged_key>(o.target).asset_type;
+      if (!oracle::is_valid_asset_id(id)) {
+        MERROR("Detected invalid output asset type in validate_miner_transaction()");
+        return false;
+      }
+      money_in_use_map[oracle::get_asset_type(id)] += o.amount;
     } else {
       MERROR("Detected invalid output type in validate_miner_transaction()");
       return false;
@@ -1850,24 +1972,22 @@ bool Blockchain::get_pricing_record(oracle::pricing_record& pr, uint64_t timesta
 
   const uint8_t hf_version = m_hardfork->get_current_version();
   if (hf_version >= HF_VERSION_DJED) {
-    bool r = false;
-
-    epee::net_utils::http::http_simple_client http_client;
-    COMMAND_RPC_GET_PRICING_RECORD::request req = AUTO_VAL_INIT(req);
-    COMMAND_RPC_GET_PRICING_RECORD::response res = AUTO_VAL_INIT(res);
-    
-    std::array<std::string, 3> oracle_urls = get_config(m_nettype).ORACLE_URLS;
-    std::shuffle(oracle_urls.begin(), oracle_urls.end(), std::default_random_engine(crypto::rand<unsigned>()));
-    for (size_t n = 0; n < oracle_urls.size(); n++) {
-      http_client.set_server(oracle_urls[n], boost::none, epee::net_utils::ssl_support_t::e_ssl_support_autodetect);
-      std::string url = "/price/?timestamp=" + boost::lexical_cast<std::string>(timestamp) + "&version=" + std::to_string(m_hardfork->get_current_version());
-
-      r = epee::net_utils::invoke_http_json(url, req, res, http_client, std::chrono::seconds(10), "GET");
-      if (r) {
-        LOG_PRINT_L1("Obtained pricing record from Oracle : " << oracle_urls[n]);
-        break;
-      }
-      LOG_PRINT_L1("Failed to obtain pricing record from Oracle : " << oracle_urls[n]);
+    // the first template starts polling in the background, and goes without
+    // a record until the first fetch is in, rather than waiting on the oracles
+    if (!m_oracle_fetcher->is_running())
+      m_oracle_fetcher->start();
+
+    bool r = m_oracle_fetcher->get_latest(pr);
+    const oracle_fetcher::stats_t stats = m_oracle_fetcher->get_stats();
+    const uint64_t now = time(NULL);
+    LOG_PRINT_L1("Using cached pricing record - timestamp : " << pr.timestamp << ", last fetch " << (stats.last_success_time ? now - stats.last_success_time : 0) <<
+        " seconds ago, last fetch latency " << stats.last_latency_ms << " ms, max " << stats.max_latency_ms << " ms, " << stats.failures << " failed fetches");
+    // the block would be rejected with a record that is not newer than the top block
+    const uint64_t top_block_timestamp = m_db->get_top_block_timestamp();
+    if (r && (pr.timestamp <= top_block_timestamp || pr.timestamp > timestamp + PRICING_RECORD_VALID_TIME_DIFF_FROM_BLOCK)) {
+      LOG_PRINT_L0("Cached pricing record is stale (timestamp " << pr.timestamp << ")");
+      m_oracle_fetcher->wake(top_block_timestamp);
+      r = false;
     }
 
     if (!r) {
@@ -1876,16 +1996,7 @@ bool Blockchain::get_pricing_record(oracle::pricing_record& pr, uint64_t timesta
       return true;
     }
 
-    // Verify the signature
-    if (res.pr.verifySignature(get_config(m_nettype).ORACLE_PUBLIC_KEY)) {
-      pr = res.pr;
-    } else {
-      LOG_PRINT_L0("Failed to verify signature of pricing record from Oracle - returning empty PR");
-      pr = oracle::pricing_record();
-      return true;
-    }
-
-    std::vector<std::pair<std::string, std::string>> circ_supply = get_db().get_circulating_supply();
+    const circ_supply_snapshot circ_supply = get_circulating_supply();
 
     pr.stable = cryptonote::get_stable_coin_price(circ_supply, pr.spot);
     pr.stable_ma = cryptonote::get_stable_coin_price(circ_supply, pr.moving_average);
@@ -3188,7 +3299,7 @@ bool Blockchain::check_tx_outputs(const transaction& tx, tx_verification_context
   // Only ZEPH allowed before the hardfork
   if (hf_version < HF_VERSION_DJED) {
     for (auto &o: tx.vout) {
-      if (boost::get<txout_zephyr_tagged_key>(o.target).asset_type != "ZEPH") {
+      if (boost::get<txout_zephyr_tagged_key>(o.target).asset_type != oracle::asset_id::ZEPH) {
         tvc.m_invalid_output = true;
         return false;
       }
@@ -4208,7 +4319,7 @@ leave: {
 
   // validate the pricing record
   TIME_MEASURE_START(pricing_record);
-  if (!bl.pricing_record.valid(m_nettype, hf_version, bl.timestamp, m_db->get_top_block_timestamp())) {
+  if (!check_block_pricing_record(bl, id, hf_version)) {
     MERROR_VER("Block with id: " << id << std::endl << "has invalid pricing record!");
     bvc.m_verifivation_failed = true;
     goto leave;
@@ -4218,7 +4329,7 @@ leave: {
   // validate pricing record values
   if (hf_version >= HF_VERSION_DJED && !bl.pricing_record.empty()) {
     TIME_MEASURE_START(pricing_record_values);
-    std::vector<std::pair<std::string, std::string>> circ_supply = get_db().get_circulating_supply();
+    const circ_supply_snapshot circ_supply = get_circulating_supply();
     uint64_t stable_price = cryptonote::get_stable_coin_price(circ_supply, bl.pricing_record.spot);
     uint64_t stable_price_ma = cryptonote::get_stable_coin_price(circ_supply, bl.pricing_record.moving_average);
     uint64_t reserve_price = cryptonote::get_reserve_coin_price(circ_supply, bl.pricing_record.spot);
@@ -4357,7 +4468,7 @@ leave: {
   boost::multiprecision::int128_t total_conversion_zeph = 0;
   boost::multiprecision::int128_t total_conversion_stables = 0;
   boost::multiprecision::int128_t total_conversion_reserves = 0;
-  std::vector<std::pair<std::string, std::string>> circ_supply = get_db().get_circulating_supply();
+  const circ_supply_snapshot circ_supply = get_circulating_supply();
 
   bool have_valid_pr = true;
   oracle::pricing_record latest_pr;
@@ -4368,6 +4479,22 @@ leave: {
     have_valid_pr = false;
   }
 
+  // Conversion txs are checked again against the pricing record the chain
+  // now has at their pricing record height, as the one the pool saw may have
+  // been reorged away; transfers do not depend on it and are not. These checks
+  // do not depend on the running conversion tallies, so they are collected
+  // here and verified as one batch once every tx has been taken from the pool.
+  struct conversion_semantics_t
+  {
+    size_t tx_idx;
+    oracle::pricing_record pr;
+    cryptonote::transaction_type tx_type;
+    std::string source;
+    std::string dest;
+  };
+  std::vector<conversion_semantics_t> conversion_semantics;
+  conversion_semantics.reserve(bl.tx_hashes.size());
+
   size_t tx_index = 0;
   // Iterate over the block's transaction hashes, grabbing each
   // from the tx_pool and validating them.  Each is then added
@@ -4506,8 +4633,8 @@ leave: {
       }
       
       // get tx type and pricing record
-      block pr_bl;
-      if (!get_block_by_hash(get_block_id_by_height(tx.pricing_record_height), pr_bl)) {
+      oracle::pricing_record tx_pr;
+      if (!get_block_pricing_record(tx.pricing_record_height, tx_pr)) {
         LOG_PRINT_L2("error: failed to get block containing pricing record");
         bvc.m_verifivation_failed = true;
         goto leave;
@@ -4541,19 +4668,14 @@ leave: {
         goto leave;
       }
 
-      if (!rct::validateMintedAmount(tx.rct_signatures, tx.amount_burnt, tx.amount_minted, pr_bl.pricing_record, source, dest, hf_version)) {
+      if (!rct::validateMintedAmount(tx.rct_signatures, tx.amount_burnt, tx.amount_minted, tx_pr, source, dest, hf_version)) {
         LOG_PRINT_L1(" validateMintedAmount failed: burnt = " << tx.amount_burnt << ", minted = " << tx.amount_minted);
         bvc.m_verifivation_failed = true;
         goto leave;
       }
 
-      // make sure proof-of-value still holds
-      if (!rct::verRctSemanticsSimple(tx.rct_signatures, pr_bl.pricing_record, tx_type, source, dest, tx.amount_burnt, tx.vout, tx.vin, hf_version))
-      {
-        LOG_PRINT_L2(" transaction proof-of-value is now invalid for tx " << tx.hash);
-        bvc.m_verifivation_failed = true;
-        goto leave; 
-      }
+      // make sure proof-of-value still holds, checked in batch below
+      conversion_semantics.push_back({txs.size() - 1, tx_pr, tx_type, source, dest});
     } else {
       //make sure those values are 0 for transfers.
       if (tx.amount_burnt || tx.amount_minted) {
@@ -4577,6 +4699,29 @@ leave: {
     cumulative_block_weight += tx_weight;
   }
 
+  if (!conversion_semantics.empty())
+  {
+    TIME_MEASURE_START(sem);
+    std::vector<rct::semantics_data> semantics;
+    semantics.reserve(conversion_semantics.size());
+    for (const conversion_semantics_t &c: conversion_semantics)
+    {
+      const transaction &tx = txs[c.tx_idx].first;
+      semantics.push_back({&tx.rct_signatures, &c.pr, c.tx_type, &c.source, &c.dest, tx.amount_burnt, &tx.vout, &tx.vin});
+    }
+    std::vector<bool> failed;
+    if (!rct::verRctSemanticsSimple(semantics, hf_version, &failed))
+    {
+      for (size_t i = 0; i < conversion_semantics.size(); ++i)
+        if (failed[i])
+          LOG_PRINT_L2(" transaction proof-of-value is now invalid for tx " << get_transaction_hash(txs[conversion_semantics[i].tx_idx].first));
+      bvc.m_verifivation_failed = true;
+      goto leave;
+    }
+    TIME_MEASURE_FINISH(sem);
+    t_checktx += sem;
+  }
+
   // if we were syncing pruned blocks
   if (n_pruned > 0)
   {
@@ -4634,7 +4779,13 @@ leave: {
     {
       uint64_t long_term_block_weight = get_next_long_term_block_weight(block_weight);
       cryptonote::blobdata bd = cryptonote::block_to_blob(bl);
+      const oracle::pricing_record block_pr = bl.pricing_record;
+      const uint64_t block_timestamp = bl.timestamp;
       new_height = m_db->add_block(std::make_pair(std::move(bl), std::move(bd)), block_weight, long_term_block_weight, cumulative_difficulty, already_generated_coins, reserve_reward, txs);
+      refresh_circulating_supply();
+      push_recent_pricing_record(new_height, block_pr);
+      if (m_oracle_fetcher && m_oracle_fetcher->is_running())
+        m_oracle_fetcher->wake(block_timestamp);
     }
     catch (const KEY_IMAGE_EXISTS& e)
     {
@@ -4970,7 +5121,8 @@ void Blockchain::set_enforce_dns_checkpoints(bool enforce_checkpoints)
 }
 
 //------------------------------------------------------------------
-void Blockchain::block_longhash_worker(uint64_t height, const epee::span<const block> &blocks, std::unordered_map<crypto::hash, crypto::hash> &map) const
+void Blockchain::block_longhash_worker(uint64_t height, uint64_t last_bl_timestamp, const epee::span<const block> &blocks,
+    std::unordered_map<crypto::hash, crypto::hash> &map, std::unordered_map<crypto::hash, pricing_record_check_t> &pr_map) const
 {
   TIME_MEASURE_START(t);
   slow_hash_allocate_state();
@@ -4982,11 +5134,36 @@ void Blockchain::block_longhash_worker(uint64_t height, const epee::span<const b
     crypto::hash id = get_block_hash(block);
     crypto::hash pow = get_block_longhash(this, block, height++, 0);
     map.emplace(id, pow);
+
+    // the hard fork rule (no pricing record before HF_VERSION_DJED) is
+    // checked when the block is added, everything else can be done here
+    if (!block.pricing_record.empty())
+    {
+      const bool valid = block.pricing_record.valid(m_nettype, HF_VERSION_DJED, block.timestamp, last_bl_timestamp);
+      pr_map.emplace(id, pricing_record_check_t{last_bl_timestamp, valid});
+    }
+    last_bl_timestamp = block.timestamp;
   }
 
   slow_hash_free_state();
   TIME_MEASURE_FINISH(t);
 }
+//------------------------------------------------------------------
+bool Blockchain::check_block_pricing_record(const block &bl, const crypto::hash &id, uint8_t hf_version) const
+{
+  const uint64_t last_bl_timestamp = m_db->get_top_block_timestamp();
+  if (hf_version >= HF_VERSION_DJED && !bl.pricing_record.empty())
+  {
+    const auto it = m_blocks_pr_check_table.find(id);
+    if (it != m_blocks_pr_check_table.end() && it->second.last_bl_timestamp == last_bl_timestamp)
+    {
+      if (!it->second.valid)
+        LOG_ERROR("Pricing record failed validation while preparing blocks.");
+      return it->second.valid;
+    }
+  }
+  return bl.pricing_record.valid(m_nettype, hf_version, bl.timestamp, last_bl_timestamp);
+}
 
 //------------------------------------------------------------------
 bool Blockchain::cleanup_handle_incoming_blocks(bool force_sync)
@@ -5009,7 +5186,11 @@ bool Blockchain::cleanup_handle_incoming_blocks(bool force_sync)
       }
     }
     else
+    {
       m_db->batch_abort();
+      refresh_circulating_supply();
+      refresh_recent_pricing_records();
+    }
     success = true;
   }
   catch (const std::exception &e)
@@ -5047,6 +5228,7 @@ bool Blockchain::cleanup_handle_incoming_blocks(bool force_sync)
 
   TIME_MEASURE_FINISH(t1);
   m_blocks_longhash_table.clear();
+  m_blocks_pr_check_table.clear();
   m_scan_table.clear();
   m_blocks_txs_check.clear();
 
@@ -5289,6 +5471,7 @@ bool Blockchain::prepare_handle_incoming_blocks(const std::vector<block_complete
     unsigned int extra = blocks_entry.size() % threads;
     MDEBUG("block_batches: " << batches);
     std::vector<std::unordered_map<crypto::hash, crypto::hash>> maps(threads);
+    std::vector<std::unordered_map<crypto::hash, pricing_record_check_t>> pr_maps(threads);
     auto it = blocks_entry.begin();
     unsigned blockidx = 0;
 
@@ -5337,7 +5520,9 @@ bool Blockchain::prepare_handle_incoming_blocks(const std::vector<block_complete
     if (!blocks_exist)
     {
       m_blocks_longhash_table.clear();
+      m_blocks_pr_check_table.clear();
       uint64_t thread_height = height;
+      const uint64_t top_timestamp = m_db->get_top_block_timestamp();
       tools::threadpool::waiter waiter(tpool);
       m_prepare_height = height;
       m_prepare_nblocks = blocks_entry.size();
@@ -5349,7 +5534,8 @@ bool Blockchain::prepare_handle_incoming_blocks(const std::vector<block_complete
           ++nblocks;
         if (nblocks == 0)
           break;
-        tpool.submit(&waiter, boost::bind(&Blockchain::block_longhash_worker, this, thread_height, epee::span<const block>(&blocks[thread_height - height], nblocks), std::ref(maps[i])), true);
+        const uint64_t last_bl_timestamp = thread_height == height ? top_timestamp : blocks[thread_height - height - 1].timestamp;
+        tpool.submit(&waiter, boost::bind(&Blockchain::block_longhash_worker, this, thread_height, last_bl_timestamp, epee::span<const block>(&blocks[thread_height - height], nblocks), std::ref(maps[i]), std::ref(pr_maps[i])), true);
         thread_height += nblocks;
       }
 
@@ -5364,6 +5550,10 @@ bool Blockchain::prepare_handle_incoming_blocks(const std::vector<block_complete
       {
         m_blocks_longhash_table.insert(map.begin(), map.end());
       }
+      for (const auto & map : pr_maps)
+      {
+        m_blocks_pr_check_table.insert(map.begin(), map.end());
+      }
     }
   }
 
@@ -58,6 +58,7 @@
 #include "cryptonote_basic/difficulty.h"
 #include "cryptonote_tx_utils.h"
 #include "tx_verification_utils.h"
+#include "oracle_fetcher.h"
 #include "cryptonote_basic/verification_context.h"
 #include "crypto/hash.h"
 #include "checkpoints/checkpoints.h"
@@ -267,10 +268,21 @@ namespace cryptonote
     /**
      * @brief gets the pricing record for the specified timestamp
      *
+     * The first call starts the background oracle fetcher. Every call uses
+     * the freshest record it has, or an empty record if there is none yet or
+     * it is too old for the next block; the oracles are never waited on.
+     *
      * @return false if method failed to obtain pricing record from oracle, otherwise true
      */
     bool get_pricing_record(oracle::pricing_record& pr, uint64_t timestamp);
 
+    /**
+     * @brief gets the background oracle fetcher's counters
+     *
+     * @return all zero if no block template was built yet
+     */
+    oracle_fetcher::stats_t get_oracle_fetcher_stats() const { return m_oracle_fetcher ? m_oracle_fetcher->get_stats() : oracle_fetcher::stats_t(); }
+
     /**
      * @brief gets the latest pricing record that was in the last 10 block.
      * If no pricing record found in the past 10 block, fails.
@@ -279,6 +291,29 @@ namespace cryptonote
      */
     bool get_latest_acceptable_pr(oracle::pricing_record& pr) const;
 
+    /**
+     * @brief gets the pricing record stored with the block at a given height
+     *
+     * Records of the last PRICING_RECORD_VALID_BLOCKS blocks are served from
+     * memory, older ones are read from block_info; blocks are never parsed.
+     *
+     * @param height the height of the block
+     * @param pr return-by-reference the block's pricing record
+     *
+     * @return false if there is no block at that height, otherwise true
+     */
+    bool get_block_pricing_record(uint64_t height, oracle::pricing_record& pr) const;
+
+    /**
+     * @brief gets the circulating supply tallies at the current top block
+     *
+     * The tallies are kept in memory and refreshed whenever the main chain
+     * changes, so this neither takes the blockchain lock nor touches the db.
+     *
+     * @return the circulating supply snapshot, tagged with its height and top hash
+     */
+    circ_supply_snapshot get_circulating_supply() const;
+
     /**
      * @brief search the blockchain for a transaction by hash
      *
@@ -1044,15 +1079,48 @@ namespace cryptonote
     void output_scan_worker(const uint64_t amount,const std::vector<uint64_t> &offsets,
         std::vector<output_data_t> &outputs) const;
 
+    /**
+     * @brief result of checking a block's pricing record ahead of time
+     *
+     * The check depends on the timestamp of the block before it, so the
+     * result only applies if that block is still the top block when the
+     * block is added.
+     */
+    struct pricing_record_check_t
+    {
+      uint64_t last_bl_timestamp;
+      bool valid;
+    };
+
     /**
      * @brief computes the "short" and "long" hashes for a set of blocks
      *
+     * Non empty pricing records are also checked (rates, oracle signature
+     * and timestamps), so that this does not need to happen serially when
+     * the blocks are added.
+     *
      * @param height the height of the first block
+     * @param last_bl_timestamp the timestamp of the block before the first block
      * @param blocks the blocks to be hashed
      * @param map return-by-reference the hashes for each block
+     * @param pr_map return-by-reference the pricing record check for each block
      */
-    void block_longhash_worker(uint64_t height, const epee::span<const block> &blocks,
-        std::unordered_map<crypto::hash, crypto::hash> &map) const;
+    void block_longhash_worker(uint64_t height, uint64_t last_bl_timestamp, const epee::span<const block> &blocks,
+        std::unordered_map<crypto::hash, crypto::hash> &map, std::unordered_map<crypto::hash, pricing_record_check_t> &pr_map) const;
+
+    /**
+     * @brief validates a block's pricing record against the current top block
+     *
+     * Uses the result computed in prepare_handle_incoming_blocks if there
+     * is one for this block and top block timestamp.
+     *
+     * @param bl the block
+     * @param id the block's hash
+     * @param hf_version the hard fork version the block is added under
+     *
+     * @return true if the pricing record is valid, otherwise false
+     */
+    bool check_block_pricing_record(const block &bl, const crypto::hash &id, uint8_t hf_version) const;
 
     /**
      * @brief returns a set of known alternate chains
@@ -1162,6 +1230,7 @@ namespace cryptonote
     // metadata containers
     std::unordered_map<crypto::hash, std::unordered_map<crypto::key_image, std::vector<output_data_t>>> m_scan_table;
     std::unordered_map<crypto::hash, crypto::hash> m_blocks_longhash_table;
+    std::unordered_map<crypto::hash, pricing_record_check_t> m_blocks_pr_check_table;
 
     // Keccak hashes for each block and for fast pow checking
     std::vector<std::pair<crypto::hash, crypto::hash>> m_blocks_hash_of_hashes;
@@ -1242,6 +1311,46 @@ namespace cryptonote
     // cache for verifying transaction RCT non semantics
     mutable rct_ver_cache_t m_rct_ver_cache;
 
+    // circulating supply at the current top block, swapped atomically so
+    // readers never contend with block processing
+    std::shared_ptr<const circ_supply_snapshot> m_circ_supply;
+
+    // polls the oracle in the background for create_block_template, started on first use
+    std::unique_ptr<oracle_fetcher> m_oracle_fetcher;
+
+    /**
+     * @brief reloads the in-memory circulating supply tallies from the db
+     *
+     * Called with the blockchain lock held right after the main chain was
+     * changed, inside the same db transaction/batch as the change, and after
+     * a batch was aborted.
+     */
+    void refresh_circulating_supply();
+
+    // pricing records of the last PRICING_RECORD_VALID_BLOCKS blocks
+    struct recent_pricing_records_t
+    {
+      uint64_t start_height; //!< height of the first record
+      std::vector<oracle::pricing_record> records;
+    };
+    std::shared_ptr<const recent_pricing_records_t> m_recent_pricing_records;
+
+    /**
+     * @brief reloads the in-memory pricing records of the last blocks from the db
+     *
+     * Called from the same places as refresh_circulating_supply, except when
+     * a block is appended, which goes through push_recent_pricing_record.
+     */
+    void refresh_recent_pricing_records();
+
+    /**
+     * @brief appends the pricing record of a newly added main chain block
+     *
+     * @param height the height of the new block
+     * @param pr the new block's pricing record
+     */
+    void push_recent_pricing_record(uint64_t height, const oracle::pricing_record& pr);
+
     /**
      * @brief collects the keys for all outputs being "spent" as an input
      *
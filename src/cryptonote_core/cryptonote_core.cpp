@@ -188,6 +188,11 @@ namespace cryptonote
   , "Set maximum txpool weight in bytes."
   , DEFAULT_TXPOOL_MAX_WEIGHT
   };
+  static const command_line::arg_descriptor<size_t> arg_txpool_parsed_cache_size  = {
+    "txpool-parsed-cache-size"
+  , "Set the approximate memory budget in bytes for parsed txpool transactions, 0 to disable."
+  , DEFAULT_TXPOOL_PARSED_CACHE_SIZE
+  };
   static const command_line::arg_descriptor<std::string> arg_block_notify = {
     "block-notify"
   , "Run a program for each new block, '%s' will be replaced by the block hash"
@@ -348,6 +353,7 @@ namespace cryptonote
     command_line::add_arg(desc, arg_block_download_max_size);
     command_line::add_arg(desc, arg_sync_pruned_blocks);
     command_line::add_arg(desc, arg_max_txpool_weight);
+    command_line::add_arg(desc, arg_txpool_parsed_cache_size);
     command_line::add_arg(desc, arg_block_notify);
     command_line::add_arg(desc, arg_prune_blockchain);
     command_line::add_arg(desc, arg_reorg_notify);
@@ -450,6 +456,18 @@ namespace cryptonote
     return true;
   }
   //-----------------------------------------------------------------------------------------------
+  bool core::get_pool_conversions(std::vector<tx_memory_pool::conversion_info>& conversions, bool include_sensitive_txes) const
+  {
+    m_mempool.get_conversions(conversions, include_sensitive_txes);
+    return true;
+  }
+  //-----------------------------------------------------------------------------------------------
+  bool core::get_pool_fee_histogram(std::map<std::string, fee_histogram::buckets>& histogram, bool include_sensitive_txes) const
+  {
+    histogram = m_mempool.get_fee_histogram(include_sensitive_txes);
+    return true;
+  }
+  //-----------------------------------------------------------------------------------------------
   bool core::get_transactions(const std::vector<crypto::hash>& txs_ids, std::vector<transaction>& txs, std::vector<crypto::hash>& missed_txs, bool pruned) const
   {
     return m_blockchain_storage.get_transactions(txs_ids, txs, missed_txs, pruned);
@@ -484,6 +502,7 @@ namespace cryptonote
     uint64_t blocks_threads = command_line::get_arg(vm, arg_prep_blocks_threads);
     std::string check_updates_string = command_line::get_arg(vm, arg_check_updates);
     size_t max_txpool_weight = command_line::get_arg(vm, arg_max_txpool_weight);
+    size_t txpool_parsed_cache_size = command_line::get_arg(vm, arg_txpool_parsed_cache_size);
     bool prune_blockchain = command_line::get_arg(vm, arg_prune_blockchain);
     bool keep_alt_blocks = command_line::get_arg(vm, arg_keep_alt_blocks);
     bool keep_fakechain = command_line::get_arg(vm, arg_keep_fakechain);
@@ -680,7 +699,7 @@ namespace cryptonote
     r = m_blockchain_storage.init(db.release(), m_nettype, m_offline, regtest ? &regtest_test_options : test_options, fixed_difficulty, get_checkpoints);
     CHECK_AND_ASSERT_MES(r, false, "Failed to initialize blockchain storage");
 
-    r = m_mempool.init(max_txpool_weight, m_nettype == FAKECHAIN);
+    r = m_mempool.init(max_txpool_weight, m_nettype == FAKECHAIN, txpool_parsed_cache_size);
     CHECK_AND_ASSERT_MES(r, false, "Failed to initialize memory pool");
 
     // now that we have a valid m_blockchain_storage, we can clean out any
@@ -956,16 +975,13 @@ namespace cryptonote
         }
 
         // Get the correct pricing record here, given the height
-        std::vector<std::pair<cryptonote::blobdata,block>> blocks_pr;
-        bool b = m_blockchain_storage.get_blocks(pr_height, 1, blocks_pr);
-        if (!b) {
+        if (!m_blockchain_storage.get_block_pricing_record(pr_height, tx_info[n].tvc.pr)) {
           MERROR_VER("Failed to obtain pricing record for block: " << pr_height);
           set_semantics_failed(tx_info[n].tx_hash);
           tx_info[n].tvc.m_verifivation_failed = true;
           tx_info[n].result = false;
           continue;
         }
-        tx_info[n].tvc.pr = blocks_pr[0].second.pricing_record;
       }
 
 
@@ -1032,19 +1048,35 @@ namespace cryptonote
     }
     if (!rvv.empty())
     {
-      LOG_PRINT_L1("Verifying one transaction at a time");
-      ret = false;
-      std::vector<std::pair<std::string, std::string>> circ_supply = m_blockchain_storage.get_db().get_circulating_supply();
+      auto is_batched = [](const tx_verification_batch_info &info) {
+        const uint8_t type = info.tx->rct_signatures.type;
+        return info.result && (type == rct::RCTTypeBulletproof || type == rct::RCTTypeBulletproof2 || type == rct::RCTTypeCLSAG || type == rct::RCTTypeBulletproofPlus);
+      };
+
+      const uint8_t hf_version = m_blockchain_storage.get_current_hard_fork_version();
+      std::vector<rct::semantics_data> batch;
+      std::vector<size_t> batch_tx_info;
+      batch.reserve(rvv.size());
+      batch_tx_info.reserve(rvv.size());
       for (size_t n = 0; n < tx_info.size(); ++n)
       {
-        if (!tx_info[n].result)
-          continue;
-        if (tx_info[n].tx->rct_signatures.type != rct::RCTTypeBulletproof && tx_info[n].tx->rct_signatures.type != rct::RCTTypeBulletproof2 && tx_info[n].tx->rct_signatures.type != rct::RCTTypeCLSAG && tx_info[n].tx->rct_signatures.type != rct::RCTTypeBulletproofPlus)
+        if (!is_batched(tx_info[n]))
           continue;
+        const transaction &tx = *tx_info[n].tx;
+        batch.push_back({&tx.rct_signatures, &tx_info[n].tvc.pr, tx_info[n].tvc.m_type, &tx_info[n].tvc.m_source_asset, &tx_info[n].tvc.m_dest_asset, tx.amount_burnt, &tx.vout, &tx.vin});
+        batch_tx_info.push_back(n);
+      }
 
-        const uint8_t hf_version = m_blockchain_storage.get_current_hard_fork_version();
-        if (!rct::verRctSemanticsSimple(tx_info[n].tx->rct_signatures, tx_info[n].tvc.pr, tx_info[n].tvc.m_type, tx_info[n].tvc.m_source_asset, tx_info[n].tvc.m_dest_asset, tx_info[n].tx->amount_burnt, tx_info[n].tx->vout, tx_info[n].tx->vin, hf_version))
+      std::vector<bool> failed;
+      if (!rct::verRctSemanticsSimple(batch, hf_version, &failed))
+      {
+        LOG_PRINT_L1("One transaction among this group has bad semantics");
+        ret = false;
+        for (size_t i = 0; i < batch.size(); ++i)
         {
+          if (!failed[i])
+            continue;
+          const size_t n = batch_tx_info[i];
           MDEBUG("Damn, rct signature semantics check failed");
           set_semantics_failed(tx_info[n].tx_hash);
           tx_info[n].tvc.m_verifivation_failed = true;
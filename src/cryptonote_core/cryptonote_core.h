@@ -500,6 +500,22 @@ namespace cryptonote
       * @note see tx_memory_pool::get_txpool_backlog
       */
      bool get_txpool_backlog(std::vector<tx_backlog_entry>& backlog, bool include_sensitive_txes = false) const;
+
+     /**
+      * @copydoc tx_memory_pool::get_conversions
+      * @param include_sensitive_txes include private transactions
+      *
+      * @note see tx_memory_pool::get_conversions
+      */
+     bool get_pool_conversions(std::vector<tx_memory_pool::conversion_info>& conversions, bool include_sensitive_txes = false) const;
+
+     /**
+      * @copydoc tx_memory_pool::get_fee_histogram
+      * @param include_sensitive_txes include private transactions
+      *
+      * @note see tx_memory_pool::get_fee_histogram
+      */
+     bool get_pool_fee_histogram(std::map<std::string, fee_histogram::buckets>& histogram, bool include_sensitive_txes = false) const;
      
      /**
       * @copydoc tx_memory_pool::get_transactions
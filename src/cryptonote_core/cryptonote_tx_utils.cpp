@@ -39,6 +39,7 @@ namespace multiprecision = boost::multiprecision;
 
 #include "common/apply_permutation.h"
 #include "cryptonote_tx_utils.h"
+#include "reserve_math.h"
 #include "cryptonote_config.h"
 #include "blockchain.h"
 #include "blockchain_db/blockchain_db.h"
@@ -320,7 +321,7 @@ namespace cryptonote
     }
   }
   //---------------------------------------------------------------
-  bool get_tx_asset_types(const transaction& tx, const crypto::hash &txid, std::string& source, std::string& destination, const bool is_miner_tx) {
+  bool get_tx_asset_types(const transaction_prefix& tx, const crypto::hash &txid, std::string& source, std::string& destination, const bool is_miner_tx) {
 
     // Clear the source
     std::set<std::string> source_asset_types;
@@ -457,34 +458,8 @@ namespace cryptonote
     return true;
   }
   //---------------------------------------------------------------
-  void get_circulating_asset_amounts(const std::vector<std::pair<std::string, std::string>>& circ_amounts, multiprecision::uint128_t& zeph_reserve, multiprecision::uint128_t& num_stables, multiprecision::uint128_t& num_reserves)
-  {
-    zeph_reserve = 0;
-    for (auto circ_amount : circ_amounts) {
-      if (circ_amount.first == "ZEPH") {
-        zeph_reserve = multiprecision::uint128_t(circ_amount.second);
-        break;
-      }
-    }
-
-    num_stables = 0;
-    for (auto circ_amount : circ_amounts) {
-      if (circ_amount.first == "ZEPHUSD") {
-        num_stables = multiprecision::uint128_t(circ_amount.second);
-        break;
-      }
-    }
-    num_reserves = 0;
-    for (auto circ_amount : circ_amounts) {
-      if (circ_amount.first == "ZEPHRSV") {
-        num_reserves = multiprecision::uint128_t(circ_amount.second);
-        break;
-      }
-    }
-  }
-  //---------------------------------------------------------------
   void get_reserve_info(
-    const std::vector<std::pair<std::string, std::string>>& circ_amounts,
+    const circ_supply_snapshot& circ_amounts,
     const oracle::pricing_record& pr,
     multiprecision::uint128_t& zeph_reserve,
     multiprecision::uint128_t& num_stables,
@@ -497,52 +472,30 @@ namespace cryptonote
     double& reserve_ratio,
     double& reserve_ratio_ma
   ){
-    get_circulating_asset_amounts(circ_amounts, zeph_reserve, num_stables, num_reserves);
-    
-    multiprecision::cpp_bin_float_quad assets_float = zeph_reserve.convert_to<multiprecision::cpp_bin_float_quad>() * pr.spot;
-    multiprecision::cpp_bin_float_quad assets_ma_float = zeph_reserve.convert_to<multiprecision::cpp_bin_float_quad>() * pr.moving_average;
-    multiprecision::cpp_bin_float_quad liabilities_float = num_stables.convert_to<multiprecision::cpp_bin_float_quad>();
-
-    if ((assets_float == 0 || assets_ma_float == 0) && liabilities_float == 0) {
-      assets = 0;
-      assets_ma = 0;
-      liabilities = 0;
-      equity = 0;
-      equity_ma = 0;
-      reserve_ratio = 0;
-      reserve_ratio_ma = 0;
-      return;
-    }
-
-    multiprecision::cpp_bin_float_quad reserve_ratio_128 = assets_float / liabilities_float;
-    multiprecision::cpp_bin_float_quad reserve_ratio_ma_128 = assets_ma_float / liabilities_float;
-
-    assets_float /= COIN;
-    assets_ma_float /= COIN;
-    assets = assets_float.convert_to<multiprecision::uint128_t>();
-    assets_ma = assets_ma_float.convert_to<multiprecision::uint128_t>();
-    liabilities = liabilities_float.convert_to<multiprecision::uint128_t>();
-    equity = assets > liabilities ? assets - liabilities : 0;
-    equity_ma = assets_ma > liabilities ? assets_ma - liabilities : 0;
-
-    reserve_ratio_128 /= COIN;
-    reserve_ratio_ma_128 /= COIN;
-    reserve_ratio = reserve_ratio_128.convert_to<double>();
-    reserve_ratio_ma = reserve_ratio_ma_128.convert_to<double>();
-    return;
+    const reserve_engine engine(circ_amounts, pr);
+    zeph_reserve = engine.zeph_reserve();
+    num_stables = engine.num_stables();
+    num_reserves = engine.num_reserves();
+    assets = engine.assets();
+    assets_ma = engine.assets_ma();
+    liabilities = engine.liabilities();
+    equity = engine.equity();
+    equity_ma = engine.equity_ma();
+    reserve_ratio = engine.reserve_ratio();
+    reserve_ratio_ma = engine.reserve_ratio_ma();
   }
-  double get_spot_reserve_ratio(const std::vector<std::pair<std::string, std::string>>& circ_amounts, const oracle::pricing_record& pr)
+  double get_spot_reserve_ratio(const circ_supply_snapshot& circ_amounts, const oracle::pricing_record& pr)
   {
     return get_reserve_ratio(circ_amounts, pr.spot);
   }
-  double get_ma_reserve_ratio(const std::vector<std::pair<std::string, std::string>>& circ_amounts, const oracle::pricing_record& pr)
+  double get_ma_reserve_ratio(const circ_supply_snapshot& circ_amounts, const oracle::pricing_record& pr)
   {
     return get_reserve_ratio(circ_amounts, pr.moving_average);
   }
-  double get_reserve_ratio(const std::vector<std::pair<std::string, std::string>>& circ_amounts, const uint64_t oracle_price)
+  double get_reserve_ratio(const circ_supply_snapshot& circ_amounts, const uint64_t oracle_price)
   {
-    multiprecision::uint128_t zeph_reserve, num_stables, num_reserves;
-    get_circulating_asset_amounts(circ_amounts, zeph_reserve, num_stables, num_reserves);
+    multiprecision::uint128_t zeph_reserve = circ_amounts.zeph_reserve();
+    multiprecision::uint128_t num_stables = circ_amounts.num_stables();
 
     multiprecision::cpp_bin_float_quad assets = zeph_reserve.convert_to<multiprecision::cpp_bin_float_quad>() * oracle_price;
     multiprecision::cpp_bin_float_quad liabilities = num_stables.convert_to<multiprecision::cpp_bin_float_quad>();
@@ -554,95 +507,148 @@ namespace cryptonote
     return (double)reserve_ratio;
   }
   //---------------------------------------------------------------
-  bool reserve_ratio_satisfied(const std::vector<std::pair<std::string, std::string>>& circ_amounts, const oracle::pricing_record& pr, const transaction_type& tx_type, multiprecision::int128_t tally_zeph, multiprecision::int128_t tally_stables, multiprecision::int128_t tally_reserves)
+  bool reserve_ratio_satisfied(const circ_supply_snapshot& circ_amounts, const oracle::pricing_record& pr, const transaction_type& tx_type, multiprecision::int128_t tally_zeph, multiprecision::int128_t tally_stables, multiprecision::int128_t tally_reserves)
   {
     std::string error_reason;
     return reserve_ratio_satisfied(circ_amounts, pr, tx_type, tally_zeph, tally_stables, tally_reserves, error_reason);
   }
   //---------------------------------------------------------------
-  bool reserve_ratio_satisfied(const std::vector<std::pair<std::string, std::string>>& circ_amounts, const oracle::pricing_record& pr, const transaction_type& tx_type, multiprecision::int128_t tally_zeph, multiprecision::int128_t tally_stables, multiprecision::int128_t tally_reserves, std::string& error_reason)
+  reserve_engine::reserve_engine(const circ_supply_snapshot& circ_amounts, const oracle::pricing_record& pr):
+    m_pr(pr),
+    m_zeph_reserve(circ_amounts.zeph_reserve()),
+    m_num_stables(circ_amounts.num_stables()),
+    m_num_reserves(circ_amounts.num_reserves()),
+    m_reserve_ratio(0),
+    m_reserve_ratio_ma(0)
+  {
+    // the ratios as they stand are read often, so they are only worked out once
+    get_reserve_ratios(0, 0, m_reserve_ratio, m_reserve_ratio_ma);
+  }
+  //---------------------------------------------------------------
+  static multiprecision::uint128_t get_assets(const multiprecision::uint128_t& zeph_reserve, uint64_t price)
   {
-    if (pr.has_missing_rates()) {
+    multiprecision::cpp_bin_float_quad assets_float = zeph_reserve.convert_to<multiprecision::cpp_bin_float_quad>() * price;
+    assets_float /= COIN;
+    return assets_float.convert_to<multiprecision::uint128_t>();
+  }
+  //---------------------------------------------------------------
+  multiprecision::uint128_t reserve_engine::assets() const
+  {
+    if ((m_zeph_reserve == 0 || m_pr.spot == 0 || m_pr.moving_average == 0) && m_num_stables == 0)
+      return 0;
+    return get_assets(m_zeph_reserve, m_pr.spot);
+  }
+  //---------------------------------------------------------------
+  multiprecision::uint128_t reserve_engine::assets_ma() const
+  {
+    if ((m_zeph_reserve == 0 || m_pr.spot == 0 || m_pr.moving_average == 0) && m_num_stables == 0)
+      return 0;
+    return get_assets(m_zeph_reserve, m_pr.moving_average);
+  }
+  //---------------------------------------------------------------
+  multiprecision::uint128_t reserve_engine::equity() const
+  {
+    const multiprecision::uint128_t a = assets();
+    return a > m_num_stables ? a - m_num_stables : 0;
+  }
+  //---------------------------------------------------------------
+  multiprecision::uint128_t reserve_engine::equity_ma() const
+  {
+    const multiprecision::uint128_t a = assets_ma();
+    return a > m_num_stables ? a - m_num_stables : 0;
+  }
+  //---------------------------------------------------------------
+  bool reserve_engine::get_reserve_ratios(const multiprecision::int128_t& delta_zeph, const multiprecision::int128_t& delta_stables, double& reserve_ratio, double& reserve_ratio_ma) const
+  {
+    const multiprecision::int128_t assets = multiprecision::int128_t(m_zeph_reserve) + delta_zeph;
+    const multiprecision::int128_t liabilities = multiprecision::int128_t(m_num_stables) + delta_stables;
+    if (assets < 0 || liabilities < 0)
+      return false;
+
+    if ((assets == 0 || m_pr.spot == 0 || m_pr.moving_average == 0) && liabilities == 0)
+    {
+      reserve_ratio = 0;
+      reserve_ratio_ma = 0;
+      return true;
+    }
+    reserve_ratio = reserve_math::reserve_ratio_quad(multiprecision::uint128_t(assets), multiprecision::uint128_t(liabilities), m_pr.spot);
+    reserve_ratio_ma = reserve_math::reserve_ratio_quad(multiprecision::uint128_t(assets), multiprecision::uint128_t(liabilities), m_pr.moving_average);
+    return true;
+  }
+  //---------------------------------------------------------------
+  uint64_t reserve_engine::get_amount_minted(const transaction_type& tx_type, uint64_t amount_burnt) const
+  {
+    switch (tx_type)
+    {
+      case transaction_type::MINT_STABLE: return zeph_to_zephusd(amount_burnt, m_pr);
+      case transaction_type::REDEEM_STABLE: return zephusd_to_zeph(amount_burnt, m_pr);
+      case transaction_type::MINT_RESERVE: return zeph_to_zephrsv(amount_burnt, m_pr);
+      case transaction_type::REDEEM_RESERVE: return zephrsv_to_zeph(amount_burnt, m_pr);
+      default: return 0;
+    }
+  }
+  //---------------------------------------------------------------
+  // same as reserve_ratio_satisfied, without logging the reason it failed
+  bool reserve_engine::check(const transaction_type& tx_type, const multiprecision::int128_t& tally_zeph, const multiprecision::int128_t& tally_stables, const multiprecision::int128_t& tally_reserves, std::string& error_reason) const
+  {
+    if (m_pr.has_missing_rates()) {
       error_reason = "Reserve ratio cannot be calculated. Pricing record is missing rates.";
-      LOG_ERROR(error_reason);
       return false;
     }
 
-    multiprecision::uint128_t zeph_reserve, num_stables, num_reserves;
-    get_circulating_asset_amounts(circ_amounts, zeph_reserve, num_stables, num_reserves);
-
     // Early exit if no ZEPH in the reserve
-    if (zeph_reserve == 0) {
+    if (m_zeph_reserve == 0) {
       if (tx_type == transaction_type::MINT_RESERVE) {
         return true;
       }
       error_reason = "Reserve ratio not satisfied. No ZEPH in the reserve.";
-      LOG_ERROR(error_reason);
       return false;
     }
 
-    multiprecision::cpp_bin_float_quad assets = zeph_reserve.convert_to<multiprecision::cpp_bin_float_quad>() + tally_zeph.convert_to<multiprecision::cpp_bin_float_quad>();
-    if (assets < 0) {
+    const multiprecision::int128_t assets_signed = multiprecision::int128_t(m_zeph_reserve) + tally_zeph;
+    if (assets_signed < 0) {
       error_reason = "Reserve ratio not satisfied. Zeph reserve would be negative.";
-      LOG_ERROR(error_reason);
       return false;
     }
 
-    multiprecision::cpp_bin_float_quad liabilities = num_stables.convert_to<multiprecision::cpp_bin_float_quad>() + tally_stables.convert_to<multiprecision::cpp_bin_float_quad>();
-    if (liabilities < 0) {
+    const multiprecision::int128_t liabilities_signed = multiprecision::int128_t(m_num_stables) + tally_stables;
+    if (liabilities_signed < 0) {
       error_reason = "Reserve ratio not satisfied. Liabilities would be negative.";
-      LOG_ERROR(error_reason);
       return false;
     }
 
-    multiprecision::cpp_bin_float_quad total_reserve_coins = num_reserves.convert_to<multiprecision::cpp_bin_float_quad>() + tally_reserves.convert_to<multiprecision::cpp_bin_float_quad>();
+    const multiprecision::int128_t total_reserve_coins = multiprecision::int128_t(m_num_reserves) + tally_reserves;
     if (total_reserve_coins < 0) {
       error_reason = "Reserve ratio not satisfied. Total reserve coins would be negative.";
-      LOG_ERROR(error_reason);
       return false;
     }
 
+    const multiprecision::uint128_t assets(assets_signed);
+    const multiprecision::uint128_t liabilities(liabilities_signed);
     if (assets == 0 && liabilities == 0) {
       error_reason = "Reserve ratio not satisfied. Assets and liabilities are both zero.";
-      LOG_ERROR(error_reason);
       return false;
     }
 
-    multiprecision::cpp_bin_float_quad assets_spot = assets * pr.spot;
-    multiprecision::cpp_bin_float_quad assets_MA = assets * pr.moving_average;
-    if (assets != 0 && (assets_spot == 0 || assets_MA == 0)) {
+    if (assets != 0 && (m_pr.spot == 0 || m_pr.moving_average == 0)) {
       error_reason = "Reserve ratio not satisfied. Error calculating assets.";
-      LOG_ERROR(error_reason);
       return false;
     }
 
-    multiprecision::cpp_bin_float_quad reserve_ratio_spot = assets_spot / liabilities;
-    multiprecision::cpp_bin_float_quad reserve_ratio_MA = assets_MA / liabilities;
-
-    reserve_ratio_spot /= COIN;
-    reserve_ratio_MA /= COIN;
-
-    if (boost::math::isnan(reserve_ratio_spot) || boost::math::isnan(reserve_ratio_MA)) {
-      error_reason = "Reserve ratio not satisfied. Error calculating reserve ratio.";
-      LOG_ERROR(error_reason);
-      return false;
-    }
-    if (reserve_ratio_spot < 0 || reserve_ratio_MA < 0) {
-      error_reason = "Reserve ratio not satisfied. Reserve ratio would be negative.";
-      LOG_ERROR(error_reason);
-      return false;
-    }
+    // The ratios are compared exactly, so they can be neither NaN nor
+    // negative here: 0/0 was rejected above and nothing is below zero.
+    // They are only computed as floats to report a failure.
+    const auto ratio_spot = [&]() { return std::to_string(reserve_math::reserve_ratio_quad(assets, liabilities, m_pr.spot)); };
+    const auto ratio_MA = [&]() { return std::to_string(reserve_math::reserve_ratio_quad(assets, liabilities, m_pr.moving_average)); };
 
     if (tx_type == transaction_type::MINT_STABLE) {
       // Make sure the reserve ratio is at least 4.0
-      if (reserve_ratio_spot < 4.0) {
-        error_reason = "Spot reserve ratio not satisfied. New reserve ratio would be " + std::to_string((double)reserve_ratio_spot) + " which is less than minimum 4.0";
-        LOG_ERROR(error_reason);
+      if (reserve_math::compare_reserve_ratio(assets, liabilities, m_pr.spot, 4) < 0) {
+        error_reason = "Spot reserve ratio not satisfied. New reserve ratio would be " + ratio_spot() + " which is less than minimum 4.0";
         return false;
       }
-      if (reserve_ratio_MA < 4.0) {
-        error_reason = "MA reserve ratio not satisfied. New reserve ratio would be " + std::to_string((double)reserve_ratio_MA) + " which is less than minimum 4.0";
-        LOG_ERROR(error_reason);
+      if (reserve_math::compare_reserve_ratio(assets, liabilities, m_pr.moving_average, 4) < 0) {
+        error_reason = "MA reserve ratio not satisfied. New reserve ratio would be " + ratio_MA() + " which is less than minimum 4.0";
         return false;
       }
       return true;
@@ -651,7 +657,6 @@ namespace cryptonote
     if (tx_type == transaction_type::REDEEM_STABLE) {
       if (assets == 0) {
         error_reason = "Reserve ratio not satisfied. Assets are zero.";
-        LOG_ERROR(error_reason);
         return false;
       }
       return true;
@@ -664,14 +669,12 @@ namespace cryptonote
         return true;
       }
       // Make sure the reserve ratio has not exceeded max of 8.0
-      if (reserve_ratio_spot >= 8.0) {
-        error_reason = "Spot reserve ratio not satisfied. New reserve ratio would be " + std::to_string((double)reserve_ratio_spot) + " which is above the maximum 8.0";
-        LOG_ERROR(error_reason);
+      if (reserve_math::compare_reserve_ratio(assets, liabilities, m_pr.spot, 8) >= 0) {
+        error_reason = "Spot reserve ratio not satisfied. New reserve ratio would be " + ratio_spot() + " which is above the maximum 8.0";
         return false;
       }
-      if (reserve_ratio_MA >= 8.0) {
-        error_reason = "MA reserve ratio not satisfied. New reserve ratio would be " + std::to_string((double)reserve_ratio_MA) + " which is above the maximum 8.0";
-        LOG_ERROR(error_reason);
+      if (reserve_math::compare_reserve_ratio(assets, liabilities, m_pr.moving_average, 8) >= 0) {
+        error_reason = "MA reserve ratio not satisfied. New reserve ratio would be " + ratio_MA() + " which is above the maximum 8.0";
         return false;
       }
       return true;
@@ -679,25 +682,85 @@ namespace cryptonote
 
     if (tx_type == transaction_type::REDEEM_RESERVE) {
       // Make sure the reserve ratio is at least 4.0
-      if (reserve_ratio_spot < 4.0) {
-        error_reason = "Reserve ratio not satisfied. New reserve ratio would be " + std::to_string((double)reserve_ratio_spot) + " which is less than the minimum 4.0";
-        LOG_ERROR(error_reason);
+      if (reserve_math::compare_reserve_ratio(assets, liabilities, m_pr.spot, 4) < 0) {
+        error_reason = "Reserve ratio not satisfied. New reserve ratio would be " + ratio_spot() + " which is less than the minimum 4.0";
         return false;
       }
-      if (reserve_ratio_MA < 4.0) {
-        error_reason = "Reserve ratio not satisfied. New reserve ratio would be " + std::to_string((double)reserve_ratio_MA) + " which is less than the minimum 4.0";
-        LOG_ERROR(error_reason);
+      if (reserve_math::compare_reserve_ratio(assets, liabilities, m_pr.moving_average, 4) < 0) {
+        error_reason = "Reserve ratio not satisfied. New reserve ratio would be " + ratio_MA() + " which is less than the minimum 4.0";
         return false;
       }
       return true;
     }
 
-    error_reason = "Reserve ratios not satisfied. Spot: " + std::to_string((double)reserve_ratio_spot) + " | MA: " + std::to_string((double)reserve_ratio_MA);
-    LOG_ERROR(error_reason);
+    error_reason = "Reserve ratios not satisfied. Spot: " + ratio_spot() + " | MA: " + ratio_MA();
     return false;
+  }
+  //---------------------------------------------------------------
+  bool reserve_ratio_satisfied(const circ_supply_snapshot& circ_amounts, const oracle::pricing_record& pr, const transaction_type& tx_type, multiprecision::int128_t tally_zeph, multiprecision::int128_t tally_stables, multiprecision::int128_t tally_reserves, std::string& error_reason)
+  {
+    if (!reserve_engine(circ_amounts, pr).check(tx_type, tally_zeph, tally_stables, tally_reserves, error_reason))
+    {
+      LOG_ERROR(error_reason);
+      return false;
+    }
+    return true;
+  }
+  //---------------------------------------------------------------
+  reserve_tally::reserve_tally(const circ_supply_snapshot& circ_amounts, const oracle::pricing_record& pr):
+    m_engine(circ_amounts, pr),
+    m_zeph(0),
+    m_stables(0),
+    m_reserves(0)
+  {
+  }
+  //---------------------------------------------------------------
+  bool reserve_tally::get_conversion_delta(const transaction_type& tx_type, uint64_t amount_burnt, uint64_t amount_minted, multiprecision::int128_t& delta_zeph, multiprecision::int128_t& delta_stables, multiprecision::int128_t& delta_reserves)
+  {
+    delta_zeph = 0;
+    delta_stables = 0;
+    delta_reserves = 0;
+    if (tx_type == transaction_type::MINT_STABLE) {
+      delta_zeph += amount_burnt; // Added to the reserve
+      delta_stables += amount_minted;
+    } else if (tx_type == transaction_type::REDEEM_STABLE) {
+      delta_stables -= amount_burnt;
+      delta_zeph -= amount_minted; // Deducted from the reserve
+    } else if (tx_type == transaction_type::MINT_RESERVE) {
+      delta_zeph += amount_burnt;
+      delta_reserves += amount_minted;
+    } else if (tx_type == transaction_type::REDEEM_RESERVE) {
+      delta_reserves -= amount_burnt;
+      delta_zeph -= amount_minted;
+    } else {
+      return false;
+    }
+    return true;
+  }
+  //---------------------------------------------------------------
+  bool reserve_tally::can_add(const transaction_type& tx_type, uint64_t amount_burnt, uint64_t amount_minted) const
+  {
+    multiprecision::int128_t delta_zeph, delta_stables, delta_reserves;
+    if (!get_conversion_delta(tx_type, amount_burnt, amount_minted, delta_zeph, delta_stables, delta_reserves))
+      return false;
+    std::string error_reason;
+    return m_engine.check(tx_type, m_zeph + delta_zeph, m_stables + delta_stables, m_reserves + delta_reserves, error_reason);
+  }
+  //---------------------------------------------------------------
+  bool reserve_tally::add(const transaction_type& tx_type, uint64_t amount_burnt, uint64_t amount_minted)
+  {
+    multiprecision::int128_t delta_zeph, delta_stables, delta_reserves;
+    if (!get_conversion_delta(tx_type, amount_burnt, amount_minted, delta_zeph, delta_stables, delta_reserves))
+      return false;
+    if (!can_add(tx_type, amount_burnt, amount_minted))
+      return false;
+    m_zeph += delta_zeph;
+    m_stables += delta_stables;
+    m_reserves += delta_reserves;
+    return true;
   }
    //---------------------------------------------------------------
-  uint64_t get_stable_coin_price(const std::vector<std::pair<std::string, std::string>>& circ_amounts, uint64_t oracle_price)
+  uint64_t get_stable_coin_price(const circ_supply_snapshot& circ_amounts, uint64_t oracle_price)
   {
     if (oracle_price <= 0) return 0;
 
@@ -712,20 +775,15 @@ namespace cryptonote
     }
     uint64_t rate = rate_128.convert_to<uint64_t>();
 
-    multiprecision::uint128_t zeph_reserve, num_stables, num_reserves;
-    get_circulating_asset_amounts(circ_amounts, zeph_reserve, num_stables, num_reserves);
+    multiprecision::uint128_t zeph_reserve = circ_amounts.zeph_reserve();
+    multiprecision::uint128_t num_stables = circ_amounts.num_stables();
 
     if (num_stables == 0) {
       return rate;
     }
 
-    // Calculate the reserve ratio
-    multiprecision::cpp_bin_float_quad assets = zeph_reserve.convert_to<multiprecision::cpp_bin_float_quad>();
-    assets *= oracle_price;
-    multiprecision::cpp_bin_float_quad reserve_ratio_atomized = assets / num_stables.convert_to<multiprecision::cpp_bin_float_quad>();
-    multiprecision::cpp_bin_float_quad reserve_ratio = reserve_ratio_atomized / COIN;
-
-    if (reserve_ratio < 1.0) {
+    // Check whether the reserve ratio is below 1
+    if (reserve_math::compare_reserve_ratio(zeph_reserve, num_stables, oracle_price, 1) < 0) {
       zeph_reserve *= COIN;
       multiprecision::uint128_t worst_case_stable_rate = zeph_reserve / num_stables;
       worst_case_stable_rate -= (worst_case_stable_rate % 10000);
@@ -739,43 +797,9 @@ namespace cryptonote
     return rate;
   }
   //---------------------------------------------------------------
-  uint64_t get_reserve_coin_price(const std::vector<std::pair<std::string, std::string>>& circ_amounts, uint64_t exchange_rate)
+  uint64_t get_reserve_coin_price(const circ_supply_snapshot& circ_amounts, uint64_t exchange_rate)
   {
-    if (exchange_rate <= 0) return 0;
-
-    multiprecision::uint128_t zeph_reserve, num_stables, num_reserves;
-    get_circulating_asset_amounts(circ_amounts, zeph_reserve, num_stables, num_reserves);
-    
-    uint64_t price_r_min = 500000000000;
-    if (num_reserves == 0) {
-      MDEBUG("No reserve amount detected. Using price_r_min..");
-      return price_r_min;
-    }
-
-    multiprecision::cpp_bin_float_quad assets = zeph_reserve.convert_to<multiprecision::cpp_bin_float_quad>();
-    multiprecision::cpp_bin_float_quad liabilities = num_stables.convert_to<multiprecision::cpp_bin_float_quad>();
-
-    liabilities *= COIN;
-    liabilities /= exchange_rate;
-
-    multiprecision::cpp_bin_float_quad equity = assets - liabilities;
-
-    if (equity < 0) {
-      return price_r_min;
-    }
-
-    equity *= COIN;
-    multiprecision::cpp_bin_float_quad reserve_coin_price_float = equity / num_reserves.convert_to<multiprecision::cpp_bin_float_quad>();
-
-    if (reserve_coin_price_float > std::numeric_limits<uint64_t>::max()) {
-      MWARNING("overflow detected in reserve coin price calculation.");
-      return 0;
-    }
-
-    uint64_t reserve_coin_price = reserve_coin_price_float.convert_to<uint64_t>();
-    reserve_coin_price -= (reserve_coin_price % 10000);
-    
-    return std::max(reserve_coin_price, price_r_min);
+    return reserve_math::reserve_coin_price(circ_amounts.zeph_reserve(), circ_amounts.num_stables(), circ_amounts.num_reserves(), exchange_rate);
   }
   //---------------------------------------------------------------
   // ZEPH -> ZEPHRSV
@@ -944,7 +968,7 @@ namespace cryptonote
     const uint64_t current_height, 
     const uint8_t hf_version,
     const oracle::pricing_record& pr,
-    const std::vector<std::pair<std::string, std::string>> circ_amounts,
+    const circ_supply_snapshot& circ_amounts,
     uint64_t unlock_time,
     const crypto::secret_key &tx_key,
     const std::vector<crypto::secret_key> &additional_tx_keys,
@@ -1470,7 +1494,7 @@ namespace cryptonote
     const uint64_t current_height,
     const uint8_t hf_version,
     const oracle::pricing_record& pr,
-    const std::vector<std::pair<std::string, std::string>> circ_amounts,
+    const circ_supply_snapshot& circ_amounts,
     uint64_t unlock_time,
     crypto::secret_key &tx_key,
     std::vector<crypto::secret_key> &additional_tx_keys,
@@ -1535,7 +1559,7 @@ namespace cryptonote
     std::vector<crypto::secret_key> additional_tx_keys;
     std::vector<tx_destination_entry> destinations_copy = destinations;
     
-    std::vector<std::pair<std::string, std::string>> circ_supply; // = m_blockchain_storage.get_db().get_circulating_supply();
+    circ_supply_snapshot circ_supply;
     return construct_tx_and_get_tx_key(sender_account_keys, subaddresses, sources, destinations_copy, change_addr, extra, tx, "ZEPH", "ZEPH", 100, hf_version, oracle::pricing_record(), circ_supply, unlock_time, tx_key, additional_tx_keys, false, { rct::RangeProofBorromean, 0});
   }
   //---------------------------------------------------------------
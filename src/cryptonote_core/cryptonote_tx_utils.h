@@ -29,6 +29,7 @@
 // Parts of this file are originally copyright (c) 2012-2013 The Cryptonote developers
 
 #pragma once
+#include "cryptonote_basic/circ_supply.h"
 #include "cryptonote_basic/cryptonote_format_utils.h"
 #include <boost/serialization/vector.hpp>
 #include <boost/serialization/utility.hpp>
@@ -167,7 +168,7 @@ namespace cryptonote
     const uint64_t current_height,
     const uint8_t hf_version,
     const oracle::pricing_record& pr,
-    const std::vector<std::pair<std::string, std::string>> circ_amounts,
+    const circ_supply_snapshot& circ_amounts,
     uint64_t unlock_time,
     const crypto::secret_key &tx_key,
     const std::vector<crypto::secret_key> &additional_tx_keys,
@@ -190,7 +191,7 @@ namespace cryptonote
     const uint64_t current_height,
     const uint8_t hf_version,
     const oracle::pricing_record& pr,
-    const std::vector<std::pair<std::string, std::string>> circ_amounts,
+    const circ_supply_snapshot& circ_amounts,
     uint64_t unlock_time,
     crypto::secret_key &tx_key,
     std::vector<crypto::secret_key> &additional_tx_keys,
@@ -226,14 +227,14 @@ namespace cryptonote
   crypto::hash get_block_longhash(const Blockchain *pb, const block& b, const uint64_t height, const crypto::hash *seed_hash = nullptr, const int miners = 0);
   void get_altblock_longhash(const block& b, crypto::hash& res, const crypto::hash& seed_hash);
 
-  bool get_tx_asset_types(const transaction& tx, const crypto::hash &txid, std::string& source, std::string& destination, const bool is_miner_tx);
+  bool get_tx_asset_types(const transaction_prefix& tx, const crypto::hash &txid, std::string& source, std::string& destination, const bool is_miner_tx);
   bool get_tx_type(const std::string& source, const std::string& destination, transaction_type& type);
 
   bool tx_pr_height_valid(const uint64_t current_height, const uint64_t pr_height, const crypto::hash& tx_hash);
   
 
   void get_reserve_info(
-    const std::vector<std::pair<std::string, std::string>>& circ_amounts,
+    const circ_supply_snapshot& circ_amounts,
     const oracle::pricing_record& pricing_record,
     boost::multiprecision::uint128_t& zeph_reserve,
     boost::multiprecision::uint128_t& num_stables,
@@ -247,13 +248,13 @@ namespace cryptonote
     double& reserve_ratio_ma
   );
 
-  double get_reserve_ratio(const std::vector<std::pair<std::string, std::string>>& circ_amounts, const uint64_t oracle_price);
-  double get_spot_reserve_ratio(const std::vector<std::pair<std::string, std::string>>& circ_amounts, const oracle::pricing_record& pr);
-  double get_ma_reserve_ratio(const std::vector<std::pair<std::string, std::string>>& circ_amounts, const oracle::pricing_record& pr);
+  double get_reserve_ratio(const circ_supply_snapshot& circ_amounts, const uint64_t oracle_price);
+  double get_spot_reserve_ratio(const circ_supply_snapshot& circ_amounts, const oracle::pricing_record& pr);
+  double get_ma_reserve_ratio(const circ_supply_snapshot& circ_amounts, const oracle::pricing_record& pr);
 
 
   bool reserve_ratio_satisfied(
-    const std::vector<std::pair<std::string, std::string>>& circ_amounts,
+    const circ_supply_snapshot& circ_amounts,
     const oracle::pricing_record& pr,
     const transaction_type& tx_type,
     boost::multiprecision::int128_t tally_zeph,
@@ -261,7 +262,7 @@ namespace cryptonote
     boost::multiprecision::int128_t tally_reserves
   );
   bool reserve_ratio_satisfied(
-    const std::vector<std::pair<std::string, std::string>>& circ_amounts,
+    const circ_supply_snapshot& circ_amounts,
     const oracle::pricing_record& pr,
     const transaction_type& tx_type,
     boost::multiprecision::int128_t tally_zeph,
@@ -270,8 +271,95 @@ namespace cryptonote
     std::string& error_reason
   );
 
-  uint64_t get_stable_coin_price(const std::vector<std::pair<std::string, std::string>>& circ_amounts, uint64_t oracle_price);
-  uint64_t get_reserve_coin_price(const std::vector<std::pair<std::string, std::string>>& circ_amounts, uint64_t exchange_rate);
+  //---------------------------------------------------------------
+  // Reserve state derived once from a supply snapshot and a pricing record.
+  // The derived values are what get_reserve_info reports, and checking a set
+  // of reserve changes against the reserve ratio rules costs a few float
+  // operations instead of re-deriving everything from the tallies.
+  class reserve_engine
+  {
+  public:
+    reserve_engine(const circ_supply_snapshot& circ_amounts, const oracle::pricing_record& pr);
+
+    const oracle::pricing_record& pricing_record() const { return m_pr; }
+    const boost::multiprecision::uint128_t& zeph_reserve() const { return m_zeph_reserve; }
+    const boost::multiprecision::uint128_t& num_stables() const { return m_num_stables; }
+    const boost::multiprecision::uint128_t& num_reserves() const { return m_num_reserves; }
+    boost::multiprecision::uint128_t assets() const;
+    boost::multiprecision::uint128_t assets_ma() const;
+    boost::multiprecision::uint128_t liabilities() const { return m_num_stables; }
+    boost::multiprecision::uint128_t equity() const;
+    boost::multiprecision::uint128_t equity_ma() const;
+    double reserve_ratio() const { return m_reserve_ratio; }
+    double reserve_ratio_ma() const { return m_reserve_ratio_ma; }
+
+    // checks a conversion against the reserve ratio rules, with the given
+    // changes to the reserve, stables and reserve coins applied
+    bool check(
+      const transaction_type& tx_type,
+      const boost::multiprecision::int128_t& delta_zeph,
+      const boost::multiprecision::int128_t& delta_stables,
+      const boost::multiprecision::int128_t& delta_reserves,
+      std::string& error_reason
+    ) const;
+
+    // spot and MA reserve ratios with the given changes applied
+    bool get_reserve_ratios(
+      const boost::multiprecision::int128_t& delta_zeph,
+      const boost::multiprecision::int128_t& delta_stables,
+      double& reserve_ratio,
+      double& reserve_ratio_ma
+    ) const;
+
+    // amount a conversion of amount_burnt mints at this pricing record
+    uint64_t get_amount_minted(const transaction_type& tx_type, uint64_t amount_burnt) const;
+
+  private:
+    oracle::pricing_record m_pr;
+    boost::multiprecision::uint128_t m_zeph_reserve;
+    boost::multiprecision::uint128_t m_num_stables;
+    boost::multiprecision::uint128_t m_num_reserves;
+    double m_reserve_ratio;
+    double m_reserve_ratio_ma;
+  };
+
+  //---------------------------------------------------------------
+  // Reserve changes of the conversions accepted into a block so far, in block
+  // order. Each conversion is checked against the reserve ratio rules with the
+  // changes of every conversion before it, as block validation does. Failed
+  // checks are not logged, callers log them at the level that suits them.
+  class reserve_tally
+  {
+  public:
+    reserve_tally(const circ_supply_snapshot& circ_amounts, const oracle::pricing_record& pr);
+
+    // change to the reserve, stables and reserve coins made by one conversion
+    static bool get_conversion_delta(
+      const transaction_type& tx_type,
+      uint64_t amount_burnt,
+      uint64_t amount_minted,
+      boost::multiprecision::int128_t& delta_zeph,
+      boost::multiprecision::int128_t& delta_stables,
+      boost::multiprecision::int128_t& delta_reserves
+    );
+
+    bool can_add(const transaction_type& tx_type, uint64_t amount_burnt, uint64_t amount_minted) const;
+    // adds the conversion only if the reserve ratio stays satisfied
+    bool add(const transaction_type& tx_type, uint64_t amount_burnt, uint64_t amount_minted);
+
+    const boost::multiprecision::int128_t& zeph() const { return m_zeph; }
+    const boost::multiprecision::int128_t& stables() const { return m_stables; }
+    const boost::multiprecision::int128_t& reserves() const { return m_reserves; }
+
+  private:
+    reserve_engine m_engine;
+    boost::multiprecision::int128_t m_zeph;
+    boost::multiprecision::int128_t m_stables;
+    boost::multiprecision::int128_t m_reserves;
+  };
+
+  uint64_t get_stable_coin_price(const circ_supply_snapshot& circ_amounts, uint64_t oracle_price);
+  uint64_t get_reserve_coin_price(const circ_supply_snapshot& circ_amounts, uint64_t exchange_rate);
 
   uint64_t zephrsv_to_zeph(const uint64_t amount, const oracle::pricing_record& pr);
   uint64_t zeph_to_zephrsv(const uint64_t amount, const oracle::pricing_record& pr);
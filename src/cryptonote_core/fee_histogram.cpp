@@ -0,0 +1,110 @@
+// Copyright (c) 2023, Zephyr Protocol
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <cmath>
+#include "fee_histogram.h"
+
+namespace cryptonote
+{
+  //---------------------------------------------------------------------------------
+  uint32_t fee_histogram::get_bucket_index(uint64_t fee, uint64_t weight)
+  {
+    const double fee_per_byte = fee / (double)(weight ? weight : 1);
+    if (fee_per_byte < 1.0)
+      return 0;
+    return 1 + (uint32_t)std::floor(std::log2(fee_per_byte) * BUCKETS_PER_DOUBLING);
+  }
+  //---------------------------------------------------------------------------------
+  uint64_t fee_histogram::get_bucket_min_fee_per_byte(uint32_t index)
+  {
+    if (index == 0)
+      return 0;
+    return (uint64_t)std::exp2((index - 1) / (double)BUCKETS_PER_DOUBLING);
+  }
+  //---------------------------------------------------------------------------------
+  void fee_histogram::add(const crypto::hash &txid, const std::string &asset_type, uint64_t fee, uint64_t weight, bool broadcasted)
+  {
+    remove(txid);
+    const tx_entry e{asset_type, get_bucket_index(fee, weight), fee, weight, broadcasted};
+    add_to(m_all, e);
+    if (broadcasted)
+      add_to(m_broadcasted, e);
+    m_txes.emplace(txid, e);
+  }
+  //---------------------------------------------------------------------------------
+  void fee_histogram::remove(const crypto::hash &txid)
+  {
+    const auto i = m_txes.find(txid);
+    if (i == m_txes.end())
+      return;
+    remove_from(m_all, i->second);
+    if (i->second.broadcasted)
+      remove_from(m_broadcasted, i->second);
+    m_txes.erase(i);
+  }
+  //---------------------------------------------------------------------------------
+  void fee_histogram::clear()
+  {
+    m_txes.clear();
+    m_all.clear();
+    m_broadcasted.clear();
+  }
+  //---------------------------------------------------------------------------------
+  std::map<std::string, fee_histogram::buckets> fee_histogram::get(bool include_sensitive) const
+  {
+    return include_sensitive ? m_all : m_broadcasted;
+  }
+  //---------------------------------------------------------------------------------
+  void fee_histogram::add_to(std::map<std::string, buckets> &histogram, const tx_entry &e)
+  {
+    bucket &b = histogram[e.asset_type].emplace(e.index, bucket{0, 0, 0}).first->second;
+    ++b.txs;
+    b.weight += e.weight;
+    b.fee += e.fee;
+  }
+  //---------------------------------------------------------------------------------
+  void fee_histogram::remove_from(std::map<std::string, buckets> &histogram, const tx_entry &e)
+  {
+    const auto a = histogram.find(e.asset_type);
+    if (a == histogram.end())
+      return;
+    const auto i = a->second.find(e.index);
+    if (i == a->second.end())
+      return;
+    bucket &b = i->second;
+    if (--b.txs == 0)
+      a->second.erase(i);
+    else
+    {
+      b.weight -= e.weight;
+      b.fee -= e.fee;
+    }
+    if (a->second.empty())
+      histogram.erase(a);
+  }
+}
@@ -0,0 +1,103 @@
+// Copyright (c) 2023, Zephyr Protocol
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include "crypto/hash.h"
+
+namespace cryptonote
+{
+  /**
+   * @brief per fee asset histogram of pool txes by fee per byte
+   *
+   * Buckets are log scaled, four per doubling of the fee per byte, so a
+   * backlog query costs O(buckets) rather than O(txes). Each tx is kept
+   * once, with a flag telling whether it is in the broadcasted relay
+   * category. Txes that are not broadcasted only show up when sensitive
+   * data is requested.
+   */
+  class fee_histogram
+  {
+  public:
+    static const uint32_t BUCKETS_PER_DOUBLING = 4;
+
+    struct bucket
+    {
+      uint64_t txs;
+      uint64_t weight;
+      uint64_t fee;
+    };
+    typedef std::map<uint32_t, bucket> buckets; //!< by bucket index
+
+    /**
+     * @brief get the bucket a fee per byte falls in, 0 is for anything below 1
+     */
+    static uint32_t get_bucket_index(uint64_t fee, uint64_t weight);
+
+    /**
+     * @brief get the lowest fee per byte in a bucket, rounded down
+     */
+    static uint64_t get_bucket_min_fee_per_byte(uint32_t index);
+
+    /**
+     * @brief adds a tx, or updates it if it is already in
+     */
+    void add(const crypto::hash &txid, const std::string &asset_type, uint64_t fee, uint64_t weight, bool broadcasted);
+
+    void remove(const crypto::hash &txid);
+    void clear();
+
+    /**
+     * @brief get the buckets for each fee asset type
+     *
+     * @param include_sensitive include txes not yet broadcasted
+     */
+    std::map<std::string, buckets> get(bool include_sensitive) const;
+
+  private:
+    struct tx_entry
+    {
+      std::string asset_type;
+      uint32_t index;
+      uint64_t fee;
+      uint64_t weight;
+      bool broadcasted;
+    };
+
+    static void add_to(std::map<std::string, buckets> &histogram, const tx_entry &e);
+    static void remove_from(std::map<std::string, buckets> &histogram, const tx_entry &e);
+
+    std::unordered_map<crypto::hash, tx_entry> m_txes;
+    std::map<std::string, buckets> m_all;
+    std::map<std::string, buckets> m_broadcasted;
+  };
+}
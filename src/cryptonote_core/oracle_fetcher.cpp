@@ -0,0 +1,234 @@
+// Copyright (c) 2023, Zephyr Protocol
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <boost/lexical_cast.hpp>
+
+#include "oracle_fetcher.h"
+#include "crypto/crypto.h"
+#include "misc_log_ex.h"
+#include "rpc/core_rpc_server_commands_defs.h"
+#include "storages/http_abstract_invoke.h"
+
+#undef MONERO_DEFAULT_LOG_CATEGORY
+#define MONERO_DEFAULT_LOG_CATEGORY "oracle"
+
+namespace cryptonote
+{
+//------------------------------------------------------------------
+oracle_fetcher::oracle_fetcher(network_type nettype, std::function<uint8_t()> get_hf_version):
+  m_get_hf_version(std::move(get_hf_version)),
+  m_fetch([this, nettype](uint64_t timestamp, uint8_t hf_version, oracle::pricing_record& pr) {
+    return fetch_pricing_record(nettype, m_clients, timestamp, hf_version, std::chrono::seconds(FETCH_TIMEOUT), pr);
+  }),
+  m_running(false),
+  m_stop(false),
+  m_woken(false),
+  m_have_pr(false),
+  m_stats()
+{
+}
+//------------------------------------------------------------------
+oracle_fetcher::oracle_fetcher(std::function<uint8_t()> get_hf_version, fetch_t fetch):
+  m_get_hf_version(std::move(get_hf_version)),
+  m_fetch(std::move(fetch)),
+  m_running(false),
+  m_stop(false),
+  m_woken(false),
+  m_have_pr(false),
+  m_stats()
+{
+}
+//------------------------------------------------------------------
+oracle_fetcher::~oracle_fetcher()
+{
+  try { stop(); }
+  catch (...) { /* ignore */ }
+}
+//------------------------------------------------------------------
+void oracle_fetcher::start()
+{
+  boost::unique_lock<boost::mutex> lock(m_lock);
+  if (m_running)
+    return;
+  m_stop = false;
+  m_woken = true;
+  m_thread = boost::thread([this]() { run(); });
+  m_running = true;
+}
+//------------------------------------------------------------------
+void oracle_fetcher::stop()
+{
+  {
+    boost::unique_lock<boost::mutex> lock(m_lock);
+    if (!m_running)
+      return;
+    m_stop = true;
+  }
+  m_cond.notify_all();
+  if (m_thread.joinable())
+    m_thread.join();
+  m_running = false;
+}
+//------------------------------------------------------------------
+void oracle_fetcher::wake(uint64_t top_block_timestamp)
+{
+  {
+    boost::unique_lock<boost::mutex> lock(m_lock);
+    if (m_have_pr && m_pr.timestamp > top_block_timestamp)
+      return;
+    if (top_block_timestamp + NEAR_TIP_AGE < (uint64_t)time(NULL))
+      return;
+    const auto now = std::chrono::steady_clock::now();
+    if (m_last_wake != std::chrono::steady_clock::time_point() && now - m_last_wake < std::chrono::seconds(FETCH_INTERVAL))
+      return;
+    m_last_wake = now;
+    m_woken = true;
+  }
+  m_cond.notify_all();
+}
+//------------------------------------------------------------------
+bool oracle_fetcher::get_latest(oracle::pricing_record& pr) const
+{
+  boost::unique_lock<boost::mutex> lock(m_lock);
+  if (!m_have_pr)
+    return false;
+  pr = m_pr;
+  return true;
+}
+//------------------------------------------------------------------
+oracle_fetcher::stats_t oracle_fetcher::get_stats() const
+{
+  boost::unique_lock<boost::mutex> lock(m_lock);
+  return m_stats;
+}
+//------------------------------------------------------------------
+bool oracle_fetcher::fetch_pricing_record(network_type nettype, std::array<epee::net_utils::http::http_simple_client, 3>& clients, uint64_t timestamp, uint8_t hf_version, std::chrono::milliseconds timeout, oracle::pricing_record& pr)
+{
+  const std::array<std::string, 3> &oracle_urls = get_config(nettype).ORACLE_URLS;
+  const std::string url = "/price/?timestamp=" + boost::lexical_cast<std::string>(timestamp) + "&version=" + std::to_string(hf_version);
+  return fetch_from_any([&](size_t n, oracle::pricing_record& pr) {
+    epee::net_utils::http::http_simple_client &http_client = clients[n];
+    // set_server drops the connection, so only do it the first time to keep it alive between calls
+    if (http_client.get_host().empty())
+      http_client.set_server(oracle_urls[n], boost::none, epee::net_utils::ssl_support_t::e_ssl_support_autodetect);
+
+    COMMAND_RPC_GET_PRICING_RECORD::request req = AUTO_VAL_INIT(req);
+    COMMAND_RPC_GET_PRICING_RECORD::response res = AUTO_VAL_INIT(res);
+    if (!epee::net_utils::invoke_http_json(url, req, res, http_client, timeout, "GET"))
+    {
+      LOG_PRINT_L1("Failed to obtain pricing record from Oracle : " << oracle_urls[n]);
+      return false;
+    }
+    LOG_PRINT_L1("Obtained pricing record from Oracle : " << oracle_urls[n]);
+
+    if (!res.pr.verifySignature(get_config(nettype).ORACLE_PUBLIC_KEY))
+    {
+      LOG_PRINT_L0("Failed to verify signature of pricing record from Oracle : " << oracle_urls[n]);
+      return false;
+    }
+    pr = res.pr;
+    return true;
+  }, pr);
+}
+//------------------------------------------------------------------
+bool oracle_fetcher::fetch_from_any(const std::function<bool(size_t n, oracle::pricing_record& pr)>& fetch_from, oracle::pricing_record& pr)
+{
+  std::array<size_t, 3> order;
+  std::iota(order.begin(), order.end(), 0);
+  std::shuffle(order.begin(), order.end(), std::default_random_engine(crypto::rand<unsigned>()));
+  for (size_t n: order)
+    if (fetch_from(n, pr))
+      return true;
+  return false;
+}
+//------------------------------------------------------------------
+void oracle_fetcher::fetch_once()
+{
+  const uint8_t hf_version = m_get_hf_version();
+  if (hf_version < HF_VERSION_DJED)
+    return;
+
+  const auto start = std::chrono::steady_clock::now();
+  oracle::pricing_record pr;
+  bool r = false;
+  try
+  {
+    r = m_fetch(time(NULL), hf_version, pr);
+  }
+  catch (const std::exception &e)
+  {
+    MERROR("Exception fetching pricing record: " << e.what());
+  }
+  const uint64_t latency = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+  boost::unique_lock<boost::mutex> lock(m_lock);
+  m_stats.last_latency_ms = latency;
+  m_stats.max_latency_ms = std::max(m_stats.max_latency_ms, latency);
+  if (r)
+  {
+    ++m_stats.fetches;
+    m_stats.last_success_time = time(NULL);
+    // never replace a record with an older one
+    if (!m_have_pr || pr.timestamp >= m_pr.timestamp)
+    {
+      m_pr = pr;
+      m_have_pr = true;
+    }
+    MDEBUG("Fetched pricing record with timestamp " << pr.timestamp << " in " << latency << " ms");
+  }
+  else
+  {
+    ++m_stats.failures;
+    const uint64_t age = m_stats.last_success_time ? time(NULL) - m_stats.last_success_time : 0;
+    MWARNING("Failed to fetch pricing record from any Oracle after " << latency << " ms" << (age ? ", last success " + std::to_string(age) + " seconds ago" : ""));
+  }
+}
+//------------------------------------------------------------------
+void oracle_fetcher::run()
+{
+  MDEBUG("Oracle fetcher started");
+  while (1)
+  {
+    {
+      boost::unique_lock<boost::mutex> lock(m_lock);
+      if (!m_woken && !m_stop)
+        m_cond.wait_for(lock, boost::chrono::seconds(FETCH_INTERVAL), [this]() { return m_woken || m_stop; });
+      if (m_stop)
+        break;
+      m_woken = false;
+    }
+    fetch_once();
+  }
+  MDEBUG("Oracle fetcher stopped");
+}
+//------------------------------------------------------------------
+}
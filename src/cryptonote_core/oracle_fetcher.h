@@ -0,0 +1,168 @@
+// Copyright (c) 2023, Zephyr Protocol
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "cryptonote_config.h"
+#include "net/http_client.h"
+#include "oracle/pricing_record.h"
+
+namespace cryptonote
+{
+  /**
+   * @brief background poller for the oracle pricing record
+   *
+   * Polls the network's ORACLE_URLS on a timer from its own thread, keeping
+   * one connection per oracle alive between polls, and verifies the oracle
+   * signature before publishing a record.  Readers get the freshest verified
+   * record without touching the network.
+   *
+   * Published records only carry the oracle fields (spot, moving average,
+   * timestamp and signature); the stable and reserve prices depend on the
+   * circulating supply and are left to the caller.
+   */
+  class oracle_fetcher
+  {
+  public:
+    struct stats_t
+    {
+      uint64_t fetches; //!< successful fetches
+      uint64_t failures; //!< failed fetches, including bad signatures
+      uint64_t last_latency_ms; //!< duration of the last fetch attempt
+      uint64_t max_latency_ms; //!< longest fetch attempt seen
+      uint64_t last_success_time; //!< unix time of the last successful fetch, 0 if none
+    };
+
+    //! fetches and verifies a record for the given time and hard fork version
+    typedef std::function<bool(uint64_t timestamp, uint8_t hf_version, oracle::pricing_record& pr)> fetch_t;
+
+    //! seconds between two polls, and the least time between two wake ups
+    static constexpr const uint64_t FETCH_INTERVAL = 10;
+    //! per oracle timeout for the background poll
+    static constexpr const uint64_t FETCH_TIMEOUT = 5;
+    //! blocks older than this many seconds are taken as synced, not mined
+    static constexpr const uint64_t NEAR_TIP_AGE = 30 * 60;
+
+    oracle_fetcher(network_type nettype, std::function<uint8_t()> get_hf_version);
+
+    /**
+     * @brief polls with the given function rather than the network's oracles
+     */
+    oracle_fetcher(std::function<uint8_t()> get_hf_version, fetch_t fetch);
+    ~oracle_fetcher();
+
+    /**
+     * @brief starts the polling thread, does nothing if already running
+     */
+    void start();
+
+    /**
+     * @brief stops the polling thread, waiting for an in flight fetch to time out
+     */
+    void stop();
+
+    bool is_running() const { return m_running; }
+
+    /**
+     * @brief asks the polling thread to fetch a new record right away
+     *
+     * Used when a new block makes the cached record too old to be included.
+     * Does nothing if the cached record is still newer than the block, if
+     * the block is older than NEAR_TIP_AGE, as while syncing, or if the
+     * thread was already woken up less than FETCH_INTERVAL ago.
+     *
+     * @param top_block_timestamp the timestamp of the new top block
+     */
+    void wake(uint64_t top_block_timestamp);
+
+    /**
+     * @brief gets the freshest verified record
+     *
+     * @return false if no record was fetched yet
+     */
+    bool get_latest(oracle::pricing_record& pr) const;
+
+    stats_t get_stats() const;
+
+    /**
+     * @brief fetches and verifies a record from the first oracle that answers
+     *
+     * @param nettype the network whose oracle public key is used
+     * @param clients one client per entry of ORACLE_URLS, connected on first use
+     * @param timestamp the time to request a record for
+     * @param hf_version the hard fork version to pass to the oracle
+     * @param timeout the per oracle timeout
+     * @param pr return-by-reference the verified record
+     *
+     * @return false if no oracle answered with a correctly signed record
+     */
+    static bool fetch_pricing_record(network_type nettype, std::array<epee::net_utils::http::http_simple_client, 3>& clients, uint64_t timestamp, uint8_t hf_version, std::chrono::milliseconds timeout, oracle::pricing_record& pr);
+
+    /**
+     * @brief tries the oracles in a random order until one gives a record
+     *
+     * @param fetch_from fetches and verifies a record from the oracle with the given index
+     * @param pr return-by-reference the first record given
+     *
+     * @return false if none of the oracles gave one
+     */
+    static bool fetch_from_any(const std::function<bool(size_t n, oracle::pricing_record& pr)>& fetch_from, oracle::pricing_record& pr);
+
+  private:
+    void run();
+    void fetch_once();
+
+    const std::function<uint8_t()> m_get_hf_version;
+    const fetch_t m_fetch;
+
+    // only used by the polling thread
+    std::array<epee::net_utils::http::http_simple_client, 3> m_clients;
+
+    mutable boost::mutex m_lock;
+    boost::condition_variable m_cond;
+    boost::thread m_thread;
+    std::atomic<bool> m_running;
+    bool m_stop;
+    bool m_woken;
+    std::chrono::steady_clock::time_point m_last_wake;
+    bool m_have_pr;
+    oracle::pricing_record m_pr;
+    stats_t m_stats;
+  };
+}
@@ -0,0 +1,162 @@
+// Copyright (c) 2023, Zephyr Protocol
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <boost/thread/lock_guard.hpp>
+#include "cryptonote_basic/cryptonote_format_utils.h"
+#include "parsed_tx_cache.h"
+
+#undef MONERO_DEFAULT_LOG_CATEGORY
+#define MONERO_DEFAULT_LOG_CATEGORY "txpool"
+
+namespace
+{
+  // a parsed transaction takes roughly twice its serialized size once all
+  // the vectors of keys, signatures and range proofs are allocated
+  size_t estimate_parsed_size(size_t blob_size)
+  {
+    return sizeof(cryptonote::transaction) + 2 * blob_size;
+  }
+}
+
+namespace cryptonote
+{
+  //---------------------------------------------------------------------------------
+  parsed_tx_cache::parsed_tx_cache(size_t max_bytes):
+    m_max_bytes(max_bytes),
+    m_bytes(0),
+    m_hits(0),
+    m_misses(0),
+    m_evictions(0)
+  {
+  }
+  //---------------------------------------------------------------------------------
+  void parsed_tx_cache::set_max_bytes(size_t max_bytes)
+  {
+    boost::lock_guard<boost::mutex> lock(m_lock);
+    m_max_bytes = max_bytes;
+    evict_locked();
+  }
+  //---------------------------------------------------------------------------------
+  bool parsed_tx_cache::find(const crypto::hash &txid, bool pruned, transaction &tx)
+  {
+    std::shared_ptr<const transaction> cached;
+    {
+      boost::lock_guard<boost::mutex> lock(m_lock);
+      const auto i = m_entries.find(txid);
+      if (i == m_entries.end() || i->second->tx->pruned != pruned)
+      {
+        ++m_misses;
+        return false;
+      }
+      m_lru.splice(m_lru.begin(), m_lru, i->second);
+      cached = i->second->tx;
+      ++m_hits;
+    }
+    tx = *cached;
+    return true;
+  }
+  //---------------------------------------------------------------------------------
+  bool parsed_tx_cache::get(const crypto::hash &txid, const blobdata_ref &blob, bool pruned, transaction &tx)
+  {
+    if (find(txid, pruned, tx))
+      return true;
+
+    if (!(pruned ? parse_and_validate_tx_base_from_blob(blob, tx) : parse_and_validate_tx_from_blob(blob, tx)))
+      return false;
+    tx.set_hash(txid);
+
+    boost::lock_guard<boost::mutex> lock(m_lock);
+    if (m_max_bytes)
+      insert_locked(txid, std::make_shared<const transaction>(tx), blob.size());
+    return true;
+  }
+  //---------------------------------------------------------------------------------
+  void parsed_tx_cache::insert(const crypto::hash &txid, const transaction &tx, size_t blob_size)
+  {
+    boost::lock_guard<boost::mutex> lock(m_lock);
+    if (m_max_bytes)
+      insert_locked(txid, std::make_shared<const transaction>(tx), blob_size);
+  }
+  //---------------------------------------------------------------------------------
+  void parsed_tx_cache::insert_locked(const crypto::hash &txid, std::shared_ptr<const transaction> tx, size_t blob_size)
+  {
+    const size_t bytes = estimate_parsed_size(blob_size);
+    const auto i = m_entries.find(txid);
+    if (i != m_entries.end())
+    {
+      m_bytes -= i->second->bytes;
+      i->second->tx = std::move(tx);
+      i->second->bytes = bytes;
+      m_lru.splice(m_lru.begin(), m_lru, i->second);
+    }
+    else
+    {
+      m_lru.push_front({txid, std::move(tx), bytes});
+      m_entries.emplace(txid, m_lru.begin());
+    }
+    m_bytes += bytes;
+    evict_locked();
+  }
+  //---------------------------------------------------------------------------------
+  void parsed_tx_cache::evict_locked()
+  {
+    while (m_bytes > m_max_bytes && !m_lru.empty())
+    {
+      const entry &e = m_lru.back();
+      m_bytes -= e.bytes;
+      m_entries.erase(e.txid);
+      m_lru.pop_back();
+      ++m_evictions;
+    }
+  }
+  //---------------------------------------------------------------------------------
+  void parsed_tx_cache::remove(const crypto::hash &txid)
+  {
+    boost::lock_guard<boost::mutex> lock(m_lock);
+    const auto i = m_entries.find(txid);
+    if (i == m_entries.end())
+      return;
+    m_bytes -= i->second->bytes;
+    m_lru.erase(i->second);
+    m_entries.erase(i);
+  }
+  //---------------------------------------------------------------------------------
+  void parsed_tx_cache::clear()
+  {
+    boost::lock_guard<boost::mutex> lock(m_lock);
+    m_lru.clear();
+    m_entries.clear();
+    m_bytes = 0;
+  }
+  //---------------------------------------------------------------------------------
+  parsed_tx_cache::stats parsed_tx_cache::get_stats() const
+  {
+    boost::lock_guard<boost::mutex> lock(m_lock);
+    return {m_hits, m_misses, m_evictions, m_entries.size(), m_bytes, m_max_bytes};
+  }
+}
@@ -0,0 +1,125 @@
+// Copyright (c) 2023, Zephyr Protocol
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <boost/thread/mutex.hpp>
+#include "crypto/hash.h"
+#include "cryptonote_basic/blobdatatype.h"
+#include "cryptonote_basic/cryptonote_basic.h"
+
+namespace cryptonote
+{
+  /**
+   * @brief size bounded LRU cache of parsed pool transactions
+   *
+   * Parsing a pool blob is done repeatedly by validation, block template
+   * building and the RPC pool listings. This cache keeps the parsed
+   * transaction (with its hash memoized) keyed by txid, and evicts the
+   * least recently used entries once the approximate memory use goes
+   * above the configured budget. A budget of 0 disables caching.
+   */
+  class parsed_tx_cache
+  {
+  public:
+    struct stats
+    {
+      uint64_t hits;
+      uint64_t misses;
+      uint64_t evictions;
+      uint64_t entries;
+      uint64_t bytes;
+      uint64_t max_bytes;
+    };
+
+    explicit parsed_tx_cache(size_t max_bytes = 0);
+
+    /**
+     * @brief sets the memory budget, evicting entries as needed
+     */
+    void set_max_bytes(size_t max_bytes);
+
+    /**
+     * @brief gets a parsed transaction, parsing and caching the blob on a miss
+     *
+     * @param txid the transaction hash
+     * @param blob the transaction blob, as stored in the pool
+     * @param pruned whether the blob is pruned
+     * @param tx return-by-reference the parsed transaction
+     *
+     * @return false if the blob failed to parse, true otherwise
+     */
+    bool get(const crypto::hash &txid, const blobdata_ref &blob, bool pruned, transaction &tx);
+
+    /**
+     * @brief gets a parsed transaction if it is cached
+     *
+     * @return true if the transaction was found, false otherwise
+     */
+    bool find(const crypto::hash &txid, bool pruned, transaction &tx);
+
+    /**
+     * @brief adds an already parsed transaction
+     *
+     * @param txid the transaction hash
+     * @param tx the parsed transaction
+     * @param blob_size the size of the transaction blob, used to estimate memory use
+     */
+    void insert(const crypto::hash &txid, const transaction &tx, size_t blob_size);
+
+    void remove(const crypto::hash &txid);
+    void clear();
+
+    stats get_stats() const;
+
+  private:
+    struct entry
+    {
+      crypto::hash txid;
+      std::shared_ptr<const transaction> tx;
+      size_t bytes;
+    };
+    typedef std::list<entry> lru_list;
+
+    void insert_locked(const crypto::hash &txid, std::shared_ptr<const transaction> tx, size_t blob_size);
+    void evict_locked();
+
+    mutable boost::mutex m_lock;
+    lru_list m_lru; //!< most recently used first
+    std::unordered_map<crypto::hash, lru_list::iterator> m_entries;
+    size_t m_max_bytes;
+    size_t m_bytes;
+    uint64_t m_hits;
+    uint64_t m_misses;
+    uint64_t m_evictions;
+  };
+}
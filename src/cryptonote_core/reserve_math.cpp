@@ -0,0 +1,210 @@
+// Copyright (c) 2023, Zephyr Protocol
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <limits>
+#include <boost/multiprecision/cpp_bin_float.hpp>
+#include "int-util.h"
+#include "misc_log_ex.h"
+#include "cryptonote_config.h"
+#include "reserve_math.h"
+
+#undef MONERO_DEFAULT_LOG_CATEGORY
+#define MONERO_DEFAULT_LOG_CATEGORY "cn"
+
+namespace multiprecision = boost::multiprecision;
+
+namespace
+{
+  const uint64_t PRICE_R_MIN = 500000000000;
+
+  // Each cpp_bin_float_quad operation rounds to 113 bits and the computations
+  // below chain at most a handful of them, so the float result is within
+  // 2^-100 of the magnitudes involved. Integer results closer than that to a
+  // threshold or rounding step are handed to the float code to decide.
+  const unsigned QUAD_ERROR_SHIFT = 100;
+
+  bool fits_uint64(const multiprecision::uint128_t& v)
+  {
+    return v <= std::numeric_limits<uint64_t>::max();
+  }
+}
+
+namespace cryptonote
+{
+namespace reserve_math
+{
+  //---------------------------------------------------------------
+  int compare_reserve_ratio(const multiprecision::uint128_t& assets, const multiprecision::uint128_t& liabilities, uint64_t price, uint64_t threshold)
+  {
+    if (fits_uint64(assets) && fits_uint64(liabilities) && threshold <= std::numeric_limits<uint64_t>::max() / COIN)
+    {
+      // ratio vs threshold is assets * price vs threshold * liabilities * COIN
+      uint64_t x_hi, y_hi;
+      const uint64_t x_lo = mul128(assets.convert_to<uint64_t>(), price, &x_hi);
+      const uint64_t y_lo = mul128(liabilities.convert_to<uint64_t>(), threshold * COIN, &y_hi);
+
+      const bool above = x_hi > y_hi || (x_hi == y_hi && x_lo >= y_lo);
+      uint64_t d_hi, d_lo;
+      if (above)
+      {
+        d_lo = x_lo - y_lo;
+        d_hi = x_hi - y_hi - (x_lo < y_lo);
+      }
+      else
+      {
+        d_lo = y_lo - x_lo;
+        d_hi = y_hi - x_hi - (y_lo < x_lo);
+      }
+      // the float ratio is off by a relative error, ie by a fraction of x
+      const uint64_t tolerance = (x_hi >> (QUAD_ERROR_SHIFT - 64)) + 1;
+      if (d_hi != 0 || d_lo > tolerance)
+        return above ? 1 : -1;
+    }
+    else if (threshold <= std::numeric_limits<uint64_t>::max() / COIN)
+    {
+      const multiprecision::uint256_t x = multiprecision::uint256_t(assets) * price;
+      const multiprecision::uint256_t y = multiprecision::uint256_t(liabilities) * (threshold * COIN);
+      const multiprecision::uint256_t tolerance = (x >> QUAD_ERROR_SHIFT) + 1;
+      if (x > y + tolerance)
+        return 1;
+      if (x + tolerance < y)
+        return -1;
+    }
+    return compare_reserve_ratio_quad(assets, liabilities, price, threshold);
+  }
+  //---------------------------------------------------------------
+  int compare_reserve_ratio_quad(const multiprecision::uint128_t& assets, const multiprecision::uint128_t& liabilities, uint64_t price, uint64_t threshold)
+  {
+    multiprecision::cpp_bin_float_quad assets_float = assets.convert_to<multiprecision::cpp_bin_float_quad>();
+    assets_float *= price;
+    multiprecision::cpp_bin_float_quad reserve_ratio = assets_float / liabilities.convert_to<multiprecision::cpp_bin_float_quad>();
+    reserve_ratio /= COIN;
+
+    if (reserve_ratio < threshold)
+      return -1;
+    if (reserve_ratio > threshold)
+      return 1;
+    return 0;
+  }
+  //---------------------------------------------------------------
+  double reserve_ratio_quad(const multiprecision::uint128_t& assets, const multiprecision::uint128_t& liabilities, uint64_t price)
+  {
+    multiprecision::cpp_bin_float_quad assets_float = assets.convert_to<multiprecision::cpp_bin_float_quad>();
+    assets_float *= price;
+    multiprecision::cpp_bin_float_quad reserve_ratio = assets_float / liabilities.convert_to<multiprecision::cpp_bin_float_quad>();
+    reserve_ratio /= COIN;
+    return reserve_ratio.convert_to<double>();
+  }
+  //---------------------------------------------------------------
+  uint64_t reserve_coin_price(const multiprecision::uint128_t& zeph_reserve, const multiprecision::uint128_t& num_stables, const multiprecision::uint128_t& num_reserves, uint64_t exchange_rate)
+  {
+    if (exchange_rate <= 0) return 0;
+
+    if (num_reserves == 0) {
+      MDEBUG("No reserve amount detected. Using price_r_min..");
+      return PRICE_R_MIN;
+    }
+
+    // price = (zeph_reserve - num_stables * COIN / rate) * COIN / num_reserves
+    //       = (zeph_reserve * rate - num_stables * COIN) * COIN / (rate * num_reserves)
+    // and everything below is a numerator over that denominator
+    const multiprecision::uint256_t zx = multiprecision::uint256_t(zeph_reserve) * exchange_rate;
+    const multiprecision::uint256_t sc = multiprecision::uint256_t(num_stables) * COIN;
+    const multiprecision::uint256_t den = multiprecision::uint256_t(num_reserves) * exchange_rate;
+    const multiprecision::uint256_t error_base = (zx + sc) * COIN * 2;
+
+    if (zx < sc)
+    {
+      const multiprecision::uint256_t num = (sc - zx) * COIN;
+      const multiprecision::uint256_t tolerance = ((error_base + num) >> QUAD_ERROR_SHIFT) + 1;
+      if (num > tolerance)
+        return PRICE_R_MIN;
+    }
+    else
+    {
+      const multiprecision::uint256_t num = (zx - sc) * COIN;
+      const multiprecision::uint256_t tolerance = ((error_base + num) >> QUAD_ERROR_SHIFT) + 1;
+      const multiprecision::uint256_t limit = multiprecision::uint256_t(std::numeric_limits<uint64_t>::max()) * den;
+      if (num > tolerance && num > limit + tolerance)
+      {
+        MWARNING("overflow detected in reserve coin price calculation.");
+        return 0;
+      }
+      if (num > tolerance && num + tolerance < limit)
+      {
+        // the price is rounded down to a multiple of 10000, so it is only
+        // in doubt next to one
+        const multiprecision::uint256_t q = num / den;
+        const multiprecision::uint256_t step_offset = (q % 10000) * den + (num - q * den);
+        if (step_offset > tolerance && 10000 * den - step_offset > tolerance)
+        {
+          uint64_t reserve_coin_price = q.convert_to<uint64_t>();
+          reserve_coin_price -= (reserve_coin_price % 10000);
+          return std::max(reserve_coin_price, PRICE_R_MIN);
+        }
+      }
+    }
+    return reserve_coin_price_quad(zeph_reserve, num_stables, num_reserves, exchange_rate);
+  }
+  //---------------------------------------------------------------
+  uint64_t reserve_coin_price_quad(const multiprecision::uint128_t& zeph_reserve, const multiprecision::uint128_t& num_stables, const multiprecision::uint128_t& num_reserves, uint64_t exchange_rate)
+  {
+    if (exchange_rate <= 0) return 0;
+
+    if (num_reserves == 0) {
+      MDEBUG("No reserve amount detected. Using price_r_min..");
+      return PRICE_R_MIN;
+    }
+
+    multiprecision::cpp_bin_float_quad assets = zeph_reserve.convert_to<multiprecision::cpp_bin_float_quad>();
+    multiprecision::cpp_bin_float_quad liabilities = num_stables.convert_to<multiprecision::cpp_bin_float_quad>();
+
+    liabilities *= COIN;
+    liabilities /= exchange_rate;
+
+    multiprecision::cpp_bin_float_quad equity = assets - liabilities;
+
+    if (equity < 0) {
+      return PRICE_R_MIN;
+    }
+
+    equity *= COIN;
+    multiprecision::cpp_bin_float_quad reserve_coin_price_float = equity / num_reserves.convert_to<multiprecision::cpp_bin_float_quad>();
+
+    if (reserve_coin_price_float > std::numeric_limits<uint64_t>::max()) {
+      MWARNING("overflow detected in reserve coin price calculation.");
+      return 0;
+    }
+
+    uint64_t reserve_coin_price = reserve_coin_price_float.convert_to<uint64_t>();
+    reserve_coin_price -= (reserve_coin_price % 10000);
+
+    return std::max(reserve_coin_price, PRICE_R_MIN);
+  }
+}
+}
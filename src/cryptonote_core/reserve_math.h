@@ -0,0 +1,67 @@
+// Copyright (c) 2023, Zephyr Protocol
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <cstdint>
+#include <boost/multiprecision/cpp_int.hpp>
+
+namespace cryptonote
+{
+  /**
+   * Reserve ratio and reserve coin price arithmetic.
+   *
+   * Consensus has always computed these in cpp_bin_float_quad. The functions
+   * here get the same answers with 128/256 bit integer arithmetic, and only
+   * fall back to cpp_bin_float_quad when the exact result is so close to a
+   * threshold or a rounding step that the float rounding could decide it.
+   * The *_quad variants are the original computations, kept as that fallback
+   * and as the reference the integer paths are tested against.
+   */
+  namespace reserve_math
+  {
+    /**
+     * @brief compares assets * price / liabilities / COIN against threshold
+     *
+     * @return -1, 0 or 1 as the ratio is below, at or above the threshold
+     */
+    int compare_reserve_ratio(const boost::multiprecision::uint128_t& assets, const boost::multiprecision::uint128_t& liabilities, uint64_t price, uint64_t threshold);
+    int compare_reserve_ratio_quad(const boost::multiprecision::uint128_t& assets, const boost::multiprecision::uint128_t& liabilities, uint64_t price, uint64_t threshold);
+
+    /**
+     * @brief assets * price / liabilities / COIN, for display and error messages
+     */
+    double reserve_ratio_quad(const boost::multiprecision::uint128_t& assets, const boost::multiprecision::uint128_t& liabilities, uint64_t price);
+
+    /**
+     * @brief price of a reserve coin in atomic ZEPH at the given exchange rate
+     */
+    uint64_t reserve_coin_price(const boost::multiprecision::uint128_t& zeph_reserve, const boost::multiprecision::uint128_t& num_stables, const boost::multiprecision::uint128_t& num_reserves, uint64_t exchange_rate);
+    uint64_t reserve_coin_price_quad(const boost::multiprecision::uint128_t& zeph_reserve, const boost::multiprecision::uint128_t& num_stables, const boost::multiprecision::uint128_t& num_reserves, uint64_t exchange_rate);
+  }
+}
@@ -123,7 +123,7 @@ namespace cryptonote
   }
   //---------------------------------------------------------------------------------
   //---------------------------------------------------------------------------------
-  tx_memory_pool::tx_memory_pool(Blockchain& bchs): m_blockchain(bchs), m_cookie(0), m_txpool_max_weight(DEFAULT_TXPOOL_MAX_WEIGHT), m_txpool_weight(0), m_mine_stem_txes(false), m_next_check(std::time(nullptr))
+  tx_memory_pool::tx_memory_pool(Blockchain& bchs): m_blockchain(bchs), m_cookie(0), m_meta_cookie(0), m_txpool_max_weight(DEFAULT_TXPOOL_MAX_WEIGHT), m_txpool_weight(0), m_mine_stem_txes(false), m_conversion_index_height(0), m_next_check(std::time(nullptr))
   {
     // class code expects unsigned values throughout
     if (m_next_check < time_t(0))
@@ -233,14 +233,12 @@ namespace cryptonote
       }
       if(tvc.pr.empty() || tvc.pr.has_missing_rates()) {
         // Get the pricing record that was used for conversion
-        block bl;
-        bool r = m_blockchain.get_block_by_hash(m_blockchain.get_block_id_by_height(tx.pricing_record_height), bl);
+        bool r = m_blockchain.get_block_pricing_record(tx.pricing_record_height, tvc.pr);
         if (!r) {
           LOG_ERROR("error: failed to get block containing pricing record");
           tvc.m_verifivation_failed = true;
           return false;
         }
-        tvc.pr = bl.pricing_record;
       }
 
       if (tvc.pr.empty() || tvc.pr.has_missing_rates()) {
@@ -336,6 +334,7 @@ namespace cryptonote
     uint64_t max_used_block_height = 0;
     cryptonote::txpool_tx_meta_t meta{};
     strcpy(meta.fee_asset_type, source.c_str());
+    meta.tx_type = (uint8_t)tx_type;
     bool ch_inp_res = check_tx_inputs([&tx]()->cryptonote::transaction&{ return tx; }, id, max_used_block_height, max_used_block_id, tvc, kept_by_block);
     if(!ch_inp_res)
     {
@@ -360,12 +359,14 @@ namespace cryptonote
         try
         {
           if (kept_by_block)
-            m_parsed_tx_cache.insert(std::make_pair(id, tx));
+            m_parsed_tx_cache.insert(id, tx, blob.size());
           CRITICAL_REGION_LOCAL1(m_blockchain);
           LockedTXN lock(m_blockchain.get_db());
           if (!insert_key_images(tx, id, tx_relay))
             return false;
 
+          if (source != dest)
+            add_to_conversion_index({id, tx_type, tx.pricing_record_height, tx.amount_burnt, tx.amount_minted, conversion_status::eligible}, meta);
           m_blockchain.add_txpool_tx(id, blob, meta);
 
           uint64_t fee_in_zeph = 0;
@@ -377,6 +378,7 @@ namespace cryptonote
 
           fee_in_zeph = fee_in_zeph ? fee_in_zeph : get_fee_in_zeph_equivalent(meta.fee_asset_type, meta.fee, tvc.pr);
           add_tx_to_transient_lists(id, fee_in_zeph / (double)(tx_weight ? tx_weight : 1), receive_time);
+          m_fee_histogram.add(id, meta.fee_asset_type, meta.fee, meta.weight, meta.matches(relay_category::broadcasted));
           lock.commit();
         }
         catch (const std::exception &e)
@@ -398,7 +400,7 @@ namespace cryptonote
       try
       {
         if (kept_by_block)
-          m_parsed_tx_cache.insert(std::make_pair(id, tx));
+          m_parsed_tx_cache.insert(id, tx, blob.size());
         CRITICAL_REGION_LOCAL1(m_blockchain);
         LockedTXN lock(m_blockchain.get_db());
 
@@ -445,6 +447,8 @@ namespace cryptonote
           if (!insert_key_images(tx, id, tx_relay))
             return false;
 
+          if (source != dest)
+            add_to_conversion_index({id, tx_type, tx.pricing_record_height, tx.amount_burnt, tx.amount_minted, conversion_status::eligible}, meta);
           m_blockchain.remove_txpool_tx(id);
           m_blockchain.add_txpool_tx(id, blob, meta);
 
@@ -458,6 +462,7 @@ namespace cryptonote
 
           fee_in_zeph = fee_in_zeph ? fee_in_zeph : get_fee_in_zeph_equivalent(meta.fee_asset_type, meta.fee, tvc.pr);
           add_tx_to_transient_lists(id, fee_in_zeph / (double)(tx_weight ? tx_weight : 1), receive_time);
+          m_fee_histogram.add(id, meta.fee_asset_type, meta.fee, meta.weight, meta.matches(relay_category::broadcasted));
         }
         lock.commit();
       }
@@ -662,20 +667,11 @@ namespace cryptonote
         return false;
       }
       txblob = m_blockchain.get_txpool_tx_blob(id, relay_category::all);
-      auto ci = m_parsed_tx_cache.find(id);
-      if (ci != m_parsed_tx_cache.end())
-      {
-        tx = ci->second;
-      }
-      else if (!(meta.pruned ? parse_and_validate_tx_base_from_blob(txblob, tx) : parse_and_validate_tx_from_blob(txblob, tx)))
+      if (!m_parsed_tx_cache.get(id, txblob, meta.pruned, tx))
       {
         MERROR("Failed to parse tx from txpool");
         return false;
       }
-      else
-      {
-        tx.set_hash(id);
-      }
       tx_weight = meta.weight;
       fee = meta.fee;
       fee_asset_type = meta.fee_asset_type;
@@ -723,20 +719,11 @@ namespace cryptonote
         return false;
       }
       cryptonote::blobdata txblob = m_blockchain.get_txpool_tx_blob(txid, relay_category::all);
-      auto ci = m_parsed_tx_cache.find(txid);
-      if (ci != m_parsed_tx_cache.end())
-      {
-        td.tx = ci->second;
-      }
-      else if (!(meta.pruned ? parse_and_validate_tx_base_from_blob(txblob, td.tx) : parse_and_validate_tx_from_blob(txblob, td.tx)))
+      if (!m_parsed_tx_cache.get(txid, txblob, meta.pruned, td.tx))
       {
         MERROR("Failed to parse tx from txpool");
         return false;
       }
-      else
-      {
-        td.tx.set_hash(txid);
-      }
       td.blob_size = txblob.size();
       td.weight = meta.weight;
       td.fee = meta.fee;
@@ -845,7 +832,7 @@ namespace cryptonote
       // Users doesn't need to wait 24 hours for it to passt the pool tx life time, especially if they want to convert their assets.
       bool invalid_pr = false;
       cryptonote::transaction tx;
-      if (!parse_and_validate_tx_from_blob(*bd, tx))
+      if (!m_parsed_tx_cache.get(txid, *bd, false, tx))
       {
         MERROR("Failed to parse tx from txpool");
         invalid_pr = true;
@@ -977,7 +964,7 @@ namespace cryptonote
          unnecessary, but is primarily a precaution against potential changes
 	 to the callback routines. */
       elem.second.last_relayed_time = now + get_relay_delay(elem.second.last_relayed_time, elem.second.receive_time);
-      m_blockchain.update_txpool_tx(elem.first, elem.second);
+      update_txpool_tx(elem.first, elem.second);
     }
 
     m_next_check = time_t(next_check);
@@ -1016,13 +1003,16 @@ namespace cryptonote
           else
             meta.last_relayed_time = std::chrono::system_clock::to_time_t(now);
 
-          m_blockchain.update_txpool_tx(hash, meta);
+          update_txpool_tx(hash, meta);
           // wait until db update succeeds to ensure tx is visible in the pool
           was_just_broadcasted = !already_broadcasted && meta.matches(relay_category::broadcasted);
 
           if (was_just_broadcasted)
+          {
             // Make sure the tx gets re-added with an updated time
             add_tx_to_transient_lists(hash, meta.fee / (double)meta.weight, std::chrono::system_clock::to_time_t(now));
+            m_fee_histogram.add(hash, meta.fee_asset_type, meta.fee, meta.weight, true);
+          }
         }
       }
       catch (const std::exception &e)
@@ -1034,6 +1024,8 @@ namespace cryptonote
     }
     lock.commit();
     set_if_less(m_next_check, time_t(next_relay));
+    if (std::find(just_broadcasted.begin(), just_broadcasted.end(), true) != just_broadcasted.end())
+      ++m_cookie;
   }
   //---------------------------------------------------------------------------------
   size_t tx_memory_pool::get_transactions_count(bool include_sensitive) const
@@ -1049,15 +1041,14 @@ namespace cryptonote
     CRITICAL_REGION_LOCAL1(m_blockchain);
     const relay_category category = include_sensitive ? relay_category::all : relay_category::broadcasted;
     txs.reserve(m_blockchain.get_txpool_tx_count(include_sensitive));
-    m_blockchain.for_all_txpool_txes([&txs](const crypto::hash &txid, const txpool_tx_meta_t &meta, const cryptonote::blobdata_ref *bd){
+    m_blockchain.for_all_txpool_txes([this, &txs](const crypto::hash &txid, const txpool_tx_meta_t &meta, const cryptonote::blobdata_ref *bd){
       transaction tx;
-      if (!(meta.pruned ? parse_and_validate_tx_base_from_blob(*bd, tx) : parse_and_validate_tx_from_blob(*bd, tx)))
+      if (!m_parsed_tx_cache.get(txid, *bd, meta.pruned, tx))
       {
         MERROR("Failed to parse tx from txpool");
         // continue
         return true;
       }
-      tx.set_hash(txid);
       txs.push_back(std::move(tx));
       return true;
     }, true, category);
@@ -1065,14 +1056,92 @@ namespace cryptonote
   //------------------------------------------------------------------
   void tx_memory_pool::get_transaction_hashes(std::vector<crypto::hash>& txs, bool include_sensitive) const
   {
-    CRITICAL_REGION_LOCAL(m_transactions_lock);
-    CRITICAL_REGION_LOCAL1(m_blockchain);
-    const relay_category category = include_sensitive ? relay_category::all : relay_category::broadcasted;
-    txs.reserve(m_blockchain.get_txpool_tx_count(include_sensitive));
-    m_blockchain.for_all_txpool_txes([&txs](const crypto::hash &txid, const txpool_tx_meta_t &meta, const cryptonote::blobdata_ref *bd){
-      txs.push_back(txid);
+    const std::shared_ptr<const pool_snapshot> snapshot = get_snapshot();
+    txs.reserve(include_sensitive ? snapshot->txes.size() : snapshot->num_broadcasted);
+    for (const pool_snapshot::entry &e: snapshot->txes)
+      if (include_sensitive || !e.sensitive)
+        txs.push_back(e.id);
+  }
+  //------------------------------------------------------------------
+  std::shared_ptr<const tx_memory_pool::pool_snapshot> tx_memory_pool::get_snapshot() const
+  {
+    return m_snapshot.get(m_cookie, m_transactions_lock, [this](){ return build_snapshot(); });
+  }
+  //------------------------------------------------------------------
+  std::shared_ptr<const tx_memory_pool::pool_snapshot> tx_memory_pool::build_snapshot() const
+  {
+    // Called with m_transactions_lock held. Pool rows are only written under
+    // that lock, so the blockchain lock is not taken: a block being added
+    // must not hold up pool readers.
+    std::shared_ptr<pool_snapshot> snapshot = std::make_shared<pool_snapshot>();
+    snapshot->num_broadcasted = 0;
+    snapshot->txes.reserve(m_blockchain.get_txpool_tx_count(true));
+    m_blockchain.for_all_txpool_txes([&snapshot](const crypto::hash &txid, const txpool_tx_meta_t &meta, const cryptonote::blobdata_ref*){
+      const bool sensitive = !meta.matches(relay_category::broadcasted);
+      snapshot->txes.push_back({txid, meta.weight, meta.fee, meta.receive_time, sensitive});
+      if (!sensitive)
+        ++snapshot->num_broadcasted;
       return true;
-    }, false, category);
+    }, false, relay_category::all);
+    std::sort(snapshot->txes.begin(), snapshot->txes.end(), [](const pool_snapshot::entry &a, const pool_snapshot::entry &b){ return a.fee * b.weight > b.fee * a.weight; });
+    return snapshot;
+  }
+  //------------------------------------------------------------------
+  std::shared_ptr<const tx_memory_pool::pool_info_snapshot> tx_memory_pool::build_info_snapshot() const
+  {
+    // Called with m_transactions_lock held, see build_snapshot
+    std::shared_ptr<pool_info_snapshot> snapshot = std::make_shared<pool_info_snapshot>();
+    snapshot->txes.reserve(m_blockchain.get_txpool_tx_count(true));
+    m_blockchain.for_all_txpool_txes([this, &snapshot](const crypto::hash &txid, const txpool_tx_meta_t &meta, const cryptonote::blobdata_ref *bd){
+      tx_info txi;
+      txi.id_hash = epee::string_tools::pod_to_hex(txid);
+      txi.tx_blob = blobdata(bd->data(), bd->size());
+      transaction tx;
+      if (!m_parsed_tx_cache.get(txid, *bd, meta.pruned, tx))
+      {
+        MERROR("Failed to parse tx from txpool");
+        // continue
+        return true;
+      }
+      txi.tx_json = obj_to_json_str(tx);
+      txi.blob_size = bd->size();
+      txi.weight = meta.weight;
+      txi.fee = meta.fee;
+      txi.kept_by_block = meta.kept_by_block;
+      txi.max_used_block_height = meta.max_used_block_height;
+      txi.max_used_block_id_hash = epee::string_tools::pod_to_hex(meta.max_used_block_id);
+      txi.last_failed_height = meta.last_failed_height;
+      txi.last_failed_id_hash = epee::string_tools::pod_to_hex(meta.last_failed_id);
+      txi.receive_time = meta.receive_time;
+      txi.relayed = meta.relayed;
+      txi.last_relayed_time = meta.dandelionpp_stem ? 0 : meta.last_relayed_time;
+      txi.do_not_relay = meta.do_not_relay;
+      txi.double_spend_seen = meta.double_spend_seen;
+      snapshot->txes.push_back({std::move(txi), !meta.matches(relay_category::broadcasted)});
+      return true;
+    }, true, relay_category::all);
+
+    snapshot->key_images.reserve(m_spent_key_images.size());
+    for (const key_images_container::value_type& kee : m_spent_key_images) {
+      pool_info_snapshot::key_image_entry ki;
+      ki.id_hash = epee::string_tools::pod_to_hex(kee.first);
+      for (const crypto::hash& tx_id_hash : kee.second)
+      {
+        if (!m_blockchain.txpool_tx_matches_category(tx_id_hash, relay_category::all))
+          continue;
+        const bool sensitive = !m_blockchain.txpool_tx_matches_category(tx_id_hash, relay_category::broadcasted);
+        ki.txs.push_back(std::make_pair(epee::string_tools::pod_to_hex(tx_id_hash), sensitive));
+      }
+      if (!ki.txs.empty())
+        snapshot->key_images.push_back(std::move(ki));
+    }
+    return snapshot;
+  }
+  //------------------------------------------------------------------
+  void tx_memory_pool::update_txpool_tx(const crypto::hash &txid, const txpool_tx_meta_t &meta)
+  {
+    m_blockchain.update_txpool_tx(txid, meta);
+    ++m_meta_cookie;
   }
   //------------------------------------------------------------------
   bool tx_memory_pool::get_pool_info(time_t start_time, bool include_sensitive, size_t max_tx_count, std::vector<std::pair<crypto::hash, tx_details>>& added_txs, std::vector<crypto::hash>& remaining_added_txids, std::vector<crypto::hash>& removed_txs, bool& incremental) const
@@ -1152,15 +1221,12 @@ namespace cryptonote
   //------------------------------------------------------------------
   void tx_memory_pool::get_transaction_backlog(std::vector<tx_backlog_entry>& backlog, bool include_sensitive) const
   {
-    CRITICAL_REGION_LOCAL(m_transactions_lock);
-    CRITICAL_REGION_LOCAL1(m_blockchain);
+    const std::shared_ptr<const pool_snapshot> snapshot = get_snapshot();
     const uint64_t now = time(NULL);
-    const relay_category category = include_sensitive ? relay_category::all : relay_category::broadcasted;
-    backlog.reserve(m_blockchain.get_txpool_tx_count(include_sensitive));
-    m_blockchain.for_all_txpool_txes([&backlog, now](const crypto::hash &txid, const txpool_tx_meta_t &meta, const cryptonote::blobdata_ref *bd){
-      backlog.push_back({meta.weight, meta.fee, meta.receive_time - now});
-      return true;
-    }, false, category);
+    backlog.reserve(include_sensitive ? snapshot->txes.size() : snapshot->num_broadcasted);
+    for (const pool_snapshot::entry &e: snapshot->txes)
+      if (include_sensitive || !e.sensitive)
+        backlog.push_back({e.weight, e.fee, e.receive_time - now});
   }
   //------------------------------------------------------------------
   void tx_memory_pool::get_block_template_backlog(std::vector<tx_block_template_backlog_entry>& backlog, bool include_sensitive) const
@@ -1169,23 +1235,20 @@ namespace cryptonote
     CRITICAL_REGION_LOCAL1(m_blockchain);
 
     std::vector<tx_block_template_backlog_entry> tmp;
-    uint64_t total_weight = 0;
 
-    // First get everything from the mempool, filter it later
-    m_blockchain.for_all_txpool_txes([&tmp, &total_weight](const crypto::hash &txid, const txpool_tx_meta_t &meta, const cryptonote::blobdata_ref*){
-      tmp.emplace_back(tx_block_template_backlog_entry{txid, meta.weight, meta.fee});
-      total_weight += meta.weight;
-      return true;
-    }, false, include_sensitive ? relay_category::all : relay_category::broadcasted);
+    // First get everything from the mempool, filter it later. The snapshot
+    // is already ordered best paying first, so if the total weight is too
+    // high the loop below picks the best paying transactions.
+    const std::shared_ptr<const pool_snapshot> snapshot = get_snapshot();
+    tmp.reserve(include_sensitive ? snapshot->txes.size() : snapshot->num_broadcasted);
+    for (const pool_snapshot::entry &e: snapshot->txes)
+      if (include_sensitive || !e.sensitive)
+        tmp.emplace_back(tx_block_template_backlog_entry{e.id, e.weight, e.fee});
 
     // Limit backlog to 112.5% of current median weight. This is enough to mine a full block with the optimal block reward
     const uint64_t median_weight = m_blockchain.get_current_cumulative_block_weight_median();
     const uint64_t max_backlog_weight = median_weight + (median_weight / 8);
 
-    // If the total weight is too high, choose the best paying transactions
-    if (total_weight > max_backlog_weight)
-      std::sort(tmp.begin(), tmp.end(), [](const auto& a, const auto& b){ return a.fee * b.weight > b.fee * a.weight; });
-
     backlog.clear();
     uint64_t w = 0;
 
@@ -1224,6 +1287,110 @@ namespace cryptonote
     }
   }
   //------------------------------------------------------------------
+  void tx_memory_pool::get_conversions(std::vector<conversion_info>& conversions, bool include_sensitive) const
+  {
+    CRITICAL_REGION_LOCAL(m_transactions_lock);
+    CRITICAL_REGION_LOCAL1(m_blockchain);
+    conversions.clear();
+    conversions.reserve(m_conversions_by_pr_height.size());
+    for (const auto &e: m_conversions_by_pr_height)
+    {
+      if (!include_sensitive)
+      {
+        txpool_tx_meta_t meta;
+        if (!m_blockchain.get_txpool_tx_meta(e.second.txid, meta) || !meta.matches(relay_category::broadcasted))
+          continue;
+      }
+      conversions.push_back(e.second);
+    }
+  }
+  //---------------------------------------------------------------------------------
+  conversion_status tx_memory_pool::get_conversion_status(const conversion_info& conversion, uint64_t height, bool have_pr, const circ_supply_snapshot& circ_supply, const oracle::pricing_record& pr) const
+  {
+    if (conversion.pricing_record_height >= height)
+      return conversion_status::pr_too_new;
+    if (!tx_pr_height_valid(height, conversion.pricing_record_height, conversion.txid))
+      return conversion_status::pr_too_old;
+    if (!have_pr)
+      return conversion_status::no_pricing_record;
+    reserve_tally tally(circ_supply, pr);
+    if (!tally.can_add(conversion.tx_type, conversion.amount_burnt, conversion.amount_minted))
+      return conversion_status::reserve_ratio;
+    return conversion_status::eligible;
+  }
+  //---------------------------------------------------------------------------------
+  void tx_memory_pool::add_to_conversion_index(conversion_info conversion, txpool_tx_meta_t& meta)
+  {
+    oracle::pricing_record pr;
+    const bool have_pr = m_blockchain.get_latest_acceptable_pr(pr);
+    const circ_supply_snapshot circ_supply = m_blockchain.get_circulating_supply();
+    conversion.status = get_conversion_status(conversion, m_blockchain.get_current_blockchain_height(), have_pr, circ_supply, pr);
+    meta.conversion_status = (uint8_t)conversion.status;
+
+    remove_from_conversion_index(conversion.txid);
+    const conversion_index::iterator it = m_conversions_by_pr_height.emplace(conversion.pricing_record_height, conversion);
+    m_conversions_by_id[conversion.txid] = it;
+  }
+  //---------------------------------------------------------------------------------
+  void tx_memory_pool::remove_from_conversion_index(const crypto::hash& txid)
+  {
+    const auto it = m_conversions_by_id.find(txid);
+    if (it == m_conversions_by_id.end())
+      return;
+    m_conversions_by_pr_height.erase(it->second);
+    m_conversions_by_id.erase(it);
+  }
+  //---------------------------------------------------------------------------------
+  void tx_memory_pool::update_conversion_index(uint64_t height, bool full)
+  {
+    CRITICAL_REGION_LOCAL1(m_blockchain);
+    // records older than this were already too old at the last update, and
+    // only get older as the chain grows
+    const uint64_t prev_min_pr_height = m_conversion_index_height > PRICING_RECORD_VALID_BLOCKS ? m_conversion_index_height - PRICING_RECORD_VALID_BLOCKS : 0;
+    const bool incremental = !full && height >= m_conversion_index_height;
+    m_conversion_index_height = height;
+    if (m_conversions_by_pr_height.empty())
+      return;
+
+    oracle::pricing_record pr;
+    const bool have_pr = m_blockchain.get_latest_acceptable_pr(pr);
+    const circ_supply_snapshot circ_supply = m_blockchain.get_circulating_supply();
+
+    std::vector<std::pair<crypto::hash, conversion_status>> changed;
+    auto it = incremental ? m_conversions_by_pr_height.lower_bound(prev_min_pr_height) : m_conversions_by_pr_height.begin();
+    for (; it != m_conversions_by_pr_height.end(); ++it)
+    {
+      conversion_info &conversion = it->second;
+      const conversion_status status = get_conversion_status(conversion, height, have_pr, circ_supply, pr);
+      if (status != conversion.status)
+      {
+        conversion.status = status;
+        changed.push_back(std::make_pair(conversion.txid, status));
+      }
+    }
+    if (changed.empty())
+      return;
+
+    MDEBUG("Conversion status changed for " << changed.size() << "/" << m_conversions_by_pr_height.size() << " pool conversions at height " << height);
+    try
+    {
+      LockedTXN lock(m_blockchain.get_db());
+      for (const auto &e: changed)
+      {
+        txpool_tx_meta_t meta;
+        if (!m_blockchain.get_txpool_tx_meta(e.first, meta))
+          continue;
+        meta.conversion_status = (uint8_t)e.second;
+        update_txpool_tx(e.first, meta);
+      }
+      lock.commit();
+    }
+    catch (const std::exception &e)
+    {
+      MERROR("Failed to update conversion status in txpool: " << e.what());
+    }
+  }
+  //---------------------------------------------------------------------------------
   void tx_memory_pool::get_transaction_stats(struct txpool_stats& stats, bool include_sensitive) const
   {
     CRITICAL_REGION_LOCAL(m_transactions_lock);
@@ -1258,6 +1425,11 @@ namespace cryptonote
       return true;
     }, false, category);
 
+    const parsed_tx_cache::stats cache_stats = m_parsed_tx_cache.get_stats();
+    stats.parsed_cache_hits = cache_stats.hits;
+    stats.parsed_cache_misses = cache_stats.misses;
+    stats.parsed_cache_bytes = cache_stats.bytes;
+
     stats.bytes_med = epee::misc_utils::median(weights);
     if (stats.txs_total > 1)
     {
@@ -1310,57 +1482,48 @@ namespace cryptonote
     }
   }
   //------------------------------------------------------------------
+  std::map<std::string, fee_histogram::buckets> tx_memory_pool::get_fee_histogram(bool include_sensitive) const
+  {
+    CRITICAL_REGION_LOCAL(m_transactions_lock);
+    return m_fee_histogram.get(include_sensitive);
+  }
+  //------------------------------------------------------------------
+  parsed_tx_cache::stats tx_memory_pool::get_parsed_tx_cache_stats() const
+  {
+    return m_parsed_tx_cache.get_stats();
+  }
+  //------------------------------------------------------------------
   //TODO: investigate whether boolean return is appropriate
   bool tx_memory_pool::get_transactions_and_spent_keys_info(std::vector<tx_info>& tx_infos, std::vector<spent_key_image_info>& key_image_infos, bool include_sensitive_data) const
   {
-    CRITICAL_REGION_LOCAL(m_transactions_lock);
-    CRITICAL_REGION_LOCAL1(m_blockchain);
-    const relay_category category = include_sensitive_data ? relay_category::all : relay_category::broadcasted;
-    const size_t count = m_blockchain.get_txpool_tx_count(include_sensitive_data);
-    tx_infos.reserve(count);
-    key_image_infos.reserve(count);
-    m_blockchain.for_all_txpool_txes([&tx_infos, key_image_infos, include_sensitive_data](const crypto::hash &txid, const txpool_tx_meta_t &meta, const cryptonote::blobdata_ref *bd){
-      tx_info txi;
-      txi.id_hash = epee::string_tools::pod_to_hex(txid);
-      txi.tx_blob = blobdata(bd->data(), bd->size());
-      transaction tx;
-      if (!(meta.pruned ? parse_and_validate_tx_base_from_blob(*bd, tx) : parse_and_validate_tx_from_blob(*bd, tx)))
+    // served from a published copy, so RPC polling of the whole pool does
+    // not hold up relay; it is rebuilt when a tx or its metadata changed
+    const std::shared_ptr<const pool_info_snapshot> snapshot = m_info_snapshot.get(
+        [this](){ return m_cookie + m_meta_cookie; }, m_transactions_lock, [this](){ return build_info_snapshot(); });
+    tx_infos.reserve(snapshot->txes.size());
+    key_image_infos.reserve(snapshot->key_images.size());
+    for (const pool_info_snapshot::entry &e: snapshot->txes)
+    {
+      if (include_sensitive_data)
       {
-        MERROR("Failed to parse tx from txpool");
-        // continue
-        return true;
+        tx_infos.push_back(e.info);
       }
-      tx.set_hash(txid);
-      txi.tx_json = obj_to_json_str(tx);
-      txi.blob_size = bd->size();
-      txi.weight = meta.weight;
-      txi.fee = meta.fee;
-      txi.kept_by_block = meta.kept_by_block;
-      txi.max_used_block_height = meta.max_used_block_height;
-      txi.max_used_block_id_hash = epee::string_tools::pod_to_hex(meta.max_used_block_id);
-      txi.last_failed_height = meta.last_failed_height;
-      txi.last_failed_id_hash = epee::string_tools::pod_to_hex(meta.last_failed_id);
-      // In restricted mode we do not include this data:
-      txi.receive_time = include_sensitive_data ? meta.receive_time : 0;
-      txi.relayed = meta.relayed;
-      // In restricted mode we do not include this data:
-      txi.last_relayed_time = (include_sensitive_data && !meta.dandelionpp_stem) ? meta.last_relayed_time : 0;
-      txi.do_not_relay = meta.do_not_relay;
-      txi.double_spend_seen = meta.double_spend_seen;
-      tx_infos.push_back(std::move(txi));
-      return true;
-    }, true, category);
-
-    for (const key_images_container::value_type& kee : m_spent_key_images) {
-      const crypto::key_image& k_image = kee.first;
-      const std::unordered_set<crypto::hash>& kei_image_set = kee.second;
-      spent_key_image_info ki;
-      ki.id_hash = epee::string_tools::pod_to_hex(k_image);
-      for (const crypto::hash& tx_id_hash : kei_image_set)
+      else if (!e.sensitive)
       {
-        if (m_blockchain.txpool_tx_matches_category(tx_id_hash, category))
-          ki.txs_hashes.push_back(epee::string_tools::pod_to_hex(tx_id_hash));
+        tx_infos.push_back(e.info);
+        // In restricted mode we do not include this data:
+        tx_infos.back().receive_time = 0;
+        tx_infos.back().last_relayed_time = 0;
       }
+    }
+
+    for (const pool_info_snapshot::key_image_entry &e: snapshot->key_images)
+    {
+      spent_key_image_info ki;
+      ki.id_hash = e.id_hash;
+      for (const auto &tx: e.txs)
+        if (include_sensitive_data || !tx.second)
+          ki.txs_hashes.push_back(tx.first);
 
       // Only return key images for which we have at least one tx that we can show for them
       if (!ki.txs_hashes.empty())
@@ -1375,16 +1538,15 @@ namespace cryptonote
     CRITICAL_REGION_LOCAL1(m_blockchain);
     tx_infos.reserve(m_blockchain.get_txpool_tx_count());
     key_image_infos.reserve(m_blockchain.get_txpool_tx_count());
-    m_blockchain.for_all_txpool_txes([&tx_infos, key_image_infos](const crypto::hash &txid, const txpool_tx_meta_t &meta, const cryptonote::blobdata_ref *bd){
+    m_blockchain.for_all_txpool_txes([this, &tx_infos, key_image_infos](const crypto::hash &txid, const txpool_tx_meta_t &meta, const cryptonote::blobdata_ref *bd){
       cryptonote::rpc::tx_in_pool txi;
       txi.tx_hash = txid;
-      if (!(meta.pruned ? parse_and_validate_tx_base_from_blob(*bd, txi.tx) : parse_and_validate_tx_from_blob(*bd, txi.tx)))
+      if (!m_parsed_tx_cache.get(txid, *bd, meta.pruned, txi.tx))
       {
         MERROR("Failed to parse tx from txpool");
         // continue
         return true;
       }
-      txi.tx.set_hash(txid);
       txi.blob_size = bd->size();
       txi.weight = meta.weight;
       txi.fee = meta.fee;
@@ -1457,7 +1619,7 @@ namespace cryptonote
   {
     CRITICAL_REGION_LOCAL(m_transactions_lock);
     m_input_cache.clear();
-    m_parsed_tx_cache.clear();
+    update_conversion_index(m_blockchain.get_current_blockchain_height(), false);
     return true;
   }
   //---------------------------------------------------------------------------------
@@ -1465,7 +1627,7 @@ namespace cryptonote
   {
     CRITICAL_REGION_LOCAL(m_transactions_lock);
     m_input_cache.clear();
-    m_parsed_tx_cache.clear();
+    update_conversion_index(m_blockchain.get_current_blockchain_height(), true);
     return true;
   }
   //---------------------------------------------------------------------------------
@@ -1537,23 +1699,23 @@ namespace cryptonote
   {
     struct transaction_parser
     {
-      transaction_parser(const cryptonote::blobdata_ref &txblob, const crypto::hash &txid, transaction &tx): txblob(txblob), txid(txid), tx(tx), parsed(false) {}
+      transaction_parser(parsed_tx_cache &cache, const cryptonote::blobdata_ref &txblob, const crypto::hash &txid, transaction &tx): cache(cache), txblob(txblob), txid(txid), tx(tx), parsed(false) {}
       cryptonote::transaction &operator()()
       {
         if (!parsed)
         {
-          if (!parse_and_validate_tx_from_blob(txblob, tx))
+          if (!cache.get(txid, txblob, false, tx))
             throw std::runtime_error("failed to parse transaction blob");
-          tx.set_hash(txid);
           parsed = true;
         }
         return tx;
       }
+      parsed_tx_cache &cache;
       const cryptonote::blobdata_ref &txblob;
       const crypto::hash &txid;
       transaction &tx;
       bool parsed;
-    } lazy_tx(txblob, txid, tx);
+    } lazy_tx(m_parsed_tx_cache, txblob, txid, tx);
 
     //not the best implementation at this time, sorry :(
     //check is ring_signature already checked ?
@@ -1655,7 +1817,7 @@ namespace cryptonote
             changed = true;
             try
             {
-              m_blockchain.update_txpool_tx(txid, meta);
+              update_txpool_tx(txid, meta);
             }
             catch (const std::exception &e)
             {
@@ -1748,10 +1910,33 @@ namespace cryptonote
     // Convert stable and reserve fees into equivalent zeph value to maximize coinbase
     uint64_t total_collected_fee_in_zeph = 0;
 
-    boost::multiprecision::int128_t total_conversion_zeph = 0;
-    boost::multiprecision::int128_t total_conversion_stables = 0;
-    boost::multiprecision::int128_t total_conversion_reserves = 0;
-    std::vector<std::pair<std::string, std::string>> circ_supply = m_blockchain.get_db().get_circulating_supply();
+    const circ_supply_snapshot circ_supply = m_blockchain.get_circulating_supply();
+    reserve_tally conversions(circ_supply, bl.pricing_record);
+
+    // Conversions that are otherwise valid but would break the reserve ratio at
+    // their place in fee order. Conversions included later can offset them (a
+    // mint against a redeem), so they are retried at the end of the block.
+    struct deferred_conversion_t
+    {
+      crypto::hash txid;
+      uint64_t weight;
+      uint64_t fee;
+      uint64_t fee_in_zeph;
+      std::string fee_asset_type;
+      tt tx_type;
+      cryptonote::transaction tx;
+    };
+    std::vector<deferred_conversion_t> deferred_conversions;
+
+    auto add_to_template = [&](const crypto::hash &txid, uint64_t weight, uint64_t fee, uint64_t fee_in_zeph, const std::string &fee_asset_type, uint64_t new_coinbase, const cryptonote::transaction &tx) {
+      bl.tx_hashes.push_back(txid);
+      total_weight += weight;
+      total_collected_fee_in_zeph += fee_in_zeph;
+      fee_map[fee_asset_type] += fee;
+      best_coinbase = new_coinbase;
+      append_key_images(k_images, tx);
+      LOG_PRINT_L2("  added, new block weight " << total_weight << "/" << max_total_weight << ", coinbase " << print_money(best_coinbase));
+    };
 
     auto sorted_it = m_txs_by_fee_and_receive_time.begin();
     for (; sorted_it != m_txs_by_fee_and_receive_time.end(); ++sorted_it)
@@ -1779,6 +1964,16 @@ namespace cryptonote
         continue;
       }
 
+      // Conversions the pool already knows can not be mined at this height.
+      // Those stuck on the reserve ratio are still tried, other conversions
+      // in this block may offset them.
+      const conversion_status status = (conversion_status)meta.conversion_status;
+      if (status == conversion_status::pr_too_old || status == conversion_status::pr_too_new || status == conversion_status::no_pricing_record)
+      {
+        LOG_PRINT_L2("  conversion can not be mined, status " << (unsigned)meta.conversion_status);
+        continue;
+      }
+
       // Can not exceed maximum block weight
       if (max_total_weight < total_weight + meta.weight)
       {
@@ -1835,7 +2030,7 @@ namespace cryptonote
       {
         try
         {
-          m_blockchain.update_txpool_tx(sorted_it->second, meta);
+          update_txpool_tx(sorted_it->second, meta);
         }
         catch (const std::exception &e)
         {
@@ -1867,41 +2062,18 @@ namespace cryptonote
         continue;
       }
 
-      boost::multiprecision::int128_t conversion_this_tx_zeph = 0;
-      boost::multiprecision::int128_t conversion_this_tx_stables = 0;
-      boost::multiprecision::int128_t conversion_this_tx_reserves = 0;
       if (source != dest)
       {
         if (!have_valid_pr) {
           continue;
         }
 
-        if (tx_type == tt::MINT_STABLE) {
-          conversion_this_tx_zeph += tx.amount_burnt; // Added to the reserve
-          conversion_this_tx_stables += tx.amount_minted;
-        } else if (tx_type == tt::REDEEM_STABLE) {
-          conversion_this_tx_stables -= tx.amount_burnt;
-          conversion_this_tx_zeph -= tx.amount_minted; // Deducted from the reserve
-        } else if (tx_type == tt::MINT_RESERVE) {
-          conversion_this_tx_zeph += tx.amount_burnt;
-          conversion_this_tx_reserves += tx.amount_minted;
-        } else if (tx_type == tt::REDEEM_RESERVE) {
-          conversion_this_tx_reserves -= tx.amount_burnt;
-          conversion_this_tx_zeph -= tx.amount_minted;
-        } else {
+        boost::multiprecision::int128_t delta_zeph, delta_stables, delta_reserves;
+        if (!reserve_tally::get_conversion_delta(tx_type, tx.amount_burnt, tx.amount_minted, delta_zeph, delta_stables, delta_reserves)) {
           LOG_PRINT_L2(" conversion transaction has invalid tx type " << sorted_it->second);
           continue;
         }
 
-        boost::multiprecision::int128_t tally_zeph = total_conversion_zeph + conversion_this_tx_zeph;
-        boost::multiprecision::int128_t tally_stables = total_conversion_stables + conversion_this_tx_stables;
-        boost::multiprecision::int128_t tally_reserves = total_conversion_reserves + conversion_this_tx_reserves;
-
-        if (!reserve_ratio_satisfied(circ_supply, bl.pricing_record, tx_type, tally_zeph, tally_stables, tally_reserves)) {
-          LOG_PRINT_L2(" transaction ignored: reserve ratio would be invalid " << sorted_it->second);
-          continue;
-        }
-
         // Validate that tx pricing record has not grown too old since it was first included in the pool
         if (!tx_pr_height_valid(m_blockchain.get_current_blockchain_height(), tx.pricing_record_height, sorted_it->second)) {
           LOG_PRINT_L2("error : transaction references a pricing record that is too old (height " << tx.pricing_record_height << ")");
@@ -1909,33 +2081,72 @@ namespace cryptonote
         }
 
         // get pricing record for this tx
-        block tx_pr_block;
-        if (!m_blockchain.get_block_by_hash(m_blockchain.get_block_id_by_height(tx.pricing_record_height), tx_pr_block)) {
+        oracle::pricing_record tx_pr;
+        if (!m_blockchain.get_block_pricing_record(tx.pricing_record_height, tx_pr)) {
           LOG_PRINT_L2("error: failed to get block containing pricing record");
           continue;
         }
 
         // make sure proof-of-value still holds
-        if (!rct::verRctSemanticsSimple(tx.rct_signatures, tx_pr_block.pricing_record, tx_type, source, dest, tx.amount_burnt, tx.vout, tx.vin, version))
+        if (!rct::verRctSemanticsSimple(tx.rct_signatures, tx_pr, tx_type, source, dest, tx.amount_burnt, tx.vout, tx.vin, version))
         {
           LOG_PRINT_L2(" transaction proof-of-value is now invalid for tx " << sorted_it->second);
           continue;
-        } 
-      }
-
+        }
 
-      bl.tx_hashes.push_back(sorted_it->second);
-      total_weight += meta.weight;
+        if (!conversions.add(tx_type, tx.amount_burnt, tx.amount_minted)) {
+          LOG_PRINT_L2(" transaction deferred: reserve ratio would be invalid " << sorted_it->second);
+          deferred_conversions.push_back({sorted_it->second, meta.weight, meta.fee, fee_this_tx_in_zeph, meta.fee_asset_type, tx_type, std::move(tx)});
+          continue;
+        }
+      }
 
-      total_collected_fee_in_zeph += fee_this_tx_in_zeph;
-      fee_map[meta.fee_asset_type] += meta.fee;
-      total_conversion_zeph += conversion_this_tx_zeph;
-      total_conversion_stables += conversion_this_tx_stables;
-      total_conversion_reserves += conversion_this_tx_reserves;
+      add_to_template(sorted_it->second, meta.weight, meta.fee, fee_this_tx_in_zeph, meta.fee_asset_type, coinbase, tx);
+    }
 
-      best_coinbase = coinbase;
-      append_key_images(k_images, tx);
-      LOG_PRINT_L2("  added, new block weight " << total_weight << "/" << max_total_weight << ", coinbase " << print_money(best_coinbase));
+    // Retry the deferred conversions against the reserve state of the whole
+    // block so far. Each one accepted can unlock others, so go round again
+    // while progress is made, up to a few passes.
+    static const size_t max_deferred_passes = 4;
+    bool progress = true;
+    for (size_t pass = 0; pass < max_deferred_passes && progress && !deferred_conversions.empty(); ++pass)
+    {
+      progress = false;
+      for (auto it = deferred_conversions.begin(); it != deferred_conversions.end(); )
+      {
+        if (max_total_weight < total_weight + it->weight)
+        {
+          ++it;
+          continue;
+        }
+        uint64_t block_reward;
+        if (!get_block_reward(median_weight, total_weight + it->weight, already_generated_coins, block_reward, version))
+        {
+          ++it;
+          continue;
+        }
+        coinbase = block_reward + total_collected_fee_in_zeph + it->fee_in_zeph;
+        if (coinbase < template_accept_threshold(best_coinbase))
+        {
+          ++it;
+          continue;
+        }
+        if (have_key_images(k_images, it->tx))
+        {
+          LOG_PRINT_L2("  deferred " << it->txid << " key images already seen");
+          it = deferred_conversions.erase(it);
+          continue;
+        }
+        if (!conversions.add(it->tx_type, it->tx.amount_burnt, it->tx.amount_minted))
+        {
+          ++it;
+          continue;
+        }
+        LOG_PRINT_L2("Deferred conversion " << it->txid << " now satisfies the reserve ratio");
+        add_to_template(it->txid, it->weight, it->fee, it->fee_in_zeph, it->fee_asset_type, coinbase, it->tx);
+        it = deferred_conversions.erase(it);
+        progress = true;
+      }
     }
     lock.commit();
 
@@ -1999,7 +2210,10 @@ namespace cryptonote
           MINFO("Failed to re-validate tx " << e.txid << " for v" << (unsigned)version << ", dropped");
           continue;
         }
-        m_blockchain.update_txpool_tx(e.txid, e.meta);
+        const auto conversion = m_conversions_by_id.find(e.txid);
+        if (conversion != m_conversions_by_id.end())
+          e.meta.conversion_status = (uint8_t)conversion->second->second.status;
+        update_txpool_tx(e.txid, e.meta);
         ++added;
       }
       catch (const std::exception &e)
@@ -2076,6 +2290,9 @@ namespace cryptonote
     {
       MDEBUG("Removing tx " << txid << " from tx pool, but it was not found in the map of added txs");
     }
+    remove_from_conversion_index(txid);
+    m_parsed_tx_cache.remove(txid);
+    m_fee_histogram.remove(txid);
     track_removed_tx(txid, sensitive);
   }
   //---------------------------------------------------------------------------------
@@ -2117,18 +2334,25 @@ namespace cryptonote
     }
   }
   //---------------------------------------------------------------------------------
-  bool tx_memory_pool::init(size_t max_txpool_weight, bool mine_stem_txes)
+  bool tx_memory_pool::init(size_t max_txpool_weight, bool mine_stem_txes, size_t parsed_cache_size)
   {
     CRITICAL_REGION_LOCAL(m_transactions_lock);
     CRITICAL_REGION_LOCAL1(m_blockchain);
 
     m_txpool_max_weight = max_txpool_weight ? max_txpool_weight : DEFAULT_TXPOOL_MAX_WEIGHT;
+    m_snapshot.reset();
+    m_info_snapshot.reset();
+    m_parsed_tx_cache.clear();
+    m_parsed_tx_cache.set_max_bytes(parsed_cache_size);
     m_txs_by_fee_and_receive_time.clear();
     m_added_txs_by_id.clear();
     m_added_txs_start_time = (time_t)0;
     m_removed_txs_by_time.clear();
     m_removed_txs_start_time = (time_t)0;
     m_spent_key_images.clear();
+    m_conversions_by_pr_height.clear();
+    m_conversions_by_id.clear();
+    m_fee_histogram.clear();
     m_txpool_weight = 0;
     std::vector<crypto::hash> remove;
 
@@ -2153,7 +2377,22 @@ namespace cryptonote
           return false;
         }
         add_tx_to_transient_lists(txid, meta.fee / (double)meta.weight, meta.receive_time);
+        m_fee_histogram.add(txid, meta.fee_asset_type, meta.fee, meta.weight, meta.matches(relay_category::broadcasted));
         m_txpool_weight += meta.weight;
+
+        // entries from older versions did not record the tx type
+        transaction_type tx_type = (transaction_type)meta.tx_type;
+        if (tx_type == transaction_type::UNSET && tx.amount_burnt)
+        {
+          std::string source, dest;
+          if (!get_tx_asset_types(tx, txid, source, dest, false) || !get_tx_type(source, dest, tx_type))
+            tx_type = transaction_type::UNSET;
+        }
+        if (tx_type == transaction_type::MINT_STABLE || tx_type == transaction_type::REDEEM_STABLE || tx_type == transaction_type::MINT_RESERVE || tx_type == transaction_type::REDEEM_RESERVE)
+        {
+          auto it = m_conversions_by_pr_height.emplace(tx.pricing_record_height, conversion_info{txid, tx_type, tx.pricing_record_height, tx.amount_burnt, tx.amount_minted, (conversion_status)meta.conversion_status});
+          m_conversions_by_id[txid] = it;
+        }
         return true;
       }, true, relay_category::all);
       if (!r)
@@ -2177,8 +2416,11 @@ namespace cryptonote
       lock.commit();
     }
 
+    update_conversion_index(m_blockchain.get_current_blockchain_height(), true);
+
     m_mine_stem_txes = mine_stem_txes;
     m_cookie = 0;
+    m_meta_cookie = 0;
 
     // Ignore deserialization error
     return true;
@@ -32,6 +32,7 @@
 #include "include_base_utils.h"
 
 #include <atomic>
+#include <map>
 #include <set>
 #include <tuple>
 #include <unordered_map>
@@ -48,6 +49,10 @@
 #include "cryptonote_basic/verification_context.h"
 #include "cryptonote_protocol/enums.h"
 #include "blockchain_db/blockchain_db.h"
+#include "cryptonote_basic/circ_supply.h"
+#include "parsed_tx_cache.h"
+#include "fee_histogram.h"
+#include "common/published_snapshot.h"
 #include "crypto/hash.h"
 #include "rpc/core_rpc_server_commands_defs.h"
 #include "rpc/message_data_structs.h"
@@ -207,10 +212,11 @@ namespace cryptonote
      *
      * @param max_txpool_weight the max weight in bytes
      * @param mine_stem_txes whether to mine txes in stem relay mode
+     * @param parsed_cache_size the approximate memory budget in bytes for parsed txes
      *
      * @return true
      */
-    bool init(size_t max_txpool_weight = 0, bool mine_stem_txes = false);
+    bool init(size_t max_txpool_weight = 0, bool mine_stem_txes = false, size_t parsed_cache_size = DEFAULT_TXPOOL_PARSED_CACHE_SIZE);
 
     /**
      * @brief attempts to save the transaction pool state to disk
@@ -287,6 +293,72 @@ namespace cryptonote
      */
     void get_transaction_stats(struct txpool_stats& stats, bool include_sensitive = false) const;
 
+    /**
+     * @brief immutable view of the pool for readers
+     */
+    struct pool_snapshot
+    {
+      struct entry
+      {
+        crypto::hash id;
+        uint64_t weight;
+        uint64_t fee;
+        uint64_t receive_time;
+        bool sensitive; //!< not in the broadcasted relay category
+      };
+      std::vector<entry> txes; //!< best paying first
+      size_t num_broadcasted;
+    };
+
+    /**
+     * @brief get the latest published snapshot of the pool
+     *
+     * The snapshot is rebuilt when the pool changed since it was published,
+     * but only if the pool lock is free: while a writer holds it, the
+     * previous snapshot is returned instead of waiting.
+     *
+     * @return the pool snapshot
+     */
+    std::shared_ptr<const pool_snapshot> get_snapshot() const;
+
+    /**
+     * @brief get the pool fee per byte histogram for each fee asset type
+     *
+     * @param include_sensitive include stempool, anonymity-pool, and unrelayed txes
+     *
+     * @return the histogram buckets by fee asset type
+     */
+    std::map<std::string, fee_histogram::buckets> get_fee_histogram(bool include_sensitive = false) const;
+
+    /**
+     * @brief get the hit/miss counters and memory use of the parsed tx cache
+     *
+     * @return the parsed tx cache statistics
+     */
+    parsed_tx_cache::stats get_parsed_tx_cache_stats() const;
+
+    /**
+     * @brief a conversion tx in the pool and whether it can currently be mined
+     */
+    struct conversion_info
+    {
+      crypto::hash txid;
+      transaction_type tx_type;
+      uint64_t pricing_record_height;
+      uint64_t amount_burnt;
+      uint64_t amount_minted;
+      conversion_status status;
+    };
+
+    /**
+     * @brief get the conversion txs in the pool and whether each can be mined
+     *
+     * @param conversions return-by-reference the conversions, by pricing record height
+     * @param include_sensitive return stempool, anonymity-pool, and unrelayed txes
+     *
+     */
+    void get_conversions(std::vector<conversion_info>& conversions, bool include_sensitive = false) const;
+
     /**
      * @brief get information about all transactions and key images in the pool
      *
@@ -486,7 +558,9 @@ namespace cryptonote
      */
     bool get_pool_info(time_t start_time, bool include_sensitive, size_t max_tx_count, std::vector<std::pair<crypto::hash, tx_details>>& added_txs, std::vector<crypto::hash>& remaining_added_txids, std::vector<crypto::hash>& removed_txs, bool& incremental) const;
 
+#ifndef IN_UNIT_TESTS
   private:
+#endif
 
     /**
      * @brief insert key images into m_spent_key_images
@@ -565,6 +639,40 @@ namespace cryptonote
      */
     static bool append_key_images(std::unordered_set<crypto::key_image>& kic, const transaction_prefix& tx);
 
+    /**
+     * @brief builds a snapshot of the pool, must be called with the pool lock held
+     */
+    std::shared_ptr<const pool_snapshot> build_snapshot() const;
+
+    /**
+     * @brief immutable copy of the data served by get_transactions_and_spent_keys_info
+     */
+    struct pool_info_snapshot
+    {
+      struct entry
+      {
+        tx_info info; //!< with the fields sensitive to the node privacy filled in
+        bool sensitive; //!< not in the broadcasted relay category
+      };
+      struct key_image_entry
+      {
+        std::string id_hash;
+        std::vector<std::pair<std::string, bool>> txs; //!< tx hash and whether that tx is sensitive
+      };
+      std::vector<entry> txes;
+      std::vector<key_image_entry> key_images;
+    };
+
+    /**
+     * @brief builds the pool info snapshot, must be called with the pool lock held
+     */
+    std::shared_ptr<const pool_info_snapshot> build_info_snapshot() const;
+
+    /**
+     * @brief writes back the metadata of a pool tx, must be called with the pool lock held
+     */
+    void update_txpool_tx(const crypto::hash &txid, const txpool_tx_meta_t &meta);
+
     /**
      * @brief check if a transaction is a valid candidate for inclusion in a block
      *
@@ -590,6 +698,31 @@ namespace cryptonote
      */
     void prune(size_t bytes = 0);
 
+    /**
+     * @brief check whether a conversion can be mined at the given chain height
+     *
+     * The reserve ratio is checked for the conversion on its own, against
+     * the current circulating supply and the latest acceptable pricing record.
+     */
+    conversion_status get_conversion_status(const conversion_info& conversion, uint64_t height, bool have_pr, const circ_supply_snapshot& circ_supply, const oracle::pricing_record& pr) const;
+
+    //! sets the status of a new conversion and adds it to the conversion index
+    void add_to_conversion_index(conversion_info conversion, txpool_tx_meta_t& meta);
+    void remove_from_conversion_index(const crypto::hash& txid);
+
+    /**
+     * @brief re-evaluate the conversions whose status may have changed
+     *
+     * Conversions whose pricing record was already too old at the last
+     * update stay that way as the chain grows and are skipped, unless full
+     * is set (after a reorg, or on startup). The others are all checked
+     * again, since the supply and pricing record their reserve ratio check
+     * depends on change with every block, so the cost is linear in the
+     * conversions still within PRICING_RECORD_VALID_BLOCKS of the chain
+     * tip. Changed statuses are written to the txs' metadata.
+     */
+    void update_conversion_index(uint64_t height, bool full);
+
     void add_tx_to_transient_lists(const crypto::hash& txid, double fee, time_t receive_time);
     void remove_tx_from_transient_lists(const cryptonote::sorted_tx_container::iterator& sorted_it, const crypto::hash& txid, bool sensitive);
     void track_removed_tx(const crypto::hash& txid, bool sensitive);
@@ -672,7 +805,26 @@ private:
 
     mutable std::unordered_map<crypto::hash, std::tuple<bool, tx_verification_context, uint64_t, crypto::hash>> m_input_cache;
 
-    std::unordered_map<crypto::hash, transaction> m_parsed_tx_cache;
+    mutable parsed_tx_cache m_parsed_tx_cache;
+
+    //! fee per byte histogram, maintained on add/remove
+    fee_histogram m_fee_histogram;
+
+    //! pool hashes and fee/weight index for readers, tagged with m_cookie
+    mutable tools::published_snapshot<pool_snapshot> m_snapshot;
+
+    //! incremented at each tx metadata update that leaves m_cookie alone
+    std::atomic<uint64_t> m_meta_cookie;
+
+    //! pool tx infos for get_transactions_and_spent_keys_info, tagged with m_cookie + m_meta_cookie
+    mutable tools::published_snapshot<pool_info_snapshot> m_info_snapshot;
+
+    typedef std::multimap<uint64_t, conversion_info> conversion_index;
+    //! conversion txs in the pool, by the height of their pricing record
+    conversion_index m_conversions_by_pr_height;
+    std::unordered_map<crypto::hash, conversion_index::iterator> m_conversions_by_id;
+    //! chain height the conversion statuses were last evaluated at
+    uint64_t m_conversion_index_height;
 
     //! Next timestamp that a DB check for relayable txes is allowed
     std::atomic<time_t> m_next_check;
@@ -1319,6 +1319,8 @@ bool t_rpc_command_executor::print_transaction_pool_stats() {
   tools::msg_writer() << n_transactions << " tx(es), " << res.pool_stats.bytes_total << " bytes total (min " << res.pool_stats.bytes_min << ", max " << res.pool_stats.bytes_max << ", avg " << avg_bytes << ", median " << res.pool_stats.bytes_med << ")" << std::endl
       << "fees " << cryptonote::print_money(res.pool_stats.fee_total) << " (avg " << cryptonote::print_money(n_transactions ? res.pool_stats.fee_total / n_transactions : 0) << " per tx" << ", " << cryptonote::print_money(res.pool_stats.bytes_total ? res.pool_stats.fee_total / res.pool_stats.bytes_total : 0) << " per byte)" << std::endl
       << res.pool_stats.num_double_spends << " double spends, " << res.pool_stats.num_not_relayed << " not relayed, " << res.pool_stats.num_failing << " failing, " << res.pool_stats.num_10m << " older than 10 minutes (oldest " << (res.pool_stats.oldest == 0 ? "-" : get_human_time_ago(res.pool_stats.oldest, now)) << "), " << backlog_message;
+  if (res.pool_stats.parsed_cache_hits || res.pool_stats.parsed_cache_misses)
+    tools::msg_writer() << "parsed tx cache: " << res.pool_stats.parsed_cache_hits << " hits, " << res.pool_stats.parsed_cache_misses << " misses, " << res.pool_stats.parsed_cache_bytes << " bytes";
 
   if (n_transactions > 1 && res.pool_stats.histo.size())
   {
@@ -26,6 +26,7 @@
 // THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #pragma once
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -33,6 +34,38 @@ namespace oracle {
 
   const std::vector<std::string> ASSET_TYPES = {"ZEPH", "ZEPHUSD", "ZEPHRSV"};
 
+  // Compact asset identifier, the value is the index in ASSET_TYPES.
+  // Asset type strings are only needed at the serialization and RPC
+  // boundaries, lookups and database keys use this instead.
+  enum class asset_id : uint8_t
+  {
+    ZEPH = 0,
+    ZEPHUSD = 1,
+    ZEPHRSV = 2,
+    invalid = 0xff
+  };
+
+  constexpr const size_t NUM_ASSET_TYPES = 3;
+
+  inline asset_id get_asset_id(const std::string &asset_type) noexcept
+  {
+    for (size_t i = 0; i < NUM_ASSET_TYPES; ++i)
+      if (asset_type == ASSET_TYPES[i])
+        return static_cast<asset_id>(i);
+    return asset_id::invalid;
+  }
+
+  inline bool is_valid_asset_id(asset_id id) noexcept
+  {
+    return static_cast<size_t>(id) < NUM_ASSET_TYPES;
+  }
+
+  // id must be valid
+  inline const std::string &get_asset_type(asset_id id) noexcept
+  {
+    return ASSET_TYPES[static_cast<size_t>(id)];
+  }
+
   class asset_type_counts
   {
 
@@ -50,28 +83,36 @@ namespace oracle {
       {
       }
 
-      uint64_t operator[](const std::string asset_type) const noexcept
+      uint64_t operator[](const asset_id id) const noexcept
       {
-        if (asset_type == "ZEPH") {
-          return ZEPH;
-        } else if (asset_type == "ZEPHUSD") {
-          return ZEPHUSD;
-        } else if (asset_type == "ZEPHRSV") {
-          return ZEPHRSV;
+        switch (id)
+        {
+          case asset_id::ZEPH: return ZEPH;
+          case asset_id::ZEPHUSD: return ZEPHUSD;
+          case asset_id::ZEPHRSV: return ZEPHRSV;
+          default: return 0;
         }
+      }
 
-        return 0;
+      uint64_t operator[](const std::string &asset_type) const noexcept
+      {
+        return (*this)[get_asset_id(asset_type)];
       }
 
-      void add(const std::string asset_type, const uint64_t val)
+      void add(const asset_id id, const uint64_t val)
       {
-        if (asset_type == "ZEPH") {
-          ZEPH += val;
-        } else if (asset_type == "ZEPHUSD") {
-          ZEPHUSD += val;
-        } else if (asset_type == "ZEPHRSV") {
-          ZEPHRSV += val;
+        switch (id)
+        {
+          case asset_id::ZEPH: ZEPH += val; break;
+          case asset_id::ZEPHUSD: ZEPHUSD += val; break;
+          case asset_id::ZEPHRSV: ZEPHRSV += val; break;
+          default: break;
         }
       }
+
+      void add(const std::string &asset_type, const uint64_t val)
+      {
+        add(get_asset_id(asset_type), val);
+      }
   };
 }
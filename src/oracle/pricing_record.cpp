@@ -28,6 +28,7 @@
 // Portions of this code based upon code Copyright (c) 2019, The Monero Project
 
 #include "pricing_record.h"
+#include "signature_verifier.h"
 
 #include "serialization/keyvalue_serialization.h"
 #include "storages/portable_storage.h"
@@ -135,6 +136,22 @@ namespace oracle
     return *this;
   }
   
+  uint64_t pricing_record::operator[](const asset_id id) const noexcept
+  {
+    switch (id)
+    {
+      case asset_id::ZEPH: return spot;
+      case asset_id::ZEPHUSD: return stable;
+      case asset_id::ZEPHRSV: return reserve;
+      default: return 0;
+    }
+  }
+
+  uint64_t pricing_record::operator[](const std::string& asset_type) const
+  {
+    return (*this)[get_asset_id(asset_type)];
+  }
+
   bool pricing_record::equal(const pricing_record& other) const noexcept
   {
     return ((spot == other.spot) &&
@@ -155,59 +172,7 @@ namespace oracle
 
   bool pricing_record::verifySignature(const std::string& public_key) const
   {
-    CHECK_AND_ASSERT_THROW_MES(!public_key.empty(), "Pricing record verification failed. NULL public key. PK Size: " << public_key.size()); // TODO: is this necessary or the one below already covers this case, meannin it will produce empty pubkey?
-
-    // extract the key
-    EVP_PKEY* pubkey;
-    BIO* bio = BIO_new_mem_buf(public_key.c_str(), public_key.size());
-    if (!bio) {
-      return false;
-    }
-    pubkey = PEM_read_bio_PUBKEY(bio, NULL, NULL, NULL);
-    BIO_free(bio);
-    CHECK_AND_ASSERT_THROW_MES(pubkey != NULL, "Pricing record verification failed. NULL public key.");
-
-    // Convert our internal 64-byte binary representation into 128-byte hex string
-    std::string sig_hex;
-    for (unsigned int i=0; i<64; i++) {
-      std::stringstream ss;
-      ss << std::hex << std::setw(2) << std::setfill('0') << (0xff & signature[i]);
-      sig_hex += ss.str();
-    }
-
-    // Build the JSON string, so that we can verify the signature
-    std::ostringstream oss;
-    oss << "{\"spot\":" << spot;
-    oss << ",\"moving_average\":" << moving_average;
-    oss << ",\"timestamp\":" << timestamp;
-    oss << "}";
-    std::string message = oss.str();
-
-    // Create a verify digest from the message
-    EVP_MD_CTX *ctx = EVP_MD_CTX_create();
-    int ret = 0;
-    if (ctx) {
-      ret = EVP_DigestVerifyInit(ctx, NULL, EVP_sha256(), NULL, pubkey);
-      if (ret == 1) {
-        ret = EVP_DigestVerifyUpdate(ctx, message.data(), message.length());
-        if (ret == 1) {
-          ret = EVP_DigestVerifyFinal(ctx, (const unsigned char *)signature, 64);
-        }
-      }
-    }
-
-    // Cleanup the context we created
-    EVP_MD_CTX_destroy(ctx);
-    // Cleanup the openssl stuff
-    EVP_PKEY_free(pubkey);
-
-    if (ret == 1)
-      return true;
-
-    // Get the errors from OpenSSL
-    ERR_print_errors_fp (stderr);
-
-    return false;
+    return signature_verifier::get(public_key).verify(*this);
   }
 
   bool pricing_record::has_missing_rates() const noexcept
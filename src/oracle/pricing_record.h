@@ -45,6 +45,7 @@
 
 #include "cryptonote_config.h"
 #include "crypto/hash.h"
+#include "asset_types.h"
 
 namespace epee
 {
@@ -94,6 +95,8 @@ namespace oracle
       bool valid(cryptonote::network_type nettype, uint32_t hf_version, uint64_t bl_timestamp, uint64_t last_bl_timestamp) const;
 
       pricing_record& operator=(const pricing_record& orig) noexcept;
+      //! Spot rate of an asset, 0 for an unknown asset
+      uint64_t operator[](const asset_id id) const noexcept;
       uint64_t operator[](const std::string& asset_type) const;
   };
 
@@ -0,0 +1,168 @@
+// Copyright (c) 2023, Zephyr Protocol
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "signature_verifier.h"
+
+#include <openssl/bio.h>
+#include <openssl/err.h>
+#include <openssl/pem.h>
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "misc_log_ex.h"
+#include "crypto/hash.h"
+#include "pricing_record.h"
+
+namespace oracle
+{
+  namespace
+  {
+    struct md_ctx_deleter
+    {
+      void operator()(EVP_MD_CTX *ctx) const { EVP_MD_CTX_destroy(ctx); }
+    };
+
+    // EVP_MD_CTX is not thread safe, so each thread gets its own, reset between uses
+    EVP_MD_CTX *get_thread_md_ctx()
+    {
+      static thread_local std::unique_ptr<EVP_MD_CTX, md_ctx_deleter> ctx(EVP_MD_CTX_create());
+      if (ctx)
+      {
+#if OPENSSL_VERSION_NUMBER < 0x10100000 || defined(LIBRESSL_VERSION_TEXT)
+        EVP_MD_CTX_cleanup(ctx.get());
+        EVP_MD_CTX_init(ctx.get());
+#else
+        EVP_MD_CTX_reset(ctx.get());
+#endif
+      }
+      return ctx.get();
+    }
+
+#pragma pack(push, 1)
+    struct signed_fields
+    {
+      uint64_t spot;
+      uint64_t moving_average;
+      uint64_t timestamp;
+      unsigned char signature[64];
+    };
+#pragma pack(pop)
+  }
+
+  signature_verifier::signature_verifier(const std::string& public_key)
+  {
+    CHECK_AND_ASSERT_THROW_MES(!public_key.empty(), "Pricing record verification failed. NULL public key. PK Size: " << public_key.size());
+    BIO* bio = BIO_new_mem_buf(public_key.c_str(), public_key.size());
+    CHECK_AND_ASSERT_THROW_MES(bio != NULL, "Pricing record verification failed. Failed to allocate BIO.");
+    m_pubkey = PEM_read_bio_PUBKEY(bio, NULL, NULL, NULL);
+    BIO_free(bio);
+    CHECK_AND_ASSERT_THROW_MES(m_pubkey != NULL, "Pricing record verification failed. NULL public key.");
+  }
+
+  signature_verifier::~signature_verifier()
+  {
+    EVP_PKEY_free(m_pubkey);
+  }
+
+  const signature_verifier& signature_verifier::get(const std::string& public_key)
+  {
+    // one entry per network at most, entries are never removed
+    static std::mutex lock;
+    static std::map<std::string, std::unique_ptr<signature_verifier>> verifiers;
+
+    std::lock_guard<std::mutex> guard(lock);
+    std::unique_ptr<signature_verifier> &verifier = verifiers[public_key];
+    if (!verifier)
+    {
+      try { verifier.reset(new signature_verifier(public_key)); }
+      catch (...) { verifiers.erase(public_key); throw; }
+    }
+    return *verifier;
+  }
+
+  size_t signature_verifier::build_message(const pricing_record& pr, char *buf, size_t size)
+  {
+    const int len = snprintf(buf, size, "{\"spot\":%" PRIu64 ",\"moving_average\":%" PRIu64 ",\"timestamp\":%" PRIu64 "}", pr.spot, pr.moving_average, pr.timestamp);
+    CHECK_AND_ASSERT_THROW_MES(len > 0 && (size_t)len < size, "Pricing record message does not fit the buffer");
+    return len;
+  }
+
+  crypto::hash signature_verifier::get_record_hash(const pricing_record& pr)
+  {
+    signed_fields fields;
+    fields.spot = pr.spot;
+    fields.moving_average = pr.moving_average;
+    fields.timestamp = pr.timestamp;
+    memcpy(fields.signature, pr.signature, sizeof(fields.signature));
+    return crypto::cn_fast_hash(&fields, sizeof(fields));
+  }
+
+  bool signature_verifier::verify(const pricing_record& pr, bool use_cache) const
+  {
+    crypto::hash record_hash;
+    if (use_cache)
+    {
+      record_hash = get_record_hash(pr);
+      if (m_verified.has(record_hash))
+        return true;
+    }
+
+    char message[MESSAGE_BUFFER_SIZE];
+    const size_t message_len = build_message(pr, message, sizeof(message));
+
+    EVP_MD_CTX *ctx = get_thread_md_ctx();
+    int ret = 0;
+    if (ctx) {
+      ret = EVP_DigestVerifyInit(ctx, NULL, EVP_sha256(), NULL, m_pubkey);
+      if (ret == 1) {
+        ret = EVP_DigestVerifyUpdate(ctx, message, message_len);
+        if (ret == 1) {
+          ret = EVP_DigestVerifyFinal(ctx, (const unsigned char *)pr.signature, 64);
+        }
+      }
+    }
+
+    if (ret == 1)
+    {
+      if (use_cache)
+        m_verified.add(record_hash);
+      return true;
+    }
+
+    // Get the errors from OpenSSL
+    ERR_print_errors_fp (stderr);
+
+    return false;
+  }
+}
@@ -0,0 +1,93 @@
+// Copyright (c) 2023, Zephyr Protocol
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#pragma once
+
+#include <openssl/evp.h>
+
+#include <cstddef>
+#include <string>
+
+#include "common/data_cache.h"
+#include "crypto/hash.h"
+
+namespace oracle
+{
+  class pricing_record;
+
+  /**
+   * @brief verifies oracle signatures on pricing records
+   *
+   * The PEM public key is parsed once, each thread reuses its own digest
+   * context, and the canonical message is formatted into a stack buffer.
+   * Records that verified successfully are remembered by hash, so the same
+   * record seen again (pool, block template, block validation) is not
+   * verified twice.
+   */
+  class signature_verifier
+  {
+  public:
+    //! throws if the key cannot be parsed
+    explicit signature_verifier(const std::string& public_key);
+    ~signature_verifier();
+
+    signature_verifier(const signature_verifier&) = delete;
+    signature_verifier& operator=(const signature_verifier&) = delete;
+
+    /**
+     * @brief checks the oracle signature of a pricing record
+     *
+     * @param pr the record to check, only spot, moving_average and timestamp are signed
+     * @param use_cache whether to look up and remember successful verifications
+     *
+     * @return true if the signature is valid for this key
+     */
+    bool verify(const pricing_record& pr, bool use_cache = true) const;
+
+    /**
+     * @brief gets the shared verifier for a public key, creating it on first use
+     */
+    static const signature_verifier& get(const std::string& public_key);
+
+    /**
+     * @brief formats the message the oracle signs
+     *
+     * @return the message length, not counting the terminating null
+     */
+    static size_t build_message(const pricing_record& pr, char *buf, size_t size);
+
+    static constexpr const size_t MESSAGE_BUFFER_SIZE = 128;
+
+  private:
+    static crypto::hash get_record_hash(const pricing_record& pr);
+
+    EVP_PKEY *m_pubkey;
+    mutable tools::data_cache<crypto::hash, 1024> m_verified;
+  };
+}
@@ -28,6 +28,10 @@
 // STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
 // THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#include <deque>
+#include <unordered_map>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/lock_guard.hpp>
 #include "misc_log_ex.h"
 #include "misc_language.h"
 #include "common/perf_timer.h"
@@ -123,6 +127,118 @@ namespace
 }
 
 namespace rct {
+    namespace
+    {
+      // CONVERSION_TYPES[i] uses conversion_context::inverse_rates[i]
+      const cryptonote::transaction_type CONVERSION_TYPES[4] = {
+        cryptonote::transaction_type::MINT_STABLE,
+        cryptonote::transaction_type::REDEEM_STABLE,
+        cryptonote::transaction_type::MINT_RESERVE,
+        cryptonote::transaction_type::REDEEM_RESERVE
+      };
+
+      // the rate the output commitments of a conversion are scaled by
+      uint64_t get_conversion_rate(const oracle::pricing_record &pr, cryptonote::transaction_type tx_type)
+      {
+        using tt = cryptonote::transaction_type;
+        if (tx_type == tt::MINT_STABLE) {
+          boost::multiprecision::uint128_t exchange_128 = std::max(pr.stable, pr.stable_ma);
+          boost::multiprecision::uint128_t rate_128 = COIN;
+          rate_128 *= COIN;
+          rate_128 /= exchange_128;
+          boost::multiprecision::uint128_t conversion_fee = (rate_128 * 2) / 100; // 2% fee
+          rate_128 -= conversion_fee;
+          rate_128 -= (rate_128 % 10000);
+          return (uint64_t)rate_128;
+        } else if (tx_type == tt::REDEEM_STABLE) {
+          boost::multiprecision::uint128_t exchange_128 = std::min(pr.stable, pr.stable_ma);
+          boost::multiprecision::uint128_t conversion_fee = (exchange_128 * 2) / 100; // 2% fee
+          exchange_128 -= conversion_fee;
+          exchange_128 -= (exchange_128 % 10000);
+          return (uint64_t)exchange_128;
+        } else if (tx_type == tt::MINT_RESERVE) {
+          uint64_t reserve_coin_price = std::max(pr.reserve, pr.reserve_ma);
+          boost::multiprecision::uint128_t rate_128 = COIN;
+          rate_128 *= COIN;
+          rate_128 /= reserve_coin_price;
+          rate_128 -= (rate_128 % 10000);
+          return (uint64_t)rate_128;
+        } else if (tx_type == tt::REDEEM_RESERVE) {
+          boost::multiprecision::uint128_t reserve_coin_price = std::min(pr.reserve, pr.reserve_ma);
+          boost::multiprecision::uint128_t conversion_fee = (reserve_coin_price * 2) / 100; // 2% fee
+          reserve_coin_price -= conversion_fee;
+          reserve_coin_price -= (reserve_coin_price % 10000);
+          return (uint64_t)reserve_coin_price;
+        }
+        throw std::runtime_error("Not a conversion transaction type");
+      }
+
+      std::shared_ptr<const conversion_context> make_conversion_context(const oracle::pricing_record &pr)
+      {
+        std::shared_ptr<conversion_context> ctx = std::make_shared<conversion_context>();
+        ctx->atomic = d2h(COIN);
+        for (size_t i = 0; i < 4; ++i)
+        {
+          ctx->inverse_rates[i] = zero();
+          ctx->has_rate[i] = false;
+          try
+          {
+            ctx->inverse_rates[i] = invert(d2h(get_conversion_rate(pr, CONVERSION_TYPES[i])));
+            ctx->has_rate[i] = true;
+          }
+          // a zero rate divides by zero, only fatal if a tx actually needs it
+          catch (const std::exception &) {}
+        }
+        return ctx;
+      }
+
+      // contexts of the last few pricing records, keyed by the hash of the rates
+      boost::mutex conversion_context_lock;
+      std::unordered_map<crypto::hash, std::shared_ptr<const conversion_context>> conversion_contexts;
+      std::deque<crypto::hash> conversion_context_order;
+      static const size_t CONVERSION_CONTEXT_CACHE_SIZE = 64;
+    }
+
+    const key &conversion_context::get_inverse_rate(cryptonote::transaction_type type) const
+    {
+      for (size_t i = 0; i < 4; ++i)
+      {
+        if (CONVERSION_TYPES[i] == type)
+        {
+          CHECK_AND_ASSERT_THROW_MES(has_rate[i], "Invalid conversion rate in pricing record");
+          return inverse_rates[i];
+        }
+      }
+      throw std::runtime_error("Not a conversion transaction type");
+    }
+
+    std::shared_ptr<const conversion_context> get_conversion_context(const oracle::pricing_record &pr)
+    {
+      const uint64_t rates[4] = {pr.stable, pr.stable_ma, pr.reserve, pr.reserve_ma};
+      const crypto::hash key_hash = crypto::cn_fast_hash(rates, sizeof(rates));
+
+      {
+        boost::lock_guard<boost::mutex> lock(conversion_context_lock);
+        auto it = conversion_contexts.find(key_hash);
+        if (it != conversion_contexts.end())
+          return it->second;
+      }
+
+      std::shared_ptr<const conversion_context> ctx = make_conversion_context(pr);
+
+      boost::lock_guard<boost::mutex> lock(conversion_context_lock);
+      if (conversion_contexts.emplace(key_hash, ctx).second)
+      {
+        conversion_context_order.push_back(key_hash);
+        if (conversion_context_order.size() > CONVERSION_CONTEXT_CACHE_SIZE)
+        {
+          conversion_contexts.erase(conversion_context_order.front());
+          conversion_context_order.pop_front();
+        }
+      }
+      return ctx;
+    }
+
     Bulletproof proveRangeBulletproof(keyV &C, keyV &masks, const std::vector<uint64_t> &amounts, epee::span<const key> sk, hw::device &hwdev)
     {
         CHECK_AND_ASSERT_THROW_MES(amounts.size() == sk.size(), "Invalid amounts/sk sizes");
@@ -1267,8 +1383,9 @@ namespace rct {
         }
 
         key sumout = zero();
-        key atomic = d2h(COIN);
-        key inverse_atomic = invert(atomic);
+        std::shared_ptr<const conversion_context> conversion;
+        if (tx_type == tt::MINT_STABLE || tx_type == tt::REDEEM_STABLE || tx_type == tt::MINT_RESERVE || tx_type == tt::REDEEM_RESERVE)
+          conversion = get_conversion_context(pr);
         for (i = 0; i < outSk.size(); ++i)
         {
             key outSk_scaled = zero();
@@ -1277,61 +1394,32 @@ namespace rct {
             // Convert commitment mask by exchange rate for equalKeys() testing
             if (tx_type == tt::MINT_STABLE) {
               if (outamounts_features[i] == "ZEPHUSD") {
-                boost::multiprecision::uint128_t exchange_128 = std::max(pr.stable, pr.stable_ma);
-                boost::multiprecision::uint128_t rate_128 = COIN;
-                rate_128 *= COIN;
-                rate_128 /= exchange_128;
-                boost::multiprecision::uint128_t conversion_fee = (rate_128 * 2) / 100; // 2% fee
-                rate_128 -= conversion_fee;
-                rate_128 -= (rate_128 % 10000);
-
-                key inverse_rate = invert(d2h((uint64_t)rate_128));
-                sc_mul(tempkey.bytes, outSk[i].mask.bytes, atomic.bytes);
-                sc_mul(outSk_scaled.bytes, tempkey.bytes, inverse_rate.bytes);
+                sc_mul(tempkey.bytes, outSk[i].mask.bytes, conversion->atomic.bytes);
+                sc_mul(outSk_scaled.bytes, tempkey.bytes, conversion->get_inverse_rate(tx_type).bytes);
               } else {
                 // ZEPH change output
                 outSk_scaled = outSk[i].mask;
               }
             } else if (tx_type == tt::REDEEM_STABLE) {
               if (outamounts_features[i] == "ZEPH") {
-                boost::multiprecision::uint128_t exchange_128 = std::min(pr.stable, pr.stable_ma);
-                boost::multiprecision::uint128_t conversion_fee = (exchange_128 * 2) / 100; // 2% fee
-                exchange_128 -= conversion_fee;
-                exchange_128 -= (exchange_128 % 10000);
-
-                key inverse_rate = invert(d2h((uint64_t)exchange_128));
-                sc_mul(tempkey.bytes, outSk[i].mask.bytes, atomic.bytes);
-                sc_mul(outSk_scaled.bytes, tempkey.bytes, inverse_rate.bytes);
+                sc_mul(tempkey.bytes, outSk[i].mask.bytes, conversion->atomic.bytes);
+                sc_mul(outSk_scaled.bytes, tempkey.bytes, conversion->get_inverse_rate(tx_type).bytes);
               } else {
                 // ZEPHUSD change output
                 outSk_scaled = outSk[i].mask;
               }
             } else if (tx_type == tt::MINT_RESERVE) {
-               if (outamounts_features[i] == "ZEPHRSV") {
-                uint64_t reserve_coin_price = std::max(pr.reserve, pr.reserve_ma);
-                boost::multiprecision::uint128_t rate_128 = COIN;
-                rate_128 *= COIN;
-                rate_128 /= reserve_coin_price;
-                rate_128 -= (rate_128 % 10000);
-                
-                key inverse_rate = invert(d2h((uint64_t)rate_128));
-
-                sc_mul(tempkey.bytes, outSk[i].mask.bytes, atomic.bytes);
-                sc_mul(outSk_scaled.bytes, tempkey.bytes, inverse_rate.bytes);
+              if (outamounts_features[i] == "ZEPHRSV") {
+                sc_mul(tempkey.bytes, outSk[i].mask.bytes, conversion->atomic.bytes);
+                sc_mul(outSk_scaled.bytes, tempkey.bytes, conversion->get_inverse_rate(tx_type).bytes);
               } else {
                 // ZEPH change output
                 outSk_scaled = outSk[i].mask;
               }
             } else if (tx_type == tt::REDEEM_RESERVE) {
               if (outamounts_features[i] == "ZEPH") {
-                boost::multiprecision::uint128_t reserve_coin_price = std::min(pr.reserve, pr.reserve_ma);
-                boost::multiprecision::uint128_t conversion_fee = (reserve_coin_price * 2) / 100; // 2% fee
-                reserve_coin_price -= conversion_fee;
-                reserve_coin_price -= (reserve_coin_price % 10000);
-
-                key inverse_rate = invert(d2h((uint64_t)reserve_coin_price));
-                sc_mul(tempkey.bytes, outSk[i].mask.bytes, atomic.bytes);
-                sc_mul(outSk_scaled.bytes, tempkey.bytes, inverse_rate.bytes);
+                sc_mul(tempkey.bytes, outSk[i].mask.bytes, conversion->atomic.bytes);
+                sc_mul(outSk_scaled.bytes, tempkey.bytes, conversion->get_inverse_rate(tx_type).bytes);
               } else {
                 // ZEPHRSV change output
                 outSk_scaled = outSk[i].mask;
@@ -1504,9 +1592,10 @@ namespace rct {
     // fdG' = fee in USD = 0
     // D'k = outPk_usd[k].mask
     //
-    //ver RingCT simple
+    //ver RingCT simple, everything but the range proofs: layout, asset types,
+    //the per colour sums (Zi) and the amount burnt for conversions
     //assumes only post-rct style inputs (at least for max anonymity)
-    bool verRctSemanticsSimple(
+    static bool verRctSemanticsSimpleNoRangeProofs(
       const rctSig& rv, 
       const oracle::pricing_record& pr,
       const cryptonote::transaction_type& tx_type,
@@ -1520,13 +1609,6 @@ namespace rct {
 
       try
       {
-        PERF_TIMER(verRctSemanticsSimple);
-
-        tools::threadpool& tpool = tools::threadpool::getInstanceForCompute();
-        tools::threadpool::waiter waiter(tpool);
-        std::deque<bool> results;
-        std::vector<const Bulletproof*> proofs;
-        size_t max_non_bp_proofs = 0, offset = 0;
         using tt = cryptonote::transaction_type;
 
         const bool bulletproof_plus = is_rct_bulletproof_plus(rv.type);
@@ -1598,49 +1680,10 @@ namespace rct {
 
 
         // CALCULATE Zi
-        if (tx_type == tt::MINT_STABLE) {
-          boost::multiprecision::uint128_t exchange_128 = std::max(pr.stable, pr.stable_ma);
-          boost::multiprecision::uint128_t rate_128 = COIN;
-          rate_128 *= COIN;
-          rate_128 /= exchange_128;
-          boost::multiprecision::uint128_t conversion_fee = (rate_128 * 2) / 100; // 2% fee
-          rate_128 -= conversion_fee;
-          rate_128 -= (rate_128 % 10000);
-
-          key D_scaled = scalarmultKey(sumD, d2h(COIN));
-          key yC_invert = invert(d2h((uint64_t)rate_128));
-          key D_final = scalarmultKey(D_scaled, yC_invert);
-          Zi = addKeys(sumC, D_final);
-        } else if (tx_type == tt::REDEEM_STABLE) {
-          boost::multiprecision::uint128_t exchange_128 = std::min(pr.stable, pr.stable_ma);
-          boost::multiprecision::uint128_t conversion_fee = (exchange_128 * 2) / 100; // 2% fee
-          exchange_128 -= conversion_fee;
-          exchange_128 -= (exchange_128 % 10000);
-
-          key D_scaled = scalarmultKey(sumD, d2h(COIN));
-          key yC_invert = invert(d2h((uint64_t)exchange_128));
-          key D_final = scalarmultKey(D_scaled, yC_invert);
-          Zi = addKeys(sumC, D_final);
-        } else if (tx_type == tt::MINT_RESERVE) {
-          uint64_t reserve_coin_price = std::max(pr.reserve, pr.reserve_ma);
-          boost::multiprecision::uint128_t rate_128 = COIN;
-          rate_128 *= COIN;
-          rate_128 /= reserve_coin_price;
-          rate_128 -= (rate_128 % 10000);
-
-          key D_scaled = scalarmultKey(sumD, d2h(COIN));
-          key yC_invert = invert(d2h((uint64_t)rate_128));
-          key D_final = scalarmultKey(D_scaled, yC_invert);
-          Zi = addKeys(sumC, D_final);
-        } else if (tx_type == tt::REDEEM_RESERVE) {
-          boost::multiprecision::uint128_t reserve_coin_price = std::min(pr.reserve, pr.reserve_ma);
-          boost::multiprecision::uint128_t conversion_fee = (reserve_coin_price * 2) / 100; // 2% fee
-          reserve_coin_price -= conversion_fee;
-          reserve_coin_price -= (reserve_coin_price % 10000);
-          
-          key D_scaled = scalarmultKey(sumD, d2h(COIN));
-          key yC_invert = invert(d2h((uint64_t)reserve_coin_price));
-          key D_final = scalarmultKey(D_scaled, yC_invert);
+        if (tx_type == tt::MINT_STABLE || tx_type == tt::REDEEM_STABLE || tx_type == tt::MINT_RESERVE || tx_type == tt::REDEEM_RESERVE) {
+          std::shared_ptr<const conversion_context> conversion = get_conversion_context(pr);
+          key D_scaled = scalarmultKey(sumD, conversion->atomic);
+          key D_final = scalarmultKey(D_scaled, conversion->get_inverse_rate(tx_type));
           Zi = addKeys(sumC, D_final);
         } else if (tx_type == tt::TRANSFER || tx_type == tt::STABLE_TRANSFER || tx_type == tt::RESERVE_TRANSFER) {
           Zi = addKeys(sumC, sumD);
@@ -1682,26 +1725,136 @@ namespace rct {
           }
         }
 
-        for (size_t i = 0; i < rv.p.bulletproofs.size(); i++)
-          proofs.push_back(&rv.p.bulletproofs[i]);
-      
-        if (!proofs.empty() && !verBulletproof(proofs))
+        return true;
+      }
+      // we can get deep throws from ge_frombytes_vartime if input isn't valid
+      catch (const std::exception &e)
+      {
+        LOG_PRINT_L1("Error in verRctSemanticsSimple: " << e.what());
+        return false;
+      }
+      catch (...)
+      {
+        LOG_PRINT_L1("Error in verRctSemanticsSimple, but not an actual exception");
+        return false;
+      }
+    }
+
+    //ver RingCT simple
+    //assumes only post-rct style inputs (at least for max anonymity)
+    bool verRctSemanticsSimple(
+      const rctSig& rv, 
+      const oracle::pricing_record& pr,
+      const cryptonote::transaction_type& tx_type,
+      const std::string& strSource, 
+      const std::string& strDest,
+      uint64_t amount_burnt,
+      const std::vector<cryptonote::tx_out> &vout,
+      const std::vector<cryptonote::txin_v> &vin,
+      const uint8_t version
+    ){
+      PERF_TIMER(verRctSemanticsSimple);
+
+      if (!verRctSemanticsSimpleNoRangeProofs(rv, pr, tx_type, strSource, strDest, amount_burnt, vout, vin, version))
+        return false;
+
+      std::vector<const Bulletproof*> proofs;
+      proofs.reserve(rv.p.bulletproofs.size());
+      for (const Bulletproof &proof: rv.p.bulletproofs)
+        proofs.push_back(&proof);
+
+      if (!proofs.empty() && !verBulletproof(proofs))
+      {
+        LOG_PRINT_L1("Aggregate range proof verified failed");
+        return false;
+      }
+
+      return true;
+    }
+
+    //ver RingCT simple for a batch of transactions
+    //the per transaction checks run on the threadpool, and the range proofs of
+    //all transactions are verified together
+    //only rv.p.bulletproofs are batched, as in the single transaction check above:
+    //the BP+ proofs that RCTTypeBulletproofPlus (and so every conversion) carries
+    //are only checked against outPk in size here, verifying them would tighten
+    //consensus and has to come with a hard fork
+    bool verRctSemanticsSimple(const std::vector<semantics_data> &txs, const uint8_t version, std::vector<bool> *failed)
+    {
+      if (failed)
+        failed->assign(txs.size(), false);
+      try
+      {
+        PERF_TIMER(verRctSemanticsSimple);
+
+        tools::threadpool& tpool = tools::threadpool::getInstanceForCompute();
+        tools::threadpool::waiter waiter(tpool);
+        std::deque<bool> results(txs.size(), false);
+        std::vector<const Bulletproof*> proofs;
+
+        for (size_t i = 0; i < txs.size(); ++i)
+        {
+          const semantics_data &tx = txs[i];
+          CHECK_AND_ASSERT_MES(tx.rv && tx.pr && tx.source && tx.dest && tx.vout && tx.vin, false, "Incomplete semantics data");
+          tpool.submit(&waiter, [&results, &tx, i, version] {
+            results[i] = verRctSemanticsSimpleNoRangeProofs(*tx.rv, *tx.pr, tx.tx_type, *tx.source, *tx.dest, tx.amount_burnt, *tx.vout, *tx.vin, version);
+          });
+          for (const Bulletproof &proof: tx.rv->p.bulletproofs)
+            proofs.push_back(&proof);
+        }
+
+        if (!waiter.wait())
+          return false;
+        bool all_passed = true;
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+          if (!results[i])
+          {
+            LOG_PRINT_L1("Semantics check failed for tx " << i << " in batch");
+            all_passed = false;
+            if (failed)
+              (*failed)[i] = true;
+          }
+        }
+
+        if (all_passed)
         {
+          if (proofs.empty() || verBulletproof(proofs))
+            return true;
           LOG_PRINT_L1("Aggregate range proof verified failed");
+        }
+        if (!failed)
           return false;
+
+        // find which of the others have bad range proofs
+        for (size_t i = 0; i < txs.size(); ++i)
+        {
+          if (!results[i])
+            continue;
+          proofs.clear();
+          for (const Bulletproof &proof: txs[i].rv->p.bulletproofs)
+            proofs.push_back(&proof);
+          if (!proofs.empty() && !verBulletproof(proofs))
+          {
+            LOG_PRINT_L1("Range proof verified failed for tx " << i << " in batch");
+            (*failed)[i] = true;
+          }
         }
-        
-        return true;
+        return false;
       }
       // we can get deep throws from ge_frombytes_vartime if input isn't valid
       catch (const std::exception &e)
       {
         LOG_PRINT_L1("Error in verRctSemanticsSimple: " << e.what());
+        if (failed)
+          failed->assign(txs.size(), true);
         return false;
       }
       catch (...)
       {
         LOG_PRINT_L1("Error in verRctSemanticsSimple, but not an actual exception");
+        if (failed)
+          failed->assign(txs.size(), true);
         return false;
       }
     }
@@ -36,6 +36,7 @@
 #define RCTSIGS_H
 
 #include <cstddef>
+#include <memory>
 #include <vector>
 #include <tuple>
 
@@ -168,6 +169,25 @@ namespace rct {
     static inline bool verRct(const rctSig & rv) { return verRct(rv, true) && verRct(rv, false); }
     
     bool verRctSemanticsSimple(const rctSig & rv, const oracle::pricing_record& pr, const cryptonote::transaction_type& type, const std::string& strSource, const std::string& strDest, uint64_t amount_burnt, const std::vector<cryptonote::tx_out> &vout, const std::vector<cryptonote::txin_v> &vin, const uint8_t version);
+
+    // what verRctSemanticsSimple needs to know about one transaction
+    struct semantics_data
+    {
+      const rctSig *rv;
+      const oracle::pricing_record *pr;
+      cryptonote::transaction_type tx_type;
+      const std::string *source;
+      const std::string *dest;
+      uint64_t amount_burnt;
+      const std::vector<cryptonote::tx_out> *vout;
+      const std::vector<cryptonote::txin_v> *vin;
+    };
+    // true if every transaction passes, the range proofs are verified in one batch.
+    // Like the single transaction version, only bulletproofs are range checked,
+    // not the bulletproofs_plus of RCTTypeBulletproofPlus transactions.
+    // If failed is given, it is set to which transactions did not pass; when the
+    // batched range proofs fail they are then checked one transaction at a time
+    bool verRctSemanticsSimple(const std::vector<semantics_data> &txs, const uint8_t version, std::vector<bool> *failed = NULL);
     bool verRctSemanticsSimple(const rctSig & rv);
 
     bool verRctNonSemanticsSimple(const rctSig & rv);
@@ -179,6 +199,20 @@ namespace rct {
     key get_pre_mlsag_hash(const rctSig &rv, hw::device &hwdev);
 
     bool validateMintedAmount(const rctSig &rv, const xmr_amount amount_burnt, const xmr_amount amount_minted, const oracle::pricing_record pr, const std::string& source, const std::string& destination, const uint8_t version);
+
+    // scalars that only depend on the pricing record: the atomic unit and the
+    // inverse of the fee adjusted rate of each conversion type, shared by every
+    // conversion tx built or verified against the same record
+    struct conversion_context
+    {
+      key atomic;
+      key inverse_rates[4];
+      bool has_rate[4];
+
+      // throws if type is not a conversion or its rate could not be derived
+      const key &get_inverse_rate(cryptonote::transaction_type type) const;
+    };
+    std::shared_ptr<const conversion_context> get_conversion_context(const oracle::pricing_record &pr);
 }
 #endif  /* RCTSIGS_H */
 
@@ -75,6 +75,8 @@ using namespace epee;
 #define RESTRICTED_TRANSACTIONS_COUNT 100
 #define RESTRICTED_SPENT_KEY_IMAGES_COUNT 5000
 #define RESTRICTED_BLOCK_COUNT 1000
+#define RESTRICTED_RESERVE_HISTORY_COUNT 1000
+#define RESTRICTED_SIMULATED_CONVERSIONS_COUNT 1000
 
 #define RPC_TRACKER(rpc) \
   PERF_TIMER(rpc); \
@@ -144,6 +146,44 @@ namespace
   {
     store_128(difficulty, sdiff, swdiff, stop64);
   }
+
+  const char *get_conversion_type_name(cryptonote::transaction_type tx_type)
+  {
+    switch (tx_type)
+    {
+      case cryptonote::transaction_type::MINT_STABLE: return "mint_stable";
+      case cryptonote::transaction_type::REDEEM_STABLE: return "redeem_stable";
+      case cryptonote::transaction_type::MINT_RESERVE: return "mint_reserve";
+      case cryptonote::transaction_type::REDEEM_RESERVE: return "redeem_reserve";
+      default: return "unknown";
+    }
+  }
+
+  bool get_conversion_type_from_name(const std::string &name, cryptonote::transaction_type &tx_type)
+  {
+    for (cryptonote::transaction_type t: {cryptonote::transaction_type::MINT_STABLE, cryptonote::transaction_type::REDEEM_STABLE, cryptonote::transaction_type::MINT_RESERVE, cryptonote::transaction_type::REDEEM_RESERVE})
+    {
+      if (name == get_conversion_type_name(t))
+      {
+        tx_type = t;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  const char *get_conversion_status_name(cryptonote::conversion_status status)
+  {
+    switch (status)
+    {
+      case cryptonote::conversion_status::eligible: return "eligible";
+      case cryptonote::conversion_status::pr_too_old: return "pricing_record_too_old";
+      case cryptonote::conversion_status::pr_too_new: return "pricing_record_too_new";
+      case cryptonote::conversion_status::no_pricing_record: return "no_pricing_record";
+      case cryptonote::conversion_status::reserve_ratio: return "reserve_ratio";
+      default: return "unknown";
+    }
+  }
 }
 
 namespace cryptonote
@@ -549,6 +589,15 @@ namespace cryptonote
     res.synchronized = check_core_ready();
     res.busy_syncing = m_p2p.get_payload_object().is_busy_syncing();
     res.restricted = restricted;
+    if (!restricted)
+    {
+      const oracle_fetcher::stats_t oracle_stats = m_core.get_blockchain_storage().get_oracle_fetcher_stats();
+      res.oracle_fetches = oracle_stats.fetches;
+      res.oracle_fetch_failures = oracle_stats.failures;
+      res.oracle_last_fetch_latency_ms = oracle_stats.last_latency_ms;
+      res.oracle_max_fetch_latency_ms = oracle_stats.max_latency_ms;
+      res.oracle_last_fetch_time = oracle_stats.last_success_time;
+    }
 
     res.status = CORE_RPC_STATUS_OK;
     return true;
@@ -3023,12 +3072,13 @@ namespace cryptonote
   bool core_rpc_server::on_get_circulating_supply(const COMMAND_RPC_GET_CIRCULATING_SUPPLY::request& req, COMMAND_RPC_GET_CIRCULATING_SUPPLY::response& res, epee::json_rpc::error& error_resp, const connection_context *ctx)
   {
     PERF_TIMER(on_get_circulating_supply);
-    std::vector<std::pair<std::string, std::string>> amounts = m_core.get_blockchain_storage().get_db().get_circulating_supply();
-    for (const auto &i: amounts)
+    const cryptonote::circ_supply_snapshot supply = m_core.get_blockchain_storage().get_circulating_supply();
+    for (size_t i = 0; i < supply.tally.size(); ++i)
     {
-      COMMAND_RPC_GET_CIRCULATING_SUPPLY::supply_entry se(i.first, i.second);
+      COMMAND_RPC_GET_CIRCULATING_SUPPLY::supply_entry se(oracle::ASSET_TYPES[i], supply.tally[i].str());
       res.supply_tally.push_back(se);
     }
+    res.height = supply.height;
     res.status = CORE_RPC_STATUS_OK;
     return true;    
   }
@@ -3036,7 +3086,7 @@ namespace cryptonote
   bool core_rpc_server::on_get_reserve_info(const COMMAND_RPC_GET_RESERVE_INFO::request& req, COMMAND_RPC_GET_RESERVE_INFO::response& res, epee::json_rpc::error& error_res, const connection_context *ctx)
   {
     PERF_TIMER(on_get_reserve_info);
-    std::vector<std::pair<std::string, std::string>> circ_supply = m_core.get_blockchain_storage().get_db().get_circulating_supply();
+    const cryptonote::circ_supply_snapshot circ_supply = m_core.get_blockchain_storage().get_circulating_supply();
     uint64_t current_height = m_core.get_current_blockchain_height();
 
     oracle::pricing_record pr;
@@ -3073,6 +3123,163 @@ namespace cryptonote
     return true;
   }
   //------------------------------------------------------------------------------------------------------------------------------
+  bool core_rpc_server::on_get_pool_conversions(const COMMAND_RPC_GET_POOL_CONVERSIONS::request& req, COMMAND_RPC_GET_POOL_CONVERSIONS::response& res, epee::json_rpc::error& error_resp, const connection_context *ctx)
+  {
+    RPC_TRACKER(get_pool_conversions);
+    const bool restricted = m_restricted && ctx;
+    const bool request_has_rpc_origin = ctx != NULL;
+    const bool allow_sensitive = !request_has_rpc_origin || !restricted;
+
+    std::vector<tx_memory_pool::conversion_info> conversions;
+    if (!m_core.get_pool_conversions(conversions, allow_sensitive))
+    {
+      error_resp.code = CORE_RPC_ERROR_CODE_INTERNAL_ERROR;
+      error_resp.message = "Failed to get pool conversions";
+      return false;
+    }
+
+    res.conversions.reserve(conversions.size());
+    for (const tx_memory_pool::conversion_info &c: conversions)
+    {
+      if (req.stuck_only && c.status == conversion_status::eligible)
+        continue;
+      pool_conversion_entry e;
+      e.id_hash = epee::string_tools::pod_to_hex(c.txid);
+      e.tx_type = get_conversion_type_name(c.tx_type);
+      e.pricing_record_height = c.pricing_record_height;
+      e.amount_burnt = c.amount_burnt;
+      e.amount_minted = c.amount_minted;
+      e.status = get_conversion_status_name(c.status);
+      res.conversions.push_back(std::move(e));
+    }
+    res.height = m_core.get_current_blockchain_height();
+    res.status = CORE_RPC_STATUS_OK;
+    return true;
+  }
+  //------------------------------------------------------------------------------------------------------------------------------
+  bool core_rpc_server::on_simulate_conversions(const COMMAND_RPC_SIMULATE_CONVERSIONS::request& req, COMMAND_RPC_SIMULATE_CONVERSIONS::response& res, epee::json_rpc::error& error_resp, const connection_context *ctx)
+  {
+    RPC_TRACKER(simulate_conversions);
+    const bool restricted = m_restricted && ctx;
+    if (restricted && req.conversions.size() > RESTRICTED_SIMULATED_CONVERSIONS_COUNT)
+    {
+      error_resp.code = CORE_RPC_ERROR_CODE_RESTRICTED;
+      error_resp.message = "Too many conversions requested.";
+      return false;
+    }
+
+    const cryptonote::circ_supply_snapshot circ_supply = m_core.get_blockchain_storage().get_circulating_supply();
+    const uint64_t current_height = m_core.get_current_blockchain_height();
+    oracle::pricing_record pr;
+    if (!get_pricing_record(pr, current_height - 1))
+    {
+      error_resp.code = CORE_RPC_ERROR_CODE_INTERNAL_ERROR;
+      error_resp.message = "Failed to get pricing record";
+      return false;
+    }
+
+    // each conversion is checked with the changes of the allowed ones before
+    // it applied, as they would be in a single block
+    const cryptonote::reserve_engine engine(circ_supply, pr);
+    boost::multiprecision::int128_t tally_zeph = 0, tally_stables = 0, tally_reserves = 0;
+    res.results.reserve(req.conversions.size());
+    for (const COMMAND_RPC_SIMULATE_CONVERSIONS::conversion &c: req.conversions)
+    {
+      cryptonote::transaction_type tx_type;
+      if (!get_conversion_type_from_name(c.tx_type, tx_type))
+      {
+        error_resp.code = CORE_RPC_ERROR_CODE_WRONG_PARAM;
+        error_resp.message = "Unknown conversion type: " + c.tx_type;
+        return false;
+      }
+
+      COMMAND_RPC_SIMULATE_CONVERSIONS::result r;
+      r.tx_type = c.tx_type;
+      r.amount_burnt = c.amount_burnt;
+      r.amount_minted = engine.get_amount_minted(tx_type, c.amount_burnt);
+
+      boost::multiprecision::int128_t delta_zeph, delta_stables, delta_reserves;
+      cryptonote::reserve_tally::get_conversion_delta(tx_type, r.amount_burnt, r.amount_minted, delta_zeph, delta_stables, delta_reserves);
+      delta_zeph += tally_zeph;
+      delta_stables += tally_stables;
+      delta_reserves += tally_reserves;
+
+      r.allowed = engine.check(tx_type, delta_zeph, delta_stables, delta_reserves, r.error);
+      double reserve_ratio = 0, reserve_ratio_ma = 0;
+      if (engine.get_reserve_ratios(delta_zeph, delta_stables, reserve_ratio, reserve_ratio_ma))
+      {
+        r.reserve_ratio = std::to_string(reserve_ratio);
+        r.reserve_ratio_ma = std::to_string(reserve_ratio_ma);
+      }
+      if (r.allowed && req.cumulative)
+      {
+        tally_zeph = delta_zeph;
+        tally_stables = delta_stables;
+        tally_reserves = delta_reserves;
+      }
+      res.results.push_back(std::move(r));
+    }
+
+    res.height = current_height;
+    res.pr = pr;
+    res.reserve_ratio = std::to_string(engine.reserve_ratio());
+    res.reserve_ratio_ma = std::to_string(engine.reserve_ratio_ma());
+    res.status = CORE_RPC_STATUS_OK;
+    return true;
+  }
+  //------------------------------------------------------------------------------------------------------------------------------
+  bool core_rpc_server::on_get_reserve_history(const COMMAND_RPC_GET_RESERVE_HISTORY::request& req, COMMAND_RPC_GET_RESERVE_HISTORY::response& res, epee::json_rpc::error& error_resp, const connection_context *ctx)
+  {
+    PERF_TIMER(on_get_reserve_history);
+    const uint64_t bc_height = m_core.get_current_blockchain_height();
+    if (req.start_height >= bc_height || req.end_height >= bc_height || req.start_height > req.end_height)
+    {
+      error_resp.code = CORE_RPC_ERROR_CODE_TOO_BIG_HEIGHT;
+      error_resp.message = "Invalid start/end heights.";
+      return false;
+    }
+    if (req.stride == 0)
+    {
+      error_resp.code = CORE_RPC_ERROR_CODE_WRONG_PARAM;
+      error_resp.message = "Stride must be non zero.";
+      return false;
+    }
+    const bool restricted = m_restricted && ctx;
+    if (restricted && (req.end_height - req.start_height) / req.stride >= RESTRICTED_RESERVE_HISTORY_COUNT)
+    {
+      error_resp.code = CORE_RPC_ERROR_CODE_RESTRICTED;
+      error_resp.message = "Too many reserve history entries requested.";
+      return false;
+    }
+
+    std::vector<cryptonote::reserve_history_entry> history;
+    try
+    {
+      history = m_core.get_blockchain_storage().get_db().get_reserve_history(req.start_height, req.end_height, req.stride);
+    }
+    catch (const std::exception &e)
+    {
+      error_resp.code = CORE_RPC_ERROR_CODE_INTERNAL_ERROR;
+      error_resp.message = std::string("Failed to get reserve history: ") + e.what();
+      return false;
+    }
+
+    res.history.reserve(history.size());
+    for (const cryptonote::reserve_history_entry &e: history)
+    {
+      res.history.emplace_back();
+      COMMAND_RPC_GET_RESERVE_HISTORY::entry &entry = res.history.back();
+      entry.height = e.height;
+      entry.zeph_reserve = e.zeph_reserve.str();
+      entry.num_stables = e.num_stables.str();
+      entry.num_reserves = e.num_reserves.str();
+      entry.spot = e.spot;
+      entry.moving_average = e.moving_average;
+    }
+    res.status = CORE_RPC_STATUS_OK;
+    return true;
+  }
+  //------------------------------------------------------------------------------------------------------------------------------
   bool core_rpc_server::on_get_base_fee_estimate(const COMMAND_RPC_GET_BASE_FEE_ESTIMATE::request& req, COMMAND_RPC_GET_BASE_FEE_ESTIMATE::response& res, epee::json_rpc::error& error_resp, const connection_context *ctx)
   {
     RPC_TRACKER(get_base_fee_estimate);
@@ -3515,6 +3722,41 @@ namespace cryptonote
     return true;
   }
   //------------------------------------------------------------------------------------------------------------------------------
+  bool core_rpc_server::on_get_fee_histogram_bin(const COMMAND_RPC_GET_FEE_HISTOGRAM::request& req, COMMAND_RPC_GET_FEE_HISTOGRAM::response& res, const connection_context *ctx)
+  {
+    RPC_TRACKER(get_fee_histogram_bin);
+    bool r;
+    if (use_bootstrap_daemon_if_necessary<COMMAND_RPC_GET_FEE_HISTOGRAM>(invoke_http_mode::BIN, "/get_fee_histogram.bin", req, res, r))
+      return r;
+
+    CHECK_PAYMENT(req, res, COST_PER_FEE_HISTOGRAM);
+
+    const bool restricted = m_restricted && ctx;
+    const bool request_has_rpc_origin = ctx != NULL;
+    const bool allow_sensitive = !request_has_rpc_origin || !restricted;
+
+    std::map<std::string, fee_histogram::buckets> histogram;
+    if (!m_core.get_pool_fee_histogram(histogram, allow_sensitive))
+    {
+      res.status = "Failed to get fee histogram";
+      return true;
+    }
+
+    res.histograms.reserve(histogram.size());
+    for (const auto &asset: histogram)
+    {
+      fee_histogram_entry entry;
+      entry.fee_asset_type = asset.first;
+      entry.buckets.reserve(asset.second.size());
+      for (const auto &b: asset.second)
+        entry.buckets.push_back({fee_histogram::get_bucket_min_fee_per_byte(b.first), b.second.txs, b.second.weight, b.second.fee});
+      res.histograms.push_back(std::move(entry));
+    }
+
+    res.status = CORE_RPC_STATUS_OK;
+    return true;
+  }
+  //------------------------------------------------------------------------------------------------------------------------------
   bool core_rpc_server::on_prune_blockchain(const COMMAND_RPC_PRUNE_BLOCKCHAIN::request& req, COMMAND_RPC_PRUNE_BLOCKCHAIN::response& res, epee::json_rpc::error& error_resp, const connection_context *ctx)
   {
     RPC_TRACKER(prune_blockchain);
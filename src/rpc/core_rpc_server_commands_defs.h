@@ -88,7 +88,7 @@ namespace cryptonote
 // advance which version they will stop working with
 // Don't go over 32767 for any of these
 #define CORE_RPC_VERSION_MAJOR 3
-#define CORE_RPC_VERSION_MINOR 12
+#define CORE_RPC_VERSION_MINOR 18
 #define MAKE_CORE_RPC_VERSION(major,minor) (((major)<<16)|(minor))
 #define CORE_RPC_VERSION MAKE_CORE_RPC_VERSION(CORE_RPC_VERSION_MAJOR, CORE_RPC_VERSION_MINOR)
 
@@ -773,6 +773,11 @@ namespace cryptonote
       std::string version;
       bool synchronized;
       bool restricted;
+      uint64_t oracle_fetches;
+      uint64_t oracle_fetch_failures;
+      uint64_t oracle_last_fetch_latency_ms;
+      uint64_t oracle_max_fetch_latency_ms;
+      uint64_t oracle_last_fetch_time;
 
       BEGIN_KV_SERIALIZE_MAP()
         KV_SERIALIZE_PARENT(rpc_access_response_base)
@@ -815,6 +820,11 @@ namespace cryptonote
         KV_SERIALIZE(version)
         KV_SERIALIZE(synchronized)
         KV_SERIALIZE(restricted)
+        KV_SERIALIZE_OPT(oracle_fetches, (uint64_t)0)
+        KV_SERIALIZE_OPT(oracle_fetch_failures, (uint64_t)0)
+        KV_SERIALIZE_OPT(oracle_last_fetch_latency_ms, (uint64_t)0)
+        KV_SERIALIZE_OPT(oracle_max_fetch_latency_ms, (uint64_t)0)
+        KV_SERIALIZE_OPT(oracle_last_fetch_time, (uint64_t)0)
       END_KV_SERIALIZE_MAP()
     };
     typedef epee::misc_utils::struct_init<response_t> response;
@@ -1727,6 +1737,47 @@ namespace cryptonote
     typedef epee::misc_utils::struct_init<response_t> response;
   };
 
+  struct fee_histogram_bucket
+  {
+    uint64_t fee_per_byte; // lowest fee per byte in the bucket
+    uint64_t txs;
+    uint64_t weight;
+    uint64_t fee;
+  };
+
+  struct fee_histogram_entry
+  {
+    std::string fee_asset_type;
+    std::vector<fee_histogram_bucket> buckets;
+
+    BEGIN_KV_SERIALIZE_MAP()
+      KV_SERIALIZE(fee_asset_type)
+      KV_SERIALIZE_CONTAINER_POD_AS_BLOB(buckets)
+    END_KV_SERIALIZE_MAP()
+  };
+
+  struct COMMAND_RPC_GET_FEE_HISTOGRAM
+  {
+    struct request_t: public rpc_access_request_base
+    {
+      BEGIN_KV_SERIALIZE_MAP()
+        KV_SERIALIZE_PARENT(rpc_access_request_base)
+      END_KV_SERIALIZE_MAP()
+    };
+    typedef epee::misc_utils::struct_init<request_t> request;
+
+    struct response_t: public rpc_access_response_base
+    {
+      std::vector<fee_histogram_entry> histograms;
+
+      BEGIN_KV_SERIALIZE_MAP()
+        KV_SERIALIZE_PARENT(rpc_access_response_base)
+        KV_SERIALIZE(histograms)
+      END_KV_SERIALIZE_MAP()
+    };
+    typedef epee::misc_utils::struct_init<response_t> response;
+  };
+
   struct txpool_histo
   {
     uint32_t txs;
@@ -1753,8 +1804,11 @@ namespace cryptonote
     uint64_t histo_98pc;
     std::vector<txpool_histo> histo;
     uint32_t num_double_spends;
+    uint64_t parsed_cache_hits;
+    uint64_t parsed_cache_misses;
+    uint64_t parsed_cache_bytes;
 
-    txpool_stats(): bytes_total(0), bytes_min(0), bytes_max(0), bytes_med(0), fee_total(0), oldest(0), txs_total(0), num_failing(0), num_10m(0), num_not_relayed(0), histo_98pc(0), num_double_spends(0) {}
+    txpool_stats(): bytes_total(0), bytes_min(0), bytes_max(0), bytes_med(0), fee_total(0), oldest(0), txs_total(0), num_failing(0), num_10m(0), num_not_relayed(0), histo_98pc(0), num_double_spends(0), parsed_cache_hits(0), parsed_cache_misses(0), parsed_cache_bytes(0) {}
 
     BEGIN_KV_SERIALIZE_MAP()
       KV_SERIALIZE(bytes_total)
@@ -1770,6 +1824,9 @@ namespace cryptonote
       KV_SERIALIZE(histo_98pc)
       KV_SERIALIZE(histo)
       KV_SERIALIZE(num_double_spends)
+      KV_SERIALIZE_OPT(parsed_cache_hits, (uint64_t)0)
+      KV_SERIALIZE_OPT(parsed_cache_misses, (uint64_t)0)
+      KV_SERIALIZE_OPT(parsed_cache_bytes, (uint64_t)0)
     END_KV_SERIALIZE_MAP()
   };
 
@@ -2206,10 +2263,12 @@ namespace cryptonote
     {
       std::string status;
       std::vector<supply_entry> supply_tally;
+      uint64_t height;
 
       BEGIN_KV_SERIALIZE_MAP()
         KV_SERIALIZE(status)
         KV_SERIALIZE(supply_tally)
+        KV_SERIALIZE_OPT(height, (uint64_t)0)
       END_KV_SERIALIZE_MAP()
     };
     typedef epee::misc_utils::struct_init<response_t> response;
@@ -2260,6 +2319,169 @@ namespace cryptonote
     typedef epee::misc_utils::struct_init<response_t> response;
   };
 
+  struct COMMAND_RPC_GET_RESERVE_HISTORY
+  {
+    struct request_t
+    {
+      uint64_t start_height;
+      uint64_t end_height;
+      uint64_t stride;
+
+      BEGIN_KV_SERIALIZE_MAP()
+        KV_SERIALIZE(start_height)
+        KV_SERIALIZE(end_height)
+        KV_SERIALIZE_OPT(stride, (uint64_t)1)
+      END_KV_SERIALIZE_MAP()
+    };
+    typedef epee::misc_utils::struct_init<request_t> request;
+
+    // raw tallies and prices only, the reserve ratios follow from them:
+    // spot ratio = zeph_reserve * spot / (num_stables * COIN), likewise with moving_average
+    struct entry
+    {
+      uint64_t height;
+      std::string zeph_reserve;
+      std::string num_stables;
+      std::string num_reserves;
+      uint64_t spot;
+      uint64_t moving_average;
+
+      BEGIN_KV_SERIALIZE_MAP()
+        KV_SERIALIZE(height)
+        KV_SERIALIZE(zeph_reserve)
+        KV_SERIALIZE(num_stables)
+        KV_SERIALIZE(num_reserves)
+        KV_SERIALIZE(spot)
+        KV_SERIALIZE(moving_average)
+      END_KV_SERIALIZE_MAP()
+    };
+
+    struct response_t
+    {
+      std::string status;
+      std::vector<entry> history;
+
+      BEGIN_KV_SERIALIZE_MAP()
+        KV_SERIALIZE(status)
+        KV_SERIALIZE(history)
+      END_KV_SERIALIZE_MAP()
+    };
+    typedef epee::misc_utils::struct_init<response_t> response;
+  };
+
+  struct pool_conversion_entry
+  {
+    std::string id_hash;
+    std::string tx_type;
+    uint64_t pricing_record_height;
+    uint64_t amount_burnt;
+    uint64_t amount_minted;
+    std::string status;
+
+    BEGIN_KV_SERIALIZE_MAP()
+      KV_SERIALIZE(id_hash)
+      KV_SERIALIZE(tx_type)
+      KV_SERIALIZE(pricing_record_height)
+      KV_SERIALIZE(amount_burnt)
+      KV_SERIALIZE(amount_minted)
+      KV_SERIALIZE(status)
+    END_KV_SERIALIZE_MAP()
+  };
+
+  struct COMMAND_RPC_GET_POOL_CONVERSIONS
+  {
+    struct request_t
+    {
+      bool stuck_only;
+
+      BEGIN_KV_SERIALIZE_MAP()
+        KV_SERIALIZE_OPT(stuck_only, false)
+      END_KV_SERIALIZE_MAP()
+    };
+    typedef epee::misc_utils::struct_init<request_t> request;
+
+    struct response_t
+    {
+      std::string status;
+      uint64_t height;
+      std::vector<pool_conversion_entry> conversions;
+
+      BEGIN_KV_SERIALIZE_MAP()
+        KV_SERIALIZE(status)
+        KV_SERIALIZE(height)
+        KV_SERIALIZE(conversions)
+      END_KV_SERIALIZE_MAP()
+    };
+    typedef epee::misc_utils::struct_init<response_t> response;
+  };
+
+  struct COMMAND_RPC_SIMULATE_CONVERSIONS
+  {
+    struct conversion
+    {
+      std::string tx_type;
+      uint64_t amount_burnt;
+
+      BEGIN_KV_SERIALIZE_MAP()
+        KV_SERIALIZE(tx_type)
+        KV_SERIALIZE(amount_burnt)
+      END_KV_SERIALIZE_MAP()
+    };
+
+    struct request_t
+    {
+      std::vector<conversion> conversions;
+      bool cumulative;
+
+      BEGIN_KV_SERIALIZE_MAP()
+        KV_SERIALIZE(conversions)
+        KV_SERIALIZE_OPT(cumulative, true)
+      END_KV_SERIALIZE_MAP()
+    };
+    typedef epee::misc_utils::struct_init<request_t> request;
+
+    struct result
+    {
+      std::string tx_type;
+      uint64_t amount_burnt;
+      uint64_t amount_minted;
+      bool allowed;
+      std::string error;
+      std::string reserve_ratio;
+      std::string reserve_ratio_ma;
+
+      BEGIN_KV_SERIALIZE_MAP()
+        KV_SERIALIZE(tx_type)
+        KV_SERIALIZE(amount_burnt)
+        KV_SERIALIZE(amount_minted)
+        KV_SERIALIZE(allowed)
+        KV_SERIALIZE(error)
+        KV_SERIALIZE(reserve_ratio)
+        KV_SERIALIZE(reserve_ratio_ma)
+      END_KV_SERIALIZE_MAP()
+    };
+
+    struct response_t
+    {
+      std::string status;
+      uint64_t height;
+      oracle::pricing_record pr;
+      std::string reserve_ratio;
+      std::string reserve_ratio_ma;
+      std::vector<result> results;
+
+      BEGIN_KV_SERIALIZE_MAP()
+        KV_SERIALIZE(status)
+        KV_SERIALIZE(height)
+        KV_SERIALIZE(pr)
+        KV_SERIALIZE(reserve_ratio)
+        KV_SERIALIZE(reserve_ratio_ma)
+        KV_SERIALIZE(results)
+      END_KV_SERIALIZE_MAP()
+    };
+    typedef epee::misc_utils::struct_init<response_t> response;
+  };
+
   struct COMMAND_RPC_GET_OUTPUT_HISTOGRAM
   {
     struct request_t: public rpc_access_request_base
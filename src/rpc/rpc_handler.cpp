@@ -1,9 +1,11 @@
 
 #include <algorithm>
+#include <array>
 #include <boost/thread/locks.hpp>
 #include <boost/thread/mutex.hpp>
 
 #include "cryptonote_core/cryptonote_core.h"
+#include "oracle/asset_types.h"
 
 namespace cryptonote
 {
@@ -23,93 +25,152 @@ namespace rpc
 
       return {std::move(distribution), start_height, base, num_spendable_global_outs};
     }
+
+    void trim_distribution(std::vector<std::uint64_t> &distribution, std::uint64_t from_height, std::uint64_t to_height, std::uint64_t start_height)
+    {
+      if (to_height > 0 && to_height >= from_height)
+      {
+        const std::uint64_t offset = std::max(from_height, start_height);
+        if (offset <= to_height && to_height - offset + 1 < distribution.size())
+          distribution.resize(to_height - offset + 1);
+      }
+    }
+
+    // rct distribution for one asset type, shared by all RPC threads
+    struct output_distribution_cache
+    {
+      boost::mutex mutex;
+      std::vector<std::uint64_t> cached_distribution;
+      std::uint64_t cached_from, cached_to, cached_start_height, cached_base, cached_num_spendable_global_outs;
+      crypto::hash cached_m10_hash;
+      crypto::hash cached_top_hash;
+      bool cached;
+      output_distribution_cache(): cached_from(0), cached_to(0), cached_start_height(0), cached_base(0), cached_num_spendable_global_outs(0), cached_m10_hash(crypto::null_hash), cached_top_hash(crypto::null_hash), cached(false) {}
+    };
+
+    // the part of the cached distribution starting at from_height, which
+    // must lie within the cached range
+    boost::optional<output_distribution_data>
+      get_cached_suffix(const output_distribution_cache &d, bool cumulative, std::uint64_t from_height)
+    {
+      CHECK_AND_ASSERT_MES(from_height >= d.cached_start_height && from_height - d.cached_start_height < d.cached_distribution.size(), boost::none, "Requested height is not in the cached distribution");
+      const std::size_t offset = from_height - d.cached_start_height;
+      std::vector<std::uint64_t> distribution(d.cached_distribution.begin() + offset, d.cached_distribution.end());
+      const std::uint64_t base = offset > 0 ? d.cached_distribution[offset - 1] : d.cached_base;
+      return process_distribution(cumulative, from_height, std::move(distribution), base, d.cached_num_spendable_global_outs);
+    }
+
+    output_distribution_cache &get_output_distribution_cache(oracle::asset_id asset)
+    {
+      static std::array<output_distribution_cache, oracle::NUM_ASSET_TYPES> caches;
+      return caches[static_cast<size_t>(asset)];
+    }
   }
 
   boost::optional<output_distribution_data>
     RpcHandler::get_output_distribution(const std::function<bool(uint64_t, std::string, uint64_t, uint64_t, uint64_t&, std::vector<uint64_t>&, uint64_t&, uint64_t&)> &f, uint64_t amount, std::string asset_type, uint64_t from_height, uint64_t to_height, const std::function<crypto::hash(uint64_t)> &get_hash, bool cumulative, uint64_t blockchain_height)
   {
       LOG_PRINT_L3("RpcHandler::get_output_distribution");
-      // static struct D
-      // {
-      //   boost::mutex mutex;
-      //   std::vector<std::uint64_t> cached_distribution;
-      //   std::uint64_t cached_from, cached_to, cached_start_height, cached_base;
-      //   crypto::hash cached_m10_hash;
-      //   crypto::hash cached_top_hash;
-      //   bool cached;
-      //   D(): cached_from(0), cached_to(0), cached_start_height(0), cached_base(0), cached_m10_hash(crypto::null_hash), cached_top_hash(crypto::null_hash), cached(false) {}
-      // } d;
-      // const boost::unique_lock<boost::mutex> lock(d.mutex);
-
-      // crypto::hash top_hash = crypto::null_hash;
-      // if (d.cached_to < blockchain_height)
-      //   top_hash = get_hash(d.cached_to);
-      // if (d.cached && amount == 0 && d.cached_from == from_height && d.cached_to == to_height && d.cached_top_hash == top_hash)
-      //   return process_distribution(cumulative, d.cached_start_height, d.cached_distribution, d.cached_base);
 
       std::vector<std::uint64_t> distribution;
       std::uint64_t start_height, base;
       uint64_t num_spendable_global_outs = 0;
 
-      // // see if we can extend the cache - a common case
-      // bool can_extend = d.cached && amount == 0 && d.cached_from == from_height && to_height > d.cached_to && top_hash == d.cached_top_hash;
-      // if (!can_extend)
-      // {
-      //   // we kept track of the hash 10 blocks below, if it exists, so if it matches,
-      //   // we can still pop the last 10 cached slots and try again
-      //   if (d.cached && amount == 0 && d.cached_from == from_height && d.cached_to - d.cached_from >= 10 && to_height > d.cached_to - 10)
-      //   {
-      //     crypto::hash hash10 = get_hash(d.cached_to - 10);
-      //     if (hash10 == d.cached_m10_hash)
-      //     {
-      //       d.cached_to -= 10;
-      //       d.cached_top_hash = hash10;
-      //       d.cached_m10_hash = crypto::null_hash;
-      //       CHECK_AND_ASSERT_MES(d.cached_distribution.size() >= 10, boost::none, "Cached distribution size does not match cached bounds");
-      //       for (int p = 0; p < 10; ++p)
-      //         d.cached_distribution.pop_back();
-      //       can_extend = true;
-      //     }
-      //   }
-      // }
-      // if (can_extend)
-      // {
-      //   std::vector<std::uint64_t> new_distribution;
-      //   if (!f(amount, asset_type, d.cached_to + 1, to_height, start_height, new_distribution, base))
-      //     return boost::none;
-      //   distribution = d.cached_distribution;
-      //   distribution.reserve(distribution.size() + new_distribution.size());
-      //   for (const auto &e: new_distribution)
-      //     distribution.push_back(e);
-      //   start_height = d.cached_start_height;
-      //   base = d.cached_base;
-      // }
-      // else
-      // {
+      // only rct distributions of known asset types are cached
+      const oracle::asset_id asset = oracle::get_asset_id(asset_type);
+      if (amount != 0 || !oracle::is_valid_asset_id(asset) || to_height < from_height)
+      {
         if (!f(amount, asset_type, from_height, to_height, start_height, distribution, base, num_spendable_global_outs))
           return boost::none;
-      // }
+        trim_distribution(distribution, from_height, to_height, start_height);
+        return process_distribution(cumulative, start_height, std::move(distribution), base, num_spendable_global_outs);
+      }
 
-      if (to_height > 0 && to_height >= from_height)
+      // requests for the same asset type wait for each other, so that
+      // concurrent wallets extend the cache once instead of each reading
+      // the whole distribution
+      output_distribution_cache &d = get_output_distribution_cache(asset);
+      const boost::unique_lock<boost::mutex> lock(d.mutex);
+
+      // wallets ask from the top of their own copy, so any range starting
+      // within the cached one is served from it, and the cache stays
+      // anchored at the lowest height asked for
+      const bool covered = d.cached && d.cached_from <= from_height;
+      crypto::hash top_hash = crypto::null_hash;
+      if (d.cached_to < blockchain_height)
+        top_hash = get_hash(d.cached_to);
+      if (covered && d.cached_to == to_height && d.cached_top_hash == top_hash)
+        return get_cached_suffix(d, cumulative, from_height);
+
+      // see if we can extend the cache - a common case
+      bool can_extend = covered && to_height > d.cached_to && top_hash == d.cached_top_hash;
+      if (!can_extend)
       {
-        const std::uint64_t offset = std::max(from_height, start_height);
-        if (offset <= to_height && to_height - offset + 1 < distribution.size())
-          distribution.resize(to_height - offset + 1);
+        // we kept track of the hash 10 blocks below, if it exists, so if it matches,
+        // we can still pop the last 10 cached slots and try again
+        if (covered && d.cached_to - d.cached_from >= 10 && to_height > d.cached_to - 10 && d.cached_to - 10 < blockchain_height)
+        {
+          crypto::hash hash10 = get_hash(d.cached_to - 10);
+          if (hash10 == d.cached_m10_hash)
+          {
+            d.cached_to -= 10;
+            d.cached_top_hash = hash10;
+            d.cached_m10_hash = crypto::null_hash;
+            CHECK_AND_ASSERT_MES(d.cached_distribution.size() >= 10, boost::none, "Cached distribution size does not match cached bounds");
+            for (int p = 0; p < 10; ++p)
+              d.cached_distribution.pop_back();
+            can_extend = true;
+          }
+        }
+      }
+
+      // the spendable output count is read CRYPTONOTE_DEFAULT_TX_SPENDABLE_AGE
+      // blocks below the top of the requested range, so the new range has to
+      // reach at least that far down, even if part of it is already cached
+      uint64_t fetch_from = 0;
+      if (can_extend)
+      {
+        fetch_from = d.cached_to + 1;
+        if (to_height + 2 < fetch_from + CRYPTONOTE_DEFAULT_TX_SPENDABLE_AGE)
+          fetch_from = to_height + 2 > CRYPTONOTE_DEFAULT_TX_SPENDABLE_AGE ? to_height + 2 - CRYPTONOTE_DEFAULT_TX_SPENDABLE_AGE : 0;
+        can_extend = fetch_from > d.cached_start_height && d.cached_distribution.size() == d.cached_to - d.cached_start_height + 1;
       }
 
-      // if (amount == 0)
-      // {
-      //   d.cached_from = from_height;
-      //   d.cached_to = to_height;
-      //   d.cached_top_hash = get_hash(d.cached_to);
-      //   d.cached_m10_hash = d.cached_to >= 10 ? get_hash(d.cached_to - 10) : crypto::null_hash;
-      //   d.cached_distribution = distribution;
-      //   d.cached_start_height = start_height;
-      //   d.cached_base = base;
-      //   d.cached = true;
-      // }
-
-      return process_distribution(cumulative, start_height, std::move(distribution), base, num_spendable_global_outs);
+      if (can_extend)
+      {
+        std::vector<std::uint64_t> new_distribution;
+        uint64_t new_start_height, new_base;
+        if (!f(amount, asset_type, fetch_from, to_height, new_start_height, new_distribution, new_base, num_spendable_global_outs))
+          return boost::none;
+        const size_t overlap = d.cached_to + 1 - fetch_from;
+        CHECK_AND_ASSERT_MES(new_start_height == fetch_from && new_distribution.size() >= overlap, boost::none, "Unexpected distribution extension");
+        distribution = d.cached_distribution;
+        distribution.reserve(distribution.size() + new_distribution.size() - overlap);
+        distribution.insert(distribution.end(), new_distribution.begin() + overlap, new_distribution.end());
+        start_height = d.cached_start_height;
+        base = d.cached_base;
+      }
+      else
+      {
+        // read everything again, from genesis if that is what was cached
+        const uint64_t anchor = d.cached ? std::min(d.cached_from, from_height) : from_height;
+        if (!f(amount, asset_type, anchor, to_height, start_height, distribution, base, num_spendable_global_outs))
+          return boost::none;
+        d.cached_from = anchor;
+      }
+
+      trim_distribution(distribution, d.cached_from, to_height, start_height);
+
+      d.cached_to = to_height;
+      d.cached_top_hash = get_hash(d.cached_to);
+      d.cached_m10_hash = d.cached_to >= 10 ? get_hash(d.cached_to - 10) : crypto::null_hash;
+      d.cached_distribution = std::move(distribution);
+      d.cached_start_height = start_height;
+      d.cached_base = base;
+      d.cached_num_spendable_global_outs = num_spendable_global_outs;
+      d.cached = true;
+
+      return get_cached_suffix(d, cumulative, from_height);
   }
 } // rpc
 } // cryptonote
@@ -0,0 +1,65 @@
+// Copyright (c) 2014-2023, The Monero Project
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// Parts of this file are originally copyright (c) 2012-2013 The Cryptonote developers
+
+#pragma once
+
+#include <string>
+
+#include "serialization.h"
+#include "string.h"
+#include "oracle/asset_types.h"
+
+// asset ids are serialized as their asset type string, unknown asset types fail to load
+template <template <bool> class Archive>
+inline bool do_serialize(Archive<false> &ar, oracle::asset_id &id)
+{
+  std::string asset_type;
+  if (!do_serialize(ar, asset_type))
+    return false;
+  id = oracle::get_asset_id(asset_type);
+  if (!oracle::is_valid_asset_id(id))
+  {
+    ar.set_fail();
+    return false;
+  }
+  return true;
+}
+
+template <template <bool> class Archive>
+inline bool do_serialize(Archive<true> &ar, oracle::asset_id &id)
+{
+  if (!oracle::is_valid_asset_id(id))
+  {
+    ar.set_fail();
+    return false;
+  }
+  std::string asset_type = oracle::get_asset_type(id);
+  return do_serialize(ar, asset_type);
+}
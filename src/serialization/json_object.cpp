@@ -552,7 +552,11 @@ void toJsonValue(rapidjson::Writer<epee::byte_stream>& dest, const cryptonote::t
   dest.StartObject();
 
   INSERT_INTO_JSON_OBJECT(dest, key, txout.key);
-  INSERT_INTO_JSON_OBJECT(dest, asset_type, txout.asset_type);
+  if (!oracle::is_valid_asset_id(txout.asset_type))
+  {
+    throw BAD_INPUT();
+  }
+  INSERT_INTO_JSON_OBJECT(dest, asset_type, oracle::get_asset_type(txout.asset_type));
   INSERT_INTO_JSON_OBJECT(dest, view_tag, txout.view_tag);
 
   dest.EndObject();
@@ -565,9 +569,15 @@ void fromJsonValue(const rapidjson::Value& val, cryptonote::txout_zephyr_tagged_
     throw WRONG_TYPE("json object");
   }
 
+  std::string asset_type;
   GET_FROM_JSON_OBJECT(val, txout.key, key);
-  GET_FROM_JSON_OBJECT(val, txout.asset_type, asset_type);
+  GET_FROM_JSON_OBJECT(val, asset_type, asset_type);
   GET_FROM_JSON_OBJECT(val, txout.view_tag, view_tag);
+  txout.asset_type = oracle::get_asset_id(asset_type);
+  if (!oracle::is_valid_asset_id(txout.asset_type))
+  {
+    throw BAD_INPUT();
+  }
 }
 
 void toJsonValue(rapidjson::Writer<epee::byte_stream>& dest, const cryptonote::tx_out& txout)
@@ -61,6 +61,7 @@ NodeRPCProxy::NodeRPCProxy(epee::net_utils::http::abstract_http_client &http_cli
 void NodeRPCProxy::invalidate()
 {
   m_height = 0;
+  m_top_hash = crypto::null_hash;
   for (size_t n = 0; n < 256; ++n)
     m_earliest_height[n] = 0;
   m_dynamic_base_fee_estimate = 0;
@@ -76,6 +77,13 @@ void NodeRPCProxy::invalidate()
   m_height_time = 0;
   m_target_height_time = 0;
   m_daemon_hard_forks.clear();
+  m_circ_supply = cryptonote::circ_supply_snapshot();
+  m_circ_supply_cached_height = 0;
+  m_circ_supply_cached_top_hash = crypto::null_hash;
+  m_pricing_record = oracle::pricing_record();
+  m_pricing_record_height = 0;
+  m_pricing_record_cached_height = 0;
+  m_pricing_record_cached_top_hash = crypto::null_hash;
 }
 
 boost::optional<std::string> NodeRPCProxy::get_rpc_version(uint32_t &rpc_version, std::vector<std::pair<uint8_t, uint64_t>> &daemon_hard_forks, uint64_t &height, uint64_t &target_height)
@@ -100,6 +108,7 @@ boost::optional<std::string> NodeRPCProxy::get_rpc_version(uint32_t &rpc_version
     if (resp_t.current_height > 0 || resp_t.target_height > 0)
     {
       m_height = resp_t.current_height;
+      m_top_hash = crypto::null_hash;
       m_target_height = resp_t.target_height;
       m_height_time = now;
       m_target_height_time = now;
@@ -117,9 +126,10 @@ boost::optional<std::string> NodeRPCProxy::get_rpc_version(uint32_t &rpc_version
   return boost::optional<std::string>();
 }
 
-void NodeRPCProxy::set_height(uint64_t h)
+void NodeRPCProxy::set_height(uint64_t h, const crypto::hash &top_hash)
 {
   m_height = h;
+  m_top_hash = top_hash;
   m_height_time = time(NULL);
 }
 
@@ -140,6 +150,8 @@ boost::optional<std::string> NodeRPCProxy::get_info()
     }
 
     m_height = resp_t.height;
+    if (!epee::string_tools::hex_to_pod(resp_t.top_block_hash, m_top_hash))
+      m_top_hash = crypto::null_hash;
     m_target_height = resp_t.target_height;
     m_block_weight_limit = resp_t.block_weight_limit ? resp_t.block_weight_limit : resp_t.block_size_limit;
     m_adjusted_time = resp_t.adjusted_time;
@@ -166,6 +178,24 @@ boost::optional<std::string> NodeRPCProxy::get_height(uint64_t &height)
   return boost::optional<std::string>();
 }
 
+boost::optional<std::string> NodeRPCProxy::get_top_block(uint64_t &height, crypto::hash &top_hash)
+{
+  boost::optional<std::string> result = get_height(height);
+  if (result)
+    return result;
+
+  // the height may have come from get_version, which does not report the top block
+  if (m_top_hash == crypto::null_hash)
+  {
+    result = get_info();
+    if (result)
+      return result;
+    height = m_height;
+  }
+  top_hash = m_top_hash;
+  return boost::optional<std::string>();
+}
+
 boost::optional<std::string> NodeRPCProxy::get_target_height(uint64_t &height)
 {
   const time_t now = time(NULL);
@@ -302,6 +332,94 @@ boost::optional<std::string> NodeRPCProxy::get_fee_quantization_mask(uint64_t &f
   return boost::optional<std::string>();
 }
 
+boost::optional<std::string> NodeRPCProxy::get_circulating_supply(cryptonote::circ_supply_snapshot &amounts)
+{
+  uint64_t height;
+  crypto::hash top_hash;
+
+  boost::optional<std::string> result = get_top_block(height, top_hash);
+  if (result)
+    return result;
+
+  if (m_offline)
+    return boost::optional<std::string>("offline");
+
+  // a reorg to a chain of the same height only changes the top block hash
+  if (m_circ_supply_cached_height != height || m_circ_supply_cached_top_hash != top_hash)
+  {
+    cryptonote::COMMAND_RPC_GET_CIRCULATING_SUPPLY::request req_t = AUTO_VAL_INIT(req_t);
+    cryptonote::COMMAND_RPC_GET_CIRCULATING_SUPPLY::response resp_t = AUTO_VAL_INIT(resp_t);
+
+    {
+      const boost::lock_guard<boost::recursive_mutex> lock{m_daemon_rpc_mutex};
+      bool r = net_utils::invoke_http_json_rpc("/json_rpc", "get_circulating_supply", req_t, resp_t, m_http_client, rpc_timeout);
+      RETURN_ON_RPC_RESPONSE_ERROR(r, epee::json_rpc::error{}, resp_t, "get_circulating_supply");
+    }
+
+    cryptonote::circ_supply_snapshot supply;
+    for (const auto &i: resp_t.supply_tally)
+    {
+      size_t idx;
+      if (!cryptonote::circ_supply_snapshot::asset_index_from_string(i.currency_label, idx))
+        return boost::optional<std::string>("Unknown asset type in circulating supply from daemon: " + i.currency_label);
+      try
+      {
+        supply.tally[idx] = boost::multiprecision::uint128_t(i.amount);
+      }
+      catch (const std::exception &)
+      {
+        return boost::optional<std::string>("Invalid circulating supply amount from daemon for " + i.currency_label + ": " + i.amount);
+      }
+    }
+
+    // daemons that report the height the tallies were read at may be
+    // ahead of the height we polled, the cache stays keyed on the latter
+    supply.height = std::max(height, resp_t.height);
+    m_circ_supply = supply;
+    m_circ_supply_cached_height = height;
+    m_circ_supply_cached_top_hash = top_hash;
+  }
+
+  amounts = m_circ_supply;
+  return boost::optional<std::string>();
+}
+
+boost::optional<std::string> NodeRPCProxy::get_pricing_record(uint64_t height, oracle::pricing_record &pr)
+{
+  uint64_t daemon_height;
+  crypto::hash top_hash;
+
+  boost::optional<std::string> result = get_top_block(daemon_height, top_hash);
+  if (result)
+    return result;
+
+  if (m_offline)
+    return boost::optional<std::string>("offline");
+
+  // the block at a given height only changes on a reorg, which changes the
+  // top block hash even when the daemon height stays the same
+  if (m_pricing_record_cached_height != daemon_height || m_pricing_record_cached_top_hash != top_hash || m_pricing_record_height != height)
+  {
+    cryptonote::COMMAND_RPC_GET_BLOCK_HEADER_BY_HEIGHT::request req_t = AUTO_VAL_INIT(req_t);
+    cryptonote::COMMAND_RPC_GET_BLOCK_HEADER_BY_HEIGHT::response resp_t = AUTO_VAL_INIT(resp_t);
+    req_t.height = height;
+
+    {
+      const boost::lock_guard<boost::recursive_mutex> lock{m_daemon_rpc_mutex};
+      bool r = net_utils::invoke_http_json_rpc("/json_rpc", "getblockheaderbyheight", req_t, resp_t, m_http_client, rpc_timeout);
+      RETURN_ON_RPC_RESPONSE_ERROR(r, epee::json_rpc::error{}, resp_t, "getblockheaderbyheight");
+    }
+
+    m_pricing_record = resp_t.block_header.pricing_record;
+    m_pricing_record_height = height;
+    m_pricing_record_cached_height = daemon_height;
+    m_pricing_record_cached_top_hash = top_hash;
+  }
+
+  pr = m_pricing_record;
+  return boost::optional<std::string>();
+}
+
 boost::optional<std::string> NodeRPCProxy::get_transactions(const std::vector<crypto::hash> &txids, const std::function<void(const cryptonote::COMMAND_RPC_GET_TRANSACTIONS::request&, const cryptonote::COMMAND_RPC_GET_TRANSACTIONS::response&, bool)> &f)
 {
   const size_t SLICE_SIZE = 100; // RESTRICTED_TRANSACTIONS_COUNT as defined in rpc/core_rpc_server.cpp
@@ -34,6 +34,7 @@
 #include "include_base_utils.h"
 #include "net/abstract_http_client.h"
 #include "rpc/core_rpc_server_commands_defs.h"
+#include "cryptonote_basic/circ_supply.h"
 
 namespace tools
 {
@@ -48,7 +49,7 @@ public:
 
   boost::optional<std::string> get_rpc_version(uint32_t &rpc_version, std::vector<std::pair<uint8_t, uint64_t>> &daemon_hard_forks, uint64_t &height, uint64_t &target_height);
   boost::optional<std::string> get_height(uint64_t &height);
-  void set_height(uint64_t h);
+  void set_height(uint64_t h, const crypto::hash &top_hash);
   boost::optional<std::string> get_target_height(uint64_t &height);
   boost::optional<std::string> get_block_weight_limit(uint64_t &block_weight_limit);
   boost::optional<std::string> get_adjusted_time(uint64_t &adjusted_time);
@@ -56,16 +57,20 @@ public:
   boost::optional<std::string> get_dynamic_base_fee_estimate(uint64_t grace_blocks, uint64_t &fee);
   boost::optional<std::string> get_dynamic_base_fee_estimate_2021_scaling(uint64_t grace_blocks, std::vector<uint64_t> &fees);
   boost::optional<std::string> get_fee_quantization_mask(uint64_t &fee_quantization_mask);
+  boost::optional<std::string> get_circulating_supply(cryptonote::circ_supply_snapshot &amounts);
+  boost::optional<std::string> get_pricing_record(uint64_t height, oracle::pricing_record &pr);
   boost::optional<std::string> get_transactions(const std::vector<crypto::hash> &txids, const std::function<void(const cryptonote::COMMAND_RPC_GET_TRANSACTIONS::request&, const cryptonote::COMMAND_RPC_GET_TRANSACTIONS::response&, bool)> &f);
 
 private:
   boost::optional<std::string> get_info();
+  boost::optional<std::string> get_top_block(uint64_t &height, crypto::hash &top_hash);
 
   epee::net_utils::http::abstract_http_client &m_http_client;
   boost::recursive_mutex &m_daemon_rpc_mutex;
   bool m_offline;
 
   uint64_t m_height;
+  crypto::hash m_top_hash;
   uint64_t m_earliest_height[256];
   uint64_t m_dynamic_base_fee_estimate;
   uint64_t m_dynamic_base_fee_estimate_cached_height;
@@ -80,6 +85,13 @@ private:
   time_t m_height_time;
   time_t m_target_height_time;
   std::vector<std::pair<uint8_t, uint64_t>> m_daemon_hard_forks;
+  cryptonote::circ_supply_snapshot m_circ_supply;
+  uint64_t m_circ_supply_cached_height;
+  crypto::hash m_circ_supply_cached_top_hash;
+  oracle::pricing_record m_pricing_record;
+  uint64_t m_pricing_record_height;
+  uint64_t m_pricing_record_cached_height;
+  crypto::hash m_pricing_record_cached_top_hash;
 };
 
 }
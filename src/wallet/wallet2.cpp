@@ -88,6 +88,7 @@ using namespace epee;
 #include "ringct/rctSigs.h"
 #include "ringdb.h"
 #include "device/device_cold.hpp"
+#include "device/device_default.hpp"
 #include "device_trezor/device_trezor.hpp"
 #include "net/socks_connect.h"
 #include "oracle/asset_types.h"
@@ -967,6 +968,121 @@ bool get_pruned_tx(const cryptonote::COMMAND_RPC_GET_TRANSACTIONS::entry &entry,
   return false;
 }
 
+// FNV-1a, to tell whether a wallet cache entry changed since it was last stored
+uint64_t add_cache_fingerprint(uint64_t h, const void *data, size_t size)
+{
+  const uint8_t *p = (const uint8_t*)data;
+  for (size_t i = 0; i < size; ++i)
+  {
+    h ^= p[i];
+    h *= 0x100000001b3;
+  }
+  return h;
+}
+
+const uint64_t CACHE_FINGERPRINT_BASIS = 0xcbf29ce484222325;
+
+template<typename T>
+uint64_t get_cache_value_fingerprint(const T &v)
+{
+  std::string blob;
+  CHECK_AND_ASSERT_THROW_MES(::serialization::dump_binary(const_cast<T&>(v), blob), "Failed to serialize wallet cache entry");
+  const uint64_t h = add_cache_fingerprint(CACHE_FINGERPRINT_BASIS, blob.data(), blob.size());
+  memwipe(&blob[0], blob.size());
+  return h;
+}
+
+uint64_t get_cache_value_fingerprint(const crypto::secret_key &v)
+{
+  return add_cache_fingerprint(CACHE_FINGERPRINT_BASIS, &v, sizeof(v));
+}
+
+uint64_t get_cache_value_fingerprint(const std::vector<crypto::secret_key> &v)
+{
+  return add_cache_fingerprint(CACHE_FINGERPRINT_BASIS, v.data(), v.size() * sizeof(crypto::secret_key));
+}
+
+uint64_t get_cache_value_fingerprint(const crypto::key_image &v)
+{
+  return add_cache_fingerprint(CACHE_FINGERPRINT_BASIS, &v, sizeof(v));
+}
+
+// what changed in a wallet cache map since the fingerprints were taken
+template<typename M, typename D>
+void get_cache_journal_delta(const M &values, const std::unordered_map<typename M::key_type, uint64_t> &fingerprints, D &delta)
+{
+  delta.count = values.size();
+  for (const auto &e: values)
+  {
+    const uint64_t fingerprint = get_cache_value_fingerprint(e.second);
+    const auto i = fingerprints.find(e.first);
+    if (i != fingerprints.end() && i->second == fingerprint)
+      continue;
+    delta.changed.push_back(e);
+    delta.fingerprints.push_back(fingerprint);
+  }
+  for (const auto &e: fingerprints)
+    if (values.find(e.first) == values.end())
+      delta.removed.push_back(e.first);
+}
+
+template<typename K, typename D>
+void commit_cache_journal_delta(std::unordered_map<K, uint64_t> &fingerprints, const D &delta)
+{
+  for (size_t i = 0; i < delta.changed.size(); ++i)
+    fingerprints[delta.changed[i].first] = delta.fingerprints[i];
+  for (const K &k: delta.removed)
+    fingerprints.erase(k);
+}
+
+template<typename M, typename D>
+bool apply_cache_journal_delta(M &values, D &delta)
+{
+  for (const auto &k: delta.removed)
+    values.erase(k);
+  for (auto &e: delta.changed)
+    values[e.first] = std::move(e.second);
+  return values.size() == delta.count;
+}
+
+template<typename M>
+void reset_cache_journal_fingerprints(const M &values, std::unordered_map<typename M::key_type, uint64_t> &fingerprints)
+{
+  fingerprints.clear();
+  for (const auto &e: values)
+    fingerprints[e.first] = get_cache_value_fingerprint(e.second);
+}
+
+// sets have no values, only what was added or removed counts
+template<typename K, typename D>
+void get_cache_journal_delta(const std::unordered_set<K> &values, const std::unordered_set<K> &journaled, D &delta)
+{
+  delta.count = values.size();
+  for (const K &k: values)
+    if (journaled.find(k) == journaled.end())
+      delta.added.push_back(k);
+  for (const K &k: journaled)
+    if (values.find(k) == values.end())
+      delta.removed.push_back(k);
+}
+
+template<typename K, typename D>
+void commit_cache_journal_delta(std::unordered_set<K> &journaled, const D &delta)
+{
+  journaled.insert(delta.added.begin(), delta.added.end());
+  for (const K &k: delta.removed)
+    journaled.erase(k);
+}
+
+template<typename K, typename D>
+bool apply_cache_journal_delta(std::unordered_set<K> &values, D &delta)
+{
+  for (const K &k: delta.removed)
+    values.erase(k);
+  values.insert(delta.added.begin(), delta.added.end());
+  return values.size() == delta.count;
+}
+
   //-----------------------------------------------------------------
 } //namespace
 
@@ -1196,7 +1312,8 @@ wallet2::wallet2(network_type nettype, uint64_t kdf_rounds, bool unattended, std
   m_enable_multisig(false),
   m_pool_info_query_time(0),
   m_has_ever_refreshed_from_node(false),
-  m_allow_mismatched_daemon_version(false)
+  m_allow_mismatched_daemon_version(false),
+  m_cache_snapshot_id(crypto::null_hash)
 {
 }
 
@@ -1552,6 +1669,7 @@ void wallet2::expand_subaddresses(const cryptonote::subaddress_index& index)
       {
          const crypto::public_key &D = pkeys[index2.minor];
          m_subaddresses[D] = index2;
+         m_cache_journal.subaddresses.push_back(D);
       }
     }
     m_subaddress_labels.resize(index.major + 1, {"Untitled account"});
@@ -1569,6 +1687,7 @@ void wallet2::expand_subaddresses(const cryptonote::subaddress_index& index)
     {
        const crypto::public_key &D = pkeys[index2.minor - begin];
        m_subaddresses[D] = index2;
+       m_cache_journal.subaddresses.push_back(D);
     }
     m_subaddress_labels[index.major].resize(index.minor + 1);
   }
@@ -1578,6 +1697,7 @@ void wallet2::create_one_off_subaddress(const cryptonote::subaddress_index& inde
 {
   const crypto::public_key pkey = get_subaddress_spend_public_key(index);
   m_subaddresses[pkey] = index;
+  m_cache_journal.subaddresses.push_back(pkey);
 }
 //----------------------------------------------------------------------------------------------------
 std::string wallet2::get_subaddress_label(const cryptonote::subaddress_index& index) const
@@ -1619,6 +1739,11 @@ void wallet2::scan_tx(const std::vector<crypto::hash> &txids)
       txq.push(tx_info);
   }
 
+  // payments and confirmed txes at old heights are only journaled along with
+  // the blocks they are in, so the next store writes the full cache
+  if (!txq.empty())
+    m_cache_journal.compact = true;
+
   // Process the transactions in chronologically ascending order
   while(!txq.empty()) {
     auto& tx_info = txq.top();
@@ -1877,9 +2002,9 @@ void wallet2::scan_output(const cryptonote::transaction &tx, bool miner_tx, cons
     return;
   }
   outs.push_back(i);
-  THROW_WALLET_EXCEPTION_IF(tx_money_got_in_outs[tx_scan_info.received->index][tx_scan_info.asset_type] >= std::numeric_limits<uint64_t>::max() - tx_scan_info.money_transfered,
+  THROW_WALLET_EXCEPTION_IF(tx_money_got_in_outs[tx_scan_info.received->index][oracle::get_asset_type(tx_scan_info.asset_type)] >= std::numeric_limits<uint64_t>::max() - tx_scan_info.money_transfered,
       error::wallet_internal_error, "Overflow in received amounts");
-  tx_money_got_in_outs[tx_scan_info.received->index][tx_scan_info.asset_type] += tx_scan_info.money_transfered;
+  tx_money_got_in_outs[tx_scan_info.received->index][oracle::get_asset_type(tx_scan_info.asset_type)] += tx_scan_info.money_transfered;
   tx_scan_info.amount = tx_scan_info.money_transfered;
   ++num_vouts_received;
 }
@@ -1936,9 +2061,10 @@ bool wallet2::spends_one_of_ours(const cryptonote::transaction &tx) const
 //----------------------------------------------------------------------------------------------------
 wallet2::transfers_iterator_container wallet2::get_specific_transfers(const std::string& asset) {
   transfers_iterator_container asset_transfers;
+  const oracle::asset_id asset_id = oracle::get_asset_id(asset);
 
   for (auto i = m_transfers.begin(); i < m_transfers.end(); ++i) {
-    if (i->asset_type == asset) {
+    if (i->asset_type == asset_id) {
       asset_transfers.push_back(i);
     }
   }
@@ -1947,53 +2073,36 @@ wallet2::transfers_iterator_container wallet2::get_specific_transfers(const std:
 //----------------------------------------------------------------------------------------------------
 bool wallet2::get_pricing_record(oracle::pricing_record& pr, const uint64_t height)
 {
-  // Issue an RPC call to get the block header (and thus the pricing record) at the specified height
-  cryptonote::COMMAND_RPC_GET_BLOCK_HEADER_BY_HEIGHT::request req = AUTO_VAL_INIT(req);
-  cryptonote::COMMAND_RPC_GET_BLOCK_HEADER_BY_HEIGHT::response res = AUTO_VAL_INIT(res);
-  m_daemon_rpc_mutex.lock();
-  req.height = height;
-  bool r = invoke_http_json_rpc("/json_rpc", "getblockheaderbyheight", req, res, rpc_timeout);
-  m_daemon_rpc_mutex.unlock();
-  if (r && res.status == CORE_RPC_STATUS_OK)
+  // Get the pricing record from the block header at the specified height, cached until the daemon top block changes
+  oracle::pricing_record block_pr;
+  boost::optional<std::string> result = m_node_rpc_proxy.get_pricing_record(height, block_pr);
+  if (result)
   {
-    // Got the block header - verify the pricing record
-    if (res.block_header.pricing_record.empty() || res.block_header.pricing_record.has_missing_rates()) {
-      MERROR("Invalid pricing record in block header - oracle TXs disabled. Please try again later.");
-      return false;
-    }
-
-    // Return the pricing record we retrieved
-    pr = res.block_header.pricing_record;
-    return true;
+    MERROR("Failed to request block header from daemon: " << *result);
+    return false;
   }
-  else
-  {
-    MERROR("Failed to request block header from daemon");
+
+  // Got the block header - verify the pricing record
+  if (block_pr.empty() || block_pr.has_missing_rates()) {
+    MERROR("Invalid pricing record in block header - oracle TXs disabled. Please try again later.");
     return false;
   }
+
+  // Return the pricing record we retrieved
+  pr = block_pr;
+  return true;
 }
 //----------------------------------------------------------------------------------------------------
-bool wallet2::get_circulating_supply(std::vector<std::pair<std::string, std::string>> &amounts)
+bool wallet2::get_circulating_supply(cryptonote::circ_supply_snapshot &amounts)
 {
-  // Issue an RPC call to get the block header (and thus the pricing record) at the specified height
-  cryptonote::COMMAND_RPC_GET_CIRCULATING_SUPPLY::request req = AUTO_VAL_INIT(req);
-  cryptonote::COMMAND_RPC_GET_CIRCULATING_SUPPLY::response res = AUTO_VAL_INIT(res);
-  m_daemon_rpc_mutex.lock();
-  bool r = invoke_http_json_rpc("/json_rpc", "get_circulating_supply", req, res, rpc_timeout);
-  m_daemon_rpc_mutex.unlock();
-  if (r && res.status == CORE_RPC_STATUS_OK)
-  {
-    // Got the supply data - convert to a meaningful format
-    for (auto i: res.supply_tally) {
-      amounts.push_back(std::make_pair(std::string(i.currency_label), std::string(i.amount)));
-    }
-    return true;
-  }
-  else
+  // The supply only changes per block, so it is cached until the daemon top block changes
+  boost::optional<std::string> result = m_node_rpc_proxy.get_circulating_supply(amounts);
+  if (result)
   {
-    MERROR("Failed to retrieve circulating supply from daemon");
+    MERROR("Failed to retrieve circulating supply from daemon: " << *result);
     return false;
   }
+  return true;
 }
 //----------------------------------------------------------------------------------------------------
 void wallet2::process_new_transaction(const crypto::hash &txid, const cryptonote::transaction& tx, const std::vector<uint64_t> &o_indices, const std::vector<uint64_t> &asset_type_output_indices, uint64_t height, uint8_t block_version, uint64_t ts, bool miner_tx, bool pool, bool double_spend_seen, const tx_cache_data &tx_cache_data, std::map<std::pair<uint64_t, uint64_t>, size_t> *output_tracker_cache)
@@ -2266,7 +2375,7 @@ void wallet2::process_new_transaction(const crypto::hash &txid, const cryptonote
             }
 	    LOG_PRINT_L0("Received money: " << print_money(td.amount()) << ", with tx: " << txid);
 	    if (0 != m_callback)
-	      m_callback->on_money_received(height, txid, tx, td.m_amount, td.asset_type, 0, td.m_subaddr_index, spends_one_of_ours(tx), td.m_tx.unlock_time);
+	      m_callback->on_money_received(height, txid, tx, td.m_amount, oracle::get_asset_type(td.asset_type), 0, td.m_subaddr_index, spends_one_of_ours(tx), td.m_tx.unlock_time);
           }
           total_received_1 += amount;
           notify = true;
@@ -2277,11 +2386,11 @@ void wallet2::process_new_transaction(const crypto::hash &txid, const cryptonote
               << " from received " << print_money(tx_scan_info[o].amount) << " output already exists with "
               << (m_transfers[kit->second].m_spent ? "spent" : "unspent") << " "
               << print_money(m_transfers[kit->second].amount()) << " in tx " << m_transfers[kit->second].m_txid << ", received output ignored");
-          THROW_WALLET_EXCEPTION_IF(tx_money_got_in_outs[tx_scan_info[o].received->index][tx_scan_info[o].asset_type] < tx_scan_info[o].amount,
+          THROW_WALLET_EXCEPTION_IF(tx_money_got_in_outs[tx_scan_info[o].received->index][oracle::get_asset_type(tx_scan_info[o].asset_type)] < tx_scan_info[o].amount,
               error::wallet_internal_error, "Unexpected values of new and old outputs");
 
               
-          tx_money_got_in_outs[tx_scan_info[o].received->index][tx_scan_info[o].asset_type] -= tx_scan_info[o].amount;
+          tx_money_got_in_outs[tx_scan_info[o].received->index][oracle::get_asset_type(tx_scan_info[o].asset_type)] -= tx_scan_info[o].amount;
 
 
           amounts_container& tx_amounts_this_out = tx_amounts_individual_outs[tx_scan_info[o].received->index]; // Only for readability on the following lines
@@ -2296,11 +2405,11 @@ void wallet2::process_new_transaction(const crypto::hash &txid, const cryptonote
               << " from received " << print_money(tx_scan_info[o].amount) << " output already exists with "
               << print_money(m_transfers[kit->second].amount()) << ", replacing with new output");
           // The new larger output replaced a previous smaller one
-          THROW_WALLET_EXCEPTION_IF(tx_money_got_in_outs[tx_scan_info[o].received->index][tx_scan_info[o].asset_type] < tx_scan_info[o].amount,
+          THROW_WALLET_EXCEPTION_IF(tx_money_got_in_outs[tx_scan_info[o].received->index][oracle::get_asset_type(tx_scan_info[o].asset_type)] < tx_scan_info[o].amount,
               error::wallet_internal_error, "Unexpected values of new and old outputs");
           THROW_WALLET_EXCEPTION_IF(m_transfers[kit->second].amount() > tx_scan_info[o].amount,
               error::wallet_internal_error, "Unexpected values of new and old outputs");
-          tx_money_got_in_outs[tx_scan_info[o].received->index][tx_scan_info[o].asset_type] -= m_transfers[kit->second].amount();
+          tx_money_got_in_outs[tx_scan_info[o].received->index][oracle::get_asset_type(tx_scan_info[o].asset_type)] -= m_transfers[kit->second].amount();
 
           uint64_t amount = tx.vout[o].amount ? tx.vout[o].amount : tx_scan_info[o].amount;
           LOG_PRINT_L0("tx use output: " << print_money(amount));
@@ -2352,7 +2461,7 @@ void wallet2::process_new_transaction(const crypto::hash &txid, const cryptonote
 
 	    LOG_PRINT_L0("Received money: " << print_money(td.amount()) << ", with tx: " << txid);
 	    if (0 != m_callback)
-	      m_callback->on_money_received(height, txid, tx, td.m_amount, td.asset_type, burnt, td.m_subaddr_index, spends_one_of_ours(tx), td.m_tx.unlock_time);
+	      m_callback->on_money_received(height, txid, tx, td.m_amount, oracle::get_asset_type(td.asset_type), burnt, td.m_subaddr_index, spends_one_of_ours(tx), td.m_tx.unlock_time);
           }
           total_received_1 += extra_amount;
           notify = true;
@@ -3786,7 +3895,7 @@ void wallet2::refresh(bool trusted_daemon, uint64_t start_height, uint64_t & blo
       added_blocks = 0;
       if (!first && blocks.empty())
       {
-        m_node_rpc_proxy.set_height(m_blockchain.size());
+        m_node_rpc_proxy.set_height(m_blockchain.size(), m_blockchain[m_blockchain.size() - 1]);
         break;
       }
       if (!last)
@@ -3809,6 +3918,7 @@ void wallet2::refresh(bool trusted_daemon, uint64_t start_height, uint64_t & blo
           generate_genesis(b);
           m_blockchain.clear();
           m_blockchain.push_back(get_block_hash(b));
+          m_cache_journal.compact = true;
           short_chain_history.clear();
           get_short_chain_history(short_chain_history);
           fast_refresh(stop_height, blocks_start_height, short_chain_history, true);
@@ -3843,7 +3953,7 @@ void wallet2::refresh(bool trusted_daemon, uint64_t start_height, uint64_t & blo
 
       if(!first && blocks_start_height == next_blocks_start_height)
       {
-        m_node_rpc_proxy.set_height(m_blockchain.size());
+        m_node_rpc_proxy.set_height(m_blockchain.size(), m_blockchain[m_blockchain.size() - 1]);
         break;
       }
 
@@ -3942,10 +4052,24 @@ bool wallet2::refresh(bool trusted_daemon, uint64_t & blocks_fetched, bool& rece
 //----------------------------------------------------------------------------------------------------
 bool wallet2::get_rct_distribution(const std::string rct_asset_type, uint64_t &start_height, std::vector<uint64_t> &distribution, uint64_t &num_spendable_global_outs)
 {
+  // a cached distribution is only extended if the block it ends on is still
+  // in our chain, otherwise a reorg or rescan went through it
+  auto cached = m_rct_distributions.find(rct_asset_type);
+  if (cached != m_rct_distributions.end())
+  {
+    const rct_distribution &d = cached->second;
+    if (d.counts.empty() || !m_blockchain.is_in_bounds(d.top_height()) || m_blockchain[d.top_height()] != d.top_hash)
+    {
+      MDEBUG("Dropping stale cached " << rct_asset_type << " output distribution");
+      m_rct_distributions.erase(cached);
+      cached = m_rct_distributions.end();
+    }
+  }
+
   cryptonote::COMMAND_RPC_GET_OUTPUT_DISTRIBUTION::request req = AUTO_VAL_INIT(req);
   cryptonote::COMMAND_RPC_GET_OUTPUT_DISTRIBUTION::response res = AUTO_VAL_INIT(res);
   req.amounts.push_back(0);
-  req.from_height = 0;
+  req.from_height = cached != m_rct_distributions.end() ? cached->second.top_height() : 0;
   req.rct_asset_type = rct_asset_type;
   req.cumulative = false;
   req.binary = true;
@@ -3960,6 +4084,12 @@ bool wallet2::get_rct_distribution(const std::string rct_asset_type, uint64_t &s
   }
   catch(...)
   {
+    if (cached != m_rct_distributions.end())
+    {
+      MWARNING("Failed to extend the cached " << rct_asset_type << " output distribution, requesting all of it");
+      m_rct_distributions.erase(cached);
+      return get_rct_distribution(rct_asset_type, start_height, distribution, num_spendable_global_outs);
+    }
     return false;
   }
   if (res.distributions.size() != 1)
@@ -3972,14 +4102,65 @@ bool wallet2::get_rct_distribution(const std::string rct_asset_type, uint64_t &s
     MWARNING("Failed to request output distribution: results are not for amount 0");
     return false;
   }
-  for (size_t i = 1; i < res.distributions[0].data.distribution.size(); ++i)
-    res.distributions[0].data.distribution[i] += res.distributions[0].data.distribution[i-1];
-  start_height = res.distributions[0].data.start_height;
-  num_spendable_global_outs = res.distributions[0].data.num_spendable_global_outs;
-  distribution = std::move(res.distributions[0].data.distribution);
+
+  const cryptonote::rpc::output_distribution_data &data = res.distributions[0].data;
+  std::vector<uint64_t> counts;
+  if (cached != m_rct_distributions.end())
+  {
+    // the daemon sends the block we have at the top again, along with the
+    // number of outputs below it, and both have to match what we have
+    const rct_distribution &d = cached->second;
+    uint64_t below_top = 0;
+    for (size_t i = 0; i + 1 < d.counts.size(); ++i)
+      below_top += d.counts[i];
+    if (data.start_height != req.from_height || data.distribution.empty() || data.base != below_top
+        || data.distribution[0] != d.counts.back() || data.num_spendable_global_outs == 0)
+    {
+      MWARNING("Cached " << rct_asset_type << " output distribution does not match the daemon's, requesting all of it");
+      m_rct_distributions.erase(cached);
+      return get_rct_distribution(rct_asset_type, start_height, distribution, num_spendable_global_outs);
+    }
+    start_height = d.start_height;
+    counts = d.counts;
+    counts.insert(counts.end(), data.distribution.begin() + 1, data.distribution.end());
+    LOG_PRINT_L2("Extended cached " << rct_asset_type << " output distribution by " << data.distribution.size() - 1 << " blocks");
+  }
+  else
+  {
+    start_height = data.start_height;
+    counts = std::move(res.distributions[0].data.distribution);
+  }
+
+  distribution.resize(counts.size());
+  for (size_t i = 0; i < counts.size(); ++i)
+    distribution[i] = counts[i] + (i ? distribution[i-1] : 0);
+  num_spendable_global_outs = data.num_spendable_global_outs;
+
+  cache_rct_distribution(rct_asset_type, start_height, std::move(counts));
   return true;
 }
 //----------------------------------------------------------------------------------------------------
+void wallet2::cache_rct_distribution(const std::string &rct_asset_type, uint64_t start_height, std::vector<uint64_t> counts)
+{
+  // keep it up to a block we have the hash of, and far enough below the top
+  // that the next request spans the blocks the spendable output count is
+  // taken from
+  if (counts.empty() || m_blockchain.size() == 0)
+    return;
+  uint64_t top_height = std::min<uint64_t>(start_height + counts.size() - 1, m_blockchain.size() - 1);
+  if (top_height < start_height + CRYPTONOTE_DEFAULT_TX_SPENDABLE_AGE)
+    return;
+  top_height -= CRYPTONOTE_DEFAULT_TX_SPENDABLE_AGE;
+  if (!m_blockchain.is_in_bounds(top_height))
+    return;
+
+  rct_distribution &d = m_rct_distributions[rct_asset_type];
+  d.start_height = start_height;
+  d.counts = std::move(counts);
+  d.counts.resize(top_height - start_height + 1);
+  d.top_hash = m_blockchain[top_height];
+}
+//----------------------------------------------------------------------------------------------------
 void wallet2::detach_blockchain(uint64_t height, std::map<std::pair<uint64_t, uint64_t>, size_t> *output_tracker_cache)
 {
   LOG_PRINT_L0("Detaching blockchain on height " << height);
@@ -4036,6 +4217,7 @@ void wallet2::detach_blockchain(uint64_t height, std::map<std::pair<uint64_t, ui
 
   const uint64_t blocks_detached = m_blockchain.size() - height;
   m_blockchain.crop(height);
+  m_cache_journal.detached_height = std::min<uint64_t>(m_cache_journal.detached_height, height);
 
   for (auto it = m_payments.begin(); it != m_payments.end(); )
   {
@@ -4089,6 +4271,9 @@ bool wallet2::clear()
   m_multisig_rounds_passed = 0;
   m_device_last_key_image_sync = 0;
   m_pool_info_query_time = 0;
+  m_rct_distributions.clear();
+  m_cache_snapshot_id = crypto::null_hash;
+  m_cache_journal = cache_journal();
   return true;
 }
 //----------------------------------------------------------------------------------------------------
@@ -4106,6 +4291,7 @@ void wallet2::clear_soft(bool keep_key_images)
   m_scanned_pool_txs[0].clear();
   m_scanned_pool_txs[1].clear();
   m_pool_info_query_time = 0;
+  m_cache_journal.compact = true;
 
   cryptonote::block b;
   generate_genesis(b);
@@ -5489,6 +5675,7 @@ std::string wallet2::exchange_multisig_keys(const epee::wipeable_string &passwor
 
     m_subaddresses.clear();
     m_subaddress_labels.clear();
+    m_cache_journal.compact = true;
     add_subaddress_account(tr("Primary account"));
 
     if (!m_wallet_file.empty())
@@ -5942,6 +6129,9 @@ void wallet2::load(const std::string& wallet_, const epee::wipeable_string& pass
       m_account_public_address.m_spend_public_key != m_account.get_keys().m_account_address.m_spend_public_key ||
       m_account_public_address.m_view_public_key  != m_account.get_keys().m_account_address.m_view_public_key,
       error::wallet_files_doesnt_correspond, m_keys_file, m_wallet_file);
+
+    if (use_fs)
+      load_cache_journal(cache_file_buf.size());
   }
 
   cryptonote::block genesis;
@@ -6075,15 +6265,26 @@ void wallet2::store_to(const std::string &path, const epee::wipeable_string &pas
     }
   }
 
+  // most stores only need to append what changed to the cache journal,
+  // the full cache is written again once the journal grows as large as it
+  const bool journaled = same_file && append_cache_journal();
+
   // get wallet cache data
-  boost::optional<wallet2::cache_file_data> cache_file_data = get_cache_file_data(password);
-  THROW_WALLET_EXCEPTION_IF(cache_file_data == boost::none, error::wallet_internal_error, "failed to generate wallet cache data");
+  boost::optional<wallet2::cache_file_data> cache_file_data;
+  if (!journaled)
+  {
+    m_cache_snapshot_id = crypto::rand<crypto::hash>();
+    m_cache_journal.compact = true;
+    cache_file_data = get_cache_file_data(password);
+    THROW_WALLET_EXCEPTION_IF(cache_file_data == boost::none, error::wallet_internal_error, "failed to generate wallet cache data");
+  }
 
   const std::string new_file = same_file ? m_wallet_file + ".new" : path;
   const std::string old_file = m_wallet_file;
   const std::string old_keys_file = m_keys_file;
   const std::string old_address_file = m_wallet_file + ".address.txt";
   const std::string old_mms_file = m_mms_file;
+  const std::string old_journal_file = get_cache_journal_file();
 
   // save keys to the new file
   // if we here, main wallet file is saved and we only need to save keys and address files
@@ -6121,7 +6322,9 @@ void wallet2::store_to(const std::string &path, const epee::wipeable_string &pas
         LOG_ERROR("error removing file: " << old_mms_file);
       }
     }
-  } else {
+    remove_cache_journal(old_journal_file);
+    m_cache_journal.compact = true;
+  } else if (!journaled) {
     // save to new file
 #ifdef WIN32
     // On Windows avoid using std::ofstream which does not work with UTF-8 filenames
@@ -6145,6 +6348,14 @@ void wallet2::store_to(const std::string &path, const epee::wipeable_string &pas
     // here we have "*.new" file, we need to rename it to be without ".new"
     std::error_code e = tools::replace_file(new_file, m_wallet_file);
     THROW_WALLET_EXCEPTION_IF(e, error::file_save_error, m_wallet_file, e);
+
+    // the journal was written against the previous cache
+    m_cache_journal.compact = false;
+    m_cache_journal.sequence = 0;
+    m_cache_journal.size = 0;
+    m_cache_journal.snapshot_size = cache_file_data->cache_data.size();
+    remove_cache_journal(old_journal_file);
+    reset_cache_journal();
   }
   
   if (m_message_store.get_active())
@@ -6180,6 +6391,436 @@ boost::optional<wallet2::cache_file_data> wallet2::get_cache_file_data(const epe
   }
 }
 //----------------------------------------------------------------------------------------------------
+uint64_t wallet2::get_cache_fingerprint(const transfer_details &td)
+{
+  // everything but the tx prefix, which is fixed by the txid
+  uint64_t h = CACHE_FINGERPRINT_BASIS;
+  const auto add_data = [&h](const void *data, size_t size) { h = add_cache_fingerprint(h, data, size); };
+  const auto add = [&add_data](const auto &v) { add_data(&v, sizeof(v)); };
+
+  add(td.m_block_height);
+  add(td.m_txid);
+  add(td.m_internal_output_index);
+  add(td.m_global_output_index);
+  add(td.m_asset_type_output_index);
+  add(td.m_spent);
+  add(td.m_frozen);
+  add(td.m_spent_height);
+  add(td.m_key_image);
+  add(td.m_mask);
+  add(td.m_amount);
+  add(td.m_rct);
+  add(td.m_key_image_known);
+  add(td.m_key_image_request);
+  add(td.m_pk_index);
+  add(td.m_subaddr_index.major);
+  add(td.m_subaddr_index.minor);
+  add(td.m_key_image_partial);
+  add(td.m_multisig_k.size());
+  for (const rct::key &k: td.m_multisig_k)
+    add(k);
+  add(td.m_multisig_info.size());
+  for (const multisig_info &mi: td.m_multisig_info)
+  {
+    add(mi.m_signer);
+    add(mi.m_LR.size());
+    for (const multisig_info::LR &lr: mi.m_LR)
+    {
+      add(lr.m_L);
+      add(lr.m_R);
+    }
+    add(mi.m_partial_key_images.size());
+    for (const crypto::key_image &ki: mi.m_partial_key_images)
+      add(ki);
+  }
+  add(td.m_uses.size());
+  for (const auto &u: td.m_uses)
+  {
+    add(u.first);
+    add(u.second);
+  }
+  add(td.asset_type);
+  return h;
+}
+//----------------------------------------------------------------------------------------------------
+void wallet2::reset_cache_journal()
+{
+  m_cache_journal.transfer_fingerprints.resize(m_transfers.size());
+  for (size_t i = 0; i < m_transfers.size(); ++i)
+    m_cache_journal.transfer_fingerprints[i] = get_cache_fingerprint(m_transfers[i]);
+  m_cache_journal.blockchain_size = m_blockchain.size();
+  m_cache_journal.blockchain_offset = m_blockchain.offset();
+  m_cache_journal.detached_height = std::numeric_limits<uint64_t>::max();
+  m_cache_journal.subaddresses.clear();
+  m_cache_journal.rct_distribution_tops.clear();
+  for (const auto &e: m_rct_distributions)
+    m_cache_journal.rct_distribution_tops[e.first] = e.second.top_hash;
+  reset_cache_journal_fingerprints(m_unconfirmed_txs, m_cache_journal.unconfirmed_tx_fingerprints);
+  reset_cache_journal_fingerprints(m_tx_keys, m_cache_journal.tx_key_fingerprints);
+  reset_cache_journal_fingerprints(m_additional_tx_keys, m_cache_journal.additional_tx_key_fingerprints);
+  reset_cache_journal_fingerprints(m_cold_key_images, m_cache_journal.cold_key_image_fingerprints);
+  m_cache_journal.scanned_pool_txs[0] = m_scanned_pool_txs[0];
+  m_cache_journal.scanned_pool_txs[1] = m_scanned_pool_txs[1];
+}
+//----------------------------------------------------------------------------------------------------
+bool wallet2::get_cache_journal_record(cache_journal_record &record, std::vector<std::pair<size_t, uint64_t>> &fingerprints)
+{
+  const cache_journal &journal = m_cache_journal;
+
+  // hashes below the journal's view of the chain can't be written as a suffix of it
+  const uint64_t blockchain_from = std::min(journal.blockchain_size, journal.detached_height);
+  if (m_blockchain.offset() < journal.blockchain_offset || blockchain_from < m_blockchain.offset() || blockchain_from > m_blockchain.size())
+    return false;
+
+  record.snapshot_id = m_cache_snapshot_id;
+  record.sequence = journal.sequence;
+
+  record.transfer_count = m_transfers.size();
+  for (size_t i = 0; i < m_transfers.size(); ++i)
+  {
+    const transfer_details &td = m_transfers[i];
+    const uint64_t fingerprint = get_cache_fingerprint(td);
+    if (i < journal.transfer_fingerprints.size() && journal.transfer_fingerprints[i] == fingerprint)
+      continue;
+    record.transfers.push_back(std::make_pair(i, td));
+    fingerprints.push_back(std::make_pair(i, fingerprint));
+    const auto ki = m_key_images.find(td.m_key_image);
+    if (ki != m_key_images.end() && ki->second == i)
+      record.key_images.push_back(std::make_pair(ki->first, i));
+    const auto pk = m_pub_keys.find(td.get_public_key());
+    if (pk != m_pub_keys.end() && pk->second == i)
+      record.pub_keys.push_back(std::make_pair(pk->first, i));
+  }
+
+  record.blockchain_offset = m_blockchain.offset();
+  record.blockchain_from = blockchain_from;
+  for (uint64_t h = blockchain_from; h < m_blockchain.size(); ++h)
+    record.blockchain.push_back(m_blockchain[h]);
+
+  // payments are only ever added or removed along with the blocks they are in
+  for (const auto &p: m_payments)
+    if (p.second.m_block_height >= blockchain_from)
+      record.payments.push_back(p);
+  for (const auto &p: m_confirmed_txs)
+    if (p.second.m_block_height >= blockchain_from)
+      record.confirmed_txs.push_back(p);
+
+  for (const crypto::public_key &pkey: journal.subaddresses)
+  {
+    const auto i = m_subaddresses.find(pkey);
+    if (i != m_subaddresses.end())
+      record.subaddresses.push_back(*i);
+  }
+
+  for (const auto &e: m_rct_distributions)
+  {
+    record.rct_distribution_assets.push_back(e.first);
+    const auto top = journal.rct_distribution_tops.find(e.first);
+    if (top == journal.rct_distribution_tops.end() || top->second != e.second.top_hash)
+      record.rct_distributions.push_back(e);
+  }
+
+  get_cache_journal_delta(m_unconfirmed_txs, journal.unconfirmed_tx_fingerprints, record.unconfirmed_txs);
+  get_cache_journal_delta(m_tx_keys, journal.tx_key_fingerprints, record.tx_keys);
+  get_cache_journal_delta(m_additional_tx_keys, journal.additional_tx_key_fingerprints, record.additional_tx_keys);
+  get_cache_journal_delta(m_cold_key_images, journal.cold_key_image_fingerprints, record.cold_key_images);
+  get_cache_journal_delta(m_scanned_pool_txs[0], journal.scanned_pool_txs[0], record.scanned_pool_txs[0]);
+  get_cache_journal_delta(m_scanned_pool_txs[1], journal.scanned_pool_txs[1], record.scanned_pool_txs[1]);
+
+  record.key_images_count = m_key_images.size();
+  record.pub_keys_count = m_pub_keys.size();
+  record.payments_count = m_payments.size();
+  record.confirmed_txs_count = m_confirmed_txs.size();
+  record.subaddresses_count = m_subaddresses.size();
+
+  std::stringstream oss;
+  binary_archive<true> ar(oss);
+  if (!serialize_cache_journal_state(ar))
+    return false;
+  record.state = oss.str();
+  return true;
+}
+//----------------------------------------------------------------------------------------------------
+bool wallet2::append_cache_journal()
+{
+  if (m_cache_journal.compact || m_cache_snapshot_id == crypto::null_hash)
+    return false;
+  if (m_cache_journal.size >= m_cache_journal.snapshot_size)
+    return false;
+
+#ifdef WIN32
+  // std::ofstream does not work with UTF-8 filenames, and rewriting the whole
+  // journal through save_to_file would defeat its purpose
+  return false;
+#else
+  try
+  {
+    cache_journal_record record;
+    std::vector<std::pair<size_t, uint64_t>> fingerprints;
+    if (!get_cache_journal_record(record, fingerprints))
+      return false;
+
+    std::string blob;
+    if (!::serialization::dump_binary(record, blob))
+      return false;
+    cache_file_data data;
+    data.iv = crypto::rand<crypto::chacha_iv>();
+    data.cache_data.resize(blob.size());
+    crypto::chacha20(blob.data(), blob.size(), m_cache_key, data.iv, &data.cache_data[0]);
+    memwipe(&blob[0], blob.size());
+    std::string frame;
+    if (!::serialization::dump_binary(data, frame))
+      return false;
+
+    const std::string journal_file = get_cache_journal_file();
+    std::ofstream ostr;
+    ostr.open(journal_file, std::ios_base::binary | std::ios_base::out | std::ios_base::app);
+    ostr.write(frame.data(), frame.size());
+    ostr.close();
+    if (!ostr.good())
+    {
+      // a partial record would hide any appended after it
+      MERROR("Failed to append to " << journal_file << ", writing the full wallet cache");
+      m_cache_journal.compact = true;
+      return false;
+    }
+
+    for (const auto &e: fingerprints)
+    {
+      if (e.first >= m_cache_journal.transfer_fingerprints.size())
+        m_cache_journal.transfer_fingerprints.resize(e.first + 1);
+      m_cache_journal.transfer_fingerprints[e.first] = e.second;
+    }
+    m_cache_journal.transfer_fingerprints.resize(m_transfers.size());
+    m_cache_journal.blockchain_size = m_blockchain.size();
+    m_cache_journal.blockchain_offset = m_blockchain.offset();
+    m_cache_journal.detached_height = std::numeric_limits<uint64_t>::max();
+    m_cache_journal.subaddresses.clear();
+    for (const auto &e: record.rct_distributions)
+      m_cache_journal.rct_distribution_tops[e.first] = e.second.top_hash;
+    commit_cache_journal_delta(m_cache_journal.unconfirmed_tx_fingerprints, record.unconfirmed_txs);
+    commit_cache_journal_delta(m_cache_journal.tx_key_fingerprints, record.tx_keys);
+    commit_cache_journal_delta(m_cache_journal.additional_tx_key_fingerprints, record.additional_tx_keys);
+    commit_cache_journal_delta(m_cache_journal.cold_key_image_fingerprints, record.cold_key_images);
+    commit_cache_journal_delta(m_cache_journal.scanned_pool_txs[0], record.scanned_pool_txs[0]);
+    commit_cache_journal_delta(m_cache_journal.scanned_pool_txs[1], record.scanned_pool_txs[1]);
+    ++m_cache_journal.sequence;
+    m_cache_journal.size += frame.size();
+    MDEBUG("Appended " << frame.size() << " bytes to the cache journal: " << record.transfers.size() << " transfers, " << record.blockchain.size() << " block hashes");
+    return true;
+  }
+  catch (const std::exception &e)
+  {
+    MERROR("Failed to append to the cache journal, writing the full wallet cache: " << e.what());
+    return false;
+  }
+#endif
+}
+//----------------------------------------------------------------------------------------------------
+bool wallet2::apply_cache_journal_record(cache_journal_record &record)
+{
+  // check what can be checked before changing anything
+  uint64_t appended = 0;
+  for (const auto &e: record.transfers)
+  {
+    if (e.first >= record.transfer_count)
+      return false;
+    if (e.first >= m_transfers.size())
+      ++appended;
+  }
+  if (record.transfer_count > m_transfers.size() && appended != record.transfer_count - m_transfers.size())
+    return false;
+  if (record.blockchain_offset < m_blockchain.offset() || record.blockchain_from < m_blockchain.offset() || record.blockchain_from > m_blockchain.size())
+    return false;
+
+  // transfers, and the key image and public key lookups pointing at them
+  const auto forget = [this](size_t i) {
+    const transfer_details &td = m_transfers[i];
+    const auto ki = m_key_images.find(td.m_key_image);
+    if (ki != m_key_images.end() && ki->second == i)
+      m_key_images.erase(ki);
+    const auto pk = m_pub_keys.find(td.get_public_key());
+    if (pk != m_pub_keys.end() && pk->second == i)
+      m_pub_keys.erase(pk);
+  };
+  for (size_t i = record.transfer_count; i < m_transfers.size(); ++i)
+    forget(i);
+  for (const auto &e: record.transfers)
+    if (e.first < m_transfers.size())
+      forget(e.first);
+  m_transfers.resize(record.transfer_count);
+  for (auto &e: record.transfers)
+    m_transfers[e.first] = std::move(e.second);
+  for (const auto &e: record.key_images)
+    m_key_images[e.first] = e.second;
+  for (const auto &e: record.pub_keys)
+    m_pub_keys[e.first] = e.second;
+
+  m_blockchain.crop(record.blockchain_from);
+  for (const crypto::hash &h: record.blockchain)
+    m_blockchain.push_back(h);
+  m_blockchain.trim(record.blockchain_offset);
+  if (m_blockchain.offset() != record.blockchain_offset)
+    return false;
+
+  for (auto i = m_payments.begin(); i != m_payments.end(); )
+  {
+    if (i->second.m_block_height >= record.blockchain_from)
+      i = m_payments.erase(i);
+    else
+      ++i;
+  }
+  for (auto &p: record.payments)
+    m_payments.emplace(p.first, std::move(p.second));
+  for (auto i = m_confirmed_txs.begin(); i != m_confirmed_txs.end(); )
+  {
+    if (i->second.m_block_height >= record.blockchain_from)
+      i = m_confirmed_txs.erase(i);
+    else
+      ++i;
+  }
+  for (auto &p: record.confirmed_txs)
+    m_confirmed_txs[p.first] = std::move(p.second);
+
+  for (const auto &e: record.subaddresses)
+    m_subaddresses[e.first] = e.second;
+
+  const std::set<std::string> rct_distribution_assets(record.rct_distribution_assets.begin(), record.rct_distribution_assets.end());
+  for (auto i = m_rct_distributions.begin(); i != m_rct_distributions.end(); )
+  {
+    if (rct_distribution_assets.find(i->first) == rct_distribution_assets.end())
+      i = m_rct_distributions.erase(i);
+    else
+      ++i;
+  }
+  for (auto &e: record.rct_distributions)
+    m_rct_distributions[e.first] = std::move(e.second);
+
+  if (!apply_cache_journal_delta(m_unconfirmed_txs, record.unconfirmed_txs) ||
+      !apply_cache_journal_delta(m_tx_keys, record.tx_keys) ||
+      !apply_cache_journal_delta(m_additional_tx_keys, record.additional_tx_keys) ||
+      !apply_cache_journal_delta(m_cold_key_images, record.cold_key_images) ||
+      !apply_cache_journal_delta(m_scanned_pool_txs[0], record.scanned_pool_txs[0]) ||
+      !apply_cache_journal_delta(m_scanned_pool_txs[1], record.scanned_pool_txs[1]))
+    return false;
+
+  binary_archive<false> ar{epee::strspan<std::uint8_t>(record.state)};
+  if (!serialize_cache_journal_state(ar) || !::serialization::check_stream_state(ar))
+    return false;
+
+  return m_key_images.size() == record.key_images_count && m_pub_keys.size() == record.pub_keys_count &&
+      m_payments.size() == record.payments_count && m_confirmed_txs.size() == record.confirmed_txs_count &&
+      m_subaddresses.size() == record.subaddresses_count && m_rct_distributions.size() == rct_distribution_assets.size();
+}
+//----------------------------------------------------------------------------------------------------
+void wallet2::load_cache_journal(uint64_t snapshot_size)
+{
+  m_cache_journal.compact = m_cache_snapshot_id == crypto::null_hash;
+  m_cache_journal.sequence = 0;
+  m_cache_journal.snapshot_size = snapshot_size;
+  m_cache_journal.size = 0;
+
+  const std::string journal_file = get_cache_journal_file();
+  boost::system::error_code e;
+  if (!m_cache_journal.compact && boost::filesystem::exists(journal_file, e) && !e)
+  {
+    std::string buf;
+    if (!load_from_file(journal_file, buf, std::numeric_limits<size_t>::max()))
+    {
+      MERROR("Failed to read " << journal_file << ", changes stored since the last full wallet cache are lost");
+      m_cache_journal.compact = true;
+    }
+    m_cache_journal.size = buf.size();
+
+    // records are applied in place and some of their checks can only run
+    // after that, so the snapshot's state is kept to go back to if one fails
+    std::string snapshot_state;
+    const auto restore_snapshot = [&]() {
+      binary_archive<false> sar{epee::strspan<std::uint8_t>(snapshot_state)};
+      THROW_WALLET_EXCEPTION_IF(!::serialization::serialize(sar, *this) || !::serialization::check_stream_state(sar),
+          error::wallet_internal_error, "Failed to restore the wallet cache after a bad journal record");
+      m_cache_journal.sequence = 0;
+    };
+
+    binary_archive<false> ar{epee::strspan<std::uint8_t>(buf)};
+    while (!m_cache_journal.compact && !ar.eof())
+    {
+      cache_journal_record record;
+      bool applying = false;
+      try
+      {
+        cache_file_data data;
+        if (!::do_serialize(ar, data) || !ar.good())
+        {
+          MWARNING("Ignoring a truncated record at the end of " << journal_file);
+          m_cache_journal.compact = true;
+          break;
+        }
+        std::string blob;
+        blob.resize(data.cache_data.size());
+        crypto::chacha20(data.cache_data.data(), data.cache_data.size(), m_cache_key, data.iv, &blob[0]);
+        const bool r = ::serialization::parse_binary(blob, record);
+        memwipe(&blob[0], blob.size());
+        if (!r || record.snapshot_id != m_cache_snapshot_id)
+        {
+          // left over from before the last full cache was written
+          MINFO("Ignoring " << journal_file << ", it does not match the wallet cache");
+          m_cache_journal.compact = true;
+          break;
+        }
+        if (record.sequence != m_cache_journal.sequence)
+        {
+          MERROR("Unexpected record " << record.sequence << " in " << journal_file << ", expected " << m_cache_journal.sequence);
+          m_cache_journal.compact = true;
+          break;
+        }
+        if (snapshot_state.empty())
+        {
+          std::stringstream oss;
+          binary_archive<true> sar(oss);
+          THROW_WALLET_EXCEPTION_IF(!::serialization::serialize(sar, *this), error::wallet_internal_error, "Failed to keep the wallet cache before replaying its journal");
+          snapshot_state = oss.str();
+        }
+        applying = true;
+        if (!apply_cache_journal_record(record))
+        {
+          MERROR("Failed to apply record " << record.sequence << " from " << journal_file << ", changes stored since the last full wallet cache are lost");
+          restore_snapshot();
+          m_cache_journal.compact = true;
+          break;
+        }
+      }
+      catch (const std::exception &x)
+      {
+        MERROR("Failed to apply record " << m_cache_journal.sequence << " from " << journal_file << ": " << x.what());
+        if (applying)
+          restore_snapshot();
+        m_cache_journal.compact = true;
+        break;
+      }
+      ++m_cache_journal.sequence;
+    }
+    if (!snapshot_state.empty())
+      memwipe(&snapshot_state[0], snapshot_state.size());
+    if (m_cache_journal.sequence > 0)
+      LOG_PRINT_L1("Replayed " << m_cache_journal.sequence << " records from " << journal_file);
+  }
+
+  reset_cache_journal();
+}
+//----------------------------------------------------------------------------------------------------
+void wallet2::remove_cache_journal(const std::string &journal_file)
+{
+  boost::system::error_code e;
+  if (!boost::filesystem::exists(journal_file, e) || e)
+    return;
+  if (!boost::filesystem::remove(journal_file, e) || e)
+  {
+    LOG_ERROR("error removing file: " << journal_file);
+    m_cache_journal.compact = true;
+  }
+}
+//----------------------------------------------------------------------------------------------------
 std::map<uint32_t, std::map<std::string, uint64_t>> wallet2::balance(uint32_t index_major, bool strict)
 {
   std::map<uint32_t, std::map<std::string, uint64_t>> amounts;
@@ -6235,9 +6876,10 @@ uint64_t wallet2::unlocked_balance(const std::string& asset_type, uint32_t index
 std::map<uint32_t, uint64_t> wallet2::balance_per_subaddress(const std::string& asset_type, uint32_t index_major, bool strict) const
 { 
   std::map<uint32_t, uint64_t> amount_per_subaddr;
+  const oracle::asset_id asset_id = oracle::get_asset_id(asset_type);
   for (const auto& td: m_transfers)
   {
-    if (td.m_subaddr_index.major == index_major && td.asset_type == asset_type && !is_spent(td, strict) && !td.m_frozen)
+    if (td.m_subaddr_index.major == index_major && td.asset_type == asset_id && !is_spent(td, strict) && !td.m_frozen)
     {
       auto found = amount_per_subaddr.find(td.m_subaddr_index.minor);
       if (found == amount_per_subaddr.end())
@@ -6290,9 +6932,10 @@ std::map<uint32_t, std::pair<uint64_t, std::pair<uint64_t, uint64_t>>> wallet2::
   std::map<uint32_t, std::pair<uint64_t, std::pair<uint64_t, uint64_t>>> amount_per_subaddr;
   const uint64_t blockchain_height = get_blockchain_current_height();
   const uint64_t now = time(NULL);
+  const oracle::asset_id asset_id = oracle::get_asset_id(asset_type);
   for(const transfer_details& td: m_transfers)
   {
-    if(td.m_subaddr_index.major == index_major && td.asset_type == asset_type && !is_spent(td, strict) && !td.m_frozen)
+    if(td.m_subaddr_index.major == index_major && td.asset_type == asset_id && !is_spent(td, strict) && !td.m_frozen)
     {
       uint64_t amount = 0, blocks_to_unlock = 0, time_to_unlock = 0;
       if (is_transfer_unlocked(td))
@@ -6789,8 +7432,9 @@ void wallet2::commit_tx(pending_tx& ptx)
   {
     payment_id = get_payment_id(ptx);
     dests = ptx.dests;
+    const oracle::asset_id source_asset_id = oracle::get_asset_id(source_asset);
     for(size_t idx: ptx.selected_transfers)
-      if (m_transfers[idx].asset_type == source_asset)
+      if (m_transfers[idx].asset_type == source_asset_id)
         amount_in += m_transfers[idx].amount();
   }
   add_unconfirmed_tx(ptx.tx, source_asset, amount_in, dests, payment_id, ptx.change_dts.amount, ptx.construction_data.subaddr_account, ptx.construction_data.subaddr_indices);
@@ -7008,7 +7652,7 @@ bool wallet2::sign_tx(unsigned_tx_set &exported_txs, std::vector<wallet2::pendin
 
     uint32_t hf_version = get_current_hard_fork();
     // Get the circulating supply data
-    std::vector<std::pair<std::string, std::string>> circ_amounts;
+    cryptonote::circ_supply_snapshot circ_amounts;
     THROW_WALLET_EXCEPTION_IF(!get_circulating_supply(circ_amounts), error::wallet_internal_error, "Failed to get circulating supply");
     bool r = cryptonote::construct_tx_and_get_tx_key(m_account.get_keys(), m_subaddresses, sd.sources, sd.splitted_dsts, sd.change_dts.addr, sd.extra, ptx.tx, "ZEPH", "ZEPH", 1, hf_version, oracle::pricing_record(), circ_amounts, sd.unlock_time, tx_key, additional_tx_keys, sd.use_rct, rct_config, sd.use_view_tags);
     THROW_WALLET_EXCEPTION_IF(!r, error::tx_not_constructed, sd.sources, sd.splitted_dsts, sd.unlock_time, m_nettype);
@@ -8248,6 +8892,11 @@ void wallet2::get_outs(std::vector<std::vector<tools::wallet2::get_outs_entry>>
 {
   std::vector<uint64_t> rct_offsets;
   uint64_t num_spendable_global_outs = 0;
+  get_outs(outs, selected_transfers, fake_outputs_count, rct, rct_offsets, num_spendable_global_outs, valid_public_keys_cache);
+}
+
+void wallet2::get_outs(std::vector<std::vector<tools::wallet2::get_outs_entry>> &outs, const std::vector<size_t> &selected_transfers, size_t fake_outputs_count, bool rct, std::vector<uint64_t> &rct_offsets, uint64_t &num_spendable_global_outs, std::unordered_set<crypto::public_key> &valid_public_keys_cache)
+{
   for (size_t attempts = 3; attempts > 0; --attempts)
   {
     get_outs(outs, selected_transfers, fake_outputs_count, rct_offsets, num_spendable_global_outs, valid_public_keys_cache);
@@ -8290,7 +8939,7 @@ void wallet2::get_outs(std::vector<std::vector<tools::wallet2::get_outs_entry>>
     // if we have at least one rct out, get the distribution, or fall back to the previous system
     uint64_t rct_start_height;
     bool has_rct = false;
-    const std::string rct_asset_type = m_transfers[selected_transfers[0]].asset_type;
+    const std::string &rct_asset_type = oracle::get_asset_type(m_transfers[selected_transfers[0]].asset_type);
     uint64_t max_rct_index = 0;
     for (size_t idx: selected_transfers)
     {
@@ -8908,6 +9557,43 @@ void wallet2::get_outs(std::vector<std::vector<tools::wallet2::get_outs_entry>>
     MERROR("Failed to set rings");
 }
 
+void wallet2::plan_outs(decoy_plan &plan, const std::vector<size_t> &transfers, size_t fake_outputs_count, bool rct, std::unordered_set<crypto::public_key> &valid_public_keys_cache)
+{
+  // only pick rings for inputs not planned yet, one request per asset type,
+  // reusing the distribution already fetched for that asset type, if any
+  std::map<std::string, std::vector<size_t>> unplanned;
+  for (size_t idx: transfers)
+  {
+    THROW_WALLET_EXCEPTION_IF(idx >= m_transfers.size(), error::wallet_internal_error, "transfers entry out of range");
+    if (plan.rings.find(idx) == plan.rings.end())
+      unplanned[oracle::get_asset_type(m_transfers[idx].asset_type)].push_back(idx);
+  }
+
+  for (auto &e: unplanned)
+  {
+    std::vector<size_t> &selected_transfers = e.second;
+    std::sort(selected_transfers.begin(), selected_transfers.end());
+    selected_transfers.erase(std::unique(selected_transfers.begin(), selected_transfers.end()), selected_transfers.end());
+    LOG_PRINT_L2("Planning rings for " << selected_transfers.size() << " " << e.first << " inputs");
+
+    std::pair<std::vector<uint64_t>, uint64_t> &distribution = plan.distributions[e.first];
+    std::vector<std::vector<get_outs_entry>> outs;
+    get_outs(outs, selected_transfers, fake_outputs_count, rct, distribution.first, distribution.second, valid_public_keys_cache);
+    THROW_WALLET_EXCEPTION_IF(outs.size() != selected_transfers.size(), error::wallet_internal_error, "get_outs returned wrong number of rings");
+    for (size_t i = 0; i < selected_transfers.size(); ++i)
+      plan.rings[selected_transfers[i]] = std::move(outs[i]);
+  }
+}
+
+void wallet2::get_planned_outs(decoy_plan &plan, std::vector<std::vector<tools::wallet2::get_outs_entry>> &outs, const std::vector<size_t> &selected_transfers, size_t fake_outputs_count, bool rct, std::unordered_set<crypto::public_key> &valid_public_keys_cache)
+{
+  plan_outs(plan, selected_transfers, fake_outputs_count, rct, valid_public_keys_cache);
+  outs.clear();
+  outs.reserve(selected_transfers.size());
+  for (size_t idx: selected_transfers)
+    outs.push_back(plan.rings[idx]);
+}
+
 template<typename T>
 void wallet2::transfer_selected(const std::vector<cryptonote::tx_destination_entry>& dsts, const std::vector<size_t>& selected_transfers, size_t fake_outputs_count,
   std::vector<std::vector<tools::wallet2::get_outs_entry>> &outs, std::unordered_set<crypto::public_key> &valid_public_keys_cache,
@@ -9024,7 +9710,7 @@ void wallet2::transfer_selected(const std::vector<cryptonote::tx_destination_ent
   LOG_PRINT_L2("constructing tx");
 
   // Get the circulating supply data
-  std::vector<std::pair<std::string, std::string>> circ_amounts;
+  cryptonote::circ_supply_snapshot circ_amounts;
   THROW_WALLET_EXCEPTION_IF(!get_circulating_supply(circ_amounts), error::wallet_internal_error, "Failed to get circulating supply");
 
   uint32_t hf_version = get_current_hard_fork();
@@ -9076,6 +9762,17 @@ void wallet2::transfer_selected(const std::vector<cryptonote::tx_destination_ent
   LOG_PRINT_L2("transfer_selected done");
 }
 
+wallet2::tx_construction_context wallet2::get_tx_construction_context()
+{
+  tx_construction_context context;
+  context.upper_transaction_weight_limit = get_upper_transaction_weight_limit();
+  context.current_height = get_blockchain_current_height()-1;
+  context.hf_version = get_current_hard_fork();
+  THROW_WALLET_EXCEPTION_IF(!get_circulating_supply(context.circ_amounts), error::wallet_internal_error, "Failed to get circulating supply");
+  context.signing_device = NULL;
+  return context;
+}
+
 void wallet2::transfer_selected_rct(
   std::vector<cryptonote::tx_destination_entry> dsts,
   const std::vector<size_t>& selected_transfers,
@@ -9091,14 +9788,15 @@ void wallet2::transfer_selected_rct(
   bool use_view_tags,
   const std::string& source_asset,
   const std::string& dest_asset,
-  const oracle::pricing_record& pr
+  const oracle::pricing_record& pr,
+  const tx_construction_context *context
 ){
   using namespace cryptonote;
   // throw if attempting a transaction with no destinations
   THROW_WALLET_EXCEPTION_IF(dsts.empty(), error::zero_destination);
 
-  uint64_t upper_transaction_weight_limit = get_upper_transaction_weight_limit();
-  uint64_t current_height = get_blockchain_current_height()-1;
+  uint64_t upper_transaction_weight_limit = context ? context->upper_transaction_weight_limit : get_upper_transaction_weight_limit();
+  uint64_t current_height = context ? context->current_height : get_blockchain_current_height()-1;
   uint64_t needed_money = fee;
   LOG_PRINT_L2("transfer_selected_rct: starting with fee " << print_money (needed_money));
   LOG_PRINT_L2("selected transfers: " << strjoin(selected_transfers, " "));
@@ -9177,9 +9875,10 @@ void wallet2::transfer_selected_rct(
 
   bool all_rct = true;
   uint64_t found_money = 0;
+  const oracle::asset_id source_asset_id = oracle::get_asset_id(source_asset);
   for(size_t idx: selected_transfers)
   {
-    if (m_transfers[idx].asset_type == source_asset)
+    if (m_transfers[idx].asset_type == source_asset_id)
       found_money += m_transfers[idx].amount();
     all_rct &= m_transfers[idx].is_rct();
   }
@@ -9205,7 +9904,7 @@ void wallet2::transfer_selected_rct(
     const transfer_details& td = m_transfers[idx];
     src.amount = td.amount();
     src.rct = td.is_rct();
-    src.asset_type = td.asset_type;
+    src.asset_type = oracle::get_asset_type(td.asset_type);
     //paste mixin transaction
 
     THROW_WALLET_EXCEPTION_IF(outs.size() < out_index + 1 ,  error::wallet_internal_error, "outs.size() < out_index + 1"); 
@@ -9340,13 +10039,19 @@ void wallet2::transfer_selected_rct(
     );
   }
   else {
-    uint32_t hf_version = get_current_hard_fork();
+    uint32_t hf_version = context ? context->hf_version : get_current_hard_fork();
     // Get the circulating supply data
-    std::vector<std::pair<std::string, std::string>> circ_amounts;
-    THROW_WALLET_EXCEPTION_IF(!get_circulating_supply(circ_amounts), error::wallet_internal_error, "Failed to get circulating supply");
+    cryptonote::circ_supply_snapshot circ_amounts;
+    if (context)
+      circ_amounts = context->circ_amounts;
+    else
+      THROW_WALLET_EXCEPTION_IF(!get_circulating_supply(circ_amounts), error::wallet_internal_error, "Failed to get circulating supply");
+    cryptonote::account_keys keys = m_account.get_keys();
+    if (context && context->signing_device)
+      keys.set_device(*context->signing_device);
     // make a normal tx
     bool r = cryptonote::construct_tx_and_get_tx_key(
-      m_account.get_keys(),
+      keys,
       m_subaddresses,
       sources,
       splitted_dsts,
@@ -9653,20 +10358,20 @@ void wallet2::get_reserve_info(
   double& reserve_ratio,
   double& reserve_ratio_ma
 ){
-  std::vector<std::pair<std::string, std::string>> circ_amounts;
+  cryptonote::circ_supply_snapshot circ_amounts;
   THROW_WALLET_EXCEPTION_IF(!get_circulating_supply(circ_amounts), error::wallet_internal_error, "Failed to get circulating supply");
   return cryptonote::get_reserve_info(circ_amounts, pricing_record, zeph_reserve, num_stables, num_reserves, assets, assets_ma, liabilities, equity, equity_ma, reserve_ratio, reserve_ratio_ma);
 }
 
 double wallet2::get_spot_reserve_ratio(const oracle::pricing_record& pricing_record)
 {
-  std::vector<std::pair<std::string, std::string>> circ_amounts;
+  cryptonote::circ_supply_snapshot circ_amounts;
   THROW_WALLET_EXCEPTION_IF(!get_circulating_supply(circ_amounts), error::wallet_internal_error, "Failed to get circulating supply");
   return cryptonote::get_spot_reserve_ratio(circ_amounts, pricing_record);
 }
 double wallet2::get_ma_reserve_ratio(const oracle::pricing_record& pricing_record)
 {
-  std::vector<std::pair<std::string, std::string>> circ_amounts;
+  cryptonote::circ_supply_snapshot circ_amounts;
   THROW_WALLET_EXCEPTION_IF(!get_circulating_supply(circ_amounts), error::wallet_internal_error, "Failed to get circulating supply");
   return cryptonote::get_ma_reserve_ratio(circ_amounts, pricing_record);
 }
@@ -9694,7 +10399,8 @@ std::vector<wallet2::pending_tx> wallet2::create_transactions_2(
   uint32_t priority,
   const std::vector<uint8_t>& extra,
   uint32_t subaddr_account,
-  std::set<uint32_t> subaddr_indices
+  std::set<uint32_t> subaddr_indices,
+  bool pipelined
 ){
   //ensure device is let in NONE mode in any case
   hw::device &hwdev = m_account.get_device();
@@ -9839,7 +10545,7 @@ std::vector<wallet2::pending_tx> wallet2::create_transactions_2(
   }
 
   if (source_asset != dest_asset) {
-    std::vector<std::pair<std::string, std::string>> circ_amounts;
+    cryptonote::circ_supply_snapshot circ_amounts;
     THROW_WALLET_EXCEPTION_IF(!get_circulating_supply(circ_amounts), error::wallet_internal_error, "Failed to get circulating supply");
 
     std::string error_reason;
@@ -10014,6 +10720,58 @@ std::vector<wallet2::pending_tx> wallet2::create_transactions_2(
   }
   LOG_PRINT_L2("done checking preferred");
 
+  // rings are picked once per input for the whole job, rather than again for
+  // every input of a tx each time it gains one; preferred inputs will all be
+  // spent, so their rings are fetched together up front
+  decoy_plan plan;
+  if (!preferred_inputs.empty())
+    plan_outs(plan, preferred_inputs, fake_outs_count, use_rct, valid_public_keys_cache);
+
+  // When pipelined, each tx is signed on the compute threadpool as soon as it
+  // is final, ie when we move on to the next one, so signing tx N overlaps
+  // with selecting inputs and fetching decoys for tx N+1. Inputs are still
+  // selected here, in order. Hardware devices and multisig sign serially.
+  // The loop sizes txes with the account's device in fake mode, which makes
+  // dummy proofs, so the background signing uses its own device in real mode.
+  const bool pipeline = pipelined && !m_multisig && hwdev.get_type() == hw::device::SOFTWARE;
+  tx_construction_context context;
+  hw::core::device_default signing_device;
+  if (pipeline)
+  {
+    context = get_tx_construction_context();
+    signing_device.set_mode(hw::device::TRANSACTION_CREATE_REAL);
+    context.signing_device = &signing_device;
+  }
+  const tx_construction_context *construction_context = pipeline ? &context : NULL;
+  struct signed_tx
+  {
+    TX tx;
+    std::exception_ptr error;
+  };
+  std::deque<signed_tx> signed_txes;
+  tools::threadpool& tpool = tools::threadpool::getInstanceForCompute();
+  tools::threadpool::waiter waiter(tpool);
+  auto wait_for_signing = epee::misc_utils::create_scope_leave_handler([&](){ waiter.wait(); });
+  auto sign_in_background = [&](const TX &tx)
+  {
+    signed_txes.push_back({tx, nullptr});
+    signed_tx *stx = &signed_txes.back();
+    tpool.submit(&waiter, [&, stx]() {
+      try
+      {
+        std::unordered_set<crypto::public_key> unused_public_keys_cache; // outs are already fetched
+        transfer_selected_rct(stx->tx.dsts, stx->tx.selected_transfers, fake_outs_count, stx->tx.outs, unused_public_keys_cache,
+            unlock_time, stx->tx.needed_fee, extra, stx->tx.tx, stx->tx.ptx, rct_config, use_view_tags, source_asset, dest_asset,
+            pricing_record, construction_context);
+        stx->tx.weight = get_transaction_weight(stx->tx.tx);
+      }
+      catch (...)
+      {
+        stx->error = std::current_exception();
+      }
+    });
+  };
+
   // while:
   // - we have something to send
   // - or we need to gather more fee
@@ -10231,6 +10989,9 @@ std::vector<wallet2::pending_tx> wallet2::create_transactions_2(
 
       LOG_PRINT_L2("Trying to create a tx now, with " << tx.dsts.size() << " outputs and " <<
       tx.selected_transfers.size() << " inputs");
+
+      if (outs.empty())
+        get_planned_outs(plan, outs, tx.selected_transfers, fake_outs_count, use_rct, valid_public_keys_cache);
   
       transfer_selected_rct(
         tx.dsts,
@@ -10247,7 +11008,8 @@ std::vector<wallet2::pending_tx> wallet2::create_transactions_2(
         use_view_tags,
         source_asset,
         dest_asset,
-        pricing_record
+        pricing_record,
+        construction_context
       );
 
       auto txBlob = t_serializable_object_to_blob(test_ptx.tx);
@@ -10287,7 +11049,8 @@ std::vector<wallet2::pending_tx> wallet2::create_transactions_2(
             use_view_tags,
             source_asset,
             dest_asset,
-            pricing_record
+            pricing_record,
+            construction_context
           );
    
           txBlob = t_serializable_object_to_blob(test_ptx.tx);
@@ -10315,6 +11078,8 @@ std::vector<wallet2::pending_tx> wallet2::create_transactions_2(
         if (!dsts.empty())
         {
           LOG_PRINT_L2("We have more to pay, starting another tx");
+          if (pipeline)
+            sign_in_background(tx);
           txes.push_back(TX());
           original_output_index = 0;
         }
@@ -10349,42 +11114,58 @@ skip_tx:
     " total fee, " << print_money(accumulated_change) << " total change");
 
   hwdev.set_mode(hw::device::TRANSACTION_CREATE_REAL);
-  for (std::vector<TX>::iterator i = txes.begin(); i != txes.end(); ++i)
+  if (pipeline)
   {
-    TX &tx = *i;
-    cryptonote::transaction test_tx;
-    pending_tx test_ptx;
+    sign_in_background(txes.back());
+    waiter.wait();
+    THROW_WALLET_EXCEPTION_IF(signed_txes.size() != txes.size(), error::wallet_internal_error, "Signed tx count does not match tx count");
+    for (size_t n = 0; n < txes.size(); ++n)
+    {
+      if (signed_txes[n].error)
+        std::rethrow_exception(signed_txes[n].error);
+      txes[n] = std::move(signed_txes[n].tx);
+    }
+  }
+  else
+  {
+    for (std::vector<TX>::iterator i = txes.begin(); i != txes.end(); ++i)
+    {
+      TX &tx = *i;
+      cryptonote::transaction test_tx;
+      pending_tx test_ptx;
   
-    transfer_selected_rct(tx.dsts,                    /* NOMOD std::vector<cryptonote::tx_destination_entry> dsts,*/
-                          tx.selected_transfers,      /* const std::list<size_t> selected_transfers */
-                          fake_outs_count,            /* CONST size_t fake_outputs_count, */
-                          tx.outs,                    /* MOD   std::vector<std::vector<tools::wallet2::get_outs_entry>> &outs, */
-                          valid_public_keys_cache,
-                          unlock_time,                /* CONST uint64_t unlock_time,  */
-                          tx.needed_fee,              /* CONST uint64_t fee, */
-                          extra,                      /* const std::vector<uint8_t>& extra, */
-                          test_tx,                    /* OUT   cryptonote::transaction& tx, */
-                          test_ptx,                   /* OUT   cryptonote::transaction& tx, */
-                          rct_config,
-                          use_view_tags,              /* const bool use_view_tags */
-                          source_asset,
-                          dest_asset,
-                          pricing_record
-                        );            
+      transfer_selected_rct(tx.dsts,                    /* NOMOD std::vector<cryptonote::tx_destination_entry> dsts,*/
+                            tx.selected_transfers,      /* const std::list<size_t> selected_transfers */
+                            fake_outs_count,            /* CONST size_t fake_outputs_count, */
+                            tx.outs,                    /* MOD   std::vector<std::vector<tools::wallet2::get_outs_entry>> &outs, */
+                            valid_public_keys_cache,
+                            unlock_time,                /* CONST uint64_t unlock_time,  */
+                            tx.needed_fee,              /* CONST uint64_t fee, */
+                            extra,                      /* const std::vector<uint8_t>& extra, */
+                            test_tx,                    /* OUT   cryptonote::transaction& tx, */
+                            test_ptx,                   /* OUT   cryptonote::transaction& tx, */
+                            rct_config,
+                            use_view_tags,              /* const bool use_view_tags */
+                            source_asset,
+                            dest_asset,
+                            pricing_record
+                          );            
 
-    auto txBlob = t_serializable_object_to_blob(test_ptx.tx);
-    tx.tx = test_tx;
-    tx.ptx = test_ptx;
-    tx.weight = get_transaction_weight(test_tx, txBlob.size());
+      auto txBlob = t_serializable_object_to_blob(test_ptx.tx);
+      tx.tx = test_tx;
+      tx.ptx = test_ptx;
+      tx.weight = get_transaction_weight(test_tx, txBlob.size());
+    }
   }
 
   std::vector<wallet2::pending_tx> ptx_vector;
+  const oracle::asset_id source_asset_id = oracle::get_asset_id(source_asset);
   for (std::vector<TX>::iterator i = txes.begin(); i != txes.end(); ++i)
   {
     TX &tx = *i;
     uint64_t tx_money = 0;
     for (size_t idx: tx.selected_transfers)
-      if (m_transfers[idx].asset_type == source_asset)
+      if (m_transfers[idx].asset_type == source_asset_id)
         tx_money += m_transfers[idx].amount();
     LOG_PRINT_L1("  Transaction " << (1+std::distance(txes.begin(), i)) << "/" << txes.size() <<
       " " << get_transaction_hash(tx.ptx.tx) << ": " << get_weight_string(tx.weight) << ", sending " << print_money(tx_money) << " in " << tx.selected_transfers.size() <<
@@ -10419,8 +11200,9 @@ bool wallet2::sanity_check(const std::vector<wallet2::pending_tx> &ptx_vector, s
   uint64_t change = 0;
   for (const auto &ptx: ptx_vector)
   {
+    const oracle::asset_id change_asset_id = oracle::get_asset_id(ptx.change_dts.dest_asset_type);
     for (size_t idx: ptx.selected_transfers)
-      if (m_transfers[idx].asset_type == ptx.change_dts.dest_asset_type)
+      if (m_transfers[idx].asset_type == change_asset_id)
         change += m_transfers[idx].amount();
     change -= ptx.fee;
   }
@@ -10657,6 +11439,12 @@ std::vector<wallet2::pending_tx> wallet2::create_transactions_from(
     THROW_WALLET_EXCEPTION_IF(!b, error::wallet_internal_error, "Failed to get pricing record");
   }
 
+  // every input will be spent, so pick all the rings in one go
+  decoy_plan plan;
+  std::vector<size_t> all_transfers_indices(unused_transfers_indices);
+  all_transfers_indices.insert(all_transfers_indices.end(), unused_dust_indices.begin(), unused_dust_indices.end());
+  plan_outs(plan, all_transfers_indices, fake_outs_count, use_rct, valid_public_keys_cache);
+
   // while we have something to send
   hwdev.set_mode(hw::device::TRANSACTION_CREATE_FAKE);
   while (!unused_dust_indices.empty() || !unused_transfers_indices.empty()) {
@@ -10711,6 +11499,7 @@ std::vector<wallet2::pending_tx> wallet2::create_transactions_from(
 
       LOG_PRINT_L2("Trying to create a tx now, with " << tx.dsts.size() << " destinations and " <<
         tx.selected_transfers.size() << " outputs");
+      get_planned_outs(plan, outs, tx.selected_transfers, fake_outs_count, use_rct, valid_public_keys_cache);
       if (use_rct)
         transfer_selected_rct(tx.dsts, tx.selected_transfers, fake_outs_count, outs, valid_public_keys_cache, unlock_time, needed_fee, extra,
           test_tx, test_ptx, rct_config, use_view_tags, source_asset, dest_asset, pricing_record);
@@ -10790,7 +11579,7 @@ std::vector<wallet2::pending_tx> wallet2::create_transactions_from(
         }
 
         if (source_asset != dest_asset) {
-          std::vector<std::pair<std::string, std::string>> circ_amounts;
+          cryptonote::circ_supply_snapshot circ_amounts;
           THROW_WALLET_EXCEPTION_IF(!get_circulating_supply(circ_amounts), error::wallet_internal_error, "Failed to get circulating supply");
 
           std::string error_reason;
@@ -11603,7 +12392,7 @@ void wallet2::check_tx_key_helper(const cryptonote::transaction &tx, const crypt
         else
           amount = 0;
       }
-      std::string asset_type = boost::get<cryptonote::txout_zephyr_tagged_key>(tx.vout[n].target).asset_type;
+      const std::string &asset_type = oracle::get_asset_type(boost::get<cryptonote::txout_zephyr_tagged_key>(tx.vout[n].target).asset_type);
       received[asset_type] += amount;
     }
   }
@@ -12817,6 +13606,7 @@ uint64_t wallet2::import_key_images(const std::vector<std::pair<crypto::key_imag
     return 0;
   }
 
+  m_cache_journal.compact = true;
   req.key_images.reserve(signed_key_images.size());
 
   PERF_TIMER_START(import_key_images_A);
@@ -12989,7 +13779,7 @@ uint64_t wallet2::import_key_images(const std::vector<std::pair<crypto::key_imag
       bool miner_tx = cryptonote::is_coinbase(spent_tx);
       for (const cryptonote::tx_out& out : spent_tx.vout)
       {
-        std::string asset_type = boost::get<txout_zephyr_tagged_key>(out.target).asset_type;
+        const std::string &asset_type = oracle::get_asset_type(boost::get<txout_zephyr_tagged_key>(out.target).asset_type);
         tx_scan_info_t tx_scan_info;
         check_acc_out_precomp(out, derivation, additional_derivations, output_index, tx_scan_info);
         THROW_WALLET_EXCEPTION_IF(tx_scan_info.error, error::wallet_internal_error, "check_acc_out_precomp failed");
@@ -13090,6 +13880,7 @@ bool wallet2::import_key_images(std::vector<crypto::key_image> key_images, size_
     LOG_PRINT_L1("More key images returned that we know outputs for");
     return false;
   }
+  m_cache_journal.compact = true;
   for (size_t ki_idx = 0; ki_idx < key_images.size(); ++ki_idx)
   {
     const size_t transfer_idx = ki_idx + offset;
@@ -13136,6 +13927,7 @@ wallet2::payment_container wallet2::export_payments() const
 }
 void wallet2::import_payments(const payment_container &payments)
 {
+  m_cache_journal.compact = true;
   m_payments.clear();
   for (auto const &p : payments)
   {
@@ -13144,6 +13936,7 @@ void wallet2::import_payments(const payment_container &payments)
 }
 void wallet2::import_payments_out(const std::list<std::pair<crypto::hash,wallet2::confirmed_transfer_details>> &confirmed_payments)
 {
+  m_cache_journal.compact = true;
   m_confirmed_txs.clear();
   for (auto const &p : confirmed_payments)
   {
@@ -13165,6 +13958,7 @@ std::tuple<size_t,crypto::hash,std::vector<crypto::hash>> wallet2::export_blockc
 
 void wallet2::import_blockchain(const std::tuple<size_t, crypto::hash, std::vector<crypto::hash>> &bc)
 {
+  m_cache_journal.compact = true;
   m_blockchain.clear();
   if (std::get<0>(bc))
   {
@@ -13265,6 +14059,7 @@ size_t wallet2::import_outputs(const std::tuple<uint64_t, uint64_t, std::vector<
 
   THROW_WALLET_EXCEPTION_IF(offset > m_transfers.size(), error::wallet_internal_error,
       "Imported outputs omit more outputs that we know of");
+  m_cache_journal.compact = true;
 
   THROW_WALLET_EXCEPTION_IF(offset + output_array.size() > num_outputs, error::wallet_internal_error,
       "Offset is larger than total outputs");
@@ -13345,6 +14140,7 @@ size_t wallet2::import_outputs(const std::tuple<uint64_t, uint64_t, std::vector<
 
   THROW_WALLET_EXCEPTION_IF(offset > m_transfers.size(), error::wallet_internal_error,
       "Imported outputs omit more outputs that we know of. Try using export_outputs all.");
+  m_cache_journal.compact = true;
 
   THROW_WALLET_EXCEPTION_IF(offset + output_array.size() > num_outputs, error::wallet_internal_error,
       "Offset is larger than total outputs");
@@ -14177,14 +14973,29 @@ std::vector<std::pair<uint64_t, uint64_t>> wallet2::estimate_backlog(const std::
     THROW_WALLET_EXCEPTION_IF(fee_level.second == 0.0, error::wallet_internal_error, "Invalid 0 fee");
   }
 
-  // get txpool backlog
-  cryptonote::COMMAND_RPC_GET_TRANSACTION_POOL_BACKLOG::request req = AUTO_VAL_INIT(req);
-  cryptonote::COMMAND_RPC_GET_TRANSACTION_POOL_BACKLOG::response res = AUTO_VAL_INIT(res);
-
+  // get txpool backlog, as fee histogram buckets if the daemon has them,
+  // each bucket standing in for all its txes at their average fee per byte
+  std::vector<cryptonote::tx_backlog_entry> backlog;
   {
+    cryptonote::COMMAND_RPC_GET_FEE_HISTOGRAM::request req = AUTO_VAL_INIT(req);
+    cryptonote::COMMAND_RPC_GET_FEE_HISTOGRAM::response res = AUTO_VAL_INIT(res);
     const boost::lock_guard<boost::recursive_mutex> lock{m_daemon_rpc_mutex};
-    bool r = net_utils::invoke_http_json_rpc("/json_rpc", "get_txpool_backlog", req, res, *m_http_client, rpc_timeout);
-    THROW_ON_RPC_RESPONSE_ERROR(r, {}, res, "get_txpool_backlog", error::get_tx_pool_error);
+    bool r = net_utils::invoke_http_bin("/get_fee_histogram.bin", req, res, *m_http_client, rpc_timeout);
+    if (r && res.status == CORE_RPC_STATUS_OK)
+    {
+      for (const auto &h: res.histograms)
+        for (const auto &b: h.buckets)
+          backlog.push_back({b.weight, b.fee, 0});
+    }
+    else
+    {
+      MDEBUG("Daemon has no fee histogram, falling back to the full txpool backlog");
+      cryptonote::COMMAND_RPC_GET_TRANSACTION_POOL_BACKLOG::request backlog_req = AUTO_VAL_INIT(backlog_req);
+      cryptonote::COMMAND_RPC_GET_TRANSACTION_POOL_BACKLOG::response backlog_res = AUTO_VAL_INIT(backlog_res);
+      r = net_utils::invoke_http_json_rpc("/json_rpc", "get_txpool_backlog", backlog_req, backlog_res, *m_http_client, rpc_timeout);
+      THROW_ON_RPC_RESPONSE_ERROR(r, {}, backlog_res, "get_txpool_backlog", error::get_tx_pool_error);
+      backlog = std::move(backlog_res.backlog);
+    }
   }
 
   uint64_t block_weight_limit = 0;
@@ -14199,7 +15010,7 @@ std::vector<std::pair<uint64_t, uint64_t>> wallet2::estimate_backlog(const std::
     const double our_fee_byte_min = fee_level.first;
     const double our_fee_byte_max = fee_level.second;
     uint64_t priority_weight_min = 0, priority_weight_max = 0;
-    for (const auto &i: res.backlog)
+    for (const auto &i: backlog)
     {
       if (i.weight == 0)
       {
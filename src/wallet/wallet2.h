@@ -311,11 +311,11 @@ private:
       rct::key mask;
       uint64_t amount;
       uint64_t money_transfered;
-      std::string asset_type;
+      oracle::asset_id asset_type;
       bool error;
       boost::optional<cryptonote::subaddress_receive_info> received;
 
-      tx_scan_info_t(): amount(0), asset_type(""), money_transfered(0), error(true) {}
+      tx_scan_info_t(): amount(0), money_transfered(0), asset_type(oracle::asset_id::invalid), error(true) {}
     };
 
     struct transfer_details
@@ -341,7 +341,7 @@ private:
       std::vector<rct::key> m_multisig_k;
       std::vector<multisig_info> m_multisig_info; // one per other participant
       std::vector<std::pair<uint64_t, crypto::hash>> m_uses;
-      std::string asset_type;
+      oracle::asset_id asset_type; // serialized as the asset type string
 
       bool is_rct() const { return m_rct; }
       uint64_t amount() const { return m_amount; }
@@ -1039,7 +1039,7 @@ private:
     bool reconnect_device();
     
     bool get_pricing_record(oracle::pricing_record& pr, const uint64_t height);
-    bool get_circulating_supply(std::vector<std::pair<std::string, std::string>> &amounts);
+    bool get_circulating_supply(cryptonote::circ_supply_snapshot &amounts);
 
      // locked & unlocked balance of given or current subaddress account
     std::map<uint32_t, std::map<std::string, uint64_t>> balance(uint32_t subaddr_index_major, bool strict);
@@ -1058,6 +1058,20 @@ private:
     void transfer_selected(const std::vector<cryptonote::tx_destination_entry>& dsts, const std::vector<size_t>& selected_transfers, size_t fake_outputs_count,
       std::vector<std::vector<tools::wallet2::get_outs_entry>> &outs, std::unordered_set<crypto::public_key> &valid_public_keys_cache,
       uint64_t unlock_time, uint64_t fee, const std::vector<uint8_t>& extra, T destination_split_strategy, const tx_dust_policy& dust_policy, cryptonote::transaction& tx, pending_tx &ptx, const bool use_view_tags);
+    // Daemon state a tx is built against, read once on the calling thread so
+    // that transfer_selected_rct can run on another one
+    struct tx_construction_context
+    {
+      uint64_t upper_transaction_weight_limit;
+      uint64_t current_height;
+      uint32_t hf_version;
+      cryptonote::circ_supply_snapshot circ_amounts;
+      // if set, txes are signed with this device rather than the account's,
+      // so the account's device mode can change while they are signed
+      hw::device *signing_device;
+    };
+    tx_construction_context get_tx_construction_context();
+
     void transfer_selected_rct(
       std::vector<cryptonote::tx_destination_entry> dsts,
       const std::vector<size_t>& selected_transfers,
@@ -1073,7 +1087,8 @@ private:
       const bool use_view_tags,
       const std::string& source_asset,
       const std::string& dest_asset,
-      const oracle::pricing_record& pr
+      const oracle::pricing_record& pr,
+      const tx_construction_context *context = NULL
     );
 
     void commit_tx(pending_tx& ptx_vector);
@@ -1121,7 +1136,8 @@ private:
       uint32_t priority,
       const std::vector<uint8_t>& extra,
       uint32_t subaddr_account,
-      std::set<uint32_t> subaddr_indices // pass subaddr_indices by value on purpose
+      std::set<uint32_t> subaddr_indices, // pass subaddr_indices by value on purpose
+      bool pipelined = false
     );     
     std::vector<wallet2::pending_tx> create_transactions_all(
       uint64_t below,
@@ -1302,7 +1318,7 @@ private:
 
     BEGIN_SERIALIZE_OBJECT()
       MAGIC_FIELD("zephyr wallet cache")
-      VERSION_FIELD(1)
+      VERSION_FIELD(3)
       FIELD(m_blockchain)
       FIELD(m_transfers)
       FIELD(m_account_public_address)
@@ -1335,6 +1351,18 @@ private:
         return true;
       }
       FIELD(m_has_ever_refreshed_from_node)
+      if (version < 2)
+      {
+        m_rct_distributions.clear();
+        return true;
+      }
+      FIELD(m_rct_distributions)
+      if (version < 3)
+      {
+        m_cache_snapshot_id = crypto::null_hash;
+        return true;
+      }
+      FIELD(m_cache_snapshot_id)
     END_SERIALIZE()
 
     /*!
@@ -1758,7 +1786,17 @@ private:
     bool is_spent(const transfer_details &td, bool strict = true) const;
     bool is_spent(size_t idx, bool strict = true) const;
     void get_outs(std::vector<std::vector<get_outs_entry>> &outs, const std::vector<size_t> &selected_transfers, size_t fake_outputs_count, bool rct, std::unordered_set<crypto::public_key> &valid_public_keys_cache);
+    void get_outs(std::vector<std::vector<get_outs_entry>> &outs, const std::vector<size_t> &selected_transfers, size_t fake_outputs_count, bool rct, std::vector<uint64_t> &rct_offsets, uint64_t &num_spendable_global_outs, std::unordered_set<crypto::public_key> &valid_public_keys_cache);
     void get_outs(std::vector<std::vector<get_outs_entry>> &outs, const std::vector<size_t> &selected_transfers, size_t fake_outputs_count, std::vector<uint64_t> &rct_offsets, uint64_t &num_spendable_global_outs, std::unordered_set<crypto::public_key> &valid_public_keys_cache);
+    // Rings picked for the inputs of a multi-tx job, by transfer index, and the
+    // output distribution of each asset type they were picked from
+    struct decoy_plan
+    {
+      std::unordered_map<size_t, std::vector<get_outs_entry>> rings;
+      std::unordered_map<std::string, std::pair<std::vector<uint64_t>, uint64_t>> distributions;
+    };
+    void plan_outs(decoy_plan &plan, const std::vector<size_t> &transfers, size_t fake_outputs_count, bool rct, std::unordered_set<crypto::public_key> &valid_public_keys_cache);
+    void get_planned_outs(decoy_plan &plan, std::vector<std::vector<get_outs_entry>> &outs, const std::vector<size_t> &selected_transfers, size_t fake_outputs_count, bool rct, std::unordered_set<crypto::public_key> &valid_public_keys_cache);
     bool tx_add_fake_output(std::vector<std::vector<tools::wallet2::get_outs_entry>> &outs, uint64_t global_index, const crypto::public_key& tx_public_key, const rct::key& mask, uint64_t real_index, bool unlocked, std::unordered_set<crypto::public_key> &valid_public_keys_cache) const;
     bool should_pick_a_second_output(bool use_rct, size_t n_transfers, const std::vector<size_t> &unused_transfers_indices, const std::vector<size_t> &unused_dust_indices) const;
     std::vector<size_t> get_only_rct(const std::vector<size_t> &unused_dust_indices, const std::vector<size_t> &unused_transfers_indices) const;
@@ -1780,7 +1818,165 @@ private:
     void register_devices();
     hw::device& lookup_device(const std::string & device_descriptor);
 
+    // Per block rct output counts of one asset type, kept in the wallet cache
+    // up to a block whose hash we know, so they can be extended from there
+    struct rct_distribution
+    {
+      uint64_t start_height;
+      std::vector<uint64_t> counts;
+      crypto::hash top_hash;
+
+      uint64_t top_height() const { return start_height + counts.size() - 1; }
+
+      BEGIN_SERIALIZE_OBJECT()
+        VERSION_FIELD(0)
+        VARINT_FIELD(start_height)
+        FIELD(counts)
+        FIELD(top_hash)
+      END_SERIALIZE()
+    };
     bool get_rct_distribution(const std::string rct_asset_type, uint64_t &start_height, std::vector<uint64_t> &distribution, uint64_t &num_spendable_global_outs);
+    void cache_rct_distribution(const std::string &rct_asset_type, uint64_t start_height, std::vector<uint64_t> counts);
+
+    // What changed in one of the wallet cache maps between two stores
+    template<typename K, typename V>
+    struct cache_journal_map_delta
+    {
+      uint64_t count = 0;
+      std::vector<std::pair<K, V>> changed;
+      std::vector<K> removed;
+      std::vector<uint64_t> fingerprints; // of the changed values, not written
+
+      BEGIN_SERIALIZE_OBJECT()
+        VERSION_FIELD(0)
+        VARINT_FIELD(count)
+        FIELD(changed)
+        FIELD(removed)
+      END_SERIALIZE()
+    };
+
+    template<typename K>
+    struct cache_journal_set_delta
+    {
+      uint64_t count = 0;
+      std::vector<K> added;
+      std::vector<K> removed;
+
+      BEGIN_SERIALIZE_OBJECT()
+        VERSION_FIELD(0)
+        VARINT_FIELD(count)
+        FIELD(added)
+        FIELD(removed)
+      END_SERIALIZE()
+    };
+
+    // What changed in the wallet cache between two stores, appended to the cache
+    // journal and replayed on top of the full cache it was written against
+    struct cache_journal_record
+    {
+      crypto::hash snapshot_id;
+      uint64_t sequence;
+      uint64_t transfer_count;
+      std::vector<std::pair<uint64_t, transfer_details>> transfers;
+      std::vector<std::pair<crypto::key_image, uint64_t>> key_images;
+      std::vector<std::pair<crypto::public_key, uint64_t>> pub_keys;
+      uint64_t blockchain_offset;
+      uint64_t blockchain_from;
+      std::vector<crypto::hash> blockchain;
+      std::vector<std::pair<crypto::hash, payment_details>> payments;
+      std::vector<std::pair<crypto::hash, confirmed_transfer_details>> confirmed_txs;
+      std::vector<std::pair<crypto::public_key, cryptonote::subaddress_index>> subaddresses;
+      std::vector<std::string> rct_distribution_assets;
+      std::vector<std::pair<std::string, rct_distribution>> rct_distributions;
+      cache_journal_map_delta<crypto::hash, unconfirmed_transfer_details> unconfirmed_txs;
+      cache_journal_map_delta<crypto::hash, crypto::secret_key> tx_keys;
+      cache_journal_map_delta<crypto::hash, std::vector<crypto::secret_key>> additional_tx_keys;
+      cache_journal_map_delta<crypto::public_key, crypto::key_image> cold_key_images;
+      cache_journal_set_delta<crypto::hash> scanned_pool_txs[2];
+      uint64_t key_images_count;
+      uint64_t pub_keys_count;
+      uint64_t payments_count;
+      uint64_t confirmed_txs_count;
+      uint64_t subaddresses_count;
+      std::string state;
+
+      BEGIN_SERIALIZE_OBJECT()
+        VERSION_FIELD(0)
+        FIELD(snapshot_id)
+        VARINT_FIELD(sequence)
+        VARINT_FIELD(transfer_count)
+        FIELD(transfers)
+        FIELD(key_images)
+        FIELD(pub_keys)
+        VARINT_FIELD(blockchain_offset)
+        VARINT_FIELD(blockchain_from)
+        FIELD(blockchain)
+        FIELD(payments)
+        FIELD(confirmed_txs)
+        FIELD(subaddresses)
+        FIELD(rct_distribution_assets)
+        FIELD(rct_distributions)
+        FIELD(unconfirmed_txs)
+        FIELD(tx_keys)
+        FIELD(additional_tx_keys)
+        FIELD(cold_key_images)
+        FIELD(scanned_pool_txs[0])
+        FIELD(scanned_pool_txs[1])
+        VARINT_FIELD(key_images_count)
+        VARINT_FIELD(pub_keys_count)
+        VARINT_FIELD(payments_count)
+        VARINT_FIELD(confirmed_txs_count)
+        VARINT_FIELD(subaddresses_count)
+        FIELD(state)
+      END_SERIALIZE()
+    };
+
+    // What the cache files on disk hold, so a store only has to write what changed since
+    struct cache_journal
+    {
+      bool compact = true;
+      uint64_t sequence = 0;
+      uint64_t snapshot_size = 0;
+      uint64_t size = 0;
+      std::vector<uint64_t> transfer_fingerprints;
+      uint64_t blockchain_size = 0;
+      uint64_t blockchain_offset = 0;
+      uint64_t detached_height = std::numeric_limits<uint64_t>::max();
+      std::vector<crypto::public_key> subaddresses;
+      std::map<std::string, crypto::hash> rct_distribution_tops;
+      std::unordered_map<crypto::hash, uint64_t> unconfirmed_tx_fingerprints;
+      std::unordered_map<crypto::hash, uint64_t> tx_key_fingerprints;
+      std::unordered_map<crypto::hash, uint64_t> additional_tx_key_fingerprints;
+      std::unordered_map<crypto::public_key, uint64_t> cold_key_image_fingerprints;
+      std::unordered_set<crypto::hash> scanned_pool_txs[2];
+    };
+
+    // the wallet cache fields which are small enough to be written whole in every journal record
+    template <bool W, template <bool> class Archive>
+    bool serialize_cache_journal_state(Archive<W> &ar)
+    {
+      VERSION_FIELD(0)
+      FIELD(m_tx_notes)
+      FIELD(m_unconfirmed_payments)
+      FIELD(m_address_book)
+      FIELD(m_subaddress_labels)
+      FIELD(m_attributes)
+      FIELD(m_account_tags)
+      FIELD(m_ring_history_saved)
+      FIELD(m_last_block_reward)
+      FIELD(m_tx_device)
+      FIELD(m_device_last_key_image_sync)
+      FIELD(m_has_ever_refreshed_from_node)
+      return ar.good();
+    }
+    static uint64_t get_cache_fingerprint(const transfer_details &td);
+    std::string get_cache_journal_file() const { return m_wallet_file + ".journal"; }
+    void reset_cache_journal();
+    bool get_cache_journal_record(cache_journal_record &record, std::vector<std::pair<size_t, uint64_t>> &fingerprints);
+    bool append_cache_journal();
+    bool apply_cache_journal_record(cache_journal_record &record);
+    void load_cache_journal(uint64_t snapshot_size);
+    void remove_cache_journal(const std::string &journal_file);
 
     uint64_t get_segregation_fork_height() const;
 
@@ -1930,6 +2126,9 @@ private:
     bool m_load_deprecated_formats;
 
     bool m_has_ever_refreshed_from_node;
+    serializable_map<std::string, rct_distribution> m_rct_distributions;
+    crypto::hash m_cache_snapshot_id;
+    cache_journal m_cache_journal;
 
     static boost::mutex default_daemon_address_lock;
     static std::string default_daemon_address;
@@ -475,6 +475,7 @@ bool gen_block_miner_tx_has_out_to_alice::generate(std::vector<test_event_entry>
   miner_tx.vout[0].amount -= out_to_alice.amount;
   txout_zephyr_tagged_key tk;
   tk.key = out_eph_public_key;
+  tk.asset_type = oracle::asset_id::ZEPH;
   out_to_alice.target = tk;
   miner_tx.vout.push_back(out_to_alice);
 
@@ -0,0 +1,247 @@
+// Copyright (c) 2023, Zephyr Protocol
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <cstring>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "cryptonote_config.h"
+#include "cryptonote_basic/cryptonote_format_utils.h"
+#include "cryptonote_core/blockchain.h"
+#include "cryptonote_core/tx_pool.h"
+#include "cryptonote_core/cryptonote_core.h"
+#include "cryptonote_core/cryptonote_tx_utils.h"
+#include "blockchain_db/testdb.h"
+#include "ringct/rctOps.h"
+#include "ringct/rctSigs.h"
+
+// tx_memory_pool::fill_block_template over a pool of 10k txes backed by an
+// in-memory txpool table. Conversions carry proofs of value that pass the
+// semantics check against the chain's pricing record, ring signatures are
+// taken as checked.
+// mode 0: transfers only
+// mode 1: 30% conversions, near the reserve ratio limits so that some of
+//         them are deferred and retried at the end of the block
+template<int mode>
+class test_block_template_conversions
+{
+public:
+  static const size_t loop_count = 20;
+  static const size_t pool_size = 10000;
+  static const uint64_t chain_height = 100;
+
+  test_block_template_conversions(): m_txpool(m_bc), m_bc(m_txpool),
+    m_hard_forks{std::make_pair((uint8_t)1, (uint64_t)0), std::make_pair((uint8_t)0, (uint64_t)0)},
+    m_test_options{m_hard_forks, CRYPTONOTE_LONG_TERM_BLOCK_WEIGHT_WINDOW_SIZE}
+  {
+  }
+
+  bool init()
+  {
+    m_pr.spot = m_pr.moving_average = 1500000000000;
+    m_pr.stable = m_pr.stable_ma = 666660000000;
+    m_pr.reserve = m_pr.reserve_ma = 2000000000000;
+    m_pr.timestamp = 1691040826;
+
+    cryptonote::TxpoolTestDB *db = new cryptonote::TxpoolTestDB();
+    // reserve ratio just above 4, the blockchain caches the supply at init
+    db->m_circ_supply.tally[cryptonote::circ_supply_snapshot::ZEPH] = 1000000 * COIN;
+    db->m_circ_supply.tally[cryptonote::circ_supply_snapshot::ZEPHUSD] = 360000 * COIN;
+    db->m_circ_supply.tally[cryptonote::circ_supply_snapshot::ZEPHRSV] = 500000 * COIN;
+    if (!m_bc.init(db, cryptonote::FAKECHAIN, true, &m_test_options, 0, NULL))
+      return false;
+    db->m_height = chain_height;
+    for (uint64_t h = chain_height - PRICING_RECORD_VALID_BLOCKS; h < chain_height; ++h)
+      db->m_pricing_records[h] = m_pr;
+
+    using tt = cryptonote::transaction_type;
+    static const tt conversion_types[] = {tt::MINT_STABLE, tt::REDEEM_STABLE, tt::MINT_RESERVE, tt::REDEEM_RESERVE};
+    std::mt19937_64 rng(0);
+    for (size_t i = 0; i < pool_size; ++i)
+    {
+      const uint64_t weight = 1500 + rng() % 3000;
+      const uint64_t fee = weight * (20000 + rng() % 20000);
+      const tt tx_type = mode == 1 && rng() % 10 < 3 ? conversion_types[rng() % 4] : tt::TRANSFER;
+      const uint64_t amount = (1 + rng() % 5000) * COIN;
+      cryptonote::transaction tx;
+      if (!make_tx(i, tx_type, amount, fee, tx))
+        return false;
+
+      const cryptonote::blobdata blob = cryptonote::t_serializable_object_to_blob(tx);
+      const crypto::hash txid = cryptonote::get_transaction_hash(tx);
+      cryptonote::txpool_tx_meta_t meta{};
+      meta.weight = weight;
+      meta.fee = fee;
+      meta.receive_time = time(NULL);
+      meta.last_relayed_time = meta.receive_time;
+      meta.relayed = true;
+      meta.set_relay_method(cryptonote::relay_method::fluff);
+      std::strncpy(meta.fee_asset_type, "ZEPH", sizeof(meta.fee_asset_type));
+      meta.tx_type = (uint8_t)tx_type;
+      db->add_txpool_tx(txid, blob, meta);
+      m_txids.push_back(txid);
+    }
+    if (!m_txpool.init())
+      return false;
+
+    // the ring signatures are not what is measured here
+    const crypto::hash checked_at = m_bc.get_block_id_by_height(0);
+    for (const crypto::hash &txid: m_txids)
+      m_txpool.m_input_cache.emplace(txid, std::make_tuple(true, cryptonote::tx_verification_context{}, (uint64_t)0, checked_at));
+    return true;
+  }
+
+  bool test()
+  {
+    cryptonote::block bl;
+    bl.pricing_record = m_pr;
+    size_t total_weight;
+    std::map<std::string, uint64_t> fee_map;
+    uint64_t expected_reward;
+    if (!m_txpool.fill_block_template(bl, CRYPTONOTE_BLOCK_GRANTED_FULL_REWARD_ZONE_V5, 0, total_weight, fee_map, expected_reward, HF_VERSION_DJED))
+      return false;
+    return !bl.tx_hashes.empty();
+  }
+
+private:
+  // x^(l-2) mod l
+  static rct::key invert(const rct::key &x)
+  {
+    rct::key e = rct::curveOrder();
+    e.bytes[0] -= 2;
+    rct::key r = rct::identity();
+    for (int i = 255; i >= 0; --i)
+    {
+      sc_mul(r.bytes, r.bytes, r.bytes);
+      if ((e.bytes[i / 8] >> (i % 8)) & 1)
+        sc_mul(r.bytes, r.bytes, x.bytes);
+    }
+    return r;
+  }
+
+  cryptonote::tx_out make_output(const std::string &asset_type) const
+  {
+    cryptonote::tx_out out;
+    out.amount = 0;
+    out.target = cryptonote::txout_zephyr_tagged_key(rct::rct2pk(rct::pkGen()), oracle::get_asset_id(asset_type), crypto::view_tag{});
+    return out;
+  }
+
+  // one input and a change output; conversions also get a converted output,
+  // with commitments balancing under the pricing record and the amount burnt
+  bool make_tx(size_t n, cryptonote::transaction_type tx_type, uint64_t amount, uint64_t fee, cryptonote::transaction &tx) const
+  {
+    using tt = cryptonote::transaction_type;
+    static const std::map<tt, std::pair<std::string, std::string>> assets = {
+      {tt::TRANSFER, {"ZEPH", "ZEPH"}},
+      {tt::MINT_STABLE, {"ZEPH", "ZEPHUSD"}},
+      {tt::REDEEM_STABLE, {"ZEPHUSD", "ZEPH"}},
+      {tt::MINT_RESERVE, {"ZEPH", "ZEPHRSV"}},
+      {tt::REDEEM_RESERVE, {"ZEPHRSV", "ZEPH"}},
+    };
+    const std::string &source = assets.at(tx_type).first;
+    const std::string &dest = assets.at(tx_type).second;
+
+    tx.version = 2;
+    tx.unlock_time = 0;
+    cryptonote::txin_zephyr_key in;
+    in.amount = 0;
+    in.asset_type = source;
+    in.key_offsets.push_back(1);
+    crypto::cn_fast_hash(&n, sizeof(n), (crypto::hash&)in.k_image);
+    tx.vin.push_back(in);
+    tx.vout.push_back(make_output(source));
+    if (tx_type == tt::TRANSFER)
+    {
+      tx.pricing_record_height = 0;
+      tx.amount_burnt = 0;
+      tx.amount_minted = 0;
+      tx.rct_signatures.type = rct::RCTTypeNull;
+      return true;
+    }
+    tx.vout.push_back(make_output(dest));
+    tx.pricing_record_height = chain_height - 1;
+    tx.amount_burnt = amount;
+    switch (tx_type)
+    {
+      case tt::MINT_STABLE: tx.amount_minted = cryptonote::zeph_to_zephusd(amount, m_pr); break;
+      case tt::REDEEM_STABLE: tx.amount_minted = cryptonote::zephusd_to_zeph(amount, m_pr); break;
+      case tt::MINT_RESERVE: tx.amount_minted = cryptonote::zeph_to_zephrsv(amount, m_pr); break;
+      default: tx.amount_minted = cryptonote::zephrsv_to_zeph(amount, m_pr); break;
+    }
+
+    // inputs of amount + fee with mask m, change of 0 with mask n: the
+    // source colour sums to (m - n)G + amount H, which must be the converted
+    // output scaled by the conversion rate
+    rct::rctSig &rv = tx.rct_signatures;
+    rv.type = rct::RCTTypeBulletproofPlus;
+    rv.txnFee = fee;
+    const rct::key m = rct::skGen(), change_mask = rct::skGen();
+    rv.maskSums = {m, change_mask};
+    rv.p.pseudoOuts.push_back(rct::commit(amount + fee, m));
+    const rct::key change = rct::commit(0, change_mask);
+    rct::key sum_source;
+    rct::subKeys(sum_source, rv.p.pseudoOuts[0], rct::scalarmultH(rct::d2h(fee)));
+    rct::subKeys(sum_source, sum_source, change);
+    const std::shared_ptr<const rct::conversion_context> conversion = rct::get_conversion_context(m_pr);
+    rct::key rate;
+    sc_mul(rate.bytes, conversion->atomic.bytes, conversion->get_inverse_rate(tx_type).bytes);
+    const rct::key converted = rct::scalarmultKey(sum_source, invert(rate));
+    rv.outPk = {{rct::zero(), change}, {rct::zero(), converted}};
+    rv.ecdhInfo.resize(2);
+
+    // placeholders of the right shape, range proofs and ring signatures are
+    // not checked by the block template
+    rct::BulletproofPlus proof;
+    proof.A = proof.A1 = proof.B = rct::identity();
+    proof.r1 = proof.s1 = proof.d1 = rct::zero();
+    proof.L.assign(7, rct::identity());
+    proof.R.assign(7, rct::identity());
+    // not serialized, restored from the output commitments on parsing
+    proof.V = {rct::scalarmultKey(change, rct::INV_EIGHT), rct::scalarmultKey(converted, rct::INV_EIGHT)};
+    rv.p.bulletproofs_plus.push_back(proof);
+    rct::clsag clsag;
+    clsag.s.push_back(rct::zero());
+    clsag.c1 = rct::zero();
+    clsag.D = rct::identity();
+    clsag.I = rct::identity();
+    rv.p.CLSAGs.push_back(clsag);
+
+    return rct::verRctSemanticsSimple(rv, m_pr, tx_type, source, dest, amount, tx.vout, tx.vin, HF_VERSION_DJED);
+  }
+
+  cryptonote::tx_memory_pool m_txpool;
+  cryptonote::Blockchain m_bc;
+  const std::pair<uint8_t, uint64_t> m_hard_forks[2];
+  const cryptonote::test_options m_test_options;
+  oracle::pricing_record m_pr;
+  std::vector<crypto::hash> m_txids;
+};
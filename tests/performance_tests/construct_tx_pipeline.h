@@ -0,0 +1,97 @@
+// Copyright (c) 2023, Zephyr Protocol
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <iostream>
+
+#include "../unit_tests/wallet_test_daemon.h"
+
+// A split transfer of 40 destinations over 3 txes, made by
+// wallet2::create_transactions_2 against a daemon 5 ms of round trip away.
+// mode 0: the txes are signed one after the other once all are sized
+// mode 1: each tx is signed on the compute threadpool while the inputs and
+//         decoys of the next one are picked
+template<int mode>
+class test_construct_tx_pipeline
+{
+public:
+  static const size_t loop_count = 5;
+  static const uint64_t chain_height = 1000;
+  static const uint64_t outs_per_block = 8;
+
+  test_construct_tx_pipeline():
+    m_daemon(chain_height, outs_per_block, std::chrono::milliseconds(5)),
+    m_wallet(cryptonote::MAINNET, 1, true, m_daemon.client_factory())
+  {
+  }
+
+  bool init()
+  {
+    try
+    {
+      m_wallet.generate("", "");
+      m_wallet.segregate_pre_fork_outputs(false);
+      m_wallet.key_reuse_mitigation2(false);
+      m_daemon.sync(m_wallet);
+      for (uint64_t n = 0; n < 6; ++n)
+        m_daemon.add_output(m_wallet, 1000 + n * 900, 10 * COIN);
+    }
+    catch (const std::exception &e)
+    {
+      std::cerr << "Failed to set up the wallet: " << e.what() << std::endl;
+      return false;
+    }
+
+    for (size_t n = 0; n < 40; ++n)
+    {
+      cryptonote::account_base recipient;
+      recipient.generate();
+      m_destinations.push_back(cryptonote::tx_destination_entry(COIN / 10, recipient.get_keys().m_account_address, false));
+    }
+    return true;
+  }
+
+  bool test()
+  {
+    try
+    {
+      return m_wallet.create_transactions_2(m_destinations, "ZEPH", 15, 0, 1, {}, 0, {}, mode == 1).size() == 3;
+    }
+    catch (const std::exception &e)
+    {
+      std::cerr << "Failed to create transactions: " << e.what() << std::endl;
+      return false;
+    }
+  }
+
+private:
+  unit_test::test_daemon m_daemon;
+  tools::wallet2 m_wallet;
+  std::vector<cryptonote::tx_destination_entry> m_destinations;
+};
@@ -0,0 +1,141 @@
+// Copyright (c) 2023, Zephyr Protocol
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#pragma once
+
+#include <boost/filesystem.hpp>
+
+#include "cryptonote_basic/cryptonote_format_utils.h"
+#include "cryptonote_basic/hardfork.h"
+#include "blockchain_db/blockchain_db.h"
+#include "blockchain_db/lmdb/db_lmdb.h"
+#include "oracle/asset_types.h"
+#include "ringct/rctOps.h"
+
+// Reads an asset's rct output distribution through
+// BlockchainLMDB::get_block_cumulative_rct_outputs, on a chain whose miner
+// txes pay out in every asset:
+// mode 0: the full distribution from genesis
+// mode 1: the last 1000 blocks, as a refreshing wallet asks for
+template<int mode>
+class test_cumulative_rct_outputs
+{
+public:
+  static const size_t loop_count = mode == 0 ? 100 : 10000;
+  static const uint64_t num_blocks = 50000;
+  static const uint64_t tail_blocks = 1000;
+
+  test_cumulative_rct_outputs(): m_db(NULL), m_hardfork(NULL) {}
+
+  ~test_cumulative_rct_outputs()
+  {
+    if (m_db)
+    {
+      try { m_db->close(); }
+      catch (...) {}
+      delete m_db;
+    }
+    delete m_hardfork;
+    if (!m_path.empty())
+    {
+      boost::system::error_code ec;
+      boost::filesystem::remove_all(m_path, ec);
+    }
+  }
+
+  bool init()
+  {
+    m_path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    if (!boost::filesystem::create_directory(m_path))
+      return false;
+
+    try
+    {
+      m_db = new cryptonote::BlockchainLMDB();
+      m_db->open(m_path.string(), MDB_NOSYNC);
+      m_hardfork = new cryptonote::HardFork(*m_db, 1, 0);
+      m_hardfork->init();
+      m_db->set_hard_fork(m_hardfork);
+
+      static const oracle::asset_id assets[] = {oracle::asset_id::ZEPH, oracle::asset_id::ZEPHUSD, oracle::asset_id::ZEPHRSV};
+      m_db->batch_start(num_blocks);
+      crypto::hash prev_id = crypto::null_hash;
+      for (uint64_t h = 0; h < num_blocks; ++h)
+      {
+        cryptonote::block b = AUTO_VAL_INIT(b);
+        b.major_version = 1;
+        b.minor_version = 0;
+        b.timestamp = h;
+        b.prev_id = prev_id;
+        b.miner_tx.version = 2;
+        b.miner_tx.unlock_time = h + CRYPTONOTE_MINED_MONEY_UNLOCK_WINDOW;
+        b.miner_tx.vin.push_back(cryptonote::txin_gen{h});
+        // a varying number of outputs per asset, so the columns differ
+        for (size_t a = 0; a < sizeof(assets) / sizeof(assets[0]); ++a)
+        {
+          for (uint64_t n = 0; n < 1 + (h + a) % 3; ++n)
+          {
+            cryptonote::tx_out out;
+            out.amount = 1000000;
+            out.target = cryptonote::txout_zephyr_tagged_key(rct::rct2pk(rct::pkGen()), assets[a], crypto::view_tag{});
+            b.miner_tx.vout.push_back(out);
+          }
+        }
+        b.miner_tx.rct_signatures.type = rct::RCTTypeNull;
+
+        cryptonote::db_wtxn_guard guard(m_db);
+        m_db->add_block(std::make_pair(b, cryptonote::block_to_blob(b)), 1, 1, h + 1, 0, 0, {});
+        prev_id = cryptonote::get_block_hash(b);
+      }
+      m_db->batch_stop();
+    }
+    catch (const std::exception &e)
+    {
+      std::cerr << "Failed to set up the database: " << e.what() << std::endl;
+      return false;
+    }
+
+    const uint64_t first = mode == 0 ? 0 : num_blocks - tail_blocks;
+    for (uint64_t h = first; h < num_blocks; ++h)
+      m_heights.push_back(h);
+    return true;
+  }
+
+  bool test()
+  {
+    const std::pair<std::vector<uint64_t>, uint64_t> res = m_db->get_block_cumulative_rct_outputs(m_heights, "ZEPHUSD");
+    return res.first.size() == m_heights.size() && res.first.back() > res.first.front();
+  }
+
+private:
+  boost::filesystem::path m_path;
+  cryptonote::BlockchainLMDB *m_db;
+  cryptonote::HardFork *m_hardfork;
+  std::vector<uint64_t> m_heights;
+};
@@ -28,6 +28,8 @@
 // 
 // Parts of this file are originally copyright (c) 2012-2013 The Cryptonote developers
 
+#define IN_UNIT_TESTS // To access tx_memory_pool::m_input_cache
+
 #include <boost/regex.hpp>
 
 #include "common/util.h"
@@ -37,6 +39,7 @@
 
 // tests
 #include "construct_tx.h"
+#include "construct_tx_pipeline.h"
 #include "check_tx_signature.h"
 #include "check_hash.h"
 #include "cn_slow_hash.h"
@@ -65,6 +68,11 @@
 #include "multiexp.h"
 #include "sig_mlsag.h"
 #include "sig_clsag.h"
+#include "pricing_record_signature.h"
+#include "cumulative_rct_outputs.h"
+#include "block_template_conversions.h"
+#include "pool_snapshot.h"
+#include "reserve_math.h"
 
 namespace po = boost::program_options;
 
@@ -222,6 +230,24 @@ int main(int argc, char** argv)
   TEST_PERFORMANCE1(filter, p, test_cn_fast_hash, 32);
   TEST_PERFORMANCE1(filter, p, test_cn_fast_hash, 16384);
 
+  TEST_PERFORMANCE1(filter, p, test_pricing_record_signature, 0);
+  TEST_PERFORMANCE1(filter, p, test_pricing_record_signature, 1);
+  TEST_PERFORMANCE1(filter, p, test_pricing_record_signature, 2);
+
+  TEST_PERFORMANCE1(filter, p, test_cumulative_rct_outputs, 0);
+  TEST_PERFORMANCE1(filter, p, test_cumulative_rct_outputs, 1);
+
+  TEST_PERFORMANCE1(filter, p, test_block_template_conversions, 0);
+  TEST_PERFORMANCE1(filter, p, test_block_template_conversions, 1);
+  TEST_PERFORMANCE1(filter, p, test_pool_snapshot, 0);
+  TEST_PERFORMANCE1(filter, p, test_pool_snapshot, 1);
+
+  TEST_PERFORMANCE1(filter, p, test_reserve_math, 0);
+  TEST_PERFORMANCE1(filter, p, test_reserve_math, 1);
+
+  TEST_PERFORMANCE1(filter, p, test_construct_tx_pipeline, 0);
+  TEST_PERFORMANCE1(filter, p, test_construct_tx_pipeline, 1);
+
   TEST_PERFORMANCE3(filter, p, test_sig_mlsag, 4, 2, 2); // MLSAG verification
   TEST_PERFORMANCE3(filter, p, test_sig_mlsag, 8, 2, 2);
   TEST_PERFORMANCE3(filter, p, test_sig_mlsag, 16, 2, 2);
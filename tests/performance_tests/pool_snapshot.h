@@ -0,0 +1,152 @@
+// Copyright (c) 2023, Zephyr Protocol
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <cstring>
+#include <memory>
+#include <vector>
+#include <boost/thread/thread.hpp>
+
+#include "cryptonote_basic/cryptonote_format_utils.h"
+#include "cryptonote_core/blockchain.h"
+#include "cryptonote_core/tx_pool.h"
+#include "cryptonote_core/cryptonote_core.h"
+#include "blockchain_db/testdb.h"
+
+// P2P relay running alongside wallets polling the pool, on a tx_memory_pool
+// of 5000 txes backed by an in-memory txpool table. The relay thread marks
+// txes relayed, which writes their metadata under the pool lock.
+// mode 0: readers poll get_transaction_hashes and get_transactions_count
+// mode 1: readers poll get_transactions_and_spent_keys_info
+template<int mode>
+class test_pool_snapshot
+{
+public:
+  static const size_t loop_count = 20;
+  static const size_t pool_size = 5000;
+  static const size_t relayed_txes = 200;
+  static const size_t readers = 4;
+  static const size_t reads_per_reader = mode == 0 ? 200 : 5;
+
+  test_pool_snapshot(): m_txpool(m_bc), m_bc(m_txpool),
+    m_hard_forks{std::make_pair((uint8_t)1, (uint64_t)0), std::make_pair((uint8_t)0, (uint64_t)0)},
+    m_test_options{m_hard_forks, CRYPTONOTE_LONG_TERM_BLOCK_WEIGHT_WINDOW_SIZE}
+  {
+  }
+
+  bool init()
+  {
+    cryptonote::TxpoolTestDB *db = new cryptonote::TxpoolTestDB();
+    if (!m_bc.init(db, cryptonote::FAKECHAIN, true, &m_test_options, 0, NULL))
+      return false;
+
+    for (size_t i = 0; i < pool_size; ++i)
+    {
+      cryptonote::transaction tx;
+      tx.version = 2;
+      tx.unlock_time = 0;
+      cryptonote::txin_zephyr_key in;
+      in.amount = 0;
+      in.asset_type = "ZEPH";
+      in.key_offsets.push_back(1);
+      crypto::cn_fast_hash(&i, sizeof(i), (crypto::hash&)in.k_image);
+      tx.vin.push_back(in);
+      cryptonote::tx_out out;
+      out.amount = 0;
+      out.target = cryptonote::txout_zephyr_tagged_key(crypto::public_key{}, oracle::asset_id::ZEPH, crypto::view_tag{});
+      tx.vout.push_back(out);
+      tx.pricing_record_height = 0;
+      tx.amount_burnt = 0;
+      tx.amount_minted = 0;
+      tx.rct_signatures.type = rct::RCTTypeNull;
+
+      const cryptonote::blobdata blob = cryptonote::t_serializable_object_to_blob(tx);
+      const crypto::hash txid = cryptonote::get_transaction_hash(tx);
+      cryptonote::txpool_tx_meta_t meta{};
+      meta.weight = 1500 + i % 1000;
+      meta.fee = 100000 + i * 7 % 50000;
+      meta.receive_time = time(NULL);
+      meta.last_relayed_time = meta.receive_time;
+      meta.relayed = true;
+      meta.set_relay_method(cryptonote::relay_method::fluff);
+      std::strncpy(meta.fee_asset_type, "ZEPH", sizeof(meta.fee_asset_type));
+      meta.tx_type = (uint8_t)cryptonote::transaction_type::TRANSFER;
+      db->add_txpool_tx(txid, blob, meta);
+      m_txids.push_back(txid);
+    }
+    return m_txpool.init();
+  }
+
+  bool test()
+  {
+    boost::thread_group threads;
+    threads.create_thread([this](){ relay(); });
+    for (size_t i = 0; i < readers; ++i)
+      threads.create_thread([this](){ read(); });
+    threads.join_all();
+    return true;
+  }
+
+private:
+  void relay()
+  {
+    std::vector<bool> just_broadcasted;
+    for (size_t i = 0; i < relayed_txes; ++i)
+    {
+      const crypto::hash &txid = m_txids[(m_next++) % m_txids.size()];
+      m_txpool.set_relayed(epee::span<const crypto::hash>(&txid, 1), cryptonote::relay_method::fluff, just_broadcasted);
+    }
+  }
+
+  void read()
+  {
+    for (size_t i = 0; i < reads_per_reader; ++i)
+    {
+      if (mode == 0)
+      {
+        std::vector<crypto::hash> hashes;
+        m_txpool.get_transaction_hashes(hashes, false);
+        m_txpool.get_transactions_count(false);
+      }
+      else
+      {
+        std::vector<cryptonote::tx_info> tx_infos;
+        std::vector<cryptonote::spent_key_image_info> key_image_infos;
+        m_txpool.get_transactions_and_spent_keys_info(tx_infos, key_image_infos, false);
+      }
+    }
+  }
+
+  cryptonote::tx_memory_pool m_txpool;
+  cryptonote::Blockchain m_bc;
+  const std::pair<uint8_t, uint64_t> m_hard_forks[2];
+  const cryptonote::test_options m_test_options;
+  std::vector<crypto::hash> m_txids;
+  size_t m_next = 0;
+};
@@ -0,0 +1,72 @@
+// Copyright (c) 2023, Zephyr Protocol
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "cryptonote_config.h"
+#include "oracle/pricing_record.h"
+#include "oracle/signature_verifier.h"
+
+// mode 0: parse the key for every check, as verifySignature used to
+// mode 1: shared verifier, no memoization
+// mode 2: shared verifier, memoized
+template<int mode>
+class test_pricing_record_signature
+{
+public:
+  static const size_t loop_count = mode == 2 ? 100000 : 10000;
+
+  bool init()
+  {
+    m_public_key = get_config(cryptonote::network_type::TESTNET).ORACLE_PUBLIC_KEY;
+    m_pr.spot = 2915484310000;
+    m_pr.moving_average = 2924650120000;
+    m_pr.timestamp = 1691040826;
+    const std::string sig = "a4eebd24d684240635f8f0dae4347a87f951ff8220495f6982e4e52359bc1fb8028b11e02e4ddea503b3c175984836e90e4f65599ab2b1fa632ccb4a915a95f9";
+    for (size_t i = 0; i < sizeof(m_pr.signature); ++i)
+      m_pr.signature[i] = (char)strtol(sig.substr(2 * i, 2).c_str(), NULL, 16);
+    m_verifier = &oracle::signature_verifier::get(m_public_key);
+    return m_verifier->verify(m_pr, false);
+  }
+
+  bool test()
+  {
+    if (mode == 0)
+      return oracle::signature_verifier(m_public_key).verify(m_pr, false);
+    return m_verifier->verify(m_pr, mode == 2);
+  }
+
+private:
+  std::string m_public_key;
+  oracle::pricing_record m_pr;
+  const oracle::signature_verifier *m_verifier;
+};
@@ -0,0 +1,102 @@
+// Copyright (c) 2023, Zephyr Protocol
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <vector>
+
+#include "cryptonote_config.h"
+#include "cryptonote_core/reserve_math.h"
+
+// Per block reserve arithmetic: the four pricing record rates the chain
+// checks each block against, and the spot and MA ratio checks of a
+// conversion, over 100 states of the reserve.
+// mode 0: cpp_bin_float_quad
+// mode 1: fixed point
+template<int mode>
+class test_reserve_math
+{
+public:
+  static const size_t loop_count = 1000;
+  static const size_t states = 100;
+
+  struct state
+  {
+    boost::multiprecision::uint128_t zeph_reserve;
+    boost::multiprecision::uint128_t num_stables;
+    boost::multiprecision::uint128_t num_reserves;
+    uint64_t spot;
+    uint64_t moving_average;
+  };
+
+  bool init()
+  {
+    for (size_t i = 0; i < states; ++i)
+    {
+      state s;
+      s.zeph_reserve = boost::multiprecision::uint128_t(2000000 + 1000 * i) * COIN + i * 987654321;
+      s.num_stables = boost::multiprecision::uint128_t(1500000 + 500 * i) * COIN + i * 123456789;
+      s.num_reserves = boost::multiprecision::uint128_t(3000000 + 700 * i) * COIN + i * 192837465;
+      s.spot = 2 * COIN + i * 10000000000;
+      s.moving_average = 2 * COIN + i * 9000000000;
+      m_states.push_back(s);
+    }
+    return true;
+  }
+
+  bool test()
+  {
+    using namespace cryptonote::reserve_math;
+    uint64_t total = 0;
+    for (const state& s: m_states)
+    {
+      if (mode == 0)
+      {
+        total += reserve_coin_price_quad(s.zeph_reserve, s.num_stables, s.num_reserves, s.spot);
+        total += reserve_coin_price_quad(s.zeph_reserve, s.num_stables, s.num_reserves, s.moving_average);
+        total += compare_reserve_ratio_quad(s.zeph_reserve, s.num_stables, s.spot, 1);
+        total += compare_reserve_ratio_quad(s.zeph_reserve, s.num_stables, s.moving_average, 1);
+        total += compare_reserve_ratio_quad(s.zeph_reserve, s.num_stables, s.spot, 4);
+        total += compare_reserve_ratio_quad(s.zeph_reserve, s.num_stables, s.moving_average, 4);
+      }
+      else
+      {
+        total += reserve_coin_price(s.zeph_reserve, s.num_stables, s.num_reserves, s.spot);
+        total += reserve_coin_price(s.zeph_reserve, s.num_stables, s.num_reserves, s.moving_average);
+        total += compare_reserve_ratio(s.zeph_reserve, s.num_stables, s.spot, 1);
+        total += compare_reserve_ratio(s.zeph_reserve, s.num_stables, s.moving_average, 1);
+        total += compare_reserve_ratio(s.zeph_reserve, s.num_stables, s.spot, 4);
+        total += compare_reserve_ratio(s.zeph_reserve, s.num_stables, s.moving_average, 4);
+      }
+    }
+    return total != 0;
+  }
+
+private:
+  std::vector<state> m_states;
+};
@@ -1455,7 +1455,7 @@ tsx_builder * tsx_builder::construct_pending_tx(tools::wallet2::pending_tx &ptx,
 
   auto sources_copy = m_sources;
   auto change_addr = m_from->get_account().get_keys().m_account_address;
-  std::vector<std::pair<std::string, std::string>> circ_amounts;
+  cryptonote::circ_supply_snapshot circ_amounts;
   bool r = construct_tx_and_get_tx_key(m_from->get_account().get_keys(), subaddresses, m_sources, destinations_copy,
                                        change_addr, extra ? extra.get() : std::vector<uint8_t>(), tx, 0, "ZEPH",
                                        "ZEPH", 1, 2, oracle::pricing_record(), circ_amounts, tx_key,
@@ -39,6 +39,7 @@
 #include "blockchain_db/blockchain_db.h"
 #include "blockchain_db/lmdb/db_lmdb.h"
 #include "cryptonote_basic/cryptonote_format_utils.h"
+#include "cryptonote_core/cryptonote_tx_utils.h"
 
 using namespace cryptonote;
 using epee::string_tools::pod_to_hex;
@@ -341,4 +342,272 @@ TYPED_TEST(BlockchainDBTest, RetrieveBlockData)
   ASSERT_HASH_EQ(get_block_hash(this->m_blocks[1].first), hashes[1]);
 }
 
+TYPED_TEST(BlockchainDBTest, PricingRecords)
+{
+  boost::filesystem::path tempPath = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+  std::string dirPath = tempPath.string();
+
+  this->set_prefix(dirPath);
+
+  // make sure open does not throw
+  ASSERT_NO_THROW(this->m_db->open(dirPath));
+  this->get_filenames();
+  this->init_hard_fork();
+
+  db_wtxn_guard guard(this->m_db);
+
+  ASSERT_NO_THROW(this->m_db->add_block(this->m_blocks[0], t_sizes[0], t_sizes[0], t_diffs[0], t_coins[0], 0, this->m_txs[0]));
+  ASSERT_NO_THROW(this->m_db->add_block(this->m_blocks[1], t_sizes[1], t_sizes[1], t_diffs[1], t_coins[1], 0, this->m_txs[1]));
+
+  std::vector<oracle::pricing_record> prs;
+  ASSERT_NO_THROW(prs = this->m_db->get_block_pricing_records(0, 10));
+  ASSERT_EQ(2, prs.size());
+  ASSERT_TRUE(prs[0] == this->m_blocks[0].first.pricing_record);
+  ASSERT_TRUE(prs[1] == this->m_blocks[1].first.pricing_record);
+
+  ASSERT_NO_THROW(prs = this->m_db->get_block_pricing_records(1, 1));
+  ASSERT_EQ(1, prs.size());
+  ASSERT_TRUE(prs[0] == this->m_blocks[1].first.pricing_record);
+
+  ASSERT_THROW(this->m_db->get_block_pricing_records(2, 1), DB_ERROR);
+}
+
+TYPED_TEST(BlockchainDBTest, ReserveHistory)
+{
+  boost::filesystem::path tempPath = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+  std::string dirPath = tempPath.string();
+
+  this->set_prefix(dirPath);
+
+  // make sure open does not throw
+  ASSERT_NO_THROW(this->m_db->open(dirPath));
+  this->get_filenames();
+  this->init_hard_fork();
+
+  db_wtxn_guard guard(this->m_db);
+
+  ASSERT_NO_THROW(this->m_db->add_block(this->m_blocks[0], t_sizes[0], t_sizes[0], t_diffs[0], t_coins[0], 1000, this->m_txs[0]));
+  ASSERT_NO_THROW(this->m_db->add_block(this->m_blocks[1], t_sizes[1], t_sizes[1], t_diffs[1], t_coins[1], 2500, this->m_txs[1]));
+
+  std::vector<reserve_history_entry> history;
+  ASSERT_NO_THROW(history = this->m_db->get_reserve_history(0, 1, 1));
+  ASSERT_EQ(2, history.size());
+  ASSERT_EQ(0, history[0].height);
+  ASSERT_EQ(1, history[1].height);
+  ASSERT_EQ(1000, history[0].zeph_reserve);
+  ASSERT_EQ(3500, history[1].zeph_reserve);
+  ASSERT_EQ(this->m_blocks[1].first.pricing_record.spot, history[1].spot);
+  ASSERT_EQ(this->m_blocks[1].first.pricing_record.moving_average, history[1].moving_average);
+
+  // the last entry is the state the running tallies are in
+  circ_supply_snapshot supply;
+  ASSERT_NO_THROW(supply = this->m_db->get_circulating_supply());
+  ASSERT_EQ(supply.zeph_reserve(), history[1].zeph_reserve);
+  ASSERT_EQ(supply.num_stables(), history[1].num_stables);
+  ASSERT_EQ(supply.num_reserves(), history[1].num_reserves);
+
+  // end height is clamped to the top block, and stride skips entries
+  ASSERT_NO_THROW(history = this->m_db->get_reserve_history(0, 100, 2));
+  ASSERT_EQ(1, history.size());
+  ASSERT_EQ(0, history[0].height);
+
+  ASSERT_NO_THROW(history = this->m_db->get_reserve_history(2, 3, 1));
+  ASSERT_TRUE(history.empty());
+
+  block popped;
+  std::vector<transaction> popped_txs;
+  ASSERT_NO_THROW(this->m_db->pop_block(popped, popped_txs));
+  ASSERT_NO_THROW(history = this->m_db->get_reserve_history(0, 1, 1));
+  ASSERT_EQ(1, history.size());
+  ASSERT_EQ(0, history[0].height);
+  ASSERT_EQ(1000, history[0].zeph_reserve);
+}
+
+TYPED_TEST(BlockchainDBTest, CumulativeRctOutputs)
+{
+  boost::filesystem::path tempPath = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+  std::string dirPath = tempPath.string();
+
+  this->set_prefix(dirPath);
+
+  // make sure open does not throw
+  ASSERT_NO_THROW(this->m_db->open(dirPath));
+  this->get_filenames();
+  this->init_hard_fork();
+
+  db_wtxn_guard guard(this->m_db);
+
+  ASSERT_NO_THROW(this->m_db->add_block(this->m_blocks[0], t_sizes[0], t_sizes[0], t_diffs[0], t_coins[0], 0, this->m_txs[0]));
+  ASSERT_NO_THROW(this->m_db->add_block(this->m_blocks[1], t_sizes[1], t_sizes[1], t_diffs[1], t_coins[1], 0, this->m_txs[1]));
+
+  std::pair<std::vector<uint64_t>, uint64_t> outputs;
+  for (const auto &asset_type: oracle::ASSET_TYPES)
+  {
+    ASSERT_NO_THROW(outputs = this->m_db->get_block_cumulative_rct_outputs({0, 1}, asset_type));
+    ASSERT_EQ(2, outputs.first.size());
+    ASSERT_LE(outputs.first[0], outputs.first[1]);
+    ASSERT_NO_THROW(outputs = this->m_db->get_block_cumulative_rct_outputs({1}, asset_type));
+    ASSERT_EQ(1, outputs.first.size());
+  }
+
+  ASSERT_NO_THROW(outputs = this->m_db->get_block_cumulative_rct_outputs({0, 1}, "XHV"));
+  ASSERT_EQ(std::vector<uint64_t>({0, 0}), outputs.first);
+
+  block popped;
+  std::vector<transaction> popped_txs;
+  ASSERT_NO_THROW(this->m_db->pop_block(popped, popped_txs));
+  ASSERT_NO_THROW(outputs = this->m_db->get_block_cumulative_rct_outputs({0}, "ZEPH"));
+  ASSERT_EQ(1, outputs.first.size());
+  ASSERT_THROW(this->m_db->get_block_cumulative_rct_outputs({1}, "ZEPH"), BLOCK_DNE);
+
+  // the block can be added back, the columns were rolled back with it
+  ASSERT_NO_THROW(this->m_db->add_block(this->m_blocks[1], t_sizes[1], t_sizes[1], t_diffs[1], t_coins[1], 0, this->m_txs[1]));
+  ASSERT_NO_THROW(outputs = this->m_db->get_block_cumulative_rct_outputs({0, 1}, "ZEPH"));
+  ASSERT_EQ(2, outputs.first.size());
+}
+
+// Builds a chain whose blocks past genesis pay a reserve reward, then turns
+// the db back into a version 2 one without reserve history, so the next
+// open runs migrate_2_3 over it.
+void make_version_2_chain(const std::string& dir, uint64_t num_blocks, std::vector<reserve_history_entry>& history, circ_supply_snapshot& supply)
+{
+  BlockchainLMDB db;
+  db.open(dir);
+  HardFork hardfork(db, 1, 0);
+  hardfork.init();
+  db.set_hard_fork(&hardfork);
+
+  crypto::hash prev_id = crypto::null_hash;
+  uint64_t coins = 0;
+  for (uint64_t h = 0; h < num_blocks; ++h)
+  {
+    block b = AUTO_VAL_INIT(b);
+    b.major_version = h ? HF_VERSION_DJED : 1;
+    b.timestamp = h;
+    b.prev_id = prev_id;
+    b.pricing_record.spot = h ? 1000000000000 + h : 0;
+    b.pricing_record.moving_average = h ? 900000000000 + h : 0;
+    b.miner_tx.version = 2;
+    b.miner_tx.unlock_time = h + CRYPTONOTE_MINED_MONEY_UNLOCK_WINDOW;
+    b.miner_tx.vin.push_back(txin_gen{h});
+    b.miner_tx.rct_signatures.type = rct::RCTTypeNull;
+
+    // rewards which no emission curve gives, as a penalized block would pay
+    const uint64_t reward = 3000000000000 - h * 123457;
+    coins += reward;
+    const uint64_t reserve_reward = b.major_version >= HF_VERSION_DJED ? get_reserve_reward(reward) : 0;
+
+    db_wtxn_guard guard(&db);
+    db.add_block(std::make_pair(b, block_to_blob(b)), 1, 1, h + 1, coins, reserve_reward, {});
+    prev_id = get_block_hash(b);
+  }
+  history = db.get_reserve_history(0, num_blocks - 1, 1);
+  supply = db.get_circulating_supply();
+  db.close();
+
+  MDB_env *env;
+  MDB_txn *txn;
+  MDB_dbi properties, reserve_history;
+  uint32_t version = 2;
+  MDB_val k = {sizeof("version"), (void *)"version"};
+  MDB_val v = {sizeof(version), (void *)&version};
+  CHECK_AND_ASSERT_THROW_MES(!mdb_env_create(&env), "Failed to create lmdb environment");
+  CHECK_AND_ASSERT_THROW_MES(!mdb_env_set_maxdbs(env, 32), "Failed to set max dbs");
+  CHECK_AND_ASSERT_THROW_MES(!mdb_env_open(env, dir.c_str(), 0, 0644), "Failed to open lmdb environment");
+  CHECK_AND_ASSERT_THROW_MES(!mdb_txn_begin(env, NULL, 0, &txn), "Failed to begin txn");
+  CHECK_AND_ASSERT_THROW_MES(!mdb_dbi_open(txn, "properties", 0, &properties), "Failed to open properties");
+  CHECK_AND_ASSERT_THROW_MES(!mdb_put(txn, properties, &k, &v, 0), "Failed to set version");
+  CHECK_AND_ASSERT_THROW_MES(!mdb_dbi_open(txn, "reserve_history", MDB_INTEGERKEY | MDB_DUPSORT | MDB_DUPFIXED, &reserve_history), "Failed to open reserve_history");
+  CHECK_AND_ASSERT_THROW_MES(!mdb_drop(txn, reserve_history, 0), "Failed to empty reserve_history");
+  CHECK_AND_ASSERT_THROW_MES(!mdb_txn_commit(txn), "Failed to commit txn");
+  mdb_env_close(env);
+}
+
+TEST(BlockchainLMDBMigration, ReserveHistory)
+{
+  const std::string dir = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string();
+  std::vector<reserve_history_entry> live;
+  circ_supply_snapshot supply;
+  ASSERT_NO_THROW(make_version_2_chain(dir, 20, live, supply));
+  ASSERT_EQ(20, live.size());
+  ASSERT_NE(0, supply.zeph_reserve());
+
+  std::vector<reserve_history_entry> migrated;
+  circ_supply_snapshot migrated_supply;
+  {
+    BlockchainLMDB db;
+    ASSERT_NO_THROW(db.open(dir));
+    ASSERT_NO_THROW(migrated = db.get_reserve_history(0, 19, 1));
+    ASSERT_NO_THROW(migrated_supply = db.get_circulating_supply());
+    db.close();
+  }
+  boost::filesystem::remove_all(dir);
+
+  ASSERT_EQ(live.size(), migrated.size());
+  for (size_t i = 0; i < live.size(); ++i)
+  {
+    ASSERT_EQ(live[i].height, migrated[i].height);
+    ASSERT_EQ(live[i].zeph_reserve, migrated[i].zeph_reserve);
+    ASSERT_EQ(live[i].num_stables, migrated[i].num_stables);
+    ASSERT_EQ(live[i].num_reserves, migrated[i].num_reserves);
+    ASSERT_EQ(live[i].spot, migrated[i].spot);
+    ASSERT_EQ(live[i].moving_average, migrated[i].moving_average);
+  }
+  ASSERT_EQ(supply.tally, migrated_supply.tally);
+  ASSERT_EQ(supply.zeph_reserve(), migrated.back().zeph_reserve);
+}
+
+TEST(BlockchainLMDBMigration, ReserveHistoryMismatch)
+{
+  const std::string dir = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string();
+  std::vector<reserve_history_entry> live;
+  circ_supply_snapshot supply;
+  ASSERT_NO_THROW(make_version_2_chain(dir, 20, live, supply));
+
+  // lose the ZEPH tally, so the replayed reserve rewards cannot match it
+  {
+    MDB_env *env;
+    MDB_txn *txn;
+    MDB_dbi circ_supply_tally;
+    uint64_t zeph = circ_supply_snapshot::ZEPH;
+    MDB_val k = {sizeof(zeph), (void *)&zeph};
+    ASSERT_EQ(0, mdb_env_create(&env));
+    ASSERT_EQ(0, mdb_env_set_maxdbs(env, 32));
+    ASSERT_EQ(0, mdb_env_open(env, dir.c_str(), 0, 0644));
+    ASSERT_EQ(0, mdb_txn_begin(env, NULL, 0, &txn));
+    ASSERT_EQ(0, mdb_dbi_open(txn, "circ_supply_tally", 0, &circ_supply_tally));
+    ASSERT_EQ(0, mdb_del(txn, circ_supply_tally, &k, NULL));
+    ASSERT_EQ(0, mdb_txn_commit(txn));
+    mdb_env_close(env);
+  }
+
+  {
+    BlockchainLMDB db;
+    ASSERT_THROW(db.open(dir), DB_ERROR);
+  }
+
+  // the version was not bumped and no partial history was kept
+  MDB_env *env;
+  MDB_txn *txn;
+  MDB_dbi properties, reserve_history;
+  MDB_val k = {sizeof("version"), (void *)"version"};
+  MDB_val v;
+  MDB_stat stats;
+  ASSERT_EQ(0, mdb_env_create(&env));
+  ASSERT_EQ(0, mdb_env_set_maxdbs(env, 32));
+  ASSERT_EQ(0, mdb_env_open(env, dir.c_str(), MDB_RDONLY, 0644));
+  ASSERT_EQ(0, mdb_txn_begin(env, NULL, MDB_RDONLY, &txn));
+  ASSERT_EQ(0, mdb_dbi_open(txn, "properties", 0, &properties));
+  ASSERT_EQ(0, mdb_get(txn, properties, &k, &v));
+  const uint32_t version = *(const uint32_t*)v.mv_data;
+  ASSERT_EQ(0, mdb_dbi_open(txn, "reserve_history", 0, &reserve_history));
+  ASSERT_EQ(0, mdb_stat(txn, reserve_history, &stats));
+  mdb_txn_abort(txn);
+  mdb_env_close(env);
+  boost::filesystem::remove_all(dir);
+
+  ASSERT_EQ(2, version);
+  ASSERT_EQ(0, stats.ms_entries);
+}
+
 }  // anonymous namespace
@@ -134,7 +134,7 @@ TEST(bulletproofs, valid_multi_random)
 //     rct::RCTConfig rct_config { rct::RangeProofPaddedBulletproof, 4 };
 
 //     const cryptonote::transaction_type tx_type = cryptonote::transaction_type::TRANSFER;
-//     std::vector<std::pair<std::string, std::string>> circ_amounts;
+//     cryptonote::circ_supply_snapshot circ_amounts;
 //     std::map<size_t, std::string> outamounts_features;
 //     rct::rctSig s = rct::genRctSimple(rct::zero(), sc, destinations, tx_type, "ZEPH", oracle::pricing_record(), circ_amounts, inamounts, outamounts, outamounts_features, available, mixRing, amount_keys, index, outSk, rct_config, hw::get_device("default"));
 //     ASSERT_TRUE(rct::verRctSimple(s));
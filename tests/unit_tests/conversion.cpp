@@ -36,10 +36,10 @@
 using tt = cryptonote::transaction_type;
 
 #define INIT_PR(pr) \
-    std::vector<std::pair<std::string, std::string>> circ_amounts; \
-    circ_amounts.push_back(std::make_pair("ZEPH",    "1000000000000000")); /* 1000 * 10^12 */ \
-    circ_amounts.push_back(std::make_pair("ZEPHUSD", "1000000000000000")); /* 1000 * 10^12 */ \
-    circ_amounts.push_back(std::make_pair("ZEPHRSV", "1000000000000000")); /* 1000 * 10^12 */ \
+    cryptonote::circ_supply_snapshot circ_amounts; \
+    circ_amounts.tally[cryptonote::circ_supply_snapshot::ZEPH] = 1000000000000000; /* 1000 * 10^12 */ \
+    circ_amounts.tally[cryptonote::circ_supply_snapshot::ZEPHUSD] = 1000000000000000; /* 1000 * 10^12 */ \
+    circ_amounts.tally[cryptonote::circ_supply_snapshot::ZEPHRSV] = 1000000000000000; /* 1000 * 10^12 */ \
     pr.spot = 20ull * COIN; \
     pr.moving_average = 15ull * COIN; \
     pr.stable = cryptonote::get_stable_coin_price(circ_amounts, pr.spot); \
@@ -76,10 +76,10 @@ TEST(get_stable_coin_price, get_stable_coin_price_zero_with_zero_rate)
 }
 TEST(get_stable_coin_price, get_stable_coin_price_zero_on_overflow)
 {
-    std::vector<std::pair<std::string, std::string>> circ_amounts;
-    circ_amounts.push_back(std::make_pair("ZEPH",    "1000000000000000")); // 1000
-    circ_amounts.push_back(std::make_pair("ZEPHUSD", "0"));
-    circ_amounts.push_back(std::make_pair("ZEPHRSV", "1000000000000000")); // 1000
+    cryptonote::circ_supply_snapshot circ_amounts;
+    circ_amounts.tally[cryptonote::circ_supply_snapshot::ZEPH] = 1000000000000000; // 1000
+    circ_amounts.tally[cryptonote::circ_supply_snapshot::ZEPHUSD] = 0;
+    circ_amounts.tally[cryptonote::circ_supply_snapshot::ZEPHRSV] = 1000000000000000; // 1000
     oracle::pricing_record pr;
     pr.spot = 1;
     pr.moving_average = 1;
@@ -123,11 +123,11 @@ TEST(get_reserve_coin_price, get_reserve_coin_price_zero_with_zero_rate)
 
 TEST(get_reserve_coin_price, get_reserve_coin_price_zero_on_overflow)
 {
-    std::vector<std::pair<std::string, std::string>> circ_amounts;
+    cryptonote::circ_supply_snapshot circ_amounts;
     oracle::pricing_record pr;
-    circ_amounts.push_back(std::make_pair("ZEPH",    "1000000000000000")); // 1000
-    circ_amounts.push_back(std::make_pair("ZEPHUSD", "1000000000000000")); // 1000
-    circ_amounts.push_back(std::make_pair("ZEPHRSV", "1000000")); // 0.000001
+    circ_amounts.tally[cryptonote::circ_supply_snapshot::ZEPH] = 1000000000000000; // 1000
+    circ_amounts.tally[cryptonote::circ_supply_snapshot::ZEPHUSD] = 1000000000000000; // 1000
+    circ_amounts.tally[cryptonote::circ_supply_snapshot::ZEPHRSV] = 1000000; // 0.000001
     pr.spot = 1000000ull * COIN;
     pr.moving_average = 1000000ull * COIN;
     pr.reserve = cryptonote::get_reserve_coin_price(circ_amounts, pr.spot);
@@ -139,11 +139,11 @@ TEST(get_reserve_coin_price, get_reserve_coin_price_zero_on_overflow)
 
 TEST(get_reserve_coin_price, get_reserve_coin_price_uses_price_r_min_if_no_reserves_issued)
 {
-    std::vector<std::pair<std::string, std::string>> circ_amounts;
+    cryptonote::circ_supply_snapshot circ_amounts;
     oracle::pricing_record pr;
-    circ_amounts.push_back(std::make_pair("ZEPH",    "1000000000000000")); // 1000
-    circ_amounts.push_back(std::make_pair("ZEPHUSD", "1000000000000000")); // 1000
-    circ_amounts.push_back(std::make_pair("ZEPHRSV", "0"));
+    circ_amounts.tally[cryptonote::circ_supply_snapshot::ZEPH] = 1000000000000000; // 1000
+    circ_amounts.tally[cryptonote::circ_supply_snapshot::ZEPHUSD] = 1000000000000000; // 1000
+    circ_amounts.tally[cryptonote::circ_supply_snapshot::ZEPHRSV] = 0;
     pr.spot = 20ull * COIN;
     pr.moving_average = 15ull * COIN;
     pr.reserve = cryptonote::get_reserve_coin_price(circ_amounts, pr.spot);
@@ -156,11 +156,11 @@ TEST(get_reserve_coin_price, get_reserve_coin_price_uses_price_r_min_if_no_reser
 
 TEST(get_reserve_coin_price, get_reserve_coin_price_uses_price_r_min_if_zero_equity)
 {
-    std::vector<std::pair<std::string, std::string>> circ_amounts;
+    cryptonote::circ_supply_snapshot circ_amounts;
     oracle::pricing_record pr;
-    circ_amounts.push_back(std::make_pair("ZEPH",     "500000000000000")); // 500
-    circ_amounts.push_back(std::make_pair("ZEPHUSD", "1000000000000000")); // 1000
-    circ_amounts.push_back(std::make_pair("ZEPHRSV", "1000000000000000")); // 1000
+    circ_amounts.tally[cryptonote::circ_supply_snapshot::ZEPH] = 500000000000000; // 500
+    circ_amounts.tally[cryptonote::circ_supply_snapshot::ZEPHUSD] = 1000000000000000; // 1000
+    circ_amounts.tally[cryptonote::circ_supply_snapshot::ZEPHRSV] = 1000000000000000; // 1000
     pr.spot = 1 * COIN;
     pr.moving_average = 1 * COIN;
     pr.reserve = cryptonote::get_reserve_coin_price(circ_amounts, pr.spot);
@@ -173,13 +173,13 @@ TEST(get_reserve_coin_price, get_reserve_coin_price_uses_price_r_min_if_zero_equ
 
 TEST(get_reserve_coin_price, get_reserve_coin_price_uses_price_r_min_at_lowest)
 {
-    std::vector<std::pair<std::string, std::string>> circ_amounts;
+    cryptonote::circ_supply_snapshot circ_amounts;
     oracle::pricing_record pr;
 
     // $1000 equity | 10000 rsv coins issued creates a rsv coin price of 0.10 (lower than price_r_min)
-    circ_amounts.push_back(std::make_pair("ZEPH",    "10000000000000000")); // 10000
-    circ_amounts.push_back(std::make_pair("ZEPHUSD",  "9000000000000000")); // 9000
-    circ_amounts.push_back(std::make_pair("ZEPHRSV", "10000000000000000")); // 10000
+    circ_amounts.tally[cryptonote::circ_supply_snapshot::ZEPH] = 10000000000000000; // 10000
+    circ_amounts.tally[cryptonote::circ_supply_snapshot::ZEPHUSD] = 9000000000000000; // 9000
+    circ_amounts.tally[cryptonote::circ_supply_snapshot::ZEPHRSV] = 10000000000000000; // 10000
     pr.spot = 1 * COIN;
     pr.moving_average = 1 * COIN;
     pr.reserve = cryptonote::get_reserve_coin_price(circ_amounts, pr.spot);
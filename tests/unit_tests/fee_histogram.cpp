@@ -0,0 +1,86 @@
+// Copyright (c) 2023, Zephyr Protocol
+// Portions copyright (c) 2016-2019, The Monero Project
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "gtest/gtest.h"
+#include "cryptonote_core/fee_histogram.h"
+
+namespace
+{
+  crypto::hash make_txid(uint8_t n)
+  {
+    crypto::hash h = crypto::null_hash;
+    h.data[0] = n;
+    return h;
+  }
+}
+
+TEST(fee_histogram, bucket_index)
+{
+  using cryptonote::fee_histogram;
+  ASSERT_EQ(fee_histogram::get_bucket_index(0, 1000), 0u);
+  ASSERT_EQ(fee_histogram::get_bucket_index(999, 1000), 0u);
+  ASSERT_EQ(fee_histogram::get_bucket_index(1000, 1000), 1u);
+  ASSERT_EQ(fee_histogram::get_bucket_index(2000, 1000), 1u + fee_histogram::BUCKETS_PER_DOUBLING);
+  for (uint64_t fee_per_byte: {1, 3, 20, 1000, 20000, 123456789})
+  {
+    const uint32_t index = fee_histogram::get_bucket_index(fee_per_byte * 1500, 1500);
+    ASSERT_LE(fee_histogram::get_bucket_min_fee_per_byte(index), fee_per_byte);
+    ASSERT_LT(fee_per_byte, fee_histogram::get_bucket_min_fee_per_byte(index + 1) + 1);
+  }
+}
+
+TEST(fee_histogram, add_remove)
+{
+  cryptonote::fee_histogram histogram;
+  const uint32_t index = cryptonote::fee_histogram::get_bucket_index(20000, 1000);
+  histogram.add(make_txid(1), "ZEPH", 20000, 1000, true);
+  histogram.add(make_txid(2), "ZEPH", 21000, 1000, false);
+  histogram.add(make_txid(3), "ZEPHUSD", 20000, 1000, true);
+
+  auto all = histogram.get(true);
+  ASSERT_EQ(all.size(), 2u);
+  ASSERT_EQ(all["ZEPH"][index].txs, 2u);
+  ASSERT_EQ(all["ZEPH"][index].weight, 2000u);
+  ASSERT_EQ(all["ZEPH"][index].fee, 41000u);
+
+  auto broadcasted = histogram.get(false);
+  ASSERT_EQ(broadcasted["ZEPH"][index].txs, 1u);
+
+  // re-adding updates rather than double counts
+  histogram.add(make_txid(2), "ZEPH", 21000, 1000, true);
+  ASSERT_EQ(histogram.get(true)["ZEPH"][index].txs, 2u);
+  ASSERT_EQ(histogram.get(false)["ZEPH"][index].txs, 2u);
+
+  histogram.remove(make_txid(1));
+  histogram.remove(make_txid(2));
+  histogram.remove(make_txid(2));
+  all = histogram.get(true);
+  ASSERT_EQ(all.size(), 1u);
+  ASSERT_EQ(all.count("ZEPH"), 0u);
+}
@@ -46,7 +46,7 @@
         cryptonote::tx_out out; \
         cryptonote::tx_out out1; \
         cryptonote::txout_zephyr_tagged_key out_key; \
-        out_key.asset_type = #asset_type1; \
+        out_key.asset_type = oracle::get_asset_id(#asset_type1); \
         out.target = out_key; \
         out1.target = out_key; \
         \
@@ -75,8 +75,8 @@
         cryptonote::tx_out out1; \
         cryptonote::txout_zephyr_tagged_key out_key; \
         cryptonote::txout_zephyr_tagged_key out_key_change; \
-        out_key.asset_type = #asset_type2; \
-        out_key_change.asset_type = #asset_type1; \
+        out_key.asset_type = oracle::get_asset_id(#asset_type2); \
+        out_key_change.asset_type = oracle::get_asset_id(#asset_type1); \
         out.target = out_key; \
         out1.target = out_key_change; \
         \
@@ -117,8 +117,8 @@ TEST(get_tx_asset_types, fail_on_multiple_input_types_2_or_more)
     cryptonote::tx_out out1;
     cryptonote::txout_zephyr_tagged_key out_key1;
     cryptonote::txout_zephyr_tagged_key out_key2;
-    out_key1.asset_type = "ZEPH";
-    out_key2.asset_type = "ZEPHUSD";
+    out_key1.asset_type = oracle::get_asset_id("ZEPH");
+    out_key2.asset_type = oracle::get_asset_id("ZEPHUSD");
     out.target = out_key1;
     out1.target = out_key2;
 
@@ -142,9 +142,9 @@ TEST(get_tx_asset_types, fail_more_than_2_output_types)
     cryptonote::txout_zephyr_tagged_key out_key1;
     cryptonote::txout_zephyr_tagged_key out_key2;
     cryptonote::txout_zephyr_tagged_key out_key3;
-    out_key1.asset_type = "ZEPHUSD";
-    out_key2.asset_type = "ZEPHRSV";
-    out_key3.asset_type = "ZEPH";
+    out_key1.asset_type = oracle::get_asset_id("ZEPHUSD");
+    out_key2.asset_type = oracle::get_asset_id("ZEPHRSV");
+    out_key3.asset_type = oracle::get_asset_id("ZEPH");
 
     cryptonote::tx_out out;
     cryptonote::tx_out out1;
@@ -173,8 +173,8 @@ TEST(get_tx_asset_types, fail_single_input_single_output_types_are_not_equal)
 
     cryptonote::txout_zephyr_tagged_key out_key1;
     cryptonote::txout_zephyr_tagged_key out_key2;
-    out_key1.asset_type = "ZEPHUSD";
-    out_key2.asset_type = "ZEPHUSD";
+    out_key1.asset_type = oracle::get_asset_id("ZEPHUSD");
+    out_key2.asset_type = oracle::get_asset_id("ZEPHUSD");
 
     cryptonote::tx_out out;
     cryptonote::tx_out out1;
@@ -200,8 +200,8 @@ TEST(get_tx_asset_types, none_of_output_matches_input)
 
     cryptonote::txout_zephyr_tagged_key out_key1;
     cryptonote::txout_zephyr_tagged_key out_key2;
-    out_key1.asset_type = "ZEPHUSD";
-    out_key2.asset_type = "ZEPHRSV";
+    out_key1.asset_type = oracle::get_asset_id("ZEPHUSD");
+    out_key2.asset_type = oracle::get_asset_id("ZEPHRSV");
 
     cryptonote::tx_out out;
     cryptonote::tx_out out1;
@@ -228,8 +228,8 @@ TEST(get_tx_asset_types, successful_on_logical_input_output_but_not_allowed)
 
     cryptonote::txout_zephyr_tagged_key out_key1;
     cryptonote::txout_zephyr_tagged_key out_key2;
-    out_key1.asset_type = "ZEPHRSV";
-    out_key2.asset_type = "ZEPHUSD";
+    out_key1.asset_type = oracle::get_asset_id("ZEPHRSV");
+    out_key2.asset_type = oracle::get_asset_id("ZEPHUSD");
 
     cryptonote::tx_out out;
     cryptonote::tx_out out1;
@@ -262,8 +262,8 @@ TEST(get_tx_asset_types, fail_on_single_input_output_zephusd_zephrsv)
     cryptonote::tx_out out1;
     cryptonote::txout_zephyr_tagged_key out_key1;
     cryptonote::txout_zephyr_tagged_key out_key2;
-    out_key1.asset_type = "ZEPHRSV";
-    out_key2.asset_type = "ZEPHRSV";
+    out_key1.asset_type = oracle::get_asset_id("ZEPHRSV");
+    out_key2.asset_type = oracle::get_asset_id("ZEPHRSV");
     out.target = out_key1;
     out1.target = out_key2;
 
@@ -291,8 +291,8 @@ TEST(get_tx_asset_types, fail_on_unknown_asset_type)
     cryptonote::tx_out out1;
     cryptonote::txout_zephyr_tagged_key out_key1;
     cryptonote::txout_zephyr_tagged_key out_key2;
-    out_key1.asset_type = "ZEPHEUR";
-    out_key2.asset_type = "ZEPHEUR";
+    out_key1.asset_type = oracle::get_asset_id("ZEPHEUR");
+    out_key2.asset_type = oracle::get_asset_id("ZEPHEUR");
     out.target = out_key1;
     out1.target = out_key2;
 
@@ -320,8 +320,8 @@ TEST(get_tx_asset_types, fail_on_2_unknown_asset_types_and_multiple_outs)
     cryptonote::tx_out out1;
     cryptonote::txout_zephyr_tagged_key out_key1;
     cryptonote::txout_zephyr_tagged_key out_key2;
-    out_key1.asset_type = "ZEPHEUR";
-    out_key2.asset_type = "ZEPHGBP";
+    out_key1.asset_type = oracle::get_asset_id("ZEPHEUR");
+    out_key2.asset_type = oracle::get_asset_id("ZEPHGBP");
     out.target = out_key1;
     out1.target = out_key2;
 
@@ -349,8 +349,8 @@ TEST(get_tx_asset_types, fail_on_1_unknown_asset_type)
     cryptonote::tx_out out1;
     cryptonote::txout_zephyr_tagged_key out_key1;
     cryptonote::txout_zephyr_tagged_key out_key2;
-    out_key1.asset_type = "ZEPH";
-    out_key2.asset_type = "ZEPHGBP";
+    out_key1.asset_type = oracle::get_asset_id("ZEPH");
+    out_key2.asset_type = oracle::get_asset_id("ZEPHGBP");
     out.target = out_key1;
     out1.target = out_key2;
 
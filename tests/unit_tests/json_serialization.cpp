@@ -78,7 +78,7 @@
 
 //         std::unordered_map<crypto::public_key, cryptonote::subaddress_index> subaddresses;
 //         subaddresses[from.m_account_address.m_spend_public_key] = {0,0};
-//         std::vector<std::pair<std::string, std::string>> circ_amounts;
+//         cryptonote::circ_supply_snapshot circ_amounts;
 //         if (!cryptonote::construct_tx_and_get_tx_key(from, subaddresses, actual_sources, to, boost::none, {}, tx, "ZEPH", "ZEPH", 1, 2, oracle::pricing_record(), circ_amounts, 0, tx_key, extra_keys, rct, { bulletproof ? rct::RangeProofBulletproof : rct::RangeProofBorromean, bulletproof ? 2 : 0 }))
 //             throw std::runtime_error{"transaction construction error"};
 
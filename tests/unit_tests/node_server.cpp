@@ -419,7 +419,7 @@ TEST(cryptonote_protocol_handler, race_condition)
       reward,
       hardfork
     );
-    block.miner_tx.vout.push_back(cryptonote::tx_out{reward, cryptonote::txout_zephyr_tagged_key{}});
+    block.miner_tx.vout.push_back(cryptonote::tx_out{reward, cryptonote::txout_zephyr_tagged_key{crypto::public_key{}, oracle::asset_id::ZEPH, crypto::view_tag{}}});
     diff = storage.get_difficulty_for_next_block();
   };
   struct stat {
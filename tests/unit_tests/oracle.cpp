@@ -29,7 +29,9 @@
 // THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "gtest/gtest.h"
+#include "oracle/asset_types.h"
 #include "oracle/pricing_record.h"
+#include "oracle/signature_verifier.h"
 
 TEST(oracle, empty_pricing_record_valid)
 {
@@ -137,3 +139,61 @@ TEST(oracle, pricing_record_missing_values_invalid)
   EXPECT_FALSE(pr.valid(cryptonote::network_type::TESTNET, 3, 1691041762, 1691040762));
 }
 
+
+TEST(oracle, signature_message_format)
+{
+  oracle::pricing_record pr;
+  pr.spot = 2915484310000;
+  pr.moving_average = 2924650120000;
+  pr.timestamp = 1691040826;
+  char buf[oracle::signature_verifier::MESSAGE_BUFFER_SIZE];
+  const size_t len = oracle::signature_verifier::build_message(pr, buf, sizeof(buf));
+  EXPECT_EQ(std::string(buf, len), "{\"spot\":2915484310000,\"moving_average\":2924650120000,\"timestamp\":1691040826}");
+}
+
+TEST(oracle, cached_signature_verification)
+{
+  oracle::pricing_record pr;
+  pr.spot = 2915484310000;
+  pr.moving_average = 2924650120000;
+  pr.timestamp = 1691040826;
+  std::string sig = "a4eebd24d684240635f8f0dae4347a87f951ff8220495f6982e4e52359bc1fb8028b11e02e4ddea503b3c175984836e90e4f65599ab2b1fa632ccb4a915a95f9";
+  int j=0;
+  for (unsigned int i = 0; i < sig.size(); i += 2) {
+    std::string byteString = sig.substr(i, 2);
+    pr.signature[j++] = (char) strtol(byteString.c_str(), NULL, 16);
+  }
+
+  const oracle::signature_verifier &verifier = oracle::signature_verifier::get(get_config(cryptonote::network_type::TESTNET).ORACLE_PUBLIC_KEY);
+  EXPECT_TRUE(verifier.verify(pr));
+  EXPECT_TRUE(verifier.verify(pr));
+
+  // a cached record must not vouch for a modified one
+  pr.spot += 1;
+  EXPECT_FALSE(verifier.verify(pr));
+  EXPECT_FALSE(verifier.verify(pr, false));
+}
+
+TEST(oracle, asset_ids)
+{
+  ASSERT_EQ(oracle::ASSET_TYPES.size(), oracle::NUM_ASSET_TYPES);
+  for (size_t i = 0; i < oracle::NUM_ASSET_TYPES; ++i)
+  {
+    const oracle::asset_id id = oracle::get_asset_id(oracle::ASSET_TYPES[i]);
+    ASSERT_TRUE(oracle::is_valid_asset_id(id));
+    EXPECT_EQ(static_cast<size_t>(id), i);
+    EXPECT_EQ(oracle::get_asset_type(id), oracle::ASSET_TYPES[i]);
+  }
+  EXPECT_FALSE(oracle::is_valid_asset_id(oracle::get_asset_id("")));
+  EXPECT_FALSE(oracle::is_valid_asset_id(oracle::get_asset_id("XHV")));
+
+  oracle::asset_type_counts counts;
+  counts.add(oracle::asset_id::ZEPHUSD, 5);
+  counts.add("ZEPHUSD", 2);
+  counts.add("XHV", 7);
+  EXPECT_EQ(counts.ZEPHUSD, 7);
+  EXPECT_EQ(counts[oracle::asset_id::ZEPHUSD], 7);
+  EXPECT_EQ(counts["ZEPHUSD"], 7);
+  EXPECT_EQ(counts[oracle::asset_id::ZEPH], 0);
+  EXPECT_EQ(counts[oracle::asset_id::invalid], 0);
+}
@@ -0,0 +1,207 @@
+// Copyright (c) 2023, Zephyr Protocol
+// Portions copyright (c) 2019-2021, Haven Protocol
+// Portions copyright (c) 2016-2019, The Monero Project
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "cryptonote_core/oracle_fetcher.h"
+
+namespace
+{
+  // stands in for the oracles, answering with the given timestamps in turn
+  class fake_oracle
+  {
+  public:
+    fake_oracle(std::vector<uint64_t> timestamps): m_timestamps(std::move(timestamps)), m_calls(0) {}
+
+    cryptonote::oracle_fetcher::fetch_t fetch()
+    {
+      return [this](uint64_t timestamp, uint8_t hf_version, oracle::pricing_record &pr) {
+        std::lock_guard<std::mutex> lock(m_lock);
+        const size_t n = m_calls++;
+        if (n >= m_timestamps.size() || !m_timestamps[n])
+          return false;
+        pr = oracle::pricing_record();
+        pr.spot = 1000 + n;
+        pr.timestamp = m_timestamps[n];
+        return true;
+      };
+    }
+
+    size_t calls() const { return m_calls; }
+
+  private:
+    std::mutex m_lock;
+    std::vector<uint64_t> m_timestamps;
+    std::atomic<size_t> m_calls;
+  };
+
+  uint8_t djed() { return HF_VERSION_DJED; }
+
+  bool wait_for_calls(const fake_oracle &oracle, size_t calls)
+  {
+    for (int i = 0; i < 500 && oracle.calls() < calls; ++i)
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    return oracle.calls() >= calls;
+  }
+}
+
+TEST(oracle_fetcher, keeps_newest_record)
+{
+  const uint64_t now = time(NULL);
+  fake_oracle oracle({now - 10, now - 20, 0});
+  cryptonote::oracle_fetcher fetcher(djed, oracle.fetch());
+
+  oracle::pricing_record pr;
+  ASSERT_FALSE(fetcher.get_latest(pr));
+  fetcher.start();
+  ASSERT_TRUE(wait_for_calls(oracle, 1));
+  fetcher.stop();
+  ASSERT_TRUE(fetcher.get_latest(pr));
+  ASSERT_EQ(pr.timestamp, now - 10);
+
+  // an older record does not replace it, and neither does a failure
+  fetcher.start();
+  ASSERT_TRUE(wait_for_calls(oracle, 2));
+  fetcher.stop();
+  ASSERT_TRUE(fetcher.get_latest(pr));
+  ASSERT_EQ(pr.timestamp, now - 10);
+  ASSERT_EQ(pr.spot, 1000);
+
+  fetcher.start();
+  ASSERT_TRUE(wait_for_calls(oracle, 3));
+  fetcher.stop();
+  ASSERT_TRUE(fetcher.get_latest(pr));
+  ASSERT_EQ(pr.timestamp, now - 10);
+
+  const cryptonote::oracle_fetcher::stats_t stats = fetcher.get_stats();
+  ASSERT_EQ(stats.fetches, 2);
+  ASSERT_EQ(stats.failures, 1);
+  ASSERT_GE(stats.last_success_time, now);
+}
+
+TEST(oracle_fetcher, stop_and_wake)
+{
+  const uint64_t now = time(NULL);
+  fake_oracle oracle(std::vector<uint64_t>(10, now - 60));
+  cryptonote::oracle_fetcher fetcher(djed, oracle.fetch());
+
+  fetcher.start();
+  ASSERT_TRUE(fetcher.is_running());
+  ASSERT_TRUE(wait_for_calls(oracle, 1));
+
+  // a block the cached record is newer than does not wake it
+  fetcher.wake(now - 120);
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  ASSERT_EQ(oracle.calls(), 1);
+
+  // a new block the record is too old for does
+  fetcher.wake(now);
+  ASSERT_TRUE(wait_for_calls(oracle, 2));
+
+  // but not again within FETCH_INTERVAL
+  fetcher.wake(now);
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  ASSERT_EQ(oracle.calls(), 2);
+
+  // stop does not wait for the next poll
+  const auto start = std::chrono::steady_clock::now();
+  fetcher.stop();
+  ASSERT_FALSE(fetcher.is_running());
+  ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(cryptonote::oracle_fetcher::FETCH_INTERVAL));
+  fetcher.wake(now + 60);
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  ASSERT_EQ(oracle.calls(), 2);
+}
+
+TEST(oracle_fetcher, no_wake_while_syncing)
+{
+  const uint64_t now = time(NULL);
+  fake_oracle oracle({0, 0});
+  cryptonote::oracle_fetcher fetcher(djed, oracle.fetch());
+
+  fetcher.start();
+  ASSERT_TRUE(wait_for_calls(oracle, 1));
+
+  // without any record, an old block still does not wake it
+  fetcher.wake(now - cryptonote::oracle_fetcher::NEAR_TIP_AGE - 60);
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  ASSERT_EQ(oracle.calls(), 1);
+
+  fetcher.wake(now);
+  ASSERT_TRUE(wait_for_calls(oracle, 2));
+  fetcher.stop();
+  ASSERT_EQ(fetcher.get_stats().failures, 2);
+}
+
+TEST(oracle_fetcher, failover)
+{
+  oracle::pricing_record pr;
+  std::vector<size_t> tried;
+  const auto fetch_from = [&tried](bool up0, bool up1, bool up2) {
+    return [&tried, up0, up1, up2](size_t n, oracle::pricing_record &pr) {
+      tried.push_back(n);
+      pr.spot = n;
+      return n == 0 ? up0 : n == 1 ? up1 : up2;
+    };
+  };
+
+  // the one oracle up answers, wherever it falls in the order
+  for (size_t up = 0; up < 3; ++up)
+  {
+    tried.clear();
+    pr = oracle::pricing_record();
+    ASSERT_TRUE(cryptonote::oracle_fetcher::fetch_from_any(fetch_from(up == 0, up == 1, up == 2), pr));
+    ASSERT_EQ(pr.spot, up);
+    ASSERT_EQ(tried.back(), up);
+    ASSERT_EQ(std::set<size_t>(tried.begin(), tried.end()).size(), tried.size());
+  }
+
+  // each oracle is tried once before giving up
+  tried.clear();
+  ASSERT_FALSE(cryptonote::oracle_fetcher::fetch_from_any(fetch_from(false, false, false), pr));
+  ASSERT_EQ(std::set<size_t>(tried.begin(), tried.end()), std::set<size_t>({0, 1, 2}));
+  ASSERT_EQ(tried.size(), 3);
+
+  // and which one is asked first is shuffled
+  std::set<size_t> first;
+  for (int i = 0; i < 200; ++i)
+  {
+    tried.clear();
+    ASSERT_TRUE(cryptonote::oracle_fetcher::fetch_from_any(fetch_from(true, true, true), pr));
+    ASSERT_EQ(tried.size(), 1);
+    first.insert(tried.front());
+  }
+  ASSERT_EQ(first.size(), 3);
+}
@@ -50,18 +50,21 @@ public:
   TestDB(size_t bc_height = test_distribution_size): blockchain_height(bc_height) { m_open = true; }
   virtual uint64_t height() const override { return blockchain_height; }
 
-  // std::pair<std::vector<uint64_t>, uint64_t> get_block_cumulative_rct_outputs(const std::vector<uint64_t> &heights, const std::string asset_type) const override
-  // {
-  //   std::vector<uint64_t> d;
-  //   for (uint64_t h: heights)
-  //   {
-  //     uint64_t c = 0;
-  //     for (uint64_t i = 0; i <= h; ++i)
-  //       c += test_distribution[i];
-  //     d.push_back(c);
-  //   }
-  //   return d;
-  // }
+  std::pair<std::vector<uint64_t>, uint64_t> get_block_cumulative_rct_outputs(const std::vector<uint64_t> &heights, const std::string asset_type) const override
+  {
+    std::vector<uint64_t> d;
+    uint64_t num_spendable_global_outs = 0;
+    for (size_t n = 0; n < heights.size(); ++n)
+    {
+      uint64_t c = 0;
+      for (uint64_t i = 0; i <= heights[n]; ++i)
+        c += test_distribution[i];
+      d.push_back(c);
+      if (n + CRYPTONOTE_DEFAULT_TX_SPENDABLE_AGE == heights.size())
+        num_spendable_global_outs = c;
+    }
+    return std::make_pair(d, num_spendable_global_outs);
+  }
 
   std::vector<uint64_t> get_block_weights(uint64_t start_offset, size_t count) const override
   {
@@ -99,6 +102,14 @@ crypto::hash get_block_hash(uint64_t height)
   return hash;
 }
 
+crypto::hash get_forked_block_hash(uint64_t height, uint64_t fork_height)
+{
+  crypto::hash hash = get_block_hash(height);
+  if (height >= fork_height)
+    hash.data[31] = fork_height;
+  return hash;
+}
+
 TEST(output_distribution, extend)
 {
   boost::optional<cryptonote::rpc::output_distribution_data> res;
@@ -184,3 +195,117 @@ TEST(output_distribution, part_noncumulative)
   ASSERT_EQ(res->distribution.size(), 5);
   ASSERT_EQ(res->distribution, std::vector<uint64_t>({0, 1, 5, 1, 4}));
 }
+
+TEST(output_distribution, cache_extend_and_reorg)
+{
+  boost::optional<cryptonote::rpc::output_distribution_data> res;
+  std::vector<uint64_t> fetched_from;
+  const auto f = [&fetched_from](uint64_t amount, std::string asset_type, uint64_t from, uint64_t to, uint64_t &start_height, std::vector<uint64_t> &distribution, uint64_t &base, uint64_t &num_spendable_global_outs) {
+    fetched_from.push_back(from);
+    return ::get_output_distribution(amount, asset_type, from, to, start_height, distribution, base, num_spendable_global_outs);
+  };
+
+  std::vector<uint64_t> expected;
+  uint64_t c = 0;
+  for (size_t i = 0; i < test_distribution_size; ++i)
+    expected.push_back(c += test_distribution[i]);
+
+  // the other tests use the ZEPH cache
+  res = cryptonote::rpc::RpcHandler::get_output_distribution(f, 0, "ZEPHRSV", 0, 15, ::get_block_hash, true, test_distribution_size);
+  ASSERT_TRUE(res != boost::none);
+  ASSERT_EQ(res->distribution, std::vector<uint64_t>(expected.begin(), expected.begin() + 16));
+  ASSERT_EQ(fetched_from, std::vector<uint64_t>({0}));
+
+  // same request, served from the cache
+  res = cryptonote::rpc::RpcHandler::get_output_distribution(f, 0, "ZEPHRSV", 0, 15, ::get_block_hash, true, test_distribution_size);
+  ASSERT_TRUE(res != boost::none);
+  ASSERT_EQ(res->distribution, std::vector<uint64_t>(expected.begin(), expected.begin() + 16));
+  ASSERT_EQ(res->num_spendable_global_outs, expected[6]);
+  ASSERT_EQ(fetched_from.size(), 1);
+
+  // new blocks, only those are read
+  res = cryptonote::rpc::RpcHandler::get_output_distribution(f, 0, "ZEPHRSV", 0, 31, ::get_block_hash, true, test_distribution_size);
+  ASSERT_TRUE(res != boost::none);
+  ASSERT_EQ(res->distribution, expected);
+  ASSERT_EQ(res->num_spendable_global_outs, expected[22]);
+  ASSERT_EQ(fetched_from.back(), 16);
+
+  // a reorg of the last few blocks, the last 10 cached blocks are dropped and read again
+  const auto shallow_fork = [](uint64_t height) { return ::get_forked_block_hash(height, 25); };
+  res = cryptonote::rpc::RpcHandler::get_output_distribution(f, 0, "ZEPHRSV", 0, 31, shallow_fork, false, test_distribution_size);
+  ASSERT_TRUE(res != boost::none);
+  ASSERT_EQ(res->distribution, std::vector<uint64_t>(test_distribution, test_distribution + test_distribution_size));
+  ASSERT_EQ(fetched_from.back(), 22);
+
+  // a deeper reorg, everything is read again
+  const auto deep_fork = [](uint64_t height) { return ::get_forked_block_hash(height, 5); };
+  res = cryptonote::rpc::RpcHandler::get_output_distribution(f, 0, "ZEPHRSV", 0, 31, deep_fork, true, test_distribution_size);
+  ASSERT_TRUE(res != boost::none);
+  ASSERT_EQ(res->distribution, expected);
+  ASSERT_EQ(fetched_from.back(), 0);
+  ASSERT_EQ(fetched_from.size(), 4);
+}
+
+TEST(output_distribution, cache_suffix)
+{
+  boost::optional<cryptonote::rpc::output_distribution_data> res;
+  std::vector<uint64_t> fetched_from;
+  const auto f = [&fetched_from](uint64_t amount, std::string asset_type, uint64_t from, uint64_t to, uint64_t &start_height, std::vector<uint64_t> &distribution, uint64_t &base, uint64_t &num_spendable_global_outs) {
+    fetched_from.push_back(from);
+    return ::get_output_distribution(amount, asset_type, from, to, start_height, distribution, base, num_spendable_global_outs);
+  };
+
+  std::vector<uint64_t> expected;
+  uint64_t c = 0;
+  for (size_t i = 0; i < test_distribution_size; ++i)
+    expected.push_back(c += test_distribution[i]);
+
+  // the other tests use the ZEPH and ZEPHRSV caches
+  res = cryptonote::rpc::RpcHandler::get_output_distribution(f, 0, "ZEPHUSD", 0, 15, ::get_block_hash, true, test_distribution_size);
+  ASSERT_TRUE(res != boost::none);
+  ASSERT_EQ(res->distribution, std::vector<uint64_t>(expected.begin(), expected.begin() + 16));
+  ASSERT_EQ(fetched_from, std::vector<uint64_t>({0}));
+
+  // a wallet asking from the top of its own copy is served from the cache
+  res = cryptonote::rpc::RpcHandler::get_output_distribution(f, 0, "ZEPHUSD", 10, 15, ::get_block_hash, false, test_distribution_size);
+  ASSERT_TRUE(res != boost::none);
+  ASSERT_EQ(res->start_height, 10);
+  ASSERT_EQ(res->base, expected[9]);
+  ASSERT_EQ(res->distribution, std::vector<uint64_t>(test_distribution + 10, test_distribution + 16));
+  ASSERT_EQ(fetched_from.size(), 1);
+
+  // new blocks, only those are read, and the cache still starts at genesis
+  res = cryptonote::rpc::RpcHandler::get_output_distribution(f, 0, "ZEPHUSD", 15, 31, ::get_block_hash, false, test_distribution_size);
+  ASSERT_TRUE(res != boost::none);
+  ASSERT_EQ(res->start_height, 15);
+  ASSERT_EQ(res->base, expected[14]);
+  ASSERT_EQ(res->distribution, std::vector<uint64_t>(test_distribution + 15, test_distribution + test_distribution_size));
+  ASSERT_EQ(res->num_spendable_global_outs, expected[22]);
+  ASSERT_EQ(fetched_from, std::vector<uint64_t>({0, 16}));
+
+  res = cryptonote::rpc::RpcHandler::get_output_distribution(f, 0, "ZEPHUSD", 0, 31, ::get_block_hash, true, test_distribution_size);
+  ASSERT_TRUE(res != boost::none);
+  ASSERT_EQ(res->start_height, 0);
+  ASSERT_EQ(res->base, 0);
+  ASSERT_EQ(res->distribution, expected);
+  ASSERT_EQ(fetched_from.size(), 2);
+
+  // the cache does not match the chain anymore, it is read again from
+  // genesis rather than from the height the wallet asked for
+  const auto deep_fork = [](uint64_t height) { return ::get_forked_block_hash(height, 5); };
+  res = cryptonote::rpc::RpcHandler::get_output_distribution(f, 0, "ZEPHUSD", 20, 31, deep_fork, false, test_distribution_size);
+  ASSERT_TRUE(res != boost::none);
+  ASSERT_EQ(res->start_height, 20);
+  ASSERT_EQ(res->base, expected[19]);
+  ASSERT_EQ(res->distribution, std::vector<uint64_t>(test_distribution + 20, test_distribution + test_distribution_size));
+  ASSERT_EQ(fetched_from, std::vector<uint64_t>({0, 16, 0}));
+
+  res = cryptonote::rpc::RpcHandler::get_output_distribution(f, 0, "ZEPHUSD", 0, 31, deep_fork, true, test_distribution_size);
+  ASSERT_TRUE(res != boost::none);
+  ASSERT_EQ(res->distribution, expected);
+  ASSERT_EQ(fetched_from.size(), 3);
+
+  // an empty range is not served from the cache
+  res = cryptonote::rpc::RpcHandler::get_output_distribution(f, 0, "ZEPHUSD", 31, 20, deep_fork, false, test_distribution_size);
+  ASSERT_TRUE(res == boost::none);
+}
@@ -0,0 +1,92 @@
+// Copyright (c) 2023, Zephyr Protocol
+// Portions copyright (c) 2016-2019, The Monero Project
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "gtest/gtest.h"
+#include "cryptonote_core/parsed_tx_cache.h"
+
+namespace
+{
+  crypto::hash make_txid(uint8_t n)
+  {
+    crypto::hash h = crypto::null_hash;
+    h.data[0] = n;
+    return h;
+  }
+
+  size_t entry_size(size_t blob_size)
+  {
+    return sizeof(cryptonote::transaction) + 2 * blob_size;
+  }
+}
+
+TEST(parsed_tx_cache, evicts_least_recently_used)
+{
+  cryptonote::parsed_tx_cache cache(2 * entry_size(1000));
+  cryptonote::transaction tx;
+  cache.insert(make_txid(1), tx, 1000);
+  cache.insert(make_txid(2), tx, 1000);
+
+  // touch 1 so 2 becomes the eviction candidate
+  ASSERT_TRUE(cache.find(make_txid(1), false, tx));
+  cache.insert(make_txid(3), tx, 1000);
+
+  ASSERT_TRUE(cache.find(make_txid(1), false, tx));
+  ASSERT_FALSE(cache.find(make_txid(2), false, tx));
+  ASSERT_TRUE(cache.find(make_txid(3), false, tx));
+
+  const cryptonote::parsed_tx_cache::stats stats = cache.get_stats();
+  ASSERT_EQ(stats.hits, 3u);
+  ASSERT_EQ(stats.misses, 1u);
+  ASSERT_EQ(stats.evictions, 1u);
+  ASSERT_EQ(stats.entries, 2u);
+  ASSERT_EQ(stats.bytes, 2 * entry_size(1000));
+}
+
+TEST(parsed_tx_cache, pruned_mismatch_and_remove)
+{
+  cryptonote::parsed_tx_cache cache(entry_size(1000));
+  cryptonote::transaction tx;
+  tx.pruned = true;
+  cache.insert(make_txid(1), tx, 1000);
+  ASSERT_FALSE(cache.find(make_txid(1), false, tx));
+  ASSERT_TRUE(cache.find(make_txid(1), true, tx));
+
+  cache.remove(make_txid(1));
+  ASSERT_FALSE(cache.find(make_txid(1), true, tx));
+  ASSERT_EQ(cache.get_stats().bytes, 0u);
+}
+
+TEST(parsed_tx_cache, zero_budget_disables)
+{
+  cryptonote::parsed_tx_cache cache(0);
+  cryptonote::transaction tx;
+  cache.insert(make_txid(1), tx, 1000);
+  ASSERT_FALSE(cache.find(make_txid(1), false, tx));
+  ASSERT_EQ(cache.get_stats().entries, 0u);
+}
@@ -0,0 +1,140 @@
+// Copyright (c) 2023, Zephyr Protocol
+// Portions copyright (c) 2016-2019, The Monero Project
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include "gtest/gtest.h"
+#include "common/published_snapshot.h"
+
+namespace
+{
+  struct counting_builder
+  {
+    int builds = 0;
+    std::shared_ptr<const int> operator()() { return std::make_shared<const int>(++builds); }
+  };
+}
+
+TEST(published_snapshot, rebuilds_only_when_stale)
+{
+  tools::published_snapshot<int> snapshot;
+  epee::critical_section lock;
+  std::atomic<uint64_t> version(0);
+  counting_builder build;
+
+  auto s = snapshot.get(version, lock, std::ref(build));
+  ASSERT_EQ(*s, 1);
+  ASSERT_EQ(*snapshot.get(version, lock, std::ref(build)), 1);
+  ASSERT_EQ(build.builds, 1);
+
+  ++version;
+  ASSERT_EQ(*snapshot.get(version, lock, std::ref(build)), 2);
+  ASSERT_EQ(*snapshot.get(version, lock, std::ref(build)), 2);
+  ASSERT_EQ(build.builds, 2);
+
+  // readers keep the snapshot they got alive
+  ASSERT_EQ(*s, 1);
+
+  snapshot.reset();
+  ASSERT_EQ(*snapshot.get(version, lock, std::ref(build)), 3);
+}
+
+TEST(published_snapshot, callable_version)
+{
+  tools::published_snapshot<int> snapshot;
+  epee::critical_section lock;
+  std::atomic<uint64_t> a(0), b(0);
+  counting_builder build;
+  const auto version = [&a, &b](){ return a + b; };
+
+  ASSERT_EQ(*snapshot.get(version, lock, std::ref(build)), 1);
+  ++b;
+  ASSERT_EQ(*snapshot.get(version, lock, std::ref(build)), 2);
+  ++a;
+  ASSERT_EQ(*snapshot.get(version, lock, std::ref(build)), 3);
+  ASSERT_EQ(*snapshot.get(version, lock, std::ref(build)), 3);
+}
+
+TEST(published_snapshot, does_not_wait_for_writer)
+{
+  tools::published_snapshot<int> snapshot;
+  epee::critical_section lock;
+  std::atomic<uint64_t> version(0);
+  counting_builder build;
+  ASSERT_EQ(*snapshot.get(version, lock, std::ref(build)), 1);
+
+  std::mutex m;
+  std::condition_variable cv;
+  bool locked = false, release = false;
+  std::thread writer([&](){
+    CRITICAL_REGION_LOCAL(lock);
+    ++version;
+    std::unique_lock<std::mutex> l(m);
+    locked = true;
+    cv.notify_all();
+    cv.wait(l, [&](){ return release; });
+  });
+  {
+    std::unique_lock<std::mutex> l(m);
+    cv.wait(l, [&](){ return locked; });
+  }
+
+  // stale, but the writer holds the lock: the previous snapshot is returned
+  ASSERT_EQ(*snapshot.get(version, lock, std::ref(build)), 1);
+  ASSERT_EQ(build.builds, 1);
+
+  {
+    std::unique_lock<std::mutex> l(m);
+    release = true;
+    cv.notify_all();
+  }
+  writer.join();
+
+  ASSERT_EQ(*snapshot.get(version, lock, std::ref(build)), 2);
+}
+
+TEST(published_snapshot, builder_failure_releases_lock)
+{
+  tools::published_snapshot<int> snapshot;
+  epee::critical_section lock;
+  std::atomic<uint64_t> version(0);
+
+  ASSERT_THROW(snapshot.get(version, lock, []() -> std::shared_ptr<const int> { throw std::runtime_error("build failed"); }), std::runtime_error);
+
+  std::atomic<bool> got_lock(false);
+  std::thread other([&](){ got_lock = lock.tryLock(); if (got_lock) lock.unlock(); });
+  other.join();
+  ASSERT_TRUE(got_lock);
+
+  counting_builder build;
+  ASSERT_EQ(*snapshot.get(version, lock, std::ref(build)), 1);
+}
@@ -36,9 +36,9 @@
 using tt = cryptonote::transaction_type;
 
 #define INIT_PROTOCOL_STATE_600_PERCENT(circ_amounts, pr) \
-    circ_amounts.push_back(std::make_pair("ZEPH",    "1000000000000000")); /* 1000 * 10^12 */ \
-    circ_amounts.push_back(std::make_pair("ZEPHUSD", "1000000000000000")); /* 1000 * 10^12 */ \
-    circ_amounts.push_back(std::make_pair("ZEPHRSV", "1000000000000000")); /* 1000 * 10^12 */ \
+    circ_amounts.tally[cryptonote::circ_supply_snapshot::ZEPH] = 1000000000000000; /* 1000 * 10^12 */ \
+    circ_amounts.tally[cryptonote::circ_supply_snapshot::ZEPHUSD] = 1000000000000000; /* 1000 * 10^12 */ \
+    circ_amounts.tally[cryptonote::circ_supply_snapshot::ZEPHRSV] = 1000000000000000; /* 1000 * 10^12 */ \
     std::string sig = "a4eebd24d684240635f8f0dae4347a87f951ff8220495f6982e4e52359bc1fb8028b11e02e4ddea503b3c175984836e90e4f65599ab2b1fa632ccb4a915a95f9"; \
     int j=0; \
     for (unsigned int i = 0; i < sig.size(); i += 2) { \
@@ -63,7 +63,7 @@ using tt = cryptonote::transaction_type;
 
 TEST(get_reserve_ratio, reserve_ratio_600_percent)
 {
-    std::vector<std::pair<std::string, std::string>> circ_amounts;
+    cryptonote::circ_supply_snapshot circ_amounts;
     oracle::pricing_record pr;
     INIT_PROTOCOL_STATE_600_PERCENT(circ_amounts, pr);
     EXPECT_EQ(cryptonote::get_reserve_ratio(circ_amounts, pr.spot), 6.0);
@@ -74,7 +74,7 @@ TEST(get_reserve_ratio, reserve_ratio_600_percent)
 */
 TEST(reserve_ratio_satisfied, mint_stable_above_400_percent_success)
 {
-    std::vector<std::pair<std::string, std::string>> circ_amounts;
+    cryptonote::circ_supply_snapshot circ_amounts;
     oracle::pricing_record pr;
     INIT_PROTOCOL_STATE_600_PERCENT(circ_amounts, pr);
 
@@ -87,7 +87,7 @@ TEST(reserve_ratio_satisfied, mint_stable_above_400_percent_success)
 
 TEST(reserve_ratio_satisfied, mint_stable_below_400_percent_fails)
 {
-    std::vector<std::pair<std::string, std::string>> circ_amounts;
+    cryptonote::circ_supply_snapshot circ_amounts;
     oracle::pricing_record pr;
     INIT_PROTOCOL_STATE_600_PERCENT(circ_amounts, pr);
     SET_PROTOCOL_STATE_X_PERCENT(pr, 1.0);
@@ -105,7 +105,7 @@ TEST(reserve_ratio_satisfied, mint_stable_below_400_percent_fails)
 */
 TEST(reserve_ratio_satisfied, redeem_stable_above_400_percent_success)
 {
-    std::vector<std::pair<std::string, std::string>> circ_amounts;
+    cryptonote::circ_supply_snapshot circ_amounts;
     oracle::pricing_record pr;
     INIT_PROTOCOL_STATE_600_PERCENT(circ_amounts, pr);
 
@@ -119,7 +119,7 @@ TEST(reserve_ratio_satisfied, redeem_stable_above_400_percent_success)
 
 TEST(reserve_ratio_satisfied, redeem_stable_below_400_percent_success)
 {
-    std::vector<std::pair<std::string, std::string>> circ_amounts;
+    cryptonote::circ_supply_snapshot circ_amounts;
     oracle::pricing_record pr;
     INIT_PROTOCOL_STATE_600_PERCENT(circ_amounts, pr);
     SET_PROTOCOL_STATE_X_PERCENT(pr, 1.0);
@@ -135,7 +135,7 @@ TEST(reserve_ratio_satisfied, redeem_stable_below_400_percent_success)
 
 TEST(reserve_ratio_satisfied, redeem_stable_fails_if_reserve_below_zero)
 {
-    std::vector<std::pair<std::string, std::string>> circ_amounts;
+    cryptonote::circ_supply_snapshot circ_amounts;
     oracle::pricing_record pr;
     INIT_PROTOCOL_STATE_600_PERCENT(circ_amounts, pr);
     SET_PROTOCOL_STATE_X_PERCENT(pr, 1.0);
@@ -154,7 +154,7 @@ TEST(reserve_ratio_satisfied, redeem_stable_fails_if_reserve_below_zero)
 */
 TEST(reserve_ratio_satisfied, mint_reserve_below_800_percent_success)
 {
-    std::vector<std::pair<std::string, std::string>> circ_amounts;
+    cryptonote::circ_supply_snapshot circ_amounts;
     oracle::pricing_record pr;
     INIT_PROTOCOL_STATE_600_PERCENT(circ_amounts, pr);
 
@@ -167,7 +167,7 @@ TEST(reserve_ratio_satisfied, mint_reserve_below_800_percent_success)
 
 TEST(reserve_ratio_satisfied, mint_reserve_above_800_percent_fails)
 {
-    std::vector<std::pair<std::string, std::string>> circ_amounts;
+    cryptonote::circ_supply_snapshot circ_amounts;
     oracle::pricing_record pr;
     INIT_PROTOCOL_STATE_600_PERCENT(circ_amounts, pr);
 
@@ -184,7 +184,7 @@ TEST(reserve_ratio_satisfied, mint_reserve_above_800_percent_fails)
 
 TEST(reserve_ratio_satisfied, redeem_reserve_above_400_percent_success)
 {
-    std::vector<std::pair<std::string, std::string>> circ_amounts;
+    cryptonote::circ_supply_snapshot circ_amounts;
     oracle::pricing_record pr;
     INIT_PROTOCOL_STATE_600_PERCENT(circ_amounts, pr);
 
@@ -198,7 +198,7 @@ TEST(reserve_ratio_satisfied, redeem_reserve_above_400_percent_success)
 
 TEST(reserve_ratio_satisfied, redeem_reserve_below_400_percent_fails)
 {
-    std::vector<std::pair<std::string, std::string>> circ_amounts;
+    cryptonote::circ_supply_snapshot circ_amounts;
     oracle::pricing_record pr;
     INIT_PROTOCOL_STATE_600_PERCENT(circ_amounts, pr);
 
@@ -209,3 +209,64 @@ TEST(reserve_ratio_satisfied, redeem_reserve_below_400_percent_fails)
 
     EXPECT_FALSE(cryptonote::reserve_ratio_satisfied(circ_amounts, pr, tt::REDEEM_RESERVE, tally_zeph, tally_stables, tally_reserves));
 }
+
+/*
+* reserve_tally
+*/
+TEST(reserve_tally, rejected_conversion_fits_after_offsetting_one)
+{
+    cryptonote::circ_supply_snapshot circ_amounts;
+    oracle::pricing_record pr;
+    INIT_PROTOCOL_STATE_600_PERCENT(circ_amounts, pr);
+    cryptonote::reserve_tally tally(circ_amounts, pr);
+
+    // 400 ZEPH out of the reserve would leave it at 360%
+    uint64_t redeem_zeph = 400 * COIN;
+    uint64_t redeem_reserves = cryptonote::zeph_to_zephrsv(redeem_zeph, pr);
+    EXPECT_FALSE(tally.add(tt::REDEEM_RESERVE, redeem_reserves, redeem_zeph));
+    EXPECT_EQ(tally.zeph(), 0);
+    EXPECT_EQ(tally.reserves(), 0);
+
+    // redeeming half the stables first brings the ratio back up
+    uint64_t redeem_stables = 500 * COIN;
+    EXPECT_TRUE(tally.add(tt::REDEEM_STABLE, redeem_stables, cryptonote::zephusd_to_zeph(redeem_stables, pr)));
+    EXPECT_EQ(tally.stables(), -boost::multiprecision::int128_t(redeem_stables));
+    EXPECT_TRUE(tally.add(tt::REDEEM_RESERVE, redeem_reserves, redeem_zeph));
+    EXPECT_EQ(tally.reserves(), -boost::multiprecision::int128_t(redeem_reserves));
+
+    EXPECT_FALSE(tally.add(tt::TRANSFER, 0, 0));
+}
+
+/*
+* reserve_engine
+*/
+TEST(reserve_engine, matches_free_functions)
+{
+    cryptonote::circ_supply_snapshot circ_amounts;
+    oracle::pricing_record pr;
+    INIT_PROTOCOL_STATE_600_PERCENT(circ_amounts, pr);
+    const cryptonote::reserve_engine engine(circ_amounts, pr);
+
+    EXPECT_EQ(engine.reserve_ratio(), cryptonote::get_spot_reserve_ratio(circ_amounts, pr));
+    EXPECT_EQ(engine.reserve_ratio_ma(), cryptonote::get_ma_reserve_ratio(circ_amounts, pr));
+
+    double reserve_ratio, reserve_ratio_ma;
+    EXPECT_TRUE(engine.get_reserve_ratios(0, 0, reserve_ratio, reserve_ratio_ma));
+    EXPECT_EQ(reserve_ratio, engine.reserve_ratio());
+    EXPECT_EQ(reserve_ratio_ma, engine.reserve_ratio_ma());
+
+    // 500 ZEPH of stables minted would leave the reserve at 400%
+    uint64_t mint_zeph = 500 * COIN;
+    uint64_t minted = engine.get_amount_minted(tt::MINT_STABLE, mint_zeph);
+    EXPECT_EQ(minted, cryptonote::zeph_to_zephusd(mint_zeph, pr));
+    boost::multiprecision::int128_t delta_zeph, delta_stables, delta_reserves;
+    EXPECT_TRUE(cryptonote::reserve_tally::get_conversion_delta(tt::MINT_STABLE, mint_zeph, minted, delta_zeph, delta_stables, delta_reserves));
+    std::string error_reason;
+    EXPECT_EQ(engine.check(tt::MINT_STABLE, delta_zeph, delta_stables, delta_reserves, error_reason),
+        cryptonote::reserve_ratio_satisfied(circ_amounts, pr, tt::MINT_STABLE, delta_zeph, delta_stables, delta_reserves));
+    EXPECT_TRUE(engine.get_reserve_ratios(delta_zeph, delta_stables, reserve_ratio, reserve_ratio_ma));
+    EXPECT_LT(reserve_ratio, engine.reserve_ratio());
+
+    // removing more ZEPH than the reserve holds cannot be evaluated
+    EXPECT_FALSE(engine.get_reserve_ratios(-boost::multiprecision::int128_t(circ_amounts.zeph_reserve()) - 1, 0, reserve_ratio, reserve_ratio_ma));
+}
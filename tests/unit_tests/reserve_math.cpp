@@ -0,0 +1,149 @@
+// Copyright (c) 2023, Zephyr Protocol
+// Portions copyright (c) 2016-2019, The Monero Project
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <fstream>
+#include <random>
+#include <sstream>
+#include "gtest/gtest.h"
+#include "cryptonote_config.h"
+#include "cryptonote_core/cryptonote_tx_utils.h"
+#include "cryptonote_core/reserve_math.h"
+#include "unit_tests_utils.h"
+
+using boost::multiprecision::uint128_t;
+using boost::multiprecision::uint256_t;
+using namespace cryptonote::reserve_math;
+
+namespace
+{
+  void expect_same_comparisons(const uint128_t& assets, const uint128_t& liabilities, uint64_t price)
+  {
+    if (assets == 0 && liabilities == 0)
+      return;
+    for (uint64_t threshold: {1, 4, 8})
+    {
+      EXPECT_EQ(compare_reserve_ratio(assets, liabilities, price, threshold), compare_reserve_ratio_quad(assets, liabilities, price, threshold))
+        << assets << " " << liabilities << " " << price << " " << threshold;
+    }
+  }
+}
+
+TEST(reserve_math, replay)
+{
+  std::ifstream in((unit_test::data_dir / "reserve_math" / "replay.txt").string());
+  ASSERT_TRUE(in.good());
+
+  size_t records = 0;
+  std::string line;
+  while (std::getline(in, line))
+  {
+    if (line.empty() || line[0] == '#')
+      continue;
+    std::istringstream fields(line);
+    uint64_t height, spot, moving_average, stable, stable_ma, reserve, reserve_ma;
+    std::string zeph_reserve, num_stables, num_reserves;
+    fields >> height >> zeph_reserve >> num_stables >> num_reserves >> spot >> moving_average >> stable >> stable_ma >> reserve >> reserve_ma;
+    ASSERT_FALSE(fields.fail()) << line;
+
+    cryptonote::circ_supply_snapshot circ_amounts;
+    circ_amounts.tally[cryptonote::circ_supply_snapshot::ZEPH] = uint128_t(zeph_reserve);
+    circ_amounts.tally[cryptonote::circ_supply_snapshot::ZEPHUSD] = uint128_t(num_stables);
+    circ_amounts.tally[cryptonote::circ_supply_snapshot::ZEPHRSV] = uint128_t(num_reserves);
+
+    EXPECT_EQ(cryptonote::get_stable_coin_price(circ_amounts, spot), stable) << "height " << height;
+    EXPECT_EQ(cryptonote::get_stable_coin_price(circ_amounts, moving_average), stable_ma) << "height " << height;
+    EXPECT_EQ(cryptonote::get_reserve_coin_price(circ_amounts, spot), reserve) << "height " << height;
+    EXPECT_EQ(cryptonote::get_reserve_coin_price(circ_amounts, moving_average), reserve_ma) << "height " << height;
+
+    // the ratio checks of conversions against this state, a small and a large one each way
+    for (const uint128_t& delta: {uint128_t(1), uint128_t(1000 * COIN)})
+    {
+      for (const uint128_t& assets: {circ_amounts.zeph_reserve() + delta, circ_amounts.zeph_reserve() > delta ? circ_amounts.zeph_reserve() - delta : 0})
+      {
+        expect_same_comparisons(assets, circ_amounts.num_stables(), spot);
+        expect_same_comparisons(assets, circ_amounts.num_stables(), moving_average);
+      }
+    }
+    ++records;
+  }
+  EXPECT_GT(records, 1000u);
+}
+
+TEST(reserve_math, ratio_next_to_thresholds)
+{
+  std::mt19937_64 rng(1);
+  for (size_t i = 0; i < 20000; ++i)
+  {
+    // assets chosen so the ratio lands on, or one atomic unit off, a threshold
+    const uint64_t threshold = 1 + rng() % 8;
+    const uint128_t liabilities = uint128_t(rng() >> (rng() % 40)) << (i % 2 ? 0 : 24);
+    const uint64_t price = 1 + (rng() >> 20);
+    const uint128_t assets = liabilities * threshold * COIN / price + rng() % 3;
+    expect_same_comparisons(assets > 0 ? assets - 1 : assets, liabilities, price);
+    expect_same_comparisons(assets, liabilities, price);
+  }
+}
+
+TEST(reserve_math, reserve_price_on_rounding_steps)
+{
+  std::mt19937_64 rng(2);
+  for (size_t i = 0; i < 20000; ++i)
+  {
+    // zeph reserve chosen so the price is on, or next to, a multiple of 10000
+    const uint64_t price = (rng() % (5000 * COIN)) / 10000 * 10000;
+    const uint128_t num_reserves = 1 + (rng() >> (rng() % 50));
+    const uint128_t num_stables = rng() >> (rng() % 50);
+    const uint64_t exchange_rate = 1 + (rng() >> 22);
+    const uint256_t needed = uint256_t(price) * exchange_rate * uint256_t(num_reserves) / COIN + uint256_t(num_stables) * COIN;
+    for (uint64_t offset = 0; offset < 3; ++offset)
+    {
+      const uint128_t zeph_reserve = uint128_t(needed / exchange_rate) + offset;
+      EXPECT_EQ(reserve_coin_price(zeph_reserve, num_stables, num_reserves, exchange_rate), reserve_coin_price_quad(zeph_reserve, num_stables, num_reserves, exchange_rate))
+        << zeph_reserve << " " << num_stables << " " << num_reserves << " " << exchange_rate;
+    }
+  }
+}
+
+TEST(reserve_math, edge_cases)
+{
+  EXPECT_EQ(reserve_coin_price(1, 1, 1, 0), 0u);
+  EXPECT_EQ(reserve_coin_price(COIN, 0, 0, COIN), 500000000000u);
+  // equity below zero
+  EXPECT_EQ(reserve_coin_price(COIN, 2 * COIN, COIN, COIN), 500000000000u);
+  // price above 2^64
+  EXPECT_EQ(reserve_coin_price(uint128_t(1) << 100, 0, 1, COIN), 0u);
+  EXPECT_EQ(reserve_coin_price_quad(uint128_t(1) << 100, 0, 1, COIN), 0u);
+
+  // no stables is an infinite ratio
+  EXPECT_EQ(compare_reserve_ratio(COIN, 0, COIN, 8), 1);
+  EXPECT_EQ(compare_reserve_ratio(0, COIN, COIN, 1), -1);
+  // tallies past 64 bits
+  expect_same_comparisons(uint128_t(4) << 80, uint128_t(1) << 80, COIN);
+  expect_same_comparisons((uint128_t(4) << 80) - 1, uint128_t(1) << 80, COIN);
+}
@@ -1278,4 +1278,41 @@ TEST(ringct, aggregated)
   {
     ASSERT_TRUE(rct::verRctSemanticsSimple(*sp[n]));
   }
+
+  // same checks, with all range proofs verified together
+  const std::string asset_type = "ZEPH";
+  const oracle::pricing_record pr;
+  const std::vector<cryptonote::tx_out> vout;
+  const std::vector<cryptonote::txin_v> vin;
+  std::vector<rct::semantics_data> batch;
+  for (size_t n = 0; n < N_PROOFS; ++n)
+    batch.push_back({sp[n], &pr, cryptonote::transaction_type::TRANSFER, &asset_type, &asset_type, 0, &vout, &vin});
+  ASSERT_TRUE(rct::verRctSemanticsSimple(batch, 0));
+}
+
+TEST(ringct, conversion_context)
+{
+  oracle::pricing_record pr;
+  pr.stable = pr.stable_ma = 1500000000000;
+  pr.reserve = pr.reserve_ma = 600000000000;
+
+  std::shared_ptr<const rct::conversion_context> ctx = rct::get_conversion_context(pr);
+  ASSERT_TRUE(ctx != nullptr);
+  ASSERT_EQ(ctx, rct::get_conversion_context(pr));
+  ASSERT_TRUE(rct::equalKeys(ctx->atomic, rct::d2h(COIN)));
+
+  // REDEEM_STABLE scales by stable less the 2% fee, rounded down to 10000
+  const uint64_t rate = 1470000000000;
+  rct::key one;
+  sc_mul(one.bytes, ctx->get_inverse_rate(cryptonote::transaction_type::REDEEM_STABLE).bytes, rct::d2h(rate).bytes);
+  ASSERT_TRUE(rct::equalKeys(one, rct::d2h(1)));
+  ASSERT_THROW(ctx->get_inverse_rate(cryptonote::transaction_type::TRANSFER), std::exception);
+
+  // a zero rate is only an error for the conversions that use it
+  oracle::pricing_record no_reserve = pr;
+  no_reserve.reserve = no_reserve.reserve_ma = 0;
+  std::shared_ptr<const rct::conversion_context> partial = rct::get_conversion_context(no_reserve);
+  ASSERT_NE(ctx, partial);
+  ASSERT_NO_THROW(partial->get_inverse_rate(cryptonote::transaction_type::MINT_STABLE));
+  ASSERT_THROW(partial->get_inverse_rate(cryptonote::transaction_type::MINT_RESERVE), std::exception);
 }
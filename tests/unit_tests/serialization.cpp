@@ -1156,3 +1156,29 @@ TEST(Serialization, difficulty_type)
 
   ASSERT_EQ(v_original, v_unserialized);
 }
+
+TEST(Serialization, txout_asset_id)
+{
+  cryptonote::tx_out out;
+  out.amount = 0;
+  out.target = cryptonote::txout_zephyr_tagged_key(crypto::public_key{}, oracle::asset_id::ZEPHUSD, crypto::view_tag{});
+
+  cryptonote::blobdata blob;
+  ASSERT_TRUE(serialization::dump_binary(out, blob));
+  ASSERT_NE(blob.find("ZEPHUSD"), std::string::npos);
+
+  cryptonote::tx_out out2;
+  ASSERT_TRUE(serialization::parse_binary(blob, out2));
+  ASSERT_EQ(boost::get<cryptonote::txout_zephyr_tagged_key>(out2.target).asset_type, oracle::asset_id::ZEPHUSD);
+  cryptonote::blobdata blob2;
+  ASSERT_TRUE(serialization::dump_binary(out2, blob2));
+  ASSERT_EQ(blob, blob2);
+
+  // asset types other than the known ones fail to parse
+  blob.replace(blob.find("ZEPHUSD"), 7, "ZEPHEUR");
+  ASSERT_FALSE(serialization::parse_binary(blob, out2));
+
+  // and an unset asset id fails to serialize
+  boost::get<cryptonote::txout_zephyr_tagged_key>(out.target).asset_type = oracle::asset_id::invalid;
+  ASSERT_FALSE(serialization::dump_binary(out, blob));
+}
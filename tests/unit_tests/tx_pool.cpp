@@ -0,0 +1,330 @@
+// Copyright (c) 2023, Zephyr Protocol
+// Portions copyright (c) 2016-2019, The Monero Project
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#define IN_UNIT_TESTS
+
+#include <cstring>
+#include <map>
+#include "gtest/gtest.h"
+#include "cryptonote_basic/cryptonote_format_utils.h"
+#include "cryptonote_core/blockchain.h"
+#include "cryptonote_core/tx_pool.h"
+#include "cryptonote_core/cryptonote_core.h"
+#include "blockchain_db/testdb.h"
+
+namespace
+{
+  struct BlockchainAndPool
+  {
+    cryptonote::tx_memory_pool txpool;
+    cryptonote::Blockchain bc;
+    cryptonote::TxpoolTestDB *db;
+    const std::pair<uint8_t, uint64_t> hard_forks[2];
+    const cryptonote::test_options test_options;
+
+    BlockchainAndPool(const cryptonote::circ_supply_snapshot &circ_supply = cryptonote::circ_supply_snapshot()): txpool(bc), bc(txpool), db(new cryptonote::TxpoolTestDB()),
+      hard_forks{std::make_pair((uint8_t)1, (uint64_t)0), std::make_pair((uint8_t)0, (uint64_t)0)},
+      test_options{hard_forks, CRYPTONOTE_LONG_TERM_BLOCK_WEIGHT_WINDOW_SIZE}
+    {
+      // the blockchain caches the supply at init
+      db->m_circ_supply = circ_supply;
+      // the blockchain takes ownership of the db
+      bc.init(db, cryptonote::FAKECHAIN, true, &test_options, 0, NULL);
+    }
+  };
+
+  cryptonote::transaction make_tx(uint8_t n, const std::string &source = "ZEPH", const std::string &dest = "ZEPH")
+  {
+    cryptonote::transaction tx;
+    tx.version = 2;
+    tx.unlock_time = 0;
+    cryptonote::txin_zephyr_key in;
+    in.amount = 0;
+    in.asset_type = source;
+    in.key_offsets.push_back(1);
+    std::memset(&in.k_image, 0, sizeof(in.k_image));
+    in.k_image.data[0] = n;
+    tx.vin.push_back(in);
+    cryptonote::tx_out out;
+    out.amount = 0;
+    out.target = cryptonote::txout_zephyr_tagged_key(crypto::public_key{}, oracle::get_asset_id(dest), crypto::view_tag{});
+    tx.vout.push_back(out);
+    tx.pricing_record_height = 0;
+    tx.amount_burnt = 0;
+    tx.amount_minted = 0;
+    tx.rct_signatures.type = rct::RCTTypeNull;
+    return tx;
+  }
+
+  cryptonote::transaction make_conversion(uint8_t n, cryptonote::transaction_type tx_type, uint64_t pr_height, uint64_t amount)
+  {
+    static const std::map<cryptonote::transaction_type, std::pair<std::string, std::string>> assets = {
+      {cryptonote::transaction_type::MINT_STABLE, {"ZEPH", "ZEPHUSD"}},
+      {cryptonote::transaction_type::REDEEM_STABLE, {"ZEPHUSD", "ZEPH"}},
+      {cryptonote::transaction_type::MINT_RESERVE, {"ZEPH", "ZEPHRSV"}},
+      {cryptonote::transaction_type::REDEEM_RESERVE, {"ZEPHRSV", "ZEPH"}},
+    };
+    const auto &a = assets.at(tx_type);
+    cryptonote::transaction tx = make_tx(n, a.first, a.second);
+    tx.pricing_record_height = pr_height;
+    // all rates are 1 in the tests' pricing records
+    tx.amount_burnt = amount;
+    tx.amount_minted = amount;
+    return tx;
+  }
+
+  oracle::pricing_record make_pricing_record()
+  {
+    oracle::pricing_record pr;
+    pr.spot = COIN;
+    pr.moving_average = COIN;
+    pr.stable = COIN;
+    pr.stable_ma = COIN;
+    pr.reserve = COIN;
+    pr.reserve_ma = COIN;
+    pr.timestamp = 1;
+    return pr;
+  }
+
+  // 1000 ZEPH in the reserve against 100 stables: reserve ratio 10
+  cryptonote::circ_supply_snapshot make_circ_supply()
+  {
+    cryptonote::circ_supply_snapshot circ_supply;
+    circ_supply.tally[cryptonote::circ_supply_snapshot::ZEPH] = 1000 * COIN;
+    circ_supply.tally[cryptonote::circ_supply_snapshot::ZEPHUSD] = 100 * COIN;
+    circ_supply.tally[cryptonote::circ_supply_snapshot::ZEPHRSV] = 1000 * COIN;
+    return circ_supply;
+  }
+
+  cryptonote::conversion_status get_status(const std::vector<cryptonote::tx_memory_pool::conversion_info> &conversions, const crypto::hash &txid)
+  {
+    for (const auto &c: conversions)
+      if (c.txid == txid)
+        return c.status;
+    throw std::runtime_error("conversion not found");
+  }
+
+  crypto::hash add_to_pool(cryptonote::TxpoolTestDB &db, const cryptonote::transaction &tx, cryptonote::relay_method method, uint64_t fee, uint64_t weight, uint64_t receive_time, cryptonote::transaction_type tx_type = cryptonote::transaction_type::TRANSFER)
+  {
+    const cryptonote::blobdata blob = cryptonote::t_serializable_object_to_blob(tx);
+    const crypto::hash txid = cryptonote::get_transaction_hash(tx);
+    cryptonote::txpool_tx_meta_t meta{};
+    meta.weight = weight;
+    meta.fee = fee;
+    meta.receive_time = receive_time;
+    meta.last_relayed_time = receive_time;
+    meta.relayed = method != cryptonote::relay_method::local;
+    meta.set_relay_method(method);
+    std::strncpy(meta.fee_asset_type, "ZEPH", sizeof(meta.fee_asset_type));
+    meta.tx_type = (uint8_t)tx_type;
+    db.add_txpool_tx(txid, blob, meta);
+    return txid;
+  }
+}
+
+TEST(tx_pool, snapshot_reads)
+{
+  BlockchainAndPool bap;
+  const crypto::hash low = add_to_pool(*bap.db, make_tx(1), cryptonote::relay_method::fluff, 1000, 1000, 100);
+  const crypto::hash high = add_to_pool(*bap.db, make_tx(2), cryptonote::relay_method::fluff, 4000, 1000, 200);
+  const crypto::hash local = add_to_pool(*bap.db, make_tx(3), cryptonote::relay_method::local, 2000, 1000, 300);
+  ASSERT_TRUE(bap.txpool.init());
+
+  ASSERT_EQ(bap.txpool.get_transactions_count(false), 2);
+  ASSERT_EQ(bap.txpool.get_transactions_count(true), 3);
+
+  // best paying first, local txes only with sensitive data
+  std::vector<crypto::hash> hashes;
+  bap.txpool.get_transaction_hashes(hashes, false);
+  ASSERT_EQ(hashes, std::vector<crypto::hash>({high, low}));
+  hashes.clear();
+  bap.txpool.get_transaction_hashes(hashes, true);
+  ASSERT_EQ(hashes, std::vector<crypto::hash>({high, local, low}));
+
+  std::vector<cryptonote::tx_info> infos;
+  std::vector<cryptonote::spent_key_image_info> key_images;
+  ASSERT_TRUE(bap.txpool.get_transactions_and_spent_keys_info(infos, key_images, false));
+  ASSERT_EQ(infos.size(), 2);
+  ASSERT_EQ(key_images.size(), 2);
+  for (const cryptonote::tx_info &info: infos)
+  {
+    ASSERT_NE(info.id_hash, epee::string_tools::pod_to_hex(local));
+    ASSERT_EQ(info.receive_time, 0);
+    ASSERT_EQ(info.last_relayed_time, 0);
+    ASSERT_FALSE(info.tx_json.empty());
+  }
+
+  infos.clear();
+  key_images.clear();
+  ASSERT_TRUE(bap.txpool.get_transactions_and_spent_keys_info(infos, key_images, true));
+  ASSERT_EQ(infos.size(), 3);
+  ASSERT_EQ(key_images.size(), 3);
+  for (const cryptonote::tx_info &info: infos)
+    ASSERT_NE(info.receive_time, 0);
+
+  // relaying the local tx makes it public
+  std::vector<bool> just_broadcasted;
+  bap.txpool.set_relayed(epee::span<const crypto::hash>(&local, 1), cryptonote::relay_method::fluff, just_broadcasted);
+  ASSERT_EQ(just_broadcasted, std::vector<bool>({true}));
+  ASSERT_EQ(bap.txpool.get_transactions_count(false), 3);
+  hashes.clear();
+  bap.txpool.get_transaction_hashes(hashes, false);
+  ASSERT_EQ(hashes.size(), 3);
+  infos.clear();
+  key_images.clear();
+  ASSERT_TRUE(bap.txpool.get_transactions_and_spent_keys_info(infos, key_images, false));
+  ASSERT_EQ(infos.size(), 3);
+  ASSERT_EQ(key_images.size(), 3);
+}
+
+TEST(tx_pool, info_snapshot_follows_metadata_updates)
+{
+  BlockchainAndPool bap;
+  const crypto::hash txid = add_to_pool(*bap.db, make_tx(1), cryptonote::relay_method::fluff, 1000, 1000, 100);
+  ASSERT_TRUE(bap.txpool.init());
+
+  std::vector<cryptonote::tx_info> infos;
+  std::vector<cryptonote::spent_key_image_info> key_images;
+  ASSERT_TRUE(bap.txpool.get_transactions_and_spent_keys_info(infos, key_images, true));
+  ASSERT_EQ(infos.size(), 1);
+  ASSERT_EQ(infos[0].last_relayed_time, 100);
+
+  // relaying again only updates the metadata, the pool cookie stays put
+  const uint64_t cookie = bap.txpool.cookie();
+  std::vector<bool> just_broadcasted;
+  bap.txpool.set_relayed(epee::span<const crypto::hash>(&txid, 1), cryptonote::relay_method::fluff, just_broadcasted);
+  ASSERT_EQ(just_broadcasted, std::vector<bool>({false}));
+  ASSERT_EQ(bap.txpool.cookie(), cookie);
+
+  cryptonote::txpool_tx_meta_t meta;
+  ASSERT_TRUE(bap.db->get_txpool_tx_meta(txid, meta));
+  ASSERT_NE(meta.last_relayed_time, 100);
+  infos.clear();
+  key_images.clear();
+  ASSERT_TRUE(bap.txpool.get_transactions_and_spent_keys_info(infos, key_images, true));
+  ASSERT_EQ(infos.size(), 1);
+  ASSERT_EQ(infos[0].last_relayed_time, meta.last_relayed_time);
+}
+
+TEST(tx_pool, conversion_status_transitions)
+{
+  BlockchainAndPool bap(make_circ_supply());
+  for (uint64_t h = 0; h < 20; ++h)
+    bap.db->m_pricing_records[h] = make_pricing_record();
+  bap.db->m_height = 20;
+
+  using cryptonote::transaction_type;
+  using cryptonote::conversion_status;
+  const crypto::hash too_new = add_to_pool(*bap.db, make_conversion(1, transaction_type::REDEEM_STABLE, 25, 10 * COIN), cryptonote::relay_method::fluff, 1000, 1000, 100, transaction_type::REDEEM_STABLE);
+  const crypto::hash eligible = add_to_pool(*bap.db, make_conversion(2, transaction_type::REDEEM_STABLE, 15, 10 * COIN), cryptonote::relay_method::fluff, 1000, 1000, 100, transaction_type::REDEEM_STABLE);
+  const crypto::hash too_old = add_to_pool(*bap.db, make_conversion(3, transaction_type::REDEEM_STABLE, 5, 10 * COIN), cryptonote::relay_method::fluff, 1000, 1000, 100, transaction_type::REDEEM_STABLE);
+  const crypto::hash ratio = add_to_pool(*bap.db, make_conversion(4, transaction_type::MINT_STABLE, 15, 1000 * COIN), cryptonote::relay_method::fluff, 1000, 1000, 100, transaction_type::MINT_STABLE);
+  const crypto::hash no_pr = add_to_pool(*bap.db, make_conversion(5, transaction_type::REDEEM_STABLE, 35, 10 * COIN), cryptonote::relay_method::fluff, 1000, 1000, 100, transaction_type::REDEEM_STABLE);
+  const crypto::hash local = add_to_pool(*bap.db, make_conversion(6, transaction_type::REDEEM_STABLE, 15, 10 * COIN), cryptonote::relay_method::local, 1000, 1000, 100, transaction_type::REDEEM_STABLE);
+  add_to_pool(*bap.db, make_tx(7), cryptonote::relay_method::fluff, 1000, 1000, 100);
+  ASSERT_TRUE(bap.txpool.init());
+
+  // by pricing record height, transfers and local txes left out
+  std::vector<cryptonote::tx_memory_pool::conversion_info> conversions;
+  bap.txpool.get_conversions(conversions, false);
+  ASSERT_EQ(conversions.size(), 5);
+  for (size_t i = 1; i < conversions.size(); ++i)
+    ASSERT_LE(conversions[i - 1].pricing_record_height, conversions[i].pricing_record_height);
+  ASSERT_EQ(conversions.front().txid, too_old);
+  ASSERT_EQ(conversions.back().txid, no_pr);
+  ASSERT_EQ(get_status(conversions, too_new), conversion_status::pr_too_new);
+  ASSERT_EQ(get_status(conversions, eligible), conversion_status::eligible);
+  ASSERT_EQ(get_status(conversions, too_old), conversion_status::pr_too_old);
+  ASSERT_EQ(get_status(conversions, ratio), conversion_status::reserve_ratio);
+  ASSERT_EQ(get_status(conversions, no_pr), conversion_status::pr_too_new);
+  bap.txpool.get_conversions(conversions, true);
+  ASSERT_EQ(conversions.size(), 6);
+  ASSERT_EQ(get_status(conversions, local), conversion_status::eligible);
+
+  // the statuses are written through to the metadata
+  cryptonote::txpool_tx_meta_t meta;
+  ASSERT_TRUE(bap.db->get_txpool_tx_meta(ratio, meta));
+  ASSERT_EQ(meta.conversion_status, (uint8_t)conversion_status::reserve_ratio);
+
+  // the chain grows past some pricing records
+  bap.db->m_height = 26;
+  ASSERT_TRUE(bap.txpool.on_blockchain_inc(26, crypto::null_hash));
+  bap.txpool.get_conversions(conversions, false);
+  ASSERT_EQ(get_status(conversions, too_new), conversion_status::eligible);
+  ASSERT_EQ(get_status(conversions, eligible), conversion_status::pr_too_old);
+  ASSERT_EQ(get_status(conversions, too_old), conversion_status::pr_too_old);
+  ASSERT_EQ(get_status(conversions, ratio), conversion_status::pr_too_old);
+  ASSERT_EQ(get_status(conversions, no_pr), conversion_status::pr_too_new);
+  ASSERT_TRUE(bap.db->get_txpool_tx_meta(too_new, meta));
+  ASSERT_EQ(meta.conversion_status, (uint8_t)conversion_status::eligible);
+
+  // no pricing records were added past height 20
+  bap.db->m_height = 40;
+  ASSERT_TRUE(bap.txpool.on_blockchain_inc(40, crypto::null_hash));
+  bap.txpool.get_conversions(conversions, false);
+  ASSERT_EQ(get_status(conversions, too_new), conversion_status::pr_too_old);
+  ASSERT_EQ(get_status(conversions, no_pr), conversion_status::no_pricing_record);
+}
+
+TEST(tx_pool, conversion_status_reorg)
+{
+  BlockchainAndPool bap(make_circ_supply());
+  for (uint64_t h = 0; h < 30; ++h)
+    bap.db->m_pricing_records[h] = make_pricing_record();
+  bap.db->m_height = 26;
+
+  using cryptonote::transaction_type;
+  using cryptonote::conversion_status;
+  const crypto::hash old_pr = add_to_pool(*bap.db, make_conversion(1, transaction_type::REDEEM_STABLE, 5, 10 * COIN), cryptonote::relay_method::fluff, 1000, 1000, 100, transaction_type::REDEEM_STABLE);
+  const crypto::hash recent_pr = add_to_pool(*bap.db, make_conversion(2, transaction_type::REDEEM_STABLE, 20, 10 * COIN), cryptonote::relay_method::fluff, 1000, 1000, 100, transaction_type::REDEEM_STABLE);
+  ASSERT_TRUE(bap.txpool.init());
+
+  std::vector<cryptonote::tx_memory_pool::conversion_info> conversions;
+  bap.txpool.get_conversions(conversions, false);
+  ASSERT_EQ(get_status(conversions, old_pr), conversion_status::pr_too_old);
+  ASSERT_EQ(get_status(conversions, recent_pr), conversion_status::eligible);
+
+  // growing the chain never brings an old pricing record back
+  bap.db->m_height = 27;
+  ASSERT_TRUE(bap.txpool.on_blockchain_inc(27, crypto::null_hash));
+  bap.txpool.get_conversions(conversions, false);
+  ASSERT_EQ(get_status(conversions, old_pr), conversion_status::pr_too_old);
+
+  // but a reorg deep enough does, and makes the recent one too new
+  bap.db->m_height = 14;
+  ASSERT_TRUE(bap.txpool.on_blockchain_dec(14, crypto::null_hash));
+  bap.txpool.get_conversions(conversions, false);
+  ASSERT_EQ(get_status(conversions, old_pr), conversion_status::eligible);
+  ASSERT_EQ(get_status(conversions, recent_pr), conversion_status::pr_too_new);
+  cryptonote::txpool_tx_meta_t meta;
+  ASSERT_TRUE(bap.db->get_txpool_tx_meta(old_pr, meta));
+  ASSERT_EQ(meta.conversion_status, (uint8_t)conversion_status::eligible);
+  ASSERT_TRUE(bap.db->get_txpool_tx_meta(recent_pr, meta));
+  ASSERT_EQ(meta.conversion_status, (uint8_t)conversion_status::pr_too_new);
+}
@@ -0,0 +1,127 @@
+// Copyright (c) 2023, Zephyr Protocol
+// Portions copyright (c) 2016-2019, The Monero Project
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <deque>
+#include "gtest/gtest.h"
+
+#include "ringct/rctOps.h"
+#include "ringct/rctSigs.h"
+#include "cryptonote_basic/cryptonote_basic.h"
+#include "cryptonote_config.h"
+
+namespace
+{
+  // outputs and range proofs are left out, the inputs only pay the fee
+  rct::rctSig make_rct(uint64_t fee)
+  {
+    rct::rctSig rv;
+    rv.type = rct::RCTTypeBulletproofPlus;
+    rv.txnFee = fee;
+    rv.p.pseudoOuts.push_back(rct::scalarmultH(rct::d2h(fee)));
+    rv.p.CLSAGs.resize(1);
+    return rv;
+  }
+
+  oracle::pricing_record make_pricing_record()
+  {
+    oracle::pricing_record pr;
+    pr.spot = COIN;
+    pr.moving_average = COIN;
+    pr.stable = COIN;
+    pr.stable_ma = COIN;
+    pr.reserve = COIN;
+    pr.reserve_ma = COIN;
+    pr.timestamp = 1;
+    return pr;
+  }
+
+  struct semantics_batch
+  {
+    const std::string zeph = "ZEPH";
+    const std::string zephusd = "ZEPHUSD";
+    const oracle::pricing_record empty_pr;
+    const oracle::pricing_record pr = make_pricing_record();
+    const std::vector<cryptonote::tx_out> vout;
+    const std::vector<cryptonote::txin_v> vin;
+    std::deque<rct::rctSig> sigs;
+    std::vector<rct::semantics_data> txs;
+
+    void add_transfer(uint64_t fee)
+    {
+      sigs.push_back(make_rct(fee));
+      txs.push_back({&sigs.back(), &empty_pr, cryptonote::transaction_type::TRANSFER, &zeph, &zeph, 0, &vout, &vin});
+    }
+
+    // the inputs only cover the fee, so nothing was actually burnt
+    void add_unbacked_conversion(uint64_t fee, uint64_t amount_burnt)
+    {
+      sigs.push_back(make_rct(fee));
+      sigs.back().maskSums = {rct::skGen(), rct::zero()};
+      txs.push_back({&sigs.back(), &pr, cryptonote::transaction_type::MINT_STABLE, &zeph, &zephusd, amount_burnt, &vout, &vin});
+    }
+  };
+}
+
+TEST(ver_rct_semantics_simple, batch_passes)
+{
+  semantics_batch batch;
+  for (uint64_t fee = 1; fee <= 4; ++fee)
+    batch.add_transfer(fee * 1000);
+
+  std::vector<bool> failed;
+  ASSERT_TRUE(rct::verRctSemanticsSimple(batch.txs, HF_VERSION_DJED, &failed));
+  ASSERT_EQ(failed, std::vector<bool>(4, false));
+  ASSERT_TRUE(rct::verRctSemanticsSimple(batch.txs, HF_VERSION_DJED));
+}
+
+TEST(ver_rct_semantics_simple, batch_finds_bad_conversion)
+{
+  semantics_batch batch;
+  batch.add_transfer(1000);
+  batch.add_transfer(2000);
+  batch.add_unbacked_conversion(3000, 10 * COIN);
+  batch.add_transfer(4000);
+
+  // the conversion fails on its own, the transfers do not
+  const rct::semantics_data &conversion = batch.txs[2];
+  ASSERT_FALSE(rct::verRctSemanticsSimple(*conversion.rv, *conversion.pr, conversion.tx_type, *conversion.source, *conversion.dest, conversion.amount_burnt, *conversion.vout, *conversion.vin, HF_VERSION_DJED));
+  const rct::semantics_data &transfer = batch.txs[3];
+  ASSERT_TRUE(rct::verRctSemanticsSimple(*transfer.rv, *transfer.pr, transfer.tx_type, *transfer.source, *transfer.dest, transfer.amount_burnt, *transfer.vout, *transfer.vin, HF_VERSION_DJED));
+
+  std::vector<bool> failed;
+  ASSERT_FALSE(rct::verRctSemanticsSimple(batch.txs, HF_VERSION_DJED, &failed));
+  ASSERT_EQ(failed, std::vector<bool>({false, false, true, false}));
+  ASSERT_FALSE(rct::verRctSemanticsSimple(batch.txs, HF_VERSION_DJED));
+
+  // a conversion without an acceptable pricing record is bad too
+  batch.txs[1] = batch.txs[2];
+  batch.txs[1].pr = &batch.empty_pr;
+  ASSERT_FALSE(rct::verRctSemanticsSimple(batch.txs, HF_VERSION_DJED, &failed));
+  ASSERT_EQ(failed, std::vector<bool>({false, true, true, false}));
+}
@@ -0,0 +1,387 @@
+// Copyright (c) 2023, Zephyr Protocol
+// Portions copyright (c) 2016-2019, The Monero Project
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "gtest/gtest.h"
+
+#include <boost/filesystem.hpp>
+#include "file_io_utils.h"
+#include "wallet_test_daemon.h"
+#include "serialization/binary_utils.h"
+
+namespace
+{
+  const uint64_t chain_height = 100;
+  const uint64_t outs_per_block = 4;
+  const epee::wipeable_string password("journal");
+
+  class wallet_cache_journal: public ::testing::Test
+  {
+  protected:
+    wallet_cache_journal():
+      m_dir(boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()),
+      m_daemon(chain_height, outs_per_block),
+      m_wallet(cryptonote::MAINNET, 1, true, m_daemon.client_factory()),
+      m_outputs(0)
+    {
+      boost::filesystem::create_directories(m_dir);
+      m_wallet_file = (m_dir / "wallet").string();
+      m_journal_file = m_wallet_file + ".journal";
+      m_wallet.generate(m_wallet_file, password);
+      m_daemon.sync(m_wallet);
+    }
+
+    ~wallet_cache_journal()
+    {
+      boost::system::error_code e;
+      boost::filesystem::remove_all(m_dir, e);
+    }
+
+    // writes the whole cache, as the first store after loading a wallet does
+    void store_full()
+    {
+      wallet_accessor_test::get_cache_journal(&m_wallet).compact = true;
+      m_wallet.store();
+    }
+
+    // a bit of everything a refresh or a transfer changes
+    void change()
+    {
+      const uint64_t n = m_outputs++;
+      m_daemon.add_output(m_wallet, 8 + n, COIN + n);
+
+      const crypto::hash txid = crypto::rand<crypto::hash>();
+      wallet_accessor_test::get_tx_keys(&m_wallet)[txid] = rct::rct2sk(rct::skGen());
+      wallet_accessor_test::get_additional_tx_keys(&m_wallet)[txid] = {rct::rct2sk(rct::skGen()), rct::rct2sk(rct::skGen())};
+      tools::wallet2::unconfirmed_transfer_details utd = AUTO_VAL_INIT(utd);
+      utd.m_amount_in = COIN + n;
+      utd.m_state = tools::wallet2::unconfirmed_transfer_details::pending;
+      wallet_accessor_test::get_unconfirmed_txs(&m_wallet)[txid] = utd;
+      wallet_accessor_test::get_cold_key_images(&m_wallet)[rct::rct2pk(rct::pkGen())] = rct::rct2ki(rct::pkGen());
+      wallet_accessor_test::get_scanned_pool_txs(&m_wallet, 0).insert(txid);
+
+      // and some of what was there already changes or goes away
+      if (n > 0)
+      {
+        m_wallet.freeze(n - 1);
+        auto &tx_keys = wallet_accessor_test::get_tx_keys(&m_wallet);
+        tx_keys.erase(tx_keys.begin());
+        auto &unconfirmed_txs = wallet_accessor_test::get_unconfirmed_txs(&m_wallet);
+        unconfirmed_txs.begin()->second.m_state = tools::wallet2::unconfirmed_transfer_details::failed;
+        std::swap(wallet_accessor_test::get_scanned_pool_txs(&m_wallet, 0), wallet_accessor_test::get_scanned_pool_txs(&m_wallet, 1));
+      }
+    }
+
+    void add_payment(uint64_t height)
+    {
+      tools::wallet2::payment_details pd = AUTO_VAL_INIT(pd);
+      pd.m_tx_hash = crypto::rand<crypto::hash>();
+      pd.m_amount = COIN;
+      pd.m_asset_type = "ZEPH";
+      pd.m_block_height = height;
+      wallet_accessor_test::get_payments(&m_wallet).emplace(crypto::rand<crypto::hash>(), pd);
+
+      tools::wallet2::confirmed_transfer_details ctd;
+      ctd.m_block_height = height;
+      ctd.m_source_asset = "ZEPH";
+      wallet_accessor_test::get_confirmed_txs(&m_wallet)[pd.m_tx_hash] = ctd;
+    }
+
+    std::unique_ptr<tools::wallet2> load() const
+    {
+      std::unique_ptr<tools::wallet2> wallet(new tools::wallet2(cryptonote::MAINNET, 1, true));
+      wallet->load(m_wallet_file, password);
+      return wallet;
+    }
+
+    const auto &journal() { return wallet_accessor_test::get_cache_journal(&m_wallet); }
+
+    std::string read_journal() const
+    {
+      std::string buf;
+      EXPECT_TRUE(epee::file_io_utils::load_file_to_string(m_journal_file, buf));
+      return buf;
+    }
+
+    void write_journal(const std::string &buf) const
+    {
+      ASSERT_TRUE(epee::file_io_utils::save_string_to_file(m_journal_file, buf));
+    }
+
+    boost::filesystem::path m_dir;
+    std::string m_wallet_file;
+    std::string m_journal_file;
+    unit_test::test_daemon m_daemon;
+    tools::wallet2 m_wallet;
+    uint64_t m_outputs;
+  };
+
+  template<typename M>
+  std::unordered_set<typename M::key_type> get_keys(const M &m)
+  {
+    std::unordered_set<typename M::key_type> keys;
+    for (const auto &e: m)
+      keys.insert(e.first);
+    return keys;
+  }
+
+  template<typename T>
+  std::string to_blob(const T &v)
+  {
+    std::string blob;
+    EXPECT_TRUE(::serialization::dump_binary(const_cast<T&>(v), blob));
+    return blob;
+  }
+
+  template<typename M>
+  void check_same_values(const M &a, const M &b)
+  {
+    ASSERT_EQ(a.size(), b.size());
+    for (const auto &e: a)
+    {
+      const auto i = b.find(e.first);
+      ASSERT_TRUE(i != b.end());
+      ASSERT_EQ(to_blob(e.second), to_blob(i->second));
+    }
+  }
+
+  void check_same_cache(tools::wallet2 &a, tools::wallet2 &b)
+  {
+    ASSERT_EQ(a.get_num_transfer_details(), b.get_num_transfer_details());
+    for (size_t i = 0; i < a.get_num_transfer_details(); ++i)
+      ASSERT_EQ(wallet_accessor_test::get_cache_fingerprint(a.get_transfer_details(i)), wallet_accessor_test::get_cache_fingerprint(b.get_transfer_details(i)));
+    ASSERT_EQ(wallet_accessor_test::get_key_images(&a), wallet_accessor_test::get_key_images(&b));
+    ASSERT_EQ(wallet_accessor_test::get_pub_keys(&a), wallet_accessor_test::get_pub_keys(&b));
+
+    const auto &chain_a = wallet_accessor_test::get_blockchain(&a);
+    const auto &chain_b = wallet_accessor_test::get_blockchain(&b);
+    ASSERT_EQ(chain_a.offset(), chain_b.offset());
+    ASSERT_EQ(chain_a.size(), chain_b.size());
+    for (size_t h = chain_a.offset(); h < chain_a.size(); ++h)
+      ASSERT_EQ(chain_a[h], chain_b[h]);
+
+    ASSERT_EQ(wallet_accessor_test::get_payments(&a).size(), wallet_accessor_test::get_payments(&b).size());
+    ASSERT_EQ(get_keys(wallet_accessor_test::get_payments(&a)), get_keys(wallet_accessor_test::get_payments(&b)));
+    ASSERT_EQ(get_keys(wallet_accessor_test::get_confirmed_txs(&a)), get_keys(wallet_accessor_test::get_confirmed_txs(&b)));
+
+    check_same_values(wallet_accessor_test::get_unconfirmed_txs(&a), wallet_accessor_test::get_unconfirmed_txs(&b));
+    check_same_values(wallet_accessor_test::get_tx_keys(&a), wallet_accessor_test::get_tx_keys(&b));
+    check_same_values(wallet_accessor_test::get_additional_tx_keys(&a), wallet_accessor_test::get_additional_tx_keys(&b));
+    ASSERT_EQ(wallet_accessor_test::get_cold_key_images(&a), wallet_accessor_test::get_cold_key_images(&b));
+    ASSERT_EQ(wallet_accessor_test::get_scanned_pool_txs(&a, 0), wallet_accessor_test::get_scanned_pool_txs(&b, 0));
+    ASSERT_EQ(wallet_accessor_test::get_scanned_pool_txs(&a, 1), wallet_accessor_test::get_scanned_pool_txs(&b, 1));
+  }
+}
+
+TEST_F(wallet_cache_journal, round_trip)
+{
+  store_full();
+  ASSERT_FALSE(boost::filesystem::exists(m_journal_file));
+
+  change();
+  m_wallet.store();
+  ASSERT_EQ(journal().sequence, 1);
+  change();
+  change();
+  m_wallet.store();
+  ASSERT_EQ(journal().sequence, 2);
+  ASSERT_EQ(boost::filesystem::file_size(m_journal_file), journal().size);
+
+  std::unique_ptr<tools::wallet2> loaded = load();
+  check_same_cache(m_wallet, *loaded);
+  ASSERT_FALSE(wallet_accessor_test::get_cache_journal(loaded.get()).compact);
+  ASSERT_EQ(wallet_accessor_test::get_cache_journal(loaded.get()).sequence, 2);
+
+  // a store with nothing changed still appends, and the loaded wallet carries on the journal
+  loaded->store();
+  ASSERT_EQ(wallet_accessor_test::get_cache_journal(loaded.get()).sequence, 3);
+  check_same_cache(m_wallet, *load());
+}
+
+TEST_F(wallet_cache_journal, torn_last_record)
+{
+  store_full();
+  change();
+  m_wallet.store();
+  std::unique_ptr<tools::wallet2> expected = load();
+  change();
+  m_wallet.store();
+  ASSERT_EQ(journal().sequence, 2);
+
+  // as if the wallet died while appending the second record
+  const std::string buf = read_journal();
+  write_journal(buf.substr(0, buf.size() - 5));
+
+  std::unique_ptr<tools::wallet2> loaded = load();
+  check_same_cache(*expected, *loaded);
+  ASSERT_TRUE(wallet_accessor_test::get_cache_journal(loaded.get()).compact);
+
+  // which makes the next store write the full cache again
+  loaded->store();
+  ASSERT_FALSE(boost::filesystem::exists(m_journal_file));
+  check_same_cache(*expected, *load());
+}
+
+TEST_F(wallet_cache_journal, stale_snapshot)
+{
+  store_full();
+  change();
+  m_wallet.store();
+  const std::string stale = read_journal();
+
+  change();
+  store_full();
+  ASSERT_FALSE(boost::filesystem::exists(m_journal_file));
+
+  // a journal left over from before the full cache was written
+  write_journal(stale);
+  std::unique_ptr<tools::wallet2> loaded = load();
+  check_same_cache(m_wallet, *loaded);
+  ASSERT_TRUE(wallet_accessor_test::get_cache_journal(loaded.get()).compact);
+}
+
+TEST_F(wallet_cache_journal, sequence_gap)
+{
+  store_full();
+  std::unique_ptr<tools::wallet2> expected = load();
+  change();
+  m_wallet.store();
+  const uint64_t first_record_size = journal().size;
+  change();
+  m_wallet.store();
+  ASSERT_EQ(journal().sequence, 2);
+
+  // the second record alone does not apply on top of the full cache
+  write_journal(read_journal().substr(first_record_size));
+  std::unique_ptr<tools::wallet2> loaded = load();
+  check_same_cache(*expected, *loaded);
+  ASSERT_TRUE(wallet_accessor_test::get_cache_journal(loaded.get()).compact);
+}
+
+TEST_F(wallet_cache_journal, bad_count)
+{
+  store_full();
+  std::unique_ptr<tools::wallet2> expected = load();
+  add_payment(chain_height - 1);
+  change();
+  m_wallet.store();
+  ASSERT_EQ(journal().sequence, 1);
+
+  // a record which decrypts and parses, but whose counts are only found
+  // not to match once everything else in it was applied
+  tools::wallet2::cache_file_data data;
+  ASSERT_TRUE(::serialization::parse_binary(read_journal(), data));
+  const crypto::chacha_key &key = wallet_accessor_test::get_cache_key(&m_wallet);
+  std::string blob(data.cache_data.size(), '\0');
+  crypto::chacha20(data.cache_data.data(), data.cache_data.size(), key, data.iv, &blob[0]);
+  wallet_accessor_test::cache_journal_record record;
+  ASSERT_TRUE(::serialization::parse_binary(blob, record));
+  ++record.payments_count;
+  ASSERT_TRUE(::serialization::dump_binary(record, blob));
+  data.cache_data.resize(blob.size());
+  crypto::chacha20(blob.data(), blob.size(), key, data.iv, &data.cache_data[0]);
+  std::string frame;
+  ASSERT_TRUE(::serialization::dump_binary(data, frame));
+  write_journal(frame);
+
+  std::unique_ptr<tools::wallet2> loaded = load();
+  check_same_cache(*expected, *loaded);
+  ASSERT_TRUE(wallet_accessor_test::get_cache_journal(loaded.get()).compact);
+
+  // and the full cache written next is the one the journal was against
+  loaded->store();
+  ASSERT_FALSE(boost::filesystem::exists(m_journal_file));
+  check_same_cache(*expected, *load());
+}
+
+TEST_F(wallet_cache_journal, reorg_across_records)
+{
+  add_payment(50);
+  add_payment(chain_height - 2);
+  change();
+  store_full();
+
+  // new blocks, with an output and a payment in them
+  for (uint64_t h = chain_height; h < chain_height + 10; ++h)
+    wallet_accessor_test::push_block(&m_wallet, unit_test::test_daemon::get_block_hash(h));
+  m_daemon.add_output(m_wallet, (chain_height + 4) * outs_per_block, COIN);
+  add_payment(chain_height + 5);
+  m_wallet.store();
+  ASSERT_EQ(journal().sequence, 1);
+
+  // a reorg down into the blocks of the full cache, and another chain on top
+  wallet_accessor_test::detach_blockchain(&m_wallet, chain_height - 3);
+  for (uint64_t h = chain_height - 3; h < chain_height + 6; ++h)
+    wallet_accessor_test::push_block(&m_wallet, crypto::rand<crypto::hash>());
+  add_payment(chain_height - 1);
+  change();
+  m_wallet.store();
+  ASSERT_EQ(journal().sequence, 2);
+
+  // and a shallower one, within the last record
+  wallet_accessor_test::detach_blockchain(&m_wallet, chain_height + 2);
+  for (uint64_t h = chain_height + 2; h < chain_height + 4; ++h)
+    wallet_accessor_test::push_block(&m_wallet, crypto::rand<crypto::hash>());
+  m_wallet.store();
+  ASSERT_EQ(journal().sequence, 3);
+
+  std::unique_ptr<tools::wallet2> loaded = load();
+  check_same_cache(m_wallet, *loaded);
+  ASSERT_FALSE(wallet_accessor_test::get_cache_journal(loaded.get()).compact);
+  ASSERT_EQ(wallet_accessor_test::get_payments(loaded.get()).size(), 2);
+  ASSERT_EQ(wallet_accessor_test::get_blockchain(loaded.get()).size(), chain_height + 4);
+}
+
+TEST_F(wallet_cache_journal, compaction_threshold)
+{
+  store_full();
+  const uint64_t snapshot_size = journal().snapshot_size;
+  ASSERT_GT(snapshot_size, 0);
+
+  bool compacted = false;
+  for (int n = 0; n < 1000 && !compacted; ++n)
+  {
+    change();
+    const uint64_t journal_size = journal().size;
+    m_wallet.store();
+    if (journal().sequence == 0)
+    {
+      // the journal had grown as large as the cache, so the cache was written whole
+      ASSERT_GE(journal_size, snapshot_size);
+      ASSERT_FALSE(boost::filesystem::exists(m_journal_file));
+      ASSERT_NE(journal().snapshot_size, snapshot_size);
+      compacted = true;
+    }
+    else
+    {
+      ASSERT_LT(journal_size, snapshot_size);
+    }
+  }
+  ASSERT_TRUE(compacted);
+  check_same_cache(m_wallet, *load());
+}
@@ -0,0 +1,342 @@
+// Copyright (c) 2023, Zephyr Protocol
+// Portions copyright (c) 2016-2019, The Monero Project
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <boost/thread/mutex.hpp>
+#include <boost/utility/string_ref.hpp>
+
+#include "byte_slice.h"
+#include "net/abstract_http_client.h"
+#include "net/http_base.h"
+#include "net/jsonrpc_structs.h"
+#include "storages/portable_storage_template_helper.h"
+#include "string_tools.h"
+#include "cryptonote_basic/cryptonote_format_utils.h"
+#include "rpc/core_rpc_server_commands_defs.h"
+#include "ringct/rctOps.h"
+#include "wallet/wallet2.h"
+
+// Wallet friend, direct access to the state a refresh would have filled in
+class wallet_accessor_test
+{
+public:
+  static void set_blockchain(tools::wallet2 *wallet, const std::vector<crypto::hash> &hashes)
+  {
+    wallet->m_blockchain.clear();
+    for (const crypto::hash &hash: hashes)
+      wallet->m_blockchain.push_back(hash);
+  }
+
+  static void add_transfer(tools::wallet2 *wallet, const tools::wallet2::transfer_details &td)
+  {
+    wallet->m_key_images[td.m_key_image] = wallet->m_transfers.size();
+    wallet->m_pub_keys[td.get_public_key()] = wallet->m_transfers.size();
+    wallet->m_transfers.push_back(td);
+  }
+
+  static const std::unordered_map<crypto::public_key, cryptonote::subaddress_index> &get_subaddresses(const tools::wallet2 *wallet)
+  {
+    return wallet->m_subaddresses;
+  }
+
+  static void push_block(tools::wallet2 *wallet, const crypto::hash &hash) { wallet->m_blockchain.push_back(hash); }
+  static void detach_blockchain(tools::wallet2 *wallet, uint64_t height) { wallet->detach_blockchain(height); }
+  static uint64_t get_cache_fingerprint(const tools::wallet2::transfer_details &td) { return tools::wallet2::get_cache_fingerprint(td); }
+
+  static auto &get_blockchain(tools::wallet2 *wallet) { return wallet->m_blockchain; }
+  static auto &get_key_images(tools::wallet2 *wallet) { return wallet->m_key_images; }
+  static auto &get_pub_keys(tools::wallet2 *wallet) { return wallet->m_pub_keys; }
+  static auto &get_payments(tools::wallet2 *wallet) { return wallet->m_payments; }
+  static auto &get_confirmed_txs(tools::wallet2 *wallet) { return wallet->m_confirmed_txs; }
+  static auto &get_unconfirmed_txs(tools::wallet2 *wallet) { return wallet->m_unconfirmed_txs; }
+  static auto &get_tx_keys(tools::wallet2 *wallet) { return wallet->m_tx_keys; }
+  static auto &get_additional_tx_keys(tools::wallet2 *wallet) { return wallet->m_additional_tx_keys; }
+  static auto &get_cold_key_images(tools::wallet2 *wallet) { return wallet->m_cold_key_images; }
+  static auto &get_scanned_pool_txs(tools::wallet2 *wallet, size_t n) { return wallet->m_scanned_pool_txs[n]; }
+  static auto &get_cache_journal(tools::wallet2 *wallet) { return wallet->m_cache_journal; }
+  static const crypto::chacha_key &get_cache_key(const tools::wallet2 *wallet) { return wallet->m_cache_key; }
+
+  typedef tools::wallet2::cache_journal_record cache_journal_record;
+};
+
+namespace unit_test
+{
+  // A daemon in process, answering the RPCs a wallet makes to build a ZEPH
+  // transfer, for a chain of `height` blocks with `outs_per_block` ZEPH
+  // outputs each. Outputs given to add_output are served as they are, any
+  // other one gets a random key and commitment. Every call can be delayed,
+  // to stand in for the round trip to a remote node.
+  class test_daemon
+  {
+  public:
+    test_daemon(uint64_t height, uint64_t outs_per_block, std::chrono::milliseconds latency = std::chrono::milliseconds(0)):
+      m_height(height), m_outs_per_block(outs_per_block), m_latency(latency), m_calls(0)
+    {
+    }
+
+    std::unique_ptr<epee::net_utils::http::http_client_factory> client_factory();
+
+    static crypto::hash get_block_hash(uint64_t height)
+    {
+      return crypto::cn_fast_hash(&height, sizeof(height));
+    }
+
+    // gives the wallet the chain it would have after a refresh
+    void sync(tools::wallet2 &wallet) const
+    {
+      std::vector<crypto::hash> hashes;
+      for (uint64_t h = 0; h < m_height; ++h)
+        hashes.push_back(get_block_hash(h));
+      wallet_accessor_test::set_blockchain(&wallet, hashes);
+    }
+
+    // makes the output with this index one of the wallet's, as if received
+    void add_output(tools::wallet2 &wallet, uint64_t index, uint64_t amount)
+    {
+      hw::device &hwdev = hw::get_device("default");
+      const cryptonote::account_keys &keys = wallet.get_account().get_keys();
+      const cryptonote::keypair txkey = cryptonote::keypair::generate(hwdev);
+      crypto::key_derivation derivation;
+      crypto::public_key out_key;
+      crypto::view_tag view_tag;
+      CHECK_AND_ASSERT_THROW_MES(crypto::generate_key_derivation(keys.m_account_address.m_view_public_key, txkey.sec, derivation), "Failed to generate key derivation");
+      CHECK_AND_ASSERT_THROW_MES(crypto::derive_public_key(derivation, 0, keys.m_account_address.m_spend_public_key, out_key), "Failed to derive output key");
+      crypto::derive_view_tag(derivation, 0, view_tag);
+
+      tools::wallet2::transfer_details td = AUTO_VAL_INIT(td);
+      td.m_tx.version = 2;
+      cryptonote::tx_out out;
+      out.amount = 0;
+      out.target = cryptonote::txout_zephyr_tagged_key(out_key, oracle::asset_id::ZEPH, view_tag);
+      td.m_tx.vout.push_back(out);
+      cryptonote::add_tx_pub_key_to_extra(td.m_tx, txkey.pub);
+      td.m_block_height = index / m_outs_per_block;
+      td.m_txid = crypto::rand<crypto::hash>();
+      td.m_internal_output_index = 0;
+      td.m_global_output_index = index;
+      td.m_asset_type_output_index = index;
+      td.m_mask = rct::skGen();
+      td.m_amount = amount;
+      td.m_rct = true;
+      td.m_pk_index = 0;
+      td.m_subaddr_index = {0, 0};
+      td.asset_type = oracle::asset_id::ZEPH;
+      cryptonote::keypair in_ephemeral;
+      CHECK_AND_ASSERT_THROW_MES(cryptonote::generate_key_image_helper(keys, wallet_accessor_test::get_subaddresses(&wallet), out_key, txkey.pub, {}, 0, in_ephemeral, td.m_key_image, hwdev),
+          "Failed to generate key image");
+      td.m_key_image_known = true;
+      wallet_accessor_test::add_transfer(&wallet, td);
+
+      boost::unique_lock<boost::mutex> lock(m_mutex);
+      m_outputs[index] = {out_key, rct::commit(amount, td.m_mask)};
+    }
+
+    size_t get_call_count() const { return m_calls; }
+
+    bool handle(const boost::string_ref uri, const boost::string_ref body, std::string &reply)
+    {
+      if (m_latency.count() > 0)
+        std::this_thread::sleep_for(m_latency);
+      ++m_calls;
+
+      if (uri == "/json_rpc")
+      {
+        epee::json_rpc::request<epee::json_rpc::dummy_result> req;
+        if (!epee::serialization::load_t_from_json(req, std::string(body.data(), body.size())))
+          return false;
+        if (req.method == "get_info")
+        {
+          cryptonote::COMMAND_RPC_GET_INFO::response res = AUTO_VAL_INIT(res);
+          res.height = m_height;
+          res.target_height = m_height;
+          res.top_block_hash = epee::string_tools::pod_to_hex(get_block_hash(m_height - 1));
+          res.block_weight_limit = CRYPTONOTE_BLOCK_GRANTED_FULL_REWARD_ZONE_V5 * 2;
+          res.status = CORE_RPC_STATUS_OK;
+          return json_rpc_reply(req.id, res, reply);
+        }
+        if (req.method == "hard_fork_info")
+        {
+          cryptonote::COMMAND_RPC_HARD_FORK_INFO::response res = AUTO_VAL_INIT(res);
+          res.version = HF_VERSION_DJED;
+          res.enabled = true;
+          res.earliest_height = 0;
+          res.status = CORE_RPC_STATUS_OK;
+          return json_rpc_reply(req.id, res, reply);
+        }
+        if (req.method == "get_fee_estimate")
+        {
+          cryptonote::COMMAND_RPC_GET_BASE_FEE_ESTIMATE::response res = AUTO_VAL_INIT(res);
+          res.fee = FEE_PER_BYTE;
+          res.fees = {FEE_PER_BYTE, FEE_PER_BYTE * 5, FEE_PER_BYTE * 25, FEE_PER_BYTE * 1000};
+          res.quantization_mask = 1;
+          res.status = CORE_RPC_STATUS_OK;
+          return json_rpc_reply(req.id, res, reply);
+        }
+        if (req.method == "get_circulating_supply")
+        {
+          cryptonote::COMMAND_RPC_GET_CIRCULATING_SUPPLY::response res = AUTO_VAL_INIT(res);
+          for (const std::string &asset_type: oracle::ASSET_TYPES)
+            res.supply_tally.push_back({asset_type, std::to_string(m_height * COIN)});
+          res.height = m_height;
+          res.status = CORE_RPC_STATUS_OK;
+          return json_rpc_reply(req.id, res, reply);
+        }
+        return false;
+      }
+      if (uri == "/get_output_distribution.bin")
+      {
+        cryptonote::COMMAND_RPC_GET_OUTPUT_DISTRIBUTION::request req = AUTO_VAL_INIT(req);
+        if (!epee::serialization::load_t_from_binary(req, std::string(body.data(), body.size())))
+          return false;
+        cryptonote::COMMAND_RPC_GET_OUTPUT_DISTRIBUTION::response res = AUTO_VAL_INIT(res);
+        if (req.amounts != std::vector<uint64_t>{0} || req.rct_asset_type != "ZEPH" || req.from_height >= m_height)
+          return false;
+        cryptonote::COMMAND_RPC_GET_OUTPUT_DISTRIBUTION::distribution d = AUTO_VAL_INIT(d);
+        d.amount = 0;
+        d.binary = req.binary;
+        d.compress = req.compress;
+        d.data.start_height = req.from_height;
+        d.data.base = req.from_height * m_outs_per_block;
+        d.data.distribution.assign(m_height - req.from_height, m_outs_per_block);
+        d.data.num_spendable_global_outs = m_height * m_outs_per_block;
+        res.distributions.push_back(d);
+        res.status = CORE_RPC_STATUS_OK;
+        return bin_reply(res, reply);
+      }
+      if (uri == "/get_outs.bin")
+      {
+        cryptonote::COMMAND_RPC_GET_OUTPUTS_BIN::request req = AUTO_VAL_INIT(req);
+        if (!epee::serialization::load_t_from_binary(req, std::string(body.data(), body.size())))
+          return false;
+        cryptonote::COMMAND_RPC_GET_OUTPUTS_BIN::response res = AUTO_VAL_INIT(res);
+        boost::unique_lock<boost::mutex> lock(m_mutex);
+        for (const cryptonote::get_outputs_out &o: req.outputs)
+        {
+          if (o.amount != 0 || o.index >= m_height * m_outs_per_block)
+            return false;
+          auto it = m_outputs.find(o.index);
+          if (it == m_outputs.end())
+            it = m_outputs.insert({o.index, {rct::rct2pk(rct::pkGen()), rct::pkGen()}}).first;
+          cryptonote::COMMAND_RPC_GET_OUTPUTS_BIN::outkey out = AUTO_VAL_INIT(out);
+          out.key = it->second.first;
+          out.mask = it->second.second;
+          out.unlocked = true;
+          out.height = o.index / m_outs_per_block;
+          out.output_id = o.index;
+          res.outs.push_back(out);
+        }
+        res.status = CORE_RPC_STATUS_OK;
+        return bin_reply(res, reply);
+      }
+      return false;
+    }
+
+  private:
+    template<typename T>
+    static bool json_rpc_reply(const epee::serialization::storage_entry &id, const T &result, std::string &reply)
+    {
+      epee::json_rpc::response<T, epee::json_rpc::dummy_error> res;
+      res.jsonrpc = "2.0";
+      res.id = id;
+      res.result = result;
+      return epee::serialization::store_t_to_json(res, reply);
+    }
+
+    template<typename T>
+    static bool bin_reply(T &res, std::string &reply)
+    {
+      epee::byte_slice data;
+      if (!epee::serialization::store_t_to_binary(res, data))
+        return false;
+      reply.assign(reinterpret_cast<const char*>(data.data()), data.size());
+      return true;
+    }
+
+    const uint64_t m_height;
+    const uint64_t m_outs_per_block;
+    const std::chrono::milliseconds m_latency;
+    std::atomic<size_t> m_calls;
+    boost::mutex m_mutex;
+    std::map<uint64_t, std::pair<crypto::public_key, rct::key>> m_outputs;
+  };
+
+  class test_daemon_client: public epee::net_utils::http::abstract_http_client
+  {
+  public:
+    test_daemon_client(test_daemon &daemon): m_daemon(daemon) {}
+    void set_server(std::string host, std::string port, boost::optional<epee::net_utils::http::login> user, epee::net_utils::ssl_options_t ssl_options) override {}
+    void set_auto_connect(bool auto_connect) override {}
+    bool connect(std::chrono::milliseconds timeout) override { return true; }
+    bool disconnect() override { return true; }
+    bool is_connected(bool *ssl) override { if (ssl) *ssl = false; return true; }
+    bool invoke(const boost::string_ref uri, const boost::string_ref method, const boost::string_ref body, std::chrono::milliseconds timeout, const epee::net_utils::http::http_response_info** ppresponse_info, const epee::net_utils::http::fields_list& additional_params) override
+    {
+      m_response.m_body.clear();
+      m_response.m_response_code = m_daemon.handle(uri, body, m_response.m_body) ? 200 : 404;
+      if (ppresponse_info)
+        *ppresponse_info = &m_response;
+      return true;
+    }
+    bool invoke_get(const boost::string_ref uri, std::chrono::milliseconds timeout, const std::string& body, const epee::net_utils::http::http_response_info** ppresponse_info, const epee::net_utils::http::fields_list& additional_params) override
+    {
+      return invoke(uri, "GET", body, timeout, ppresponse_info, additional_params);
+    }
+    uint64_t get_bytes_sent() const override { return 0; }
+    uint64_t get_bytes_received() const override { return 0; }
+
+  private:
+    test_daemon &m_daemon;
+    epee::net_utils::http::http_response_info m_response;
+  };
+
+  class test_daemon_client_factory: public epee::net_utils::http::http_client_factory
+  {
+  public:
+    test_daemon_client_factory(test_daemon &daemon): m_daemon(daemon) {}
+    std::unique_ptr<epee::net_utils::http::abstract_http_client> create() override
+    {
+      return std::unique_ptr<epee::net_utils::http::abstract_http_client>(new test_daemon_client(m_daemon));
+    }
+
+  private:
+    test_daemon &m_daemon;
+  };
+
+  inline std::unique_ptr<epee::net_utils::http::http_client_factory> test_daemon::client_factory()
+  {
+    return std::unique_ptr<epee::net_utils::http::http_client_factory>(new test_daemon_client_factory(*this));
+  }
+}
@@ -0,0 +1,90 @@
+// Copyright (c) 2023, Zephyr Protocol
+// Portions copyright (c) 2016-2019, The Monero Project
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "gtest/gtest.h"
+
+#include "ringct/bulletproofs_plus.h"
+#include "ringct/rctSigs.h"
+#include "wallet_test_daemon.h"
+
+namespace
+{
+  // few enough outputs that the wallet does not check how its rings spread
+  const uint64_t chain_height = 1000;
+  const uint64_t outs_per_block = 8;
+
+  // 40 destinations, split over 3 txes of at most 15 destinations each
+  std::vector<tools::wallet2::pending_tx> make_split_transfer(bool pipelined)
+  {
+    unit_test::test_daemon daemon(chain_height, outs_per_block);
+    tools::wallet2 wallet(cryptonote::MAINNET, 1, true, daemon.client_factory());
+    wallet.generate("", "");
+    wallet.segregate_pre_fork_outputs(false);
+    wallet.key_reuse_mitigation2(false);
+    daemon.sync(wallet);
+    for (uint64_t n = 0; n < 6; ++n)
+      daemon.add_output(wallet, 1000 + n * 900, 10 * COIN);
+
+    std::vector<cryptonote::tx_destination_entry> dsts;
+    for (size_t n = 0; n < 40; ++n)
+    {
+      cryptonote::account_base recipient;
+      recipient.generate();
+      dsts.push_back(cryptonote::tx_destination_entry(COIN / 10, recipient.get_keys().m_account_address, false));
+    }
+    return wallet.create_transactions_2(dsts, "ZEPH", 15, 0, 1, {}, 0, {}, pipelined);
+  }
+
+  void check_signed(const std::vector<tools::wallet2::pending_tx> &ptx_vector)
+  {
+    ASSERT_EQ(ptx_vector.size(), 3u);
+    for (const tools::wallet2::pending_tx &ptx: ptx_vector)
+    {
+      const rct::rctSig &rv = ptx.tx.rct_signatures;
+      ASSERT_EQ(rv.p.CLSAGs.size(), ptx.tx.vin.size());
+      ASSERT_EQ(rv.mixRing.size(), ptx.tx.vin.size());
+      for (const auto &ring: rv.mixRing)
+        ASSERT_EQ(ring.size(), 16u);
+      // dummy proofs from a fake mode device fail both of these
+      ASSERT_TRUE(rct::verRctNonSemanticsSimple(rv));
+      ASSERT_EQ(rv.p.bulletproofs_plus.size(), 1u);
+      ASSERT_TRUE(rct::bulletproof_plus_VERIFY(rv.p.bulletproofs_plus));
+    }
+  }
+}
+
+TEST(wallet_tx_pipeline, serial_txes_are_signed)
+{
+  check_signed(make_split_transfer(false));
+}
+
+TEST(wallet_tx_pipeline, pipelined_txes_are_signed)
+{
+  check_signed(make_split_transfer(true));
+}